@@ -0,0 +1,147 @@
+/**
+ * @file busArbiter.hpp
+ * @brief In-process arbitration of the shared I2C bus by priority and deadline.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   /dev/i2c-3 carries the MLX90640 (0x33) and a handful of housekeeping
+ *   devices (0x1a, 0x21, 0x40, 0x48-0x4b, 0x4f, 0x50, 0x57). Each client
+ *   talks to its device through an ArbitratedDevice, a drop-in I2cDevice
+ *   whose transfers first queue at the BusArbiter. The arbiter grants the
+ *   bus to one transaction at a time: highest priority first, then the
+ *   earliest deadline (start time plus the client's budget), then arrival
+ *   order.
+ *
+ *   A transaction on the wire cannot be pre-empted, so clients marked
+ *   splittable have their multi-message transfers issued one register
+ *   access (address write + read, or a single write) at a time, and go
+ *   back into the queue between them. A subpage burst arriving halfway
+ *   through a 256-byte EEPROM dump then waits for one access, not the
+ *   whole dump. Non-splittable transfers (the MLX90640's combined STATUS +
+ *   RAM read relies on it) go out in one piece.
+ *
+ *   Per-client counters record queue wait, bus time, deadline misses and
+ *   how often a split transfer gave way to another client. Only this
+ *   process is arbitrated; kernel drivers holding the UU addresses still
+ *   share the adapter's own lock.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "i2cUtils.hpp"
+
+namespace duosight {
+
+class MetricsRegistry;
+class Histogram;
+
+enum class BusPriority : uint8_t {
+    Housekeeping = 0,   ///< slow polling of auxiliary sensors, EEPROM dumps
+    Normal       = 1,
+    Critical     = 2    ///< subpage acquisition
+};
+
+struct BusClientOptions {
+    std::string name;
+    BusPriority priority  {BusPriority::Normal};
+    int64_t     budgetNs  {20'000'000};   ///< deadline = request time + budget
+    bool        splittable {false};       ///< issue multi-message transfers access by access
+};
+
+struct BusClientStats {
+    std::string name;
+    BusPriority priority       {BusPriority::Normal};
+    uint64_t    transactions   {0};   ///< calls made by the client
+    uint64_t    grants         {0};   ///< bus grants (> transactions when split)
+    uint64_t    yields         {0};   ///< times another client cut into a split transfer
+    uint64_t    deadlineMisses {0};
+    int64_t     waitNs         {0};   ///< summed over grants
+    int64_t     maxWaitNs      {0};
+    int64_t     busNs          {0};
+
+    double meanWaitNs() const { return grants ? double(waitNs) / double(grants) : 0.0; }
+};
+
+class BusArbiter {
+public:
+    using Clock = std::function<int64_t()>;
+
+    /// now defaults to the steady clock (nanoseconds).
+    explicit BusArbiter(Clock now = {});
+
+    /// Returns the client id passed to run(); ids are never reused.
+    int addClient(const BusClientOptions& options);
+
+    /// Runs op while holding the bus. deadlineNs orders the request among
+    /// equal priorities; 0 means now + the client's budget.
+    bool run(int client, const std::function<bool()>& op, int64_t deadlineNs = 0);
+
+    /// Runs a transfer on dev, split at register accesses if the client
+    /// is splittable. Counted as one transaction.
+    bool transfer(int client, I2cDevice& dev, I2cMessage* messages, size_t count);
+
+    BusClientOptions client(int id) const;
+    std::vector<BusClientStats> stats() const;
+
+    /// Per-client wait histograms and counters, labelled client="name".
+    void attachMetrics(MetricsRegistry& registry);
+
+private:
+    struct Client {
+        BusClientOptions options;
+        BusClientStats   stats;
+        Histogram*       waitSeconds {nullptr};
+    };
+
+    struct Waiter {
+        int      client;
+        uint8_t  priority;
+        int64_t  deadlineNs;
+        uint64_t seq;
+    };
+
+    int64_t acquire(int client, int64_t deadlineNs, bool resumed);   // returns time granted
+    void    release(int client, int64_t grantedNs, int64_t deadlineNs);
+    static bool before(const Waiter& a, const Waiter& b);
+
+    Clock                                now_;
+    mutable std::mutex                   mutex_;
+    std::condition_variable              cv_;
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::vector<Waiter>                  queue_;
+    uint64_t                             seq_     {0};
+    bool                                 busy_    {false};
+    int                                  lastHolder_ {-1};
+};
+
+/// I2cDevice that routes every transfer on dev through the arbiter.
+class ArbitratedDevice : public I2cDevice {
+public:
+    ArbitratedDevice(BusArbiter& arbiter, I2cDevice& dev, const BusClientOptions& options);
+
+    int clientId() const { return client_; }
+
+    bool isOpen() const override { return dev_.isOpen(); }
+    bool writeBytes(const uint8_t* data, size_t length) override;
+    bool readBytes(uint8_t* buffer, size_t length) override;
+    bool writeThenRead(const uint8_t* txData, size_t txLen, uint8_t* rxData, size_t rxLen) override;
+    bool transfer(I2cMessage* messages, size_t count) override;
+
+private:
+    BusArbiter& arbiter_;
+    I2cDevice&  dev_;
+    int         client_;
+};
+
+} // namespace duosight
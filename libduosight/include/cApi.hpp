@@ -0,0 +1,40 @@
+/**
+ * @file cApi.hpp
+ * @brief C++ host side of the duosight.h frame pipeline.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Publishes graph frames into a ds_pipeline by reference: the ring slot
+ *   holds the FramePtr, and a borrow hands the consumer the address of
+ *   that frame's temperature array. No pixel is copied between the
+ *   acquisition thread and the foreign consumer.
+ *
+ *   Attaching a pipeline to a host's graph, before configure():
+ *
+ *       ds_pipeline* ffi = ds_pipeline_create(8);
+ *       graph.addNode("ffi", NodeKind::Sink, pipelineSink(ffi));
+ *       graph.configure("source -> render[1]; source -> ffi[8]");
+ *       // hand `ffi` to the embedded consumer; it calls ds_reader_open()
+ *
+ *   Destroying the pipeline before the graph is safe: the sink holds the
+ *   ring's shared state and from then on publishes nothing.
+ */
+
+#pragma once
+
+#include "duosight.h"
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+/// Publishes one frame without copying it.
+DS_API bool publish(ds_pipeline* pipeline, FramePtr frame);
+
+/// Sink stage publishing every frame it receives to pipeline.
+DS_API ProcessingGraph::StageFn pipelineSink(ds_pipeline* pipeline);
+
+} // namespace duosight
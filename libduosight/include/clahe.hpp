@@ -0,0 +1,94 @@
+/**
+ * @file clahe.hpp
+ * @brief Contrast-limited adaptive histogram equalisation for the thermal view.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Display-only transform: a temperature frame is bilinearly upscaled to
+ *   a 10-bit grey image, and each tile of that image gets its own clipped
+ *   histogram-equalisation curve, blended bilinearly between tile centres.
+ *   A small gradient next to one hot object then still spans many grey
+ *   levels instead of two or three, and the extra input bits keep the
+ *   stretched gradient from banding. Output is 8-bit for the palette. The
+ *   temperatures are only read; keep using them for any measurement.
+ *
+ *   Tile histograms are accumulated in the same pass that writes the
+ *   upscaled pixels, and every per-column / per-row interpolation weight
+ *   (source sampling and tile blending) is precomputed for the output
+ *   size, so a frame is two passes over the image. Blends are Q7 fixed
+ *   point, NEON on ARM with a bit-identical scalar path elsewhere.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+
+namespace duosight {
+
+struct ClaheOptions {
+    int   width     {640};
+    int   height    {480};
+    int   tilesX    {8};
+    int   tilesY    {8};
+    float clipLimit {3.0f};   ///< histogram clip, multiple of a flat bin (1 = plain linear)
+};
+
+class Clahe {
+public:
+    static constexpr int BINS = 1024;   ///< input levels (10-bit)
+
+    explicit Clahe(const ClaheOptions& options = {});
+
+    /// Upscales a WIDTH x HEIGHT temperature frame to 0..BINS-1 over
+    /// [lo, hi] and builds the tile histograms.
+    void upscale(const float* temperatures, float lo, float hi);
+
+    /// Writes the equalised image (width * height bytes, row-major).
+    void equalise(uint8_t* out);
+
+    /// upscale() over the frame's own min..max, then equalise().
+    void apply(const float* temperatures, uint8_t* out);
+
+    const uint16_t* levels() const { return levels_.data(); }   ///< linear mapping, before equalising
+    int width()  const { return opt_.width; }
+    int height() const { return opt_.height; }
+
+private:
+    using Lut = std::array<uint8_t, BINS>;
+
+    /// Run of columns sharing the same pair of tile columns.
+    struct Span {
+        int     begin;
+        int     end;
+        uint8_t t0;
+        uint8_t t1;
+    };
+
+    void buildLuts();
+
+    ClaheOptions opt_;
+
+    // Source sampling for the upscale: index of the left/top source pixel
+    // and the weight of the right/bottom one.
+    std::vector<uint16_t> srcX_, srcY_;
+    std::vector<float>    fracX_, fracY_;
+
+    // Tile blending: neighbouring tiles and the Q7 weight of the second.
+    std::vector<uint8_t> tileX0_, tileX1_, weightX_;
+    std::vector<uint8_t> tileY0_, tileY1_, weightY_;
+    std::vector<uint8_t> tileOfX_, tileOfY_;             // histogram tile per column / row
+    std::vector<Span>    spans_;
+
+    std::vector<uint16_t>                   levels_;
+    std::vector<std::array<uint32_t, BINS>> hist_;        // tilesY * tilesX
+    std::vector<Lut>                        luts_;
+};
+
+} // namespace duosight
@@ -0,0 +1,123 @@
+/**
+ * @file duosight.h
+ * @brief Stable C ABI for consuming DuoSight frames from other languages.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Plain C99 interface for FFI consumers (Python ctypes/cffi, Rust). A
+ *   ds_pipeline is a ring of the most recent frames; each ds_reader is an
+ *   independent consumer cursor on it. ds_reader_borrow() hands out a
+ *   pointer to a frame's pixels and metadata without copying them; the
+ *   frame stays valid, even after the ring moves on, until the reader
+ *   passes it back to ds_reader_release(). C++ hosts feed the ring
+ *   straight from the processing graph (cApi.hpp), so the pixels a
+ *   consumer reads are the ones acquisition wrote. Acquisition itself
+ *   still copies once: MLX90640Reader::readFrame fills a std::vector,
+ *   which is copied into the published ThermalFrame. Past that point no
+ *   pixel is copied.
+ *
+ *   The library never creates a pipeline itself, and neither does the
+ *   bundled Qt viewer. A host process that embeds the consumer attaches
+ *   one as described in cApi.hpp.
+ *
+ *   Layout guarantees, fixed for DS_ABI_VERSION 1:
+ *     - pixels: IEEE-754 float32, host byte order, degrees Celsius
+ *     - row-major, width x height = 32 x 24, rows row_stride bytes apart
+ *       (128, i.e. tightly packed), no padding between rows
+ *     - the first pixel is aligned to DS_PIXEL_ALIGNMENT (64) bytes
+ *     - timestamp_ns is CLOCK_MONOTONIC nanoseconds
+ *   New fields are only ever appended to ds_frame; check struct_size
+ *   before reading past the fields you know.
+ *
+ *   Threading: pipelines are thread-safe. A reader, and the frames it
+ *   borrowed, belong to one thread at a time. Every call returns a
+ *   ds_status; nothing aborts or throws across the boundary.
+ */
+
+#ifndef DUOSIGHT_H
+#define DUOSIGHT_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  define DS_API __declspec(dllexport)
+#else
+#  define DS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DS_ABI_VERSION      1u
+#define DS_WIDTH            32u
+#define DS_HEIGHT           24u
+#define DS_PIXELS           (DS_WIDTH * DS_HEIGHT)
+#define DS_ROW_STRIDE       (DS_WIDTH * 4u)   /* bytes */
+#define DS_PIXEL_ALIGNMENT  64u               /* bytes */
+#define DS_MAX_BORROWS      16u               /* outstanding per reader */
+
+typedef enum ds_status {
+    DS_OK        =  0,
+    DS_TIMEOUT   =  1,   /* no new frame within the timeout */
+    DS_EINVAL    = -1,   /* null handle or a frame this reader does not hold */
+    DS_ECLOSED   = -2,   /* pipeline destroyed; no further frames */
+    DS_ELIMIT    = -3,   /* DS_MAX_BORROWS frames already held */
+    DS_ENOMEM    = -4
+} ds_status;
+
+typedef struct ds_pipeline ds_pipeline;
+typedef struct ds_reader   ds_reader;
+
+typedef struct ds_frame {
+    uint32_t     struct_size;     /* sizeof(ds_frame) in this library */
+    uint32_t     width;           /* DS_WIDTH */
+    uint32_t     height;          /* DS_HEIGHT */
+    uint32_t     row_stride;      /* bytes between rows, DS_ROW_STRIDE */
+    uint64_t     sequence;        /* acquisition counter */
+    int64_t      timestamp_ns;    /* CLOCK_MONOTONIC */
+    uint64_t     dropped;         /* frames this reader skipped since its previous borrow */
+    uint32_t     changed_tiles;   /* scene-change tile mask; all set = unknown */
+    float        change_score;    /* mean |delta| against the scene reference, degC */
+    const float* pixels;          /* degC, valid until ds_reader_release() */
+} ds_frame;
+
+/** DS_ABI_VERSION the library was built with. */
+DS_API uint32_t ds_abi_version(void);
+
+/** Ring keeping the latest `slots` frames (at least 2). NULL on failure. */
+DS_API ds_pipeline* ds_pipeline_create(uint32_t slots);
+
+/** Wakes blocked readers with DS_ECLOSED. Readers must still be closed;
+ *  borrowed frames stay valid until released. */
+DS_API void ds_pipeline_destroy(ds_pipeline* pipeline);
+
+/** For C producers: copies DS_PIXELS values (degC) into a new frame. C++
+ *  hosts publish by reference instead (cApi.hpp). */
+DS_API ds_status ds_pipeline_publish(ds_pipeline* pipeline, const float* celsius,
+                                     uint64_t sequence, int64_t timestamp_ns);
+
+/** Frames published so far. */
+DS_API uint64_t ds_pipeline_published(const ds_pipeline* pipeline);
+
+/** New consumer cursor; it sees frames published after this call. */
+DS_API ds_reader* ds_reader_open(ds_pipeline* pipeline);
+
+/** Releases anything still borrowed and frees the reader. */
+DS_API void ds_reader_close(ds_reader* reader);
+
+/** Oldest frame newer than this reader's previous one that the ring still
+ *  holds. timeout_ms < 0 waits indefinitely, 0 polls. */
+DS_API ds_status ds_reader_borrow(ds_reader* reader, int32_t timeout_ms, const ds_frame** frame);
+
+/** Returns a borrowed frame; the pointer and its pixels become invalid. */
+DS_API ds_status ds_reader_release(ds_reader* reader, const ds_frame* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DUOSIGHT_H */
@@ -0,0 +1,102 @@
+/**
+ * @file frameHistory.hpp
+ * @brief Mirrored virtual-memory ring of recent frames.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   The ring's physical pages (a memfd) are mapped twice, back to back, so
+ *   slot k and slot k + capacity alias the same memory. Any run of the most
+ *   recent N frames is therefore one contiguous block, even when it wraps,
+ *   and temporal stages receive it as a zero-copy FrameWindow instead of
+ *   copying frames into a scratch tensor every step.
+ *
+ *   Single producer. One slot is always reserved for the frame being
+ *   written, so a window of N frames stays valid until (capacity - 1 - N)
+ *   further frames have been pushed; use isIntact() to check after long
+ *   work. stage() makes the history a graph sink; RateOfRise keeps its
+ *   fit samples in one and reads them back as windows.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "MLX90640Regs.hpp"
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+/// Strided read-only view of consecutive frames, oldest first.
+struct FrameWindow {
+    const float* data        {nullptr};
+    size_t       frames      {0};
+    size_t       width       {Geometry::WIDTH};
+    size_t       height      {Geometry::HEIGHT};
+    size_t       rowStride   {Geometry::WIDTH};   ///< floats between rows
+    size_t       frameStride {Geometry::PIXELS};  ///< floats between frames
+    uint64_t     firstSequence {0};               ///< sequence of frame 0
+    const int64_t* timestampsNs {nullptr};        ///< one per frame, same order
+
+    const float* frame(size_t k) const { return data + k * frameStride; }
+    int64_t timestampNs(size_t k) const { return timestampsNs[k]; }
+    float at(size_t k, size_t row, size_t col) const
+    {
+        return data[k * frameStride + row * rowStride + col];
+    }
+};
+
+class FrameHistory {
+public:
+    /// @param minCapacity frames to keep; rounded up (plus the write slot)
+    ///        so the ring spans whole pages (a multiple of 4 frames with
+    ///        4 KiB pages).
+    explicit FrameHistory(size_t minCapacity);
+    ~FrameHistory();
+
+    FrameHistory(const FrameHistory&) = delete;
+    FrameHistory& operator=(const FrameHistory&) = delete;
+
+    bool   isValid()  const { return base_ != nullptr; }
+    size_t capacity()  const { return capacity_; }
+    size_t maxWindow() const { return capacity_ ? capacity_ - 1 : 0; }
+    size_t size()      const;                ///< frames available to window()
+
+    /// Copies a frame's temperatures into the next slot.
+    void push(const ThermalFrame& frame);
+
+    /// Zero-copy producer path: write PIXELS floats, then commit.
+    float* beginWrite();
+    void   commitWrite(uint64_t sequence, int64_t timestampNs = 0);
+
+    /// Graph sink that push()es every frame it receives. A node runs one
+    /// frame at a time, so the graph is the single producer.
+    ProcessingGraph::StageFn stage();
+
+    /// Latest n frames as one contiguous view. False if fewer are stored.
+    bool window(size_t n, FrameWindow& out) const;
+
+    /// True while none of the window's frames has been overwritten.
+    bool isIntact(const FrameWindow& w) const;
+
+private:
+    static constexpr size_t SLOT_FLOATS = Geometry::PIXELS;
+
+    float*   slot(uint64_t index) const;
+
+    float*   base_      {nullptr};   // start of the doubled mapping
+    size_t   bytes_     {0};         // size of one copy of the ring
+    size_t   capacity_  {0};
+
+    std::unique_ptr<std::atomic<uint64_t>[]> sequences_;   // per slot
+    std::unique_ptr<int64_t[]> timestamps_;               // per slot, stored twice like the frames
+    std::atomic<uint64_t> written_ {0};                   // frames committed so far
+};
+
+} // namespace duosight
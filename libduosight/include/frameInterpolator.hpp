@@ -0,0 +1,97 @@
+/**
+ * @file frameInterpolator.hpp
+ * @brief Display-side frame-rate upconversion between measured frames.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   At 4-8 Hz the live view steps visibly. The interpolator keeps the two
+ *   most recent frames and synthesises one for any display time between
+ *   them, either as a linear cross-fade or motion-compensated: block
+ *   matching on the 32x24 grid finds where each 4x4 block moved, and the
+ *   output samples both frames along that path, so a moving hand glides
+ *   instead of ghosting. Motion is estimated once per measured frame;
+ *   rendering an output frame is a few microseconds.
+ *
+ *   The view runs one measured-frame period behind real time (it needs
+ *   the next frame to interpolate towards). Output is a DisplayFrame, not
+ *   a ThermalFrame: interpolated values are not measurements and must not
+ *   reach radiometric stages, readouts or recordings.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+#include "MLX90640Regs.hpp"
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+enum class InterpolationMode { Linear, MotionCompensated };
+
+struct InterpolationOptions {
+    InterpolationMode mode         {InterpolationMode::MotionCompensated};
+    int               searchRadius {3};              ///< ± pixels searched per block
+    float             noiseFloor   {0.15f};          ///< °C per pixel a vector must beat zero motion by
+    int64_t           maxGapNs     {1'000'000'000};  ///< longer gaps hold the newer frame
+};
+
+/// One synthesised display frame. Non-radiometric: values are blended
+/// temperatures for colour mapping only.
+struct DisplayFrame {
+    static constexpr bool radiometric = false;
+
+    int64_t  timestampNs  {0};   ///< display time the frame represents
+    uint64_t fromSequence {0};
+    uint64_t toSequence   {0};
+    float    phase        {0.0f};   ///< 0 = from frame, 1 = to frame
+    std::array<float, Geometry::PIXELS> values {};   ///< row-major, °C scale, NOT measured
+};
+
+struct MotionVector {
+    int8_t dx {0};
+    int8_t dy {0};
+};
+
+class FrameInterpolator {
+public:
+    static constexpr int BLOCK    = 4;
+    static constexpr int BLOCKS_X = Geometry::WIDTH / BLOCK;
+    static constexpr int BLOCKS_Y = Geometry::HEIGHT / BLOCK;
+
+    explicit FrameInterpolator(const InterpolationOptions& options = {});
+
+    /// Accepts a measured frame and estimates motion from the previous one.
+    void push(const FramePtr& frame);
+
+    /// Frame for display time nowNs (shown one input period late). False
+    /// until two frames have arrived. Safe against a concurrent push().
+    bool render(int64_t nowNs, DisplayFrame& out) const;
+
+    /// Graph sink around push().
+    ProcessingGraph::StageFn stage();
+
+    /// Per-block motion from the previous to the latest frame.
+    std::array<MotionVector, BLOCKS_X * BLOCKS_Y> motion() const;
+
+    const InterpolationOptions& options() const { return opt_; }
+
+private:
+    void estimateMotion(const float* from, const float* to,
+                        std::array<MotionVector, BLOCKS_X * BLOCKS_Y>& motion) const;
+
+    InterpolationOptions opt_;
+
+    mutable std::mutex                            mutex_;
+    FramePtr                                      from_;
+    FramePtr                                      to_;
+    std::array<MotionVector, BLOCKS_X * BLOCKS_Y> motion_ {};
+};
+
+} // namespace duosight
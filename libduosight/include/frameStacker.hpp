@@ -0,0 +1,101 @@
+/**
+ * @file frameStacker.hpp
+ * @brief Sigma-clipped stacking of merged frames into a low-noise snapshot.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   An inspection snapshot averages N consecutive frames: pixel noise
+ *   falls by sqrt(N) while transients (a hand passing through, a reflection
+ *   flicker) are removed by iterative sigma clipping rather than smeared
+ *   into the mean. Each frame is kept and folded into double-precision
+ *   sum / sum-of-squares accumulators as it arrives (NEON on AArch64);
+ *   the clipping passes run once, when the Nth frame lands.
+ *
+ *   The stacker is a graph stage: wired beside the live view it sees the
+ *   same frames, so a capture costs no extra bus traffic. arm() starts a
+ *   capture from any thread with the first frame stamped after the call,
+ *   however many older frames are still queued for the stage. The stage
+ *   forwards the stacked mean as a frame when it completes and hands the
+ *   full result to a callback.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+struct StackOptions {
+    size_t frames     {64};     ///< frames per snapshot
+    float  clipSigma  {3.0f};   ///< reject |x - mean| > clipSigma * sigma
+    int    clipPasses {3};      ///< 0 disables clipping
+    float  minSigma   {0.05f};  ///< sigma floor, °C (keeps flat pixels from rejecting everything)
+};
+
+struct StackedFrame {
+    uint64_t firstSequence {0};
+    uint64_t lastSequence  {0};
+    int64_t  timestampNs   {0};   ///< of the last frame
+    uint32_t frames        {0};
+    uint64_t rejected      {0};   ///< samples clipped, all pixels
+    std::array<float, Geometry::PIXELS>    mean     {};
+    std::array<float, Geometry::PIXELS>    variance {};  ///< per-sample, unbiased; / used = variance of mean
+    std::array<uint16_t, Geometry::PIXELS> used     {};  ///< frames kept per pixel
+};
+
+using StackPtr = std::shared_ptr<const StackedFrame>;
+
+class FrameStacker {
+public:
+    using DoneFn = std::function<void(const StackPtr&)>;
+
+    explicit FrameStacker(const StackOptions& options = {});
+
+    /// Starts a capture with the first frame stamped at or after fromNs
+    /// (default: now), so frames still queued from before the call, e.g.
+    /// before a shutter closed, are not stacked. done runs on the thread
+    /// that adds the last frame. False if a capture is already running.
+    bool arm(DoneFn done = nullptr, int64_t fromNs = monotonicNowNs());
+    bool armed() const { return armed_.load(std::memory_order_acquire); }
+
+    /// Feeds a frame; returns the result once it completes a capture.
+    /// Cheap no-op while disarmed or for frames older than the arm time.
+    StackPtr add(const ThermalFrame& frame);
+
+    /// Graph stage around add(): forwards the stacked mean as a frame.
+    ProcessingGraph::StageFn stage();
+
+    const StackOptions& options() const { return opt_; }
+
+private:
+    std::shared_ptr<StackedFrame> finish();
+
+    StackOptions             opt_;
+    std::atomic<bool>        armed_ {false};
+    std::mutex               mutex_;
+    DoneFn                   done_;
+
+    // Capture state (guarded by mutex_)
+    std::vector<float>       frames_;        // frames x PIXELS, for clipping
+    size_t                   count_  {0};
+    int64_t                  fromNs_ {0};
+    uint64_t                 firstSequence_ {0};
+    std::array<float,  Geometry::PIXELS> ref_   {};   // first frame; sums are offsets from it
+    std::array<double, Geometry::PIXELS> sum_   {};
+    std::array<double, Geometry::PIXELS> sumSq_ {};
+};
+
+} // namespace duosight
@@ -8,7 +8,8 @@
  *
  * Summary:
  *   Provides a lightweight, object-oriented wrapper around /dev/i2c-X
- *   for use in sensor applications such as MLX90640.
+ *   for use in sensor applications such as MLX90640. The transfer
+ *   primitives are virtual so simulated devices can stand in for the bus.
  */
 
 #pragma once
@@ -18,19 +19,40 @@
 
 namespace duosight {
 
+/// One message of a combined transaction; messages are joined by repeated
+/// STARTs, so no other bus master can slip in between them.
+struct I2cMessage {
+    bool     read   {false};
+    uint8_t* data   {nullptr};
+    size_t   length {0};
+};
+
 class I2cDevice {
 public:
     I2cDevice(const std::string& devicePath, uint8_t address);
-    ~I2cDevice();
+    virtual ~I2cDevice();
 
-    bool isOpen() const;
+    I2cDevice(const I2cDevice&) = delete;
+    I2cDevice& operator=(const I2cDevice&) = delete;
 
-    bool writeBytes(const uint8_t* data, size_t length);
-    bool readBytes(uint8_t* buffer, size_t length);
-    bool writeThenRead(const uint8_t* txData, size_t txLen, uint8_t* rxData, size_t rxLen);
+    virtual bool isOpen() const;
+
+    virtual bool writeBytes(const uint8_t* data, size_t length);
+    virtual bool readBytes(uint8_t* buffer, size_t length);
+    virtual bool writeThenRead(const uint8_t* txData, size_t txLen, uint8_t* rxData, size_t rxLen);
+    /// Up to MAX_MESSAGES messages in one I2C_RDWR transaction.
+    virtual bool transfer(I2cMessage* messages, size_t count);
     bool readRegister16(uint16_t reg, uint16_t& value);
     bool writeRegister16(uint16_t reg, uint16_t value);
-    
+
+    uint8_t address() const { return addr_; }
+
+    static constexpr size_t MAX_MESSAGES = 42;   ///< I2C_RDWR_IOCTL_MAX_MSGS
+
+protected:
+    /// For devices that are not backed by /dev/i2c-X (simulators).
+    explicit I2cDevice(uint8_t address);
+
 private:
     int fd_;
     uint8_t addr_;
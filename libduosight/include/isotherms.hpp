@@ -0,0 +1,143 @@
+/**
+ * @file isotherms.hpp
+ * @brief Marching-squares isotherm contours as compact vector output.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Contours at fixed temperatures (e.g. 60 and 80 °C) are traced directly
+ *   on the 32x24 grid. Each 2x2 cell of pixel centres is classified by
+ *   which corners are at or above the level. The crossing on each cell
+ *   edge is placed by linear interpolation between its two pixels. Saddle
+ *   cells are resolved by the mean of their four corners. Each crossing
+ *   is shared by the two cells either side of it, so segments join into
+ *   polylines: open ones end on the border, closed ones are loops.
+ *   Coordinates are in pixel units with pixel (col, row) at (col, row),
+ *   so a renderer scales them to any view size. Nothing is rasterised.
+ *
+ *   Frames mostly change in a few places. A pixel counts as changed only
+ *   when it has moved more than `tolerance` since it was last used. Only
+ *   the cells around changed pixels are reclassified, and a level is
+ *   re-joined only when one of its cells changed class. A level whose
+ *   crossings all sit between unchanged pixels is reused as it was.
+ *   The default tolerance of 0.2 °C is about twice the per-pixel noise
+ *   (1σ 0.1 °C). Below the noise nearly every pixel counts as changed and
+ *   the cache saves nothing. Crossings are placed from the values last
+ *   used, so they may lag the frame by up to the tolerance; set it to 0
+ *   for output identical to a fresh extraction.
+ *
+ *   encode() packs a set for the network: centi-degree levels, 1/64-pixel
+ *   coordinates, and zig-zag varint deltas along each line. A typical
+ *   contour costs about two bytes per point.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+struct IsoPoint {
+    float x {0.0f};   ///< column, 0 .. WIDTH - 1
+    float y {0.0f};   ///< row, 0 .. HEIGHT - 1
+};
+
+struct Isoline {
+    uint8_t  level  {0};       ///< index into IsothermSet::levels
+    bool     closed {false};   ///< loop; the last point joins the first
+    uint32_t first  {0};       ///< into IsothermSet::points
+    uint32_t count  {0};
+};
+
+struct IsothermSet {
+    uint64_t              sequence    {0};
+    int64_t               timestampNs {0};
+    std::vector<float>    levels;        ///< °C
+    std::vector<Isoline>  lines;
+    std::vector<IsoPoint> points;
+};
+
+using IsothermPtr = std::shared_ptr<const IsothermSet>;
+
+struct IsothermOptions {
+    std::vector<float> levels    {60.0f, 80.0f};   ///< °C, at most 255
+    float              tolerance {0.2f};           ///< °C a pixel must move to count as changed; 0 is exact
+};
+
+struct IsothermStats {
+    uint64_t frames          {0};
+    uint64_t cellsClassified {0};   ///< cell x level classifications done
+    uint64_t cellsReused     {0};   ///< skipped because no corner changed
+    uint64_t levelsJoined    {0};   ///< levels whose polylines were rebuilt
+    uint64_t levelsReused    {0};   ///< levels taken unchanged from the last frame
+};
+
+class IsothermExtractor {
+public:
+    static constexpr int CELLS_X = Geometry::WIDTH - 1;
+    static constexpr int CELLS_Y = Geometry::HEIGHT - 1;
+    static constexpr int CELLS   = CELLS_X * CELLS_Y;
+    static constexpr int H_EDGES = CELLS_X * Geometry::HEIGHT;   // between horizontal neighbours
+    static constexpr int EDGES   = H_EDGES + Geometry::WIDTH * CELLS_Y;
+
+    explicit IsothermExtractor(const IsothermOptions& options = {});
+
+    /// Contours of one frame (WIDTH x HEIGHT, row-major).
+    IsothermPtr update(const float* temperatures, uint64_t sequence = 0, int64_t timestampNs = 0);
+
+    /// Graph sink around update(); the result is read with latest().
+    ProcessingGraph::StageFn stage();
+    /// Last result, or nullptr before the first frame. Safe against a concurrent update().
+    IsothermPtr latest() const;
+
+    IsothermStats stats() const { return stats_; }
+    const IsothermOptions& options() const { return opt_; }
+
+    /// Wire format; decode() returns false on a malformed buffer.
+    static std::vector<uint8_t> encode(const IsothermSet& set);
+    static bool decode(const uint8_t* data, size_t size, IsothermSet& out);
+
+private:
+    struct Level {
+        float                           c {0.0f};
+        std::array<uint8_t, CELLS>      cls {};        // corner bits: tl 1, tr 2, br 4, bl 8
+        std::vector<std::vector<uint16_t>> chains;     // edge ids per polyline
+        std::vector<bool>               closed;
+        std::vector<IsoPoint>           points;        // chains' crossings, in order
+        bool                            valid {false};
+    };
+
+    uint8_t  classify(const Level& level, int cx, int cy) const;
+    void     join(Level& level);
+    void     place(Level& level) const;
+    IsoPoint crossing(int edge, float c) const;
+
+    IsothermOptions opt_;
+    std::vector<Level> levels_;
+
+    std::array<float, Geometry::PIXELS> ref_ {};     // values last used, per pixel
+    bool                                haveRef_ {false};
+    std::array<uint8_t, CELLS>          dirty_ {};   // a corner changed this frame
+
+    // Join scratch, sized once
+    std::vector<std::array<uint16_t, 2>> links_;
+    std::vector<uint8_t>                 degree_;
+    std::vector<uint8_t>                 visited_;
+
+    IsothermStats stats_;
+
+    mutable std::mutex mutex_;
+    IsothermPtr        latest_;
+};
+
+} // namespace duosight
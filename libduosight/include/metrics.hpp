@@ -0,0 +1,128 @@
+/**
+ * @file metrics.hpp
+ * @brief Lock-free counters, gauges and histograms with Prometheus text output.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Instruments are plain relaxed atomics, so updating one from the
+ *   acquisition loop or a pool worker costs a single atomic add (a CAS
+ *   loop for floating-point sums) and never takes a lock. The registry's
+ *   mutex guards only registration and render(), which formats the
+ *   exposition text on demand, i.e. once per scrape.
+ *
+ *   Instruments live as long as the registry and never move; hold the
+ *   returned references. Registering the same name and labels twice
+ *   returns the existing instrument.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duosight {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "metrics rely on lock-free 64-bit atomics");
+
+class Counter {
+public:
+    void     inc(uint64_t n = 1) noexcept { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const noexcept       { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_ {0};
+};
+
+class Gauge {
+public:
+    void   set(double v) noexcept;
+    void   add(double v) noexcept;
+    double value() const noexcept;
+
+private:
+    std::atomic<uint64_t> bits_ {0};   // IEEE-754 pattern of the value
+};
+
+class Histogram {
+public:
+    /// @param bounds ascending upper bounds; +Inf is implicit.
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double v) noexcept;
+
+    const std::vector<double>& bounds() const { return bounds_; }
+    uint64_t bucket(size_t i) const noexcept   ///< non-cumulative; i == bounds().size() is +Inf
+    {
+        return buckets_[i].load(std::memory_order_relaxed);
+    }
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    double   sum()   const noexcept { return sum_.value(); }
+
+    /// n bounds start, start*factor, ... (e.g. latencies).
+    static std::vector<double> exponential(double start, double factor, size_t n);
+
+private:
+    std::vector<double>                      bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t>                    count_ {0};
+    Gauge                                    sum_;
+};
+
+class MetricsRegistry {
+public:
+    /// Labels are given pre-formatted without braces, e.g. `stage="render"`.
+    Counter&   counter(const std::string& name, const std::string& help,
+                       const std::string& labels = "");
+    Gauge&     gauge(const std::string& name, const std::string& help,
+                     const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         std::vector<double> bounds, const std::string& labels = "");
+
+    /// Gauge sampled at scrape time, for values already kept elsewhere
+    /// (queue depths, graph stage statistics). fn runs on the scraping
+    /// thread and must be thread-safe.
+    void callbackGauge(const std::string& name, const std::string& help,
+                       std::function<double()> fn, const std::string& labels = "");
+    /// As callbackGauge(), for a monotonically increasing value.
+    void callbackCounter(const std::string& name, const std::string& help,
+                         std::function<double()> fn, const std::string& labels = "");
+
+    /// Prometheus text exposition format 0.0.4.
+    std::string render() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::string                labels;
+        std::unique_ptr<Counter>   counter;
+        std::unique_ptr<Gauge>     gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()>    callback;
+    };
+
+    struct Family {
+        std::string        name;
+        std::string        help;
+        Type               type;
+        std::deque<Series> series;
+    };
+
+    Series& series(const std::string& name, const std::string& help, Type type,
+                   const std::string& labels);
+
+    mutable std::mutex mutex_;
+    std::deque<Family> families_;
+};
+
+} // namespace duosight
@@ -0,0 +1,57 @@
+/**
+ * @file metricsServer.hpp
+ * @brief Minimal HTTP endpoint serving a MetricsRegistry at /metrics.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   One background thread multiplexes the listening socket and every open
+ *   connection with poll(), so concurrent scrapes never spawn threads and
+ *   a slow client cannot stall the others. Requests are answered with
+ *   HTTP/1.0 semantics (one response, then close), which is all a
+ *   Prometheus scraper or curl needs.
+ *
+ *   Binds to loopback by default; pass "0.0.0.0" to expose it to the
+ *   fleet collector. Port 0 picks a free port (see port()).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "metrics.hpp"
+
+namespace duosight {
+
+class MetricsServer {
+public:
+    MetricsServer(const MetricsRegistry& registry, uint16_t port,
+                  const std::string& bindAddress = "127.0.0.1");
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool     isRunning() const { return thread_.joinable(); }
+    uint16_t port()      const { return port_; }
+    uint64_t scrapes()   const { return scrapes_.load(std::memory_order_relaxed); }
+
+    void stop();
+
+private:
+    void run();
+
+    const MetricsRegistry& registry_;
+    int                    listenFd_ {-1};
+    int                    wakeFd_   {-1};   // eventfd, signalled by stop()
+    uint16_t               port_     {0};
+    std::atomic<uint64_t>  scrapes_  {0};
+    std::thread            thread_;
+};
+
+} // namespace duosight
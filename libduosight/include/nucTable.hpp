@@ -0,0 +1,64 @@
+/**
+ * @file nucTable.hpp
+ * @brief User non-uniformity correction tables and the calibration cache file.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A NucTable holds per-pixel offset (and optionally gain) corrections
+ *   measured against a uniform reference, on top of the factory EEPROM
+ *   calibration. Values live in the compensated-signal domain of the
+ *   Melexis conversion, so PixelConverter::applyNuc() can fold them into
+ *   its per-pixel offset / Kta / alpha coefficients instead of adding a
+ *   correction pass after conversion. Tables captured at several sensor
+ *   ambients (Ta) are fitted per pixel as offset(Ta) = a + b (Ta - 25).
+ *
+ *   CalibrationCache is the on-disk companion: the EEPROM image (so a
+ *   restart can skip the dump when the device ID matches) plus the NUC
+ *   tables captured for that sensor, in one CRC-checked file that is
+ *   replaced atomically and fsynced before save() reports success.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+
+namespace duosight {
+
+struct NucTable {
+    float ta  {25.0f};   ///< sensor ambient at capture, °C
+    float vdd {3.3f};    ///< supply at capture, V
+    std::array<float, Geometry::PIXELS> offset {};   ///< signal to remove, counts
+    std::array<float, Geometry::PIXELS> gain   {};   ///< responsivity vs factory (1 = none)
+
+    NucTable() { gain.fill(1.0f); }
+};
+
+struct CalibrationCache {
+    std::array<uint16_t, Eeprom::WORDS> eeprom {};
+    std::vector<NucTable>               nuc;
+
+    /// False (and leaves the cache untouched) if the file is missing,
+    /// truncated, fails its CRC or is from another format version.
+    bool load(const std::string& path);
+
+    /// Writes and fsyncs path + ".tmp", renames it over path and fsyncs
+    /// the directory.
+    bool save(const std::string& path) const;
+
+    /// True when id (Eeprom::ID_WORDS words read from Eeprom::DEVICE_ID)
+    /// matches the cached image.
+    bool sameDevice(const uint16_t* id) const;
+
+    /// Adds a table, replacing any captured within tolerance °C of its Ta.
+    void addNuc(const NucTable& table, float tolerance = 1.0f);
+};
+
+} // namespace duosight
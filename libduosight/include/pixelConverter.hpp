@@ -0,0 +1,278 @@
+/**
+ * @file pixelConverter.hpp
+ * @brief Per-pixel MLX90640 temperature conversion and lazily converted frames.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   MLX90640_CalculateTo converts every pixel of a subpage in one call.
+ *   PixelConverter splits that work into a per-subpage step (Ta, Vdd,
+ *   gain, compensation-pixel terms) and a per-pixel step that follows the
+ *   Melexis arithmetic term for term, so any single pixel can be converted
+ *   on its own with the same result.
+ *
+ *   User NUC tables (nucTable.hpp) are folded into the per-pixel offset,
+ *   Kta and alpha coefficients, so a corrected conversion runs the same
+ *   arithmetic as an uncorrected one.
+ *
+ *   CoefficientCache keeps the per-pixel factors that depend only on Ta
+ *   and Vdd (offset drift, supply sensitivity, alpha compensation) for one
+ *   sensor and recomputes them only when Ta or Vdd has moved by more than
+ *   an epsilon since they were computed. Ta and Vdd still come from every
+ *   subpage, so the scalar per-subpage terms stay current. With
+ *   `vectorised` set it also keeps those factors in a structure-of-arrays
+ *   block per readout pattern and subpage and converts four pixels at a
+ *   time (SSE2, AArch64 NEON, scalar otherwise) in single precision.
+ *
+ *   LazyFrame keeps the raw words of the latest subpage of each parity and
+ *   converts pixels only when asked (per pixel, per ROI or the full frame),
+ *   memoising results until the owning subpage is replaced.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MLX90640_API.h"
+#include "MLX90640Regs.hpp"
+#include "nucTable.hpp"
+
+namespace duosight {
+
+/// Terms shared by every pixel of one subpage.
+struct SubpageTerms {
+    int   subpage      {0};
+    bool  chessMode    {true};   ///< readout pattern of this subpage
+    bool  calibMode    {true};   ///< pattern matches the EEPROM calibration mode
+    float vdd          {3.3f};
+    float ta           {25.0f};
+    float gain         {1.0f};
+    float irDataCP     {0.0f};   ///< compensation pixel for this subpage
+    float taTr         {0.0f};   ///< reflected/ambient radiation term
+    float emissivity   {IRParams::EMISSIVITY};
+    float alphaCorrR[4] {};
+};
+
+/// Inclusive-exclusive rectangle in sensor pixel coordinates.
+struct Roi {
+    int x {0};
+    int y {0};
+    int w {Geometry::WIDTH};
+    int h {Geometry::HEIGHT};
+};
+
+struct RoiStats {
+    float min     {0.0f};
+    float max     {0.0f};
+    float mean    {0.0f};
+    int   hottest {-1};   ///< pixel index of max
+};
+
+class PixelConverter {
+public:
+    explicit PixelConverter(const paramsMLX90640& params);
+
+    /// Per-subpage terms; tr < -273 means "use the subpage's own Ta",
+    /// which is what MLX90640Reader::readFrame passes today.
+    SubpageTerms prepare(const uint16_t* words,
+                         float emissivity = IRParams::EMISSIVITY,
+                         float tr = -300.0f) const;
+
+    /// True when the pixel is measured in the subpage described by t.
+    bool inSubpage(int pixel, const SubpageTerms& t) const
+    {
+        const int pattern = t.chessMode ? chessPattern_[pixel] : ilPattern_[pixel];
+        return pattern == t.subpage;
+    }
+
+    float toTemperature(const uint16_t* words, const SubpageTerms& t, int pixel) const;
+    void  convertSubpage(const uint16_t* words, const SubpageTerms& t, float* result) const;
+
+    /// Inverse of the conversion in the raw domain: a pixel reads at least
+    /// tempC exactly when raw * t.gain - tgc() * t.irDataCP >= the bound
+    /// (up to float rounding). Depends only on Ta, Vdd and emissivity, so
+    /// callers can cache it across subpages.
+    float signalBound(int pixel, const SubpageTerms& t, float tempC) const;
+
+    /// signalBound() split as alpha * boundScale() + boundOffset(). The
+    /// scale is the same for every pixel, so once the offsets are cached a
+    /// bound at any temperature costs one multiply-add per pixel.
+    double boundScale(const SubpageTerms& t, float tempC) const { return signalFor(t, tempC, 1.0f); }
+    double boundOffset(int pixel, const SubpageTerms& t) const
+    {
+        return offsetFor(pixel, t, offset_[pixel], kta_[pixel]);
+    }
+
+    float tgc() const { return params_.tgc; }
+
+    /// Active per-pixel coefficients (any NUC folded in), indexed by pixel,
+    /// for callers that lay them out their own way (ThresholdSearch).
+    struct Coefficients {
+        const float* offset;
+        const float* kta;
+        const float* kv;
+        const float* alpha;
+        const float* ilCorr;
+    };
+    Coefficients coefficients() const
+    {
+        return {offset_.data(), kta_.data(), kv_.data(), alpha_.data(), ilCorr_.data()};
+    }
+
+    /// Folds user NUC tables into the per-pixel coefficients; an empty
+    /// list restores the factory calibration. Offsets from tables at
+    /// different Ta are fitted linearly in Ta, gains are averaged. Must
+    /// not race with conversions: apply between frames.
+    void applyNuc(const std::vector<NucTable>& tables);
+
+    /// One-point table from a uniform scene at referenceC, as this
+    /// converter reported it (e.g. a stacked mean). Relative to the
+    /// factory calibration, so it may be measured with a NUC applied;
+    /// gains already applied are kept.
+    NucTable measureNuc(const SubpageTerms& t, const float* measured, float referenceC) const;
+
+    /// Two-point table (offset and gain) from uniform scenes at two
+    /// temperatures, both measured at the Ta / Vdd in t.
+    NucTable measureNuc(const SubpageTerms& t, const float* cold, float coldC,
+                        const float* hot, float hotC) const;
+
+private:
+    friend class CoefficientCache;
+
+    /// Second half of toTemperature(): from the compensated signal to °C.
+    /// ac3 and acK are ac^3 and ac * (1 - ksTo[1] * 273.15), which
+    /// CoefficientCache keeps per pixel.
+    float radiometric(float irData, float ac, float ac3, double acK, const SubpageTerms& t) const;
+
+    /// Compensated signal (irData * emissivity) that converts to tempC.
+    double signalFor(const SubpageTerms& t, float tempC, float alpha) const;
+    /// Offset term subtracted from raw * gain - tgc * CP (incl. il/chess).
+    double offsetFor(int p, const SubpageTerms& t, float offset, float kta) const;
+    /// Raw measurement behind a reported temperature, in factory terms.
+    double factorySignal(int p, const SubpageTerms& t, float measuredC) const;
+
+    // Per-pixel terms resolved from the EEPROM scales once; the active
+    // copies carry any folded NUC.
+    std::array<float, Geometry::PIXELS>   offset_ {};
+    std::array<float, Geometry::PIXELS>   kta_    {};
+    std::array<float, Geometry::PIXELS>   kv_     {};
+    std::array<float, Geometry::PIXELS>   alpha_  {};
+    std::array<float, Geometry::PIXELS>   factoryOffset_ {};
+    std::array<float, Geometry::PIXELS>   factoryKta_    {};
+    std::array<float, Geometry::PIXELS>   factoryAlpha_  {};
+    std::array<float, Geometry::PIXELS>   nucGain_       {};
+    std::array<float, Geometry::PIXELS>   ilCorr_ {};   // il/chess correction
+    std::array<uint8_t, Geometry::PIXELS> ilPattern_    {};
+    std::array<uint8_t, Geometry::PIXELS> chessPattern_ {};
+
+    paramsMLX90640 params_ {};   // own copy; the API helpers want the struct
+};
+
+struct CoefficientCacheOptions {
+    float taEpsilon  {0.05f};    ///< °C of Ta movement before a refresh
+    float vddEpsilon {0.005f};   ///< V of Vdd movement before a refresh
+    bool  vectorised {false};    ///< four-lane convertSubpage(), within 1e-3 °C of the scalar one
+};
+
+struct CoefficientCacheStats {
+    uint64_t subpages  {0};
+    uint64_t refreshes {0};
+
+    double refreshRate() const { return subpages ? double(refreshes) / double(subpages) : 0.0; }
+};
+
+class CoefficientCache {
+public:
+    /// The converter must outlive the cache.
+    explicit CoefficientCache(const PixelConverter& converter,
+                              const CoefficientCacheOptions& options = {});
+
+    /// PixelConverter::prepare(), then a refresh of the per-pixel factors
+    /// if Ta or Vdd is further than its epsilon from the values they were
+    /// computed at. With both epsilons 0 and `vectorised` off the results
+    /// match the converter's exactly.
+    SubpageTerms prepare(const uint16_t* words,
+                         float emissivity = IRParams::EMISSIVITY,
+                         float tr = -300.0f);
+
+    float toTemperature(const uint16_t* words, const SubpageTerms& t, int pixel) const;
+    void  convertSubpage(const uint16_t* words, const SubpageTerms& t, float* result) const;
+
+    /// Forces a refresh on the next prepare(); call after applyNuc().
+    void invalidate() { valid_ = false; }
+
+    float ta()  const { return ta_; }    ///< Ta the factors were computed at
+    float vdd() const { return vdd_; }
+    const CoefficientCacheStats& stats() const { return stats_; }
+
+private:
+    void refresh(float ta, float vdd);
+    void convertLanes(const uint16_t* words, const SubpageTerms& t, float* result) const;
+
+    const PixelConverter&   conv_;
+    CoefficientCacheOptions opt_;
+
+    // Doubles where the Melexis arithmetic promotes, so nothing is rounded
+    // that the uncached path keeps
+    std::array<double, Geometry::PIXELS> offsetTerm_ {};   // offset (1 + Kta dTa)(1 + Kv dVdd)
+    std::array<float, Geometry::PIXELS>  ac_  {};          // alpha (1 + KsTa dTa)
+    std::array<float, Geometry::PIXELS>  ac3_ {};
+    std::array<double, Geometry::PIXELS> acK_ {};
+
+    // The same factors in single precision for convertLanes(), one block
+    // per readout pattern and subpage holding only the pixels it measures,
+    // so coefficients load contiguously and only raw words are gathered
+    static constexpr int LANES = Geometry::PIXELS / 2;
+    struct Block {
+        std::array<uint16_t, LANES> pixel {};
+        alignas(16) std::array<float, LANES> offsetTerm {};
+        alignas(16) std::array<float, LANES> ilCorr {};
+        alignas(16) std::array<float, LANES> ac  {};
+        alignas(16) std::array<float, LANES> ac3 {};
+        alignas(16) std::array<float, LANES> acK {};
+    };
+    std::array<Block, 4> blocks_ {};   // [chess * 2 + subpage]
+
+    float ta_    {0.0f};
+    float vdd_   {0.0f};
+    bool  valid_ {false};
+    CoefficientCacheStats stats_;
+};
+
+class LazyFrame {
+public:
+    explicit LazyFrame(const PixelConverter& converter);
+
+    /// Replaces the raw data for words[833]'s subpage. Only that subpage's
+    /// memoised pixels are invalidated.
+    void update(const uint16_t* words,
+                float emissivity = IRParams::EMISSIVITY,
+                float tr = -300.0f);
+
+    bool     ready() const { return have_[0] && have_[1]; }
+    float    pixel(int index);
+    float    pixel(int row, int col) { return pixel(row * Geometry::WIDTH + col); }
+    RoiStats roi(const Roi& r);
+    const float* full();                      ///< merged 32x24 frame
+
+    uint64_t conversions() const { return conversions_; }   ///< memo misses
+
+private:
+    const PixelConverter& conv_;
+
+    std::array<std::array<uint16_t, Geometry::WORDS>, 2> raw_ {};
+    std::array<SubpageTerms, 2> terms_ {};
+    bool have_[2] {false, false};
+
+    std::array<float, Geometry::PIXELS> cache_ {};
+    std::bitset<Geometry::PIXELS>       valid_;
+    uint64_t conversions_ {0};
+};
+
+} // namespace duosight
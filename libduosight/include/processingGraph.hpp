@@ -0,0 +1,126 @@
+/**
+ * @file processingGraph.hpp
+ * @brief Declarative frame-processing graph executed on a work-stealing pool.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Stages (conversion, filters, detectors, sinks) are registered by name
+ *   and wired at startup from a small text spec, e.g.
+ *
+ *       source -> denoise -> render
+ *       denoise -> alarms
+ *       source -> record[2]
+ *
+ *   Every edge owns a bounded queue; when a slow consumer lets it fill, the
+ *   oldest frame is dropped and counted, so the acquisition thread calling
+ *   push() never waits for a sink. The tiles that changed on a dropped
+ *   frame are carried onto the next frame in that queue, so a consumer
+ *   gated on change (sceneChange.hpp) still sees them. Each node runs at most one task at a
+ *   time (frames stay in order per node) while independent branches run in
+ *   parallel on the pool. Per-node timing is kept for diagnostics.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "thermalFrame.hpp"
+#include "workStealingPool.hpp"
+
+namespace duosight {
+
+enum class NodeKind { Source, Conversion, Filter, Detector, Sink };
+
+const char* toString(NodeKind kind);
+
+struct NodeStats {
+    std::string name;
+    NodeKind    kind        {NodeKind::Sink};
+    uint64_t    processed   {0};    ///< frames handled by the stage function
+    uint64_t    dropped     {0};    ///< frames evicted from this node's input queues
+    double      meanUs      {0.0};  ///< mean stage execution time
+    double      maxUs       {0.0};  ///< worst stage execution time
+    size_t      queueDepth  {0};    ///< frames waiting right now
+};
+
+class ProcessingGraph {
+public:
+    /// A stage maps one frame to the frame it forwards. Returning nullptr
+    /// stops propagation for this frame (sinks simply return nullptr).
+    using StageFn = std::function<FramePtr(const FramePtr&)>;
+
+    static constexpr size_t DEFAULT_EDGE_CAPACITY = 4;
+
+    explicit ProcessingGraph(WorkStealingPool& pool);
+    ~ProcessingGraph();
+
+    ProcessingGraph(const ProcessingGraph&) = delete;
+    ProcessingGraph& operator=(const ProcessingGraph&) = delete;
+
+    bool addSource(const std::string& name);
+    bool addNode(const std::string& name, NodeKind kind, StageFn fn);
+
+    bool connect(const std::string& from, const std::string& to,
+                 size_t capacity = DEFAULT_EDGE_CAPACITY);
+
+    /// Wires registered nodes from "a -> b[cap] -> c" chains separated by
+    /// newlines or ';'. Returns false (and logs) on unknown names.
+    bool configure(const std::string& spec);
+
+    /// Publishes a frame from a source node. Never blocks on consumers.
+    bool push(const std::string& source, FramePtr frame);
+
+    void drain();                        ///< waits until all queues are empty
+    std::vector<NodeStats> stats() const;
+
+private:
+    struct Node;
+
+    struct Edge {
+        Node*                to {nullptr};
+        size_t               capacity {DEFAULT_EDGE_CAPACITY};
+        std::deque<FramePtr> queue;      // guarded by to->mutex
+    };
+
+    struct Node {
+        std::string name;
+        NodeKind    kind {NodeKind::Sink};
+        StageFn     fn;
+
+        std::vector<Edge*> outputs;
+        std::vector<Edge*> inputs;
+        size_t             nextInput {0};   // round-robin over inputs
+
+        mutable std::mutex mutex;           // guards inputs' queues
+        std::atomic<bool>  scheduled {false};
+
+        std::atomic<uint64_t> processed {0};
+        std::atomic<uint64_t> dropped   {0};
+        std::atomic<uint64_t> totalNs   {0};
+        std::atomic<uint64_t> maxNs     {0};
+    };
+
+    Node* find(const std::string& name) const;
+    void  forward(Node& from, const FramePtr& frame);
+    void  schedule(Node& node);
+    void  runNode(Node& node);
+    bool  popInput(Node& node, FramePtr& out);
+
+    WorkStealingPool& pool_;
+    std::unordered_map<std::string, std::unique_ptr<Node>> nodes_;
+    std::vector<std::unique_ptr<Edge>> edges_;
+    std::vector<Node*> order_;               // registration order, for stats()
+};
+
+} // namespace duosight
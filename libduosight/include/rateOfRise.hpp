@@ -0,0 +1,134 @@
+/**
+ * @file rateOfRise.hpp
+ * @brief Per-pixel rate-of-rise map with fastest pixels and rising regions.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   "Temperature rising fast" is a slope, not a level. Every frame, each
+ *   pixel gets the least-squares slope of its last `window` samples
+ *   against their timestamps (dropped frames and jitter are handled), in
+ *   °C per minute.
+ *
+ *   The fit needs only sum(y) and sum(t y) per pixel, plus sum(t) and
+ *   sum(t^2), which are shared by all pixels. Times are measured back
+ *   from the newest frame, so sliding the window is the same few
+ *   operations per pixel whatever its length. Shift the origin
+ *   (sum(t y) -= dt sum(y)), drop the oldest sample, add the new one.
+ *   The sums live in SoA arrays and are updated four pixels at a time
+ *   (SSE2, AArch64 NEON, scalar otherwise). Each pixel's values are taken
+ *   relative to a recent sample of its own, which keeps the float sums
+ *   small. Rounding would still slowly accumulate, so every `window`
+ *   frames the sums are recomputed from the retained samples, which keeps
+ *   the cost O(1) per pixel per frame. The samples live in a FrameHistory
+ *   and are read back as one FrameWindow, without copying.
+ *
+ *   Each map carries the k fastest-rising pixels, and the rising regions:
+ *   4-connected groups of pixels above `regionCPerMin`, with bounding box
+ *   and peak rate, fastest first. It also carries the mean rate of each
+ *   configured ROI.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+#include "frameHistory.hpp"
+#include "pixelConverter.hpp"
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+struct RiseOptions {
+    size_t           window        {32};     ///< samples per fit
+    size_t           minSamples    {8};      ///< no rates until this many
+    size_t           topK          {8};      ///< fastest pixels / regions reported
+    float            regionCPerMin {3.0f};   ///< a pixel rising faster joins a region
+    std::vector<Roi> rois;                   ///< mean rate reported per ROI
+};
+
+struct RisePixel {
+    int   pixel   {-1};
+    float cPerMin {0.0f};
+};
+
+struct RiseRegion {
+    Roi   box;                   ///< bounding box
+    int   pixels      {0};
+    int   peakPixel   {-1};
+    float peakCPerMin {0.0f};
+    float meanCPerMin {0.0f};
+};
+
+struct RiseMap {
+    uint64_t sequence    {0};
+    int64_t  timestampNs {0};
+    uint32_t samples     {0};       ///< in the fit
+    bool     valid       {false};   ///< samples >= minSamples; rates are 0 otherwise
+    std::array<float, Geometry::PIXELS> cPerMin {};
+    std::vector<RisePixel>  fastest;   ///< descending, at most topK
+    std::vector<RiseRegion> regions;   ///< by peak rate, at most topK
+    std::vector<float>      roiCPerMin;   ///< per RiseOptions::rois
+};
+
+using RisePtr = std::shared_ptr<const RiseMap>;
+
+class RateOfRise {
+public:
+    using MapFn = std::function<void(const RisePtr&)>;
+
+    explicit RateOfRise(const RiseOptions& options = {});
+
+    /// Adds a frame (timestamps must increase) and returns its map, or
+    /// nullptr if the sample history could not be created.
+    RisePtr update(const float* temperatures, int64_t timestampNs, uint64_t sequence = 0);
+
+    /// Graph sink around update(); each map also goes to onMap if given.
+    ProcessingGraph::StageFn stage(MapFn onMap = nullptr);
+    /// Last map, or nullptr before the first frame. Safe against a concurrent update().
+    RisePtr latest() const;
+
+    void reset();
+    const RiseOptions& options() const { return opt_; }
+    uint64_t resyncs() const { return resyncs_; }
+
+private:
+    void resync();
+    void rank(RiseMap& map);
+
+    RiseOptions opt_;
+
+    // Retained samples: the latest count_ frames of history_
+    FrameHistory history_;
+    size_t       count_    {0};
+    int64_t      originNs_ {0};   // newest frame; t = 0
+
+    // Fit sums, t in seconds before the newest frame (t <= 0), y relative to
+    // anchor_ so the float sums stay small; reset at each resync
+    alignas(16) std::array<float, Geometry::PIXELS> anchor_ {};
+    alignas(16) std::array<float, Geometry::PIXELS> sumY_  {};
+    alignas(16) std::array<float, Geometry::PIXELS> sumTY_ {};
+    double   sumT_  {0.0};
+    double   sumTT_ {0.0};
+    size_t   sinceResync_ {0};
+    uint64_t resyncs_     {0};
+
+    // Ranking scratch, sized once
+    std::array<int, Geometry::PIXELS>     order_ {};
+    std::array<int, Geometry::PIXELS>     label_ {};
+    std::array<int, Geometry::PIXELS>     stack_ {};
+
+    mutable std::mutex mutex_;
+    RisePtr            latest_;
+};
+
+} // namespace duosight
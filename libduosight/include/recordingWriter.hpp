@@ -0,0 +1,187 @@
+/**
+ * @file recordingWriter.hpp
+ * @brief Recording backend: preallocated file, aligned block writes off the acquisition thread.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A plain write() on the board's eMMC now and then stalls for several
+ *   milliseconds, while the controller erases or the journal commits. An
+ *   inline recorder would hold the acquisition loop for that long.
+ *
+ *   Here append() only copies the record into the block being filled.
+ *   Full blocks are queued and written by another thread, so the caller
+ *   never waits for the disk. There is a fixed pool of `buffers` blocks
+ *   (filling, queued or in flight). When none is free, the record is
+ *   dropped and counted rather than waited for. All writes are whole
+ *   blocks at block-aligned offsets, through O_DIRECT when the filesystem
+ *   allows it. The file is extended with fallocate() well ahead of the
+ *   write offset, so no write has to allocate. close() writes the
+ *   zero-padded last block and trims the file to the bytes appended.
+ *
+ *   The IoUring backend keeps up to `buffers` writes queued in one ring,
+ *   set up with raw syscalls (no liburing). The same ring polls an
+ *   eventfd that append() signals. If io_uring is unavailable (old
+ *   kernel, seccomp), Auto falls back to the Threads backend: a few
+ *   workers issuing pwrite(). A ring that fails after set-up is retired
+ *   the same way, once every write it still holds has completed or been
+ *   cancelled. Both report per-write latency (queued to complete) and
+ *   queue depth.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "processingGraph.hpp"
+#include "thermalFrame.hpp"
+
+namespace duosight {
+
+class MetricsRegistry;
+class Histogram;
+
+enum class RecordingBackend : uint8_t {
+    Auto,      ///< IoUring if the kernel allows it, else Threads
+    IoUring,
+    Threads
+};
+
+const char* toString(RecordingBackend backend);
+
+struct RecordingOptions {
+    size_t           blockBytes    {64 * 1024};   ///< write size; rounded up to 4 KiB
+    size_t           buffers       {8};           ///< blocks filling, queued or in flight
+    size_t           preallocBytes {16u << 20};   ///< fallocate() step, kept ahead of the writes
+    bool             direct        {true};        ///< O_DIRECT; buffered if the filesystem refuses
+    RecordingBackend backend       {RecordingBackend::Auto};
+    int              threads       {2};           ///< Threads backend workers
+
+    /// Test hook: the ring's io_uring_enter() reports EBUSY on every
+    /// busyEvery-th call, and EIO on failCount calls from call failAt
+    /// (counted from 1), without entering the kernel. 0 disables either.
+    struct RingFaults {
+        int busyEvery {0};
+        int failAt    {0};
+        int failCount {1};
+    } ringFaults;
+};
+
+struct RecordingStats {
+    RecordingBackend backend       {RecordingBackend::Threads};   ///< the one in use
+    bool             direct        {false};
+    uint32_t         writers       {0};   ///< threads issuing writes
+    uint64_t         bytes         {0};   ///< accepted by append()
+    uint64_t         drops         {0};   ///< appends refused, no free buffer
+    uint64_t         droppedBytes  {0};
+    uint64_t         writes        {0};   ///< blocks completed
+    uint64_t         writeErrors   {0};
+    uint64_t         preallocated  {0};   ///< file bytes reserved by fallocate()
+    uint32_t         queueDepth    {0};   ///< blocks queued or in flight now
+    uint32_t         maxQueueDepth {0};
+    int64_t          writeNs       {0};   ///< queued to complete, summed
+    int64_t          maxWriteNs    {0};
+
+    double meanWriteNs() const { return writes ? double(writeNs) / double(writes) : 0.0; }
+};
+
+/// Record written by append(const ThermalFrame&), followed by PIXELS floats.
+struct FrameRecord {
+    static constexpr uint32_t MAGIC = 0x52465344;   // "DSFR"
+
+    uint32_t magic       {MAGIC};
+    uint32_t bytes       {0};   ///< record size, this header included
+    uint64_t sequence    {0};
+    int64_t  timestampNs {0};
+};
+
+class RecordingWriter {
+public:
+    /// Creates or truncates path. Check isValid().
+    explicit RecordingWriter(const std::string& path, const RecordingOptions& options = {});
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    bool isValid() const { return fd_ >= 0; }
+
+    /// Copies a record into the pending blocks; never waits for I/O. False
+    /// (the record is dropped whole) if it does not fit in the free
+    /// buffers, or after close(). One producer thread.
+    bool append(const void* data, size_t bytes);
+    /// A FrameRecord and the frame's temperatures.
+    bool append(const ThermalFrame& frame);
+
+    /// Graph sink recording every frame.
+    ProcessingGraph::StageFn stage();
+
+    /// Writes everything appended, waits for it, trims the file. False if
+    /// any write failed. Called by the destructor.
+    bool close();
+
+    RecordingStats stats() const;
+    const RecordingOptions& options() const { return opt_; }
+
+    /// Write latency histogram, drop and queue-depth series, labelled
+    /// recording="name".
+    void attachMetrics(MetricsRegistry& registry, const std::string& name);
+
+private:
+    struct Block {
+        uint8_t* data     {nullptr};
+        size_t   used     {0};
+        uint64_t offset   {0};   // file offset
+        size_t   done     {0};   // bytes written so far
+        int64_t  queuedNs {0};
+    };
+
+    struct Ring;   // io_uring state, recordingWriter.cpp
+
+    void ringLoop();
+    void threadLoop();
+    void queueFilling();                          // mutex_ held
+    void allocateAhead(uint64_t end);
+    bool writeRest(Block& block);                 // pwrite() until the block is out
+    void finished(int index, int64_t result);     // mutex_ held
+    void wake();
+
+    RecordingOptions opt_;
+    RecordingBackend backend_ {RecordingBackend::Threads};
+    int              fd_      {-1};
+    bool             direct_  {false};
+
+    std::vector<Block>  blocks_;
+    std::vector<int>    free_;            // block indices
+    std::deque<int>     queued_;          // full, not yet submitted
+    int                 filling_ {-1};
+    uint64_t            nextOffset_ {0};  // of the next block to fill
+    bool                closing_ {false};
+    bool                closeOk_ {true};
+
+    // Preallocation, done on the writer side
+    mutable std::mutex allocMutex_;
+    uint64_t           allocated_   {0};
+    bool               canAllocate_ {true};
+
+    std::unique_ptr<Ring>    ring_;
+    std::vector<std::thread> workers_;
+    std::vector<std::thread> fallbackWorkers_;   // started by a failed ring thread
+    mutable std::mutex       mutex_;
+    std::condition_variable  cv_;     // Threads backend work
+    uint32_t                 inFlight_ {0};
+    RecordingStats           stats_;
+    Histogram*               latency_ {nullptr};
+};
+
+} // namespace duosight
@@ -0,0 +1,91 @@
+/**
+ * @file sceneChange.hpp
+ * @brief Block-wise change detection and gating of downstream stages.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Splits the 32x24 grid into 8x8 tiles and computes the sum of absolute
+ *   differences of each tile against the tile's reference (the last frame
+ *   on which that tile was reported changed), so slow drift accumulates
+ *   until it matters instead of hiding below a per-frame threshold.
+ *   Frames are tagged with a changed-tile mask and a global score; stages
+ *   wrapped with gateOnChange() skip frames on which nothing changed and
+ *   account for the CPU time that saved. A frame a graph edge drops hands
+ *   its mask on to the next frame queued for that consumer, so the gate
+ *   compares against the last frame the consumer actually ran on.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "MLX90640Regs.hpp"
+#include "processingGraph.hpp"
+
+namespace duosight {
+
+namespace SceneTiles {
+inline constexpr int SIZE    = 8;
+inline constexpr int COLS    = Geometry::WIDTH / SIZE;    // 4
+inline constexpr int ROWS    = Geometry::HEIGHT / SIZE;   // 3
+inline constexpr int COUNT   = COLS * ROWS;               // 12
+inline constexpr uint32_t ALL = (1u << COUNT) - 1;
+} // namespace SceneTiles
+
+struct SceneChange {
+    uint32_t changedTiles {SceneTiles::ALL};  ///< bit (row * COLS + col)
+    float    score        {0.0f};             ///< mean |Δ| over the frame
+    bool     changed() const { return changedTiles != 0; }
+};
+
+class SceneChangeDetector {
+public:
+    /// @param tileThreshold mean absolute difference per pixel (°C for
+    ///        temperature frames, ADC counts for raw words) that marks a
+    ///        tile as changed.
+    explicit SceneChangeDetector(float tileThreshold = 0.3f);
+
+    SceneChange update(const float* temperatures);
+
+    /// Raw path: compares the pixels measured in words[833]'s subpage
+    /// against the previous subpage of the same parity, before conversion.
+    SceneChange updateRaw(const uint16_t* words);
+
+    uint64_t frames()    const { return frames_; }
+    uint64_t unchanged() const { return unchanged_; }
+
+private:
+    float threshold_;
+    bool  haveRef_ {false};
+    std::array<float, Geometry::PIXELS> ref_ {};
+
+    bool  haveRawRef_[2] {false, false};
+    std::array<std::array<int16_t, Geometry::PIXELS>, 2> rawRef_ {};
+
+    uint64_t frames_    {0};
+    uint64_t unchanged_ {0};
+};
+
+/// Skip accounting for one gated stage.
+struct GateStats {
+    std::atomic<uint64_t> passed   {0};
+    std::atomic<uint64_t> skipped  {0};
+    std::atomic<uint64_t> passedNs {0};
+
+    /// CPU time saved, estimated from the stage's mean cost when it ran.
+    double savedMs() const
+    {
+        const uint64_t n = passed.load();
+        return n ? skipped.load() * (passedNs.load() / 1e6 / n) : 0.0;
+    }
+};
+
+/// Wraps a stage so it only runs on frames with at least one changed tile.
+ProcessingGraph::StageFn gateOnChange(ProcessingGraph::StageFn stage, GateStats& stats);
+
+} // namespace duosight
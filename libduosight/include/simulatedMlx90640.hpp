@@ -0,0 +1,177 @@
+/**
+ * @file simulatedMlx90640.hpp
+ * @brief In-process MLX90640 bus device with scripted and random faults.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Stands in for the sensor behind an I2cDevice: serves RAM (0x0400),
+ *   EEPROM (0x2400), STATUS (0x8000) and CTRL1 (0x800D) with the same
+ *   big-endian word protocol as the real part, producing subpages from a
+ *   SyntheticScene on the configured refresh schedule. Hand it to
+ *   mlx90640_set_i2c_device() or MLX90640Reader in place of the real bus.
+ *
+ *   Faults reproduce production incidents on a desk: NACKs, short reads,
+ *   bit flips, late or stuck NEW_DATA_READY, overrun bursts and sensor
+ *   hangs, either scripted at a given subpage or drawn per transaction
+ *   with a seeded RNG. Every injected fault is logged with its time.
+ *
+ *   Time is either the real steady clock or a virtual clock that advances
+ *   by the modelled bus time of each transaction (plus advance() calls),
+ *   which makes recovery-time and frame-loss measurements deterministic.
+ *   Sensors given the same busClock share one virtual bus. By default a
+ *   CTRL1 write restarts the measurement (the next subpage is due one
+ *   period later), the behaviour StaggerCoordinator assumes; it is not
+ *   documented for the real part, so ctrl1Restarts can turn it off.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "i2cUtils.hpp"
+#include "syntheticScene.hpp"
+
+namespace duosight {
+
+enum class SimFault {
+    Nack,          ///< transaction fails (no ACK)
+    ShortRead,     ///< read ends early; remaining bytes read back as 0xFF
+    BitFlip,       ///< one random bit of the read data inverted
+    DelayedReady,  ///< NEW_DATA_READY raised late by durationUs
+    StuckReady,    ///< NEW_DATA_READY ignores clears for `count` subpages
+    OverrunBurst,  ///< `count` subpages produced back to back (reader overruns)
+    Hang           ///< no new data and every transaction NACKs for durationUs
+};
+
+const char* toString(SimFault fault);
+
+/// One scripted fault, armed when the sensor produces subpage `atSubpage`.
+struct ScriptedFault {
+    uint64_t atSubpage  {0};
+    SimFault fault      {SimFault::Nack};
+    uint32_t count      {1};      ///< transactions or subpages affected
+    uint32_t durationUs {0};      ///< for DelayedReady / Hang
+};
+
+/// Per-transaction probabilities for random faults.
+struct FaultRates {
+    double nack      {0.0};
+    double shortRead {0.0};
+    double bitFlip   {0.0};
+};
+
+struct FaultEvent {
+    int64_t     timeNs  {0};
+    uint64_t    subpage {0};
+    SimFault    fault   {SimFault::Nack};
+    std::string detail;
+};
+
+struct SimStats {
+    uint64_t produced     {0};   ///< subpages the sensor measured
+    uint64_t delivered    {0};   ///< subpages whose RAM was read after NEW_DATA_READY
+    int64_t  readyToReadNs {0};  ///< sum over delivered subpages of NEW_DATA_READY -> RAM burst
+    uint64_t overwritten  {0};   ///< subpages replaced before being read
+    uint64_t transactions {0};
+    uint64_t faults       {0};
+};
+
+class SimulatedMlx90640 : public I2cDevice {
+public:
+    struct Options {
+        uint8_t  address      {Bus::SLAVE_ADDR};
+        bool     virtualTime  {true};
+        uint32_t busHz        {1'000'000}; ///< FM+; 400 kHz cannot keep up beyond FR8
+        bool     logFaults    {true};      ///< echo fault events to std::clog
+        uint32_t seed         {1};
+        double   clockPpm     {0.0};       ///< sensor oscillator error (+ = slower)
+        bool     ctrl1Restarts {true};     ///< CTRL1 write restarts the measurement (unconfirmed on hardware)
+        /// Virtual time shared by several sensors on one bus, so each one's
+        /// transactions hold up the others. Drive them from one thread.
+        std::shared_ptr<int64_t> busClock;
+    };
+
+    SimulatedMlx90640(const paramsMLX90640& params, const SceneConfig& scene,
+                      const Options& options);
+
+    /// EEPROM image served at 0x2400 (e.g. a dump from a real sensor).
+    void setEeprom(const uint16_t* words, size_t count);
+
+    void addFault(const ScriptedFault& fault);
+    void setFaultRates(const FaultRates& rates);
+
+    /// Virtual-time only: let time pass (e.g. the reader's poll sleep).
+    void advance(int64_t ns);
+    int64_t nowNs() const;
+
+    std::vector<FaultEvent> faultLog() const;
+    SimStats                stats() const;
+
+    // I2cDevice
+    bool isOpen() const override { return true; }
+    bool writeBytes(const uint8_t* data, size_t length) override;
+    bool readBytes(uint8_t* buffer, size_t length) override;
+    bool writeThenRead(const uint8_t* txData, size_t txLen, uint8_t* rxData, size_t rxLen) override;
+    bool transfer(I2cMessage* messages, size_t count) override;
+
+private:
+    static constexpr uint16_t RAM_BASE    = 0x0400;
+    static constexpr uint16_t EEPROM_BASE = 0x2400;
+    static constexpr uint16_t CTRL1_REG   = 0x800D;
+    static constexpr uint16_t I2C_CFG_REG = 0x800F;
+
+    int64_t  clockNs() const;
+    int64_t  subpagePeriodNs(int refreshCode) const;
+    void     tick(size_t bytes);                  // bus time + schedule
+    void     clockBytes(size_t bytes);            // bus time only
+    void     produceDue();
+    void     produce(int64_t dueNs);
+    void     armScripted();
+    bool     injectTransactionFault(uint8_t* rx, size_t rxLen, bool isRead);
+    void     log(SimFault fault, std::string detail);
+    uint16_t readWord(uint16_t reg) const;
+    void     serveRead(uint16_t reg, uint8_t* rx, size_t rxLen) const;
+    void     storeWord(uint16_t reg, uint16_t value);
+    void     consumeIfBurst(uint16_t reg, size_t rxLen);
+
+    mutable std::mutex mutex_;
+    Options            opt_;
+    SyntheticScene     scene_;
+    std::mt19937       rng_;
+    FaultRates         rates_;
+
+    std::array<uint16_t, Geometry::WORDS> ram_    {};   // 832 + ctrl + sp
+    std::array<uint16_t, 832>             eeprom_ {};
+    uint16_t status_ {0};
+    uint16_t ctrl1_  {0x1901};
+    uint16_t i2cCfg_ {0};
+
+    std::shared_ptr<int64_t> virtualNs_;
+    int64_t  startNs_       {0};
+    int64_t  nextSubpageNs_ {0};
+    int64_t  periodNs_      {0};
+    bool     unread_        {false};   // last produced subpage not yet read
+
+    std::vector<ScriptedFault> script_;
+    uint32_t nackBudget_       {0};
+    uint32_t shortReadBudget_  {0};
+    uint32_t bitFlipBudget_    {0};
+    uint32_t stuckSubpages_    {0};
+    int64_t  readyDelayNs_     {0};    // applies to the next produced subpage
+    int64_t  readyAtNs_        {0};    // NEW_DATA_READY becomes visible
+    int64_t  hangUntilNs_      {0};
+
+    std::vector<FaultEvent> log_;
+    SimStats stats_;
+};
+
+} // namespace duosight
@@ -0,0 +1,87 @@
+/**
+ * @file spatialFilter.hpp
+ * @brief Edge-preserving spatial denoise: sorting-network medians and a LUT bilateral.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A temporal filter averages noise away only where the scene holds still.
+ *   Single-pixel spikes (salt and pepper) and per-frame Gaussian noise on
+ *   a moving target have to be removed within the frame instead, without
+ *   blurring the edges the alarms look at.
+ *
+ *   median3() / median5() take the 3x3 or 5x5 median with a fixed sorting
+ *   network (19 and 99 compare-exchanges, no branches), four output pixels
+ *   per vector. bilateral() weights each neighbour by a precomputed spatial
+ *   Gaussian times a range weight looked up in a table of
+ *   exp(-d^2 / 2 sigma^2). The table spans 0..4 sigma and falls to zero
+ *   beyond, so a 40 °C edge contributes nothing across itself. Lane
+ *   arithmetic is SSE2 or AArch64 NEON (scalar otherwise); the four table
+ *   lookups per vector are scalar loads.
+ *
+ *   Grids are any width x height: the sensor's 32x24 by default, or an
+ *   upscaled view. Edges are replicated. All buffers are sized in the
+ *   constructor, so filtering allocates nothing. One instance filters one
+ *   frame at a time. stage() wraps a filter as a graph node. Put it in
+ *   front of a temporal stage (e.g. "source -> median -> stack") so
+ *   spikes are gone before frames are averaged.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+#include "processingGraph.hpp"
+
+namespace duosight {
+
+enum class SpatialKind { Median3, Median5, Bilateral };
+
+const char* toString(SpatialKind kind);
+
+struct SpatialFilterOptions {
+    int   width      {Geometry::WIDTH};
+    int   height     {Geometry::HEIGHT};
+    int   radius     {1};      ///< bilateral window: 1 = 3x3, 2 = 5x5
+    float sigmaSpace {1.0f};   ///< bilateral spatial sigma, pixels
+    float sigmaRange {1.5f};   ///< bilateral range sigma, °C
+};
+
+class SpatialFilter {
+public:
+    static constexpr int LUT_SIZE = 256;   ///< range weights over 0..4 sigmaRange
+
+    explicit SpatialFilter(const SpatialFilterOptions& options = {});
+
+    /// in and out are width * height, row-major, and must not alias.
+    void median3(const float* in, float* out);
+    void median5(const float* in, float* out);
+    void bilateral(const float* in, float* out);
+    void apply(SpatialKind kind, const float* in, float* out);
+
+    /// Graph stage forwarding a filtered copy of each frame (metadata
+    /// kept). Needs the default 32x24 grid.
+    ProcessingGraph::StageFn stage(SpatialKind kind);
+
+    const SpatialFilterOptions& options() const { return opt_; }
+
+private:
+    static constexpr int BORDER = 2;   // widest window is 5x5
+
+    void pad(const float* in);
+
+    SpatialFilterOptions opt_;
+    int                  stride_ {0};   // padded row length, with room for a last partial vector
+    std::vector<float>   padded_;       // (height + 2 BORDER) rows of stride_
+
+    std::array<float, LUT_SIZE> rangeLut_ {};
+    float                       lutScale_ {0.0f};   // |d| -> table index
+    std::array<float, 25>       spaceWeight_ {};    // (2 radius + 1)^2, row-major
+};
+
+} // namespace duosight
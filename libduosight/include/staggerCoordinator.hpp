@@ -0,0 +1,129 @@
+/**
+ * @file staggerCoordinator.hpp
+ * @brief Phase-staggered acquisition from several MLX90640s on one bus.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Sensors at the same refresh rate raise NEW_DATA_READY at whatever
+ *   phase they happened to start with, and their oscillators drift them
+ *   through each other. When the ready times line up, the RAM bursts
+ *   queue behind one another: the last sensor's subpage waits for every
+ *   other burst, and the bus sits idle for the rest of the period.
+ *
+ *   The coordinator reads all sensors from one loop, one SubpageFetcher
+ *   (polling) each. Every poll tick probes STATUS on each sensor that is
+ *   due before any RAM burst starts, so the ready times are bracketed even
+ *   when several sensors become ready together. Each fetcher's clock model
+ *   gives that sensor's ready phase within the subpage period.
+ *
+ *   Every checkEvery subpages, once all phases are measured, the phases
+ *   are compared with evenly spaced targets (one slot of period / N each,
+ *   anchored where the fewest sensors have to move). A sensor further than
+ *   `tolerance` of a slot from its target is re-phased: CTRL1 is rewritten
+ *   with its current value at the instant that makes the restarted
+ *   measurement finish on target. The restart costs that sensor one
+ *   subpage. The lag from the write to NEW_DATA_READY is learned from each
+ *   re-phase. RAM bursts are held back while a restart is imminent, so
+ *   the write goes out on time. Drift is taken out by the same check.
+ *
+ *   That a CTRL1 write restarts the measurement in progress is assumed,
+ *   not documented: the datasheet does not say so and it has not been
+ *   confirmed on the board. The coordinator therefore checks it on every
+ *   re-phase. A sensor whose ready phase does not move after
+ *   MAX_MISSED_REPHASES consecutive rewrites is left where it is (and
+ *   reported as rephaseOff); the others are spread around it, or the
+ *   coordinator just measures and reads if none can move.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "i2cUtils.hpp"
+#include "subpageFetcher.hpp"
+
+namespace duosight {
+
+struct StaggerOptions {
+    int64_t  periodNs   {62'500'000};   ///< subpage period all sensors run at
+    int64_t  pollNs     {1'000'000};    ///< STATUS poll interval
+    double   tolerance  {0.25};         ///< of a slot; beyond this a sensor is re-phased
+    uint32_t checkEvery {32};           ///< subpages (all sensors) between phase checks
+    bool     enabled    {true};         ///< false: measure and read only
+};
+
+struct StaggerSensorStats {
+    uint8_t  address  {0};
+    uint64_t subpages {0};
+    uint64_t overruns {0};    ///< subpages whose STATUS reported an earlier one lost
+    uint64_t rephases {0};
+    bool     rephaseOff {false};  ///< CTRL1 rewrites did not move the phase; no longer re-phased
+    uint64_t failures {0};    ///< bus errors
+    int64_t  queuedNs {0};    ///< summed wait from NEW_DATA_READY (as measured) to burst start
+    int64_t  phaseNs  {-1};   ///< ready phase within the period; -1 until measured
+};
+
+struct StaggerStats {
+    std::vector<StaggerSensorStats> sensors;
+    int64_t elapsedNs {0};
+    int64_t busNs     {0};    ///< time in this loop's bus transactions
+
+    double idleFraction() const { return elapsedNs ? 1.0 - double(busNs) / double(elapsedNs) : 0.0; }
+};
+
+class StaggerCoordinator {
+public:
+    static constexpr uint32_t MAX_MISSED_REPHASES = 2;
+
+    /// All sensors must run at options.periodNs.
+    StaggerCoordinator(const std::vector<I2cDevice*>& sensors, const StaggerOptions& options,
+                       FetchClock clock = {});
+
+    /// Blocks until a sensor delivers a subpage into words (Geometry::WORDS).
+    /// Returns its index in the constructor's list; -1 on a bus error, -2
+    /// if no sensor delivers within four periods.
+    int next(uint16_t* words, FetchResult* result = nullptr);
+
+    StaggerStats stats() const;
+    /// Starts a new reporting window; phases and schedules are kept.
+    void resetStats();
+
+    size_t size() const { return sensors_.size(); }
+    int64_t restartLagNs() const { return restartLagNs_; }
+
+private:
+    struct Sensor {
+        I2cDevice*                      bus {nullptr};
+        std::unique_ptr<SubpageFetcher> fetcher;
+        StaggerSensorStats              stats;
+        int64_t dueNs       {0};    // next STATUS probe
+        int64_t readyAtNs   {-1};   // probe saw NEW_DATA_READY; burst pending
+        int64_t restartAtNs {-1};   // scheduled re-phase
+        int64_t targetNs    {-1};   // phase moved to, until measured after the restart
+        int64_t fromNs      {-1};   // phase before that restart
+        uint32_t missed     {0};    // consecutive restarts that did not move the phase
+    };
+
+    int64_t phaseOf(const Sensor& s) const;
+    int64_t wrap(int64_t ns) const;               // into [-P/2, P/2)
+    bool    restart(Sensor& s);
+    void    check();
+    void    schedule(Sensor& s, int64_t targetNs);
+
+    StaggerOptions      opt_;
+    FetchClock          clock_;
+    std::vector<Sensor> sensors_;
+    int64_t  originNs_     {0};    // phases are measured from here
+    int64_t  restartLagNs_ {0};    // CTRL1 write -> NEW_DATA_READY
+    int64_t  burstNs_      {0};    // longest RAM burst seen
+    uint32_t sinceCheck_   {0};
+    int64_t  windowNs_     {0};
+    int64_t  busNs_        {0};
+};
+
+} // namespace duosight
@@ -0,0 +1,151 @@
+/**
+ * @file subpageFetcher.hpp
+ * @brief Subpage acquisition with speculative STATUS + RAM bursts.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Polling costs a STATUS round trip (usually many) before every RAM
+ *   burst. A clock model of the sensor's subpage schedule lets the
+ *   fetcher instead issue, when a subpage is predicted due, one combined
+ *   I2C transaction that reads STATUS, the 832-word RAM block and CTRL1
+ *   together. If NEW_DATA_READY was set the data is kept (a hit, no extra
+ *   round trip); otherwise it is discarded and the fetcher polls for that
+ *   subpage (a miss, one wasted burst).
+ *
+ *   The model is the time the last subpage was ready plus the subpage
+ *   period. The period is measured while polling (warm-up and fallback),
+ *   from STATUS polls either side of each flag. Once speculating, a hit
+ *   moves the next probe a step earlier and a miss moves it several steps
+ *   later, so the probe settles just after the ready time with roughly one
+ *   miss per MISS_STEPS hits; a small integral term on the same hit/miss
+ *   signal trims what is left of the period error. When the hit rate over
+ *   a window drops below the threshold (sensor rate changed behind the
+ *   fetcher's back, bus contention) it falls back to polling for a while,
+ *   then tries again.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "MLX90640Regs.hpp"
+#include "i2cUtils.hpp"
+
+namespace duosight {
+
+struct FetchOptions {
+    bool     speculative {true};
+    int64_t  periodNs    {31'250'000};   ///< nominal subpage period (CTRL1 refresh code)
+    int64_t  pollNs      {1'000'000};    ///< STATUS poll interval
+    uint32_t window      {32};           ///< speculative bursts per hit-rate check
+    double   minHitRate  {0.6};          ///< below this, poll instead of speculating
+    uint32_t backoff     {128};          ///< subpages to poll before speculating again
+    uint32_t warmup      {8};            ///< bracketed polls before the first speculation
+    int      timeoutPeriods {4};         ///< give up after this many periods without data
+};
+
+/// Time source; the defaults are the steady clock and a thread sleep.
+/// Tests drive a virtual-time SimulatedMlx90640 through these.
+struct FetchClock {
+    std::function<int64_t()>     now;
+    std::function<void(int64_t)> sleep;
+};
+
+struct FetchResult {
+    static constexpr int NOT_READY = -3;
+
+    int     subpage    {-1};     ///< 0/1; -1 bus error, -2 timeout, NOT_READY (poll()/collect())
+    bool    speculated {false};  ///< data came from a speculative burst (hit)
+    bool    overrun    {false};  ///< STATUS reported a subpage overwritten before this one
+    int64_t detectNs   {0};      ///< start of the transaction that saw NEW_DATA_READY
+    int64_t dataNs     {0};      ///< RAM block in hand
+};
+
+struct FetchStats {
+    uint64_t subpages     {0};
+    uint64_t hits         {0};
+    uint64_t misses       {0};   ///< speculative bursts discarded
+    uint64_t statusPolls  {0};
+    uint64_t transactions {0};
+    uint64_t fallbacks    {0};   ///< switches to polling on a low hit rate
+    int64_t  detectToDataNs {0}; ///< summed over subpages
+
+    double hitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+class SubpageFetcher {
+public:
+    SubpageFetcher(I2cDevice& bus, const FetchOptions& options = {}, FetchClock clock = {});
+
+    /// Reads the next subpage into words (Geometry::WORDS: RAM, CTRL1,
+    /// subpage number, the layout MLX90640_GetFrameData produces).
+    FetchResult fetch(uint16_t* words);
+
+    /// Non-blocking steps for callers that service several sensors from
+    /// one loop; they refine the clock model like fetch()'s own polling.
+    /// probe() is one STATUS read: 1 if NEW_DATA_READY is set, 0 if not,
+    /// -1 on a bus error. collect() then reads the subpage; the ready time
+    /// is the first probe that saw the flag, however long collect() waited.
+    int         probe();
+    FetchResult collect(uint16_t* words);
+    /// probe() and, if ready, collect(); NOT_READY otherwise.
+    FetchResult poll(uint16_t* words);
+
+    /// Nominal period changed (refresh rate written); resets the model.
+    void setPeriod(int64_t periodNs);
+
+    bool speculating() const { return speculating_; }
+    bool locked() const { return locked_; }
+    /// Model's latest ready time (clock ns); meaningful once locked().
+    int64_t lastReadyNs() const { return lastReadyNs_; }
+    int64_t periodNs() const { return static_cast<int64_t>(period_); }
+    const FetchStats& stats() const { return stats_; }
+
+private:
+    bool readStatus(uint16_t& status);
+    bool readBlock(uint16_t* words);                       // RAM + CTRL1
+    bool speculate(uint16_t& status, uint16_t* words);     // STATUS + RAM + CTRL1
+    bool clearReady();
+    void learn(int64_t readyLo, int64_t readyHi, int64_t guessNs);
+    void account(bool hit);
+    void track(bool hit);
+    int64_t stepNs() const { return std::max<int64_t>(opt_.periodNs / 512, 1000); }
+
+    static constexpr int MISS_STEPS = 8;   // a miss moves the phase this many hit steps
+
+    I2cDevice&   bus_;
+    FetchOptions opt_;
+    FetchClock   clock_;
+    FetchStats   stats_;
+
+    // Clock model
+    double   period_       {0.0};
+    int64_t  lastReadyNs_  {0};      // latest time the last subpage was known ready
+    bool     locked_       {false};
+    uint32_t missStreak_   {0};      // consecutive misses
+    bool     seenNotReady_ {false};  // a poll saw the flag clear since the last subpage
+    int64_t  notReadyAt_   {0};      // ... most recently at this time
+    int64_t  predicted_    {0};      // model's ready time after a missed burst
+    bool     readySeen_    {false};  // probe() saw NEW_DATA_READY, not collected yet
+    int64_t  readyAt_      {0};
+    uint16_t readyStatus_  {0};
+    int64_t  anchorNs_     {0};      // baseline for the period measurement
+    bool     anchored_     {false};
+    uint32_t brackets_     {0};      // narrow brackets since the baseline
+
+    // Hit-rate window and fallback
+    bool     speculating_  {false};
+    uint32_t windowTries_  {0};
+    uint32_t windowHits_   {0};
+    uint32_t backoffLeft_  {0};
+
+    std::array<uint8_t, 2 * 832> ramBytes_ {};          // RAM block, big-endian
+};
+
+} // namespace duosight
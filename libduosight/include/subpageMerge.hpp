@@ -0,0 +1,106 @@
+/**
+ * @file subpageMerge.hpp
+ * @brief Branch-free merge of two converted subpages into one frame.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Each subpage refreshes half the array: alternate pixels in chess mode,
+ *   alternate rows in interleaved mode. The pattern is a template
+ *   parameter, so each kernel is a fixed select with no per-pixel branch
+ *   or lookup: chess blends four lanes at a time under a constant mask
+ *   (NEON bsl, SSE2 and/andnot/or, paired scalar stores otherwise) whose
+ *   phase flips every row; interleaved copies whole rows. out may alias
+ *   either input, so mergeSubpages(frame, sub1, frame) half-updates a
+ *   frame in place from a single subpage.
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include "MLX90640Regs.hpp"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace duosight {
+
+enum class ReadoutPattern { Chess, Interleaved };
+
+/// out[p] = pixel p's own subpage: sub0 where the pattern is 0, sub1 where 1.
+template <ReadoutPattern P>
+void mergeSubpages(const float* sub0, const float* sub1, float* out);
+
+template <>
+inline void mergeSubpages<ReadoutPattern::Chess>(const float* sub0, const float* sub1, float* out)
+{
+    constexpr int W = Geometry::WIDTH;
+    static_assert(W % 4 == 0, "rows are whole vectors");
+
+#if defined(__ARM_NEON)
+    // Lanes taking sub1 on even rows (odd columns); odd rows use the complement
+    const uint32x4_t even = {0u, ~0u, 0u, ~0u};
+    const uint32x4_t odd  = vmvnq_u32(even);
+    for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
+        const uint32x4_t m = (row & 1) ? odd : even;
+        const int base = row * W;
+        for (int c = 0; c < W; c += 4) {
+            vst1q_f32(out + base + c, vbslq_f32(m, vld1q_f32(sub1 + base + c), vld1q_f32(sub0 + base + c)));
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128 even = _mm_castsi128_ps(_mm_set_epi32(-1, 0, -1, 0));
+    const __m128 odd  = _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, -1));
+    for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
+        const __m128 m = (row & 1) ? odd : even;
+        const int base = row * W;
+        for (int c = 0; c < W; c += 4) {
+            const __m128 a = _mm_loadu_ps(sub0 + base + c);
+            const __m128 b = _mm_loadu_ps(sub1 + base + c);
+            _mm_storeu_ps(out + base + c, _mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a)));
+        }
+    }
+#else
+    const float* src[2] = {sub0, sub1};
+    for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
+        const float* a = src[row & 1];         // even columns
+        const float* b = src[(row & 1) ^ 1];   // odd columns
+        const int base = row * W;
+        for (int c = 0; c < W; c += 2) {
+            out[base + c]     = a[base + c];
+            out[base + c + 1] = b[base + c + 1];
+        }
+    }
+#endif
+}
+
+template <>
+inline void mergeSubpages<ReadoutPattern::Interleaved>(const float* sub0, const float* sub1, float* out)
+{
+    constexpr int W = Geometry::WIDTH;
+    const float* src[2] = {sub0, sub1};
+    for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
+        const float* s = src[row & 1] + row * W;
+        if (s != out + row * W) {
+            std::memcpy(out + row * W, s, W * sizeof(float));
+        }
+    }
+}
+
+/// Runtime dispatch on a subpage's readout mode (SubpageTerms::chessMode).
+inline void mergeSubpages(bool chessMode, const float* sub0, const float* sub1, float* out)
+{
+    if (chessMode) {
+        mergeSubpages<ReadoutPattern::Chess>(sub0, sub1, out);
+    } else {
+        mergeSubpages<ReadoutPattern::Interleaved>(sub0, sub1, out);
+    }
+}
+
+} // namespace duosight
@@ -0,0 +1,91 @@
+/**
+ * @file syntheticScene.hpp
+ * @brief Synthetic MLX90640 raw subpages from a modelled temperature field.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Generates a ground-truth temperature field (background, gradient,
+ *   moving hot blobs, noise, drift), then runs the MLX90640 conversion
+ *   backwards with a real paramsMLX90640 to produce the 834 raw words the
+ *   sensor would deliver, including the auxiliary Ta/Vdd/gain/CP words
+ *   and CTRL1. Feeding those words to MLX90640_CalculateTo recovers the
+ *   field to within ADC quantisation, so the whole acquisition and
+ *   conversion pipeline can be load-tested without hardware, at rates far
+ *   beyond the sensor's.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "MLX90640_API.h"
+#include "MLX90640Regs.hpp"
+#include "pixelConverter.hpp"
+
+namespace duosight {
+
+struct SceneConfig {
+    float    backgroundC        {22.0f};
+    float    gradientCPerCol    {0.05f};   ///< horizontal temperature slope
+    float    gradientCPerRow    {0.0f};
+    float    noiseC             {0.1f};    ///< per-pixel Gaussian noise (1σ)
+    float    sceneDriftCPerSec  {0.0f};    ///< whole-scene drift
+    float    ambientC           {25.0f};   ///< sensor Ta encoded in the aux words
+    float    ambientDriftCPerSec{0.0f};
+    float    vdd                {3.3f};
+
+    int      blobs              {2};
+    float    blobPeakC          {45.0f};   ///< peak temperature of each blob
+    float    blobRadius         {2.5f};    ///< Gaussian σ in pixels
+    float    blobSpeed          {3.0f};    ///< pixels per second
+
+    uint8_t  refreshCode        {refresh::FR2};
+    uint8_t  resolution         {Resolution::ADC_18bit};
+    bool     chess              {true};
+    float    emissivity         {IRParams::EMISSIVITY};
+    uint32_t seed               {1};
+};
+
+class SyntheticScene {
+public:
+    SyntheticScene(const paramsMLX90640& params, const SceneConfig& cfg = {});
+
+    /// Fills words[0..833] with the next subpage (alternating 0/1) and
+    /// advances scene time by one subpage period. Pixels belonging to the
+    /// other subpage keep their previous values, as in the sensor's RAM.
+    void nextSubpage(uint16_t* words);
+
+    /// Ground-truth field used for the last subpage (°C, before noise).
+    const std::array<float, Geometry::PIXELS>& truth() const { return truth_; }
+
+    double timeSec() const { return timeSec_; }
+    int    subpage() const { return subpage_; }
+
+private:
+    struct Blob { float x, y, vx, vy; };
+
+    void renderField(double t);
+    void writeAux(uint16_t* words, int subpage, float ta) const;
+
+    paramsMLX90640   params_;
+    PixelConverter   conv_;
+    SceneConfig      cfg_;
+    double           subpagePeriod_ {0.25};
+
+    std::mt19937                    rng_;
+    std::normal_distribution<float> noise_;
+    std::vector<Blob>               blobs_;
+
+    std::array<float, Geometry::PIXELS>    truth_ {};
+    std::array<uint16_t, Geometry::WORDS>  ram_   {};
+    double timeSec_ {0.0};
+    int    subpage_ {1};      // so the first call produces subpage 0
+};
+
+} // namespace duosight
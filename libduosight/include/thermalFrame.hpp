@@ -0,0 +1,45 @@
+/**
+ * @file thermalFrame.hpp
+ * @brief Frame packet passed between DuoSight processing stages.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A merged 32x24 temperature frame plus the acquisition metadata every
+ *   downstream stage needs (sequence number, monotonic timestamp).
+ *   Frames are immutable once published and shared by pointer, so fan-out
+ *   to several branches never copies pixel data.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "MLX90640Regs.hpp"
+
+namespace duosight {
+
+struct ThermalFrame {
+    uint64_t sequence     {0};    ///< acquisition counter, monotonically increasing
+    int64_t  timestampNs  {0};    ///< steady-clock time the second subpage landed
+    uint32_t changedTiles {~0u};  ///< SceneChangeDetector tile mask; all set = unknown
+    float    changeScore  {0.0f}; ///< mean |Δ| against the scene reference, °C
+    alignas(64) std::array<float, Geometry::PIXELS> temperatures {}; ///< row-major, °C; cache-line
+                                                                     ///< aligned (duosight.h relies on it)
+};
+
+using FramePtr = std::shared_ptr<const ThermalFrame>;
+
+/// Steady-clock "now" in nanoseconds, the time base used by every stage.
+inline int64_t monotonicNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace duosight
@@ -0,0 +1,95 @@
+/**
+ * @file thresholdSearch.hpp
+ * @brief Exact over-threshold and hottest-pixel queries that skip cold pixels.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   For alarm-only use the question is "is anything above X °C", not the
+ *   whole image. The raw signal at which a pixel reads X °C is
+ *   alpha * scale(X) + offset, where only scale(X) depends on X and it is
+ *   the same for every pixel. So each subpage is screened by one
+ *   subtract-multiply per pixel, giving a level (signal - offset) / alpha
+ *   that is compared against scale(X - guard). Only pixels that pass are
+ *   run through the full conversion. The guard band keeps the screen
+ *   conservative, and the final comparison uses the exact temperature, so
+ *   results equal those of full conversion.
+ *
+ *   hottest() converts the pixel with the highest level first. The bound
+ *   then sits just below that pixel's temperature and rises with every
+ *   hotter pixel found, so usually only a handful are converted.
+ *
+ *   The offset and 1/alpha tables depend only on Ta, Vdd and the readout
+ *   pattern. They are rebuilt when those move, not when the target
+ *   changes. Measured (-O3, test_threshold_search): hottest about 8x and
+ *   over-threshold about 15x cheaper than MLX90640_CalculateTo.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "pixelConverter.hpp"
+
+namespace duosight {
+
+struct ThresholdHit {
+    int   pixel       {-1};
+    float temperature {0.0f};
+};
+
+class ThresholdSearch {
+public:
+    struct Stats {
+        uint64_t subpages   {0};   ///< subpages screened
+        uint64_t screened   {0};   ///< pixels compared against a bound
+        uint64_t converted  {0};   ///< pixels fully converted
+        uint64_t rebuilds   {0};   ///< offset table recomputations
+    };
+
+    /// @param guardC  safety band below the target used for the screen
+    explicit ThresholdSearch(const PixelConverter& converter, float guardC = 0.5f);
+
+    /// Appends every pixel of this subpage at or above thresholdC.
+    /// Returns the number of hits.
+    size_t overThreshold(const uint16_t* words, float thresholdC,
+                         std::vector<ThresholdHit>& hits);
+
+    /// Hottest pixel measured in this subpage (exact).
+    ThresholdHit hottest(const uint16_t* words);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    static constexpr float TA_EPSILON   = 0.05f;   // °C
+    static constexpr float VDD_EPSILON  = 0.002f;  // V
+
+    /// Per-pixel level of every pixel in this subpage (-inf elsewhere).
+    void screen(const uint16_t* words, const SubpageTerms& t);
+
+    const PixelConverter& conv_;
+    float                 guardC_;
+
+    // signalBound() = alpha * boundScale() + offset_, kept per Ta/Vdd
+    std::array<float, Geometry::PIXELS> offset_   {};
+    std::array<float, Geometry::PIXELS> invAlpha_ {};
+    bool  valid_ {false};
+    float ta_    {0.0f};
+    float vdd_   {0.0f};
+    bool  calib_ {true};
+
+    // 0 for pixels measured in subpage 0/1, -inf for the others
+    std::array<std::array<float, Geometry::PIXELS>, 2> own_ {};
+    bool  chess_ {true};
+    bool  haveOwn_ {false};
+
+    std::array<float, Geometry::PIXELS> level_ {};
+
+    Stats stats_;
+};
+
+} // namespace duosight
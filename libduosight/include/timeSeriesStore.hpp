@@ -0,0 +1,202 @@
+/**
+ * @file timeSeriesStore.hpp
+ * @brief Append-only, compressed, columnar store for frame and ROI statistics.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   One mmap'd file of fixed 4 KiB blocks. Every column (a series' raw
+ *   values, or one field of one downsampling tier) is a chain of blocks;
+ *   each block is a self-contained bit stream of delta-of-delta
+ *   timestamps and either Gorilla-style XOR floats or fixed-point deltas.
+ *   Noisy temperatures cost roughly 1-3 bytes per sample instead of a
+ *   text line.
+ *
+ *   The 1 s, 1 min and 1 h tiers (min, max, mean, count) are rolled up
+ *   incrementally as raw samples arrive, each tier from the one below,
+ *   so a year-long query reads a few thousand hourly points instead of
+ *   decoding raw data. Block headers carry the time span and value range
+ *   and are indexed in memory at open, so a range query touches only the
+ *   blocks it returns.
+ *
+ *   Timestamps are int64 milliseconds (wall-clock for trend data) and must
+ *   not decrease within a series. All methods are serialised internally;
+ *   one process should have a file open for writing at a time.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duosight {
+
+/// Downsampling levels; Raw holds every appended sample.
+enum class Tier : uint8_t { Raw = 0, Second, Minute, Hour };
+
+/// Columns kept for each aggregated tier.
+enum class Field : uint8_t { Min = 0, Max, Mean, Count };
+
+enum class SeriesEncoding : uint8_t {
+    Xor,          ///< lossless float32 (Gorilla XOR)
+    FixedPoint,   ///< round(value / quantum), delta-coded; much smaller for noisy
+                  ///< data. Tier counts stay exact either way.
+};
+
+struct SeriesOptions {
+    SeriesEncoding encoding {SeriesEncoding::Xor};
+    float          quantum  {0.01f};   ///< FixedPoint resolution, e.g. 0.01 °C
+};
+
+struct Sample {
+    int64_t timeMs {0};
+    float   value  {0.0f};
+};
+
+/// One downsampled bucket; timeMs is the bucket start.
+struct Aggregate {
+    int64_t  timeMs {0};
+    float    min    {0.0f};
+    float    max    {0.0f};
+    float    mean   {0.0f};
+    uint32_t count  {0};
+};
+
+struct StoreStats {
+    uint64_t blocks    {0};   ///< data blocks in use
+    uint64_t rawBlocks {0};   ///< of which raw samples, the rest are tiers
+    uint64_t samples   {0};   ///< raw samples across all series
+    uint64_t bytes     {0};   ///< file bytes in use, header included
+};
+
+class TimeSeriesStore {
+public:
+    static constexpr size_t  BLOCK_BYTES = 4096;
+    static constexpr size_t  MAX_SERIES  = 64;
+    static constexpr size_t  NAME_BYTES  = 40;
+    static constexpr int     TIERS       = 3;   ///< aggregated tiers
+    static constexpr int64_t TIER_MS[TIERS] = {1000, 60'000, 3'600'000};
+
+    /// Opens or creates the file. Read-only stores answer queries only.
+    explicit TimeSeriesStore(const std::string& path, bool readOnly = false);
+    ~TimeSeriesStore();
+
+    TimeSeriesStore(const TimeSeriesStore&) = delete;
+    TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+    bool isValid() const { return base_ != nullptr; }
+
+    /// Id of the named series, creating it if needed (options apply only
+    /// on creation). -1 if the table is full, the name is too long, or the
+    /// store is read-only and the series does not exist.
+    int addSeries(const std::string& name, const SeriesOptions& options = {});
+    int findSeries(const std::string& name) const;
+    size_t seriesCount() const;
+
+    /// Appends one sample and updates the tiers. False if the store is
+    /// read-only, the id is unknown or the timestamp goes backwards.
+    /// Non-finite values are stored (Xor only) but skipped by the tiers.
+    bool append(int series, int64_t timeMs, float value);
+
+    /// Raw samples with from <= time <= to, appended to out.
+    size_t query(int series, int64_t fromMs, int64_t toMs, std::vector<Sample>& out) const;
+
+    /// One field of a tier; buckets still being filled are included.
+    size_t query(int series, Tier tier, Field field, int64_t fromMs, int64_t toMs,
+                 std::vector<Sample>& out) const;
+
+    /// All fields of a tier, buckets starting in [from, to].
+    size_t query(int series, Tier tier, int64_t fromMs, int64_t toMs,
+                 std::vector<Aggregate>& out) const;
+
+    /// Finest aggregated tier that covers [from, to] in at most maxPoints
+    /// buckets (Hour if none does). Raw is never chosen: its rate is unknown.
+    static Tier tierFor(int64_t fromMs, int64_t toMs, size_t maxPoints);
+
+    /// Schedules dirty pages for write-back (MS_ASYNC).
+    void flush();
+
+    StoreStats stats() const;
+
+private:
+    // Column = one block chain: slot 0 raw, then tier-major (min,max,mean,count).
+    static constexpr int FIELDS            = 4;
+    static constexpr int COLUMNS_PER_SERIES = 1 + TIERS * FIELDS;
+
+    struct BlockRef {
+        int64_t  firstMs;
+        int64_t  lastMs;
+        uint32_t index;
+    };
+
+    /// Encoder state of a column's newest block (also what a full decode
+    /// of that block ends with).
+    struct Cursor {
+        uint32_t count     {0};
+        uint32_t bitPos    {0};
+        int64_t  prevMs    {0};
+        int64_t  prevDelta {0};
+        uint32_t prevBits  {0};   // Xor: previous float bits
+        int64_t  prevQ     {0};   // FixedPoint: previous quantised value
+        uint8_t  lead      {0xff};
+        uint8_t  trail     {0};
+    };
+
+    struct Column {
+        std::vector<BlockRef> blocks;
+        Cursor                cursor;
+    };
+
+    struct Bucket {
+        int64_t  startMs {0};
+        float    min     {0.0f};
+        float    max     {0.0f};
+        double   sum     {0.0};
+        uint32_t count   {0};
+    };
+
+    struct Series {
+        std::string    name;
+        SeriesOptions  options;
+        int64_t        lastMs {INT64_MIN};
+        std::array<Bucket, TIERS> open {};   // buckets still accumulating
+    };
+
+    uint8_t* block(uint32_t index) const { return base_ + size_t(index) * BLOCK_BYTES; }
+    static int rawColumn(int series) { return series * COLUMNS_PER_SERIES; }
+    static int tierColumn(int series, int tier, Field field)   // tier 0 = 1 s
+    {
+        return series * COLUMNS_PER_SERIES + 1 + tier * FIELDS + static_cast<int>(field);
+    }
+
+    SeriesOptions columnOptions(int column) const;
+    bool     mapFile(size_t bytes);
+    bool     reserveBlock(uint32_t& index);
+    void     loadIndex();
+    void     restoreBuckets(int series);
+    bool     appendColumn(int column, int64_t timeMs, float value);
+    void     feedTier(int series, int tier, int64_t timeMs,
+                      float mn, float mx, double sum, uint32_t count);
+    template <typename Fn>
+    void     scanColumn(int column, int64_t fromMs, int64_t toMs, Fn&& fn) const;
+    std::vector<Bucket> pendingBuckets(int series, int tier) const;
+    size_t   queryLocked(int series, Tier tier, Field field, int64_t fromMs, int64_t toMs,
+                         std::vector<Sample>& out) const;
+
+    bool                 readOnly_ {false};
+    uint64_t             samples_  {0};
+    int                  fd_       {-1};
+    uint8_t*             base_     {nullptr};
+    size_t               mapped_   {0};     // bytes mapped (== file size)
+    std::vector<Series>  series_;
+    std::vector<Column>  columns_;
+    mutable std::mutex   mutex_;
+};
+
+} // namespace duosight
@@ -0,0 +1,71 @@
+/**
+ * @file workStealingPool.hpp
+ * @brief Fixed-size thread pool with per-worker deques and work stealing.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Each worker owns a deque: tasks submitted from a worker go to its own
+ *   deque (LIFO, cache-warm), tasks submitted from outside are spread
+ *   round-robin. An idle worker steals the oldest task from its siblings,
+ *   so independent processing branches keep all four A53 cores busy.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace duosight {
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /// @param workers number of threads; 0 selects hardware_concurrency().
+    explicit WorkStealingPool(unsigned workers = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+    void waitIdle();                    ///< blocks until no task is queued or running
+
+    unsigned workerCount() const { return static_cast<unsigned>(threads_.size()); }
+    uint64_t stealCount()  const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(unsigned index);
+    bool popLocal(unsigned index, Task& out);
+    bool steal(unsigned thief, Task& out);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread>             threads_;
+
+    std::mutex              sleepMutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+
+    std::atomic<size_t>   queued_  {0};   // submitted, not yet picked up
+    std::atomic<size_t>   running_ {0};   // picked up, not yet finished
+    std::atomic<unsigned> next_    {0};   // round-robin cursor for external submits
+    std::atomic<uint64_t> steals_  {0};
+    std::atomic<bool>     stop_    {false};
+};
+
+} // namespace duosight
@@ -0,0 +1,186 @@
+/**
+ * @file zoneMap.hpp
+ * @brief Per-block min/max/mean zone maps in recordings, and queries that use them.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   ZoneMapRecorder packs FrameRecords into whole RecordingWriter blocks.
+ *   Each block starts with a header giving the block's time and sequence
+ *   span. It also gives the min, max and mean of every zone over the
+ *   block's frames. The zones are the twelve 8x8 scene tiles, plus up to
+ *   MAX_ROIS configured ROIs, whose rectangles are stored alongside. The
+ *   summaries are accumulated frame by frame as the block fills, so
+ *   nothing is re-read when it is written.
+ *
+ *   RecordingIndex reads only the block headers at open (as
+ *   TimeSeriesStore indexes its blocks). A query such as "any pixel of ROI
+ *   X above 90 °C between t0 and t1" then skips every block that cannot
+ *   match. Blocks outside the time span are skipped, and so are blocks
+ *   whose bound for the ROI cannot cross the threshold. The bound is taken
+ *   from the tiles the ROI overlaps, tightened by any recorded ROI that
+ *   contains it. Only the remaining candidate blocks are read and decoded,
+ *   split across a WorkStealingPool. Hits come back in time order.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MLX90640Regs.hpp"
+#include "pixelConverter.hpp"
+#include "processingGraph.hpp"
+#include "recordingWriter.hpp"
+#include "sceneChange.hpp"
+#include "thermalFrame.hpp"
+#include "workStealingPool.hpp"
+
+namespace duosight {
+
+namespace ZoneMap {
+inline constexpr size_t MAX_ROIS  = 20;
+inline constexpr size_t MAX_ZONES = SceneTiles::COUNT + MAX_ROIS;   ///< tiles first, then ROIs
+} // namespace ZoneMap
+
+struct ZoneRange {
+    float min  { std::numeric_limits<float>::infinity()};
+    float max  {-std::numeric_limits<float>::infinity()};
+    float mean {0.0f};
+};
+
+struct ZoneMapOptions {
+    std::vector<Roi> rois;   ///< summarised next to the tiles; at most MAX_ROIS
+};
+
+struct ZoneRecorderStats {
+    uint64_t frames        {0};   ///< appended
+    uint64_t blocks        {0};   ///< handed to the writer
+    uint64_t droppedBlocks {0};   ///< refused by the writer (no free buffer)
+    uint64_t droppedFrames {0};
+};
+
+class ZoneMapRecorder {
+public:
+    /// Blocks are writer.options().blockBytes; the writer must outlive
+    /// the recorder (or see finish() first).
+    explicit ZoneMapRecorder(RecordingWriter& writer, const ZoneMapOptions& options = {});
+    ~ZoneMapRecorder();
+
+    ZoneMapRecorder(const ZoneMapRecorder&) = delete;
+    ZoneMapRecorder& operator=(const ZoneMapRecorder&) = delete;
+
+    /// Adds a frame to the block being filled. False if this completed a
+    /// block the writer refused; that block's frames are lost.
+    bool append(const ThermalFrame& frame);
+
+    /// Hands over the partly filled block.
+    bool finish();
+
+    /// Graph sink around append().
+    ProcessingGraph::StageFn stage();
+
+    ZoneRecorderStats stats() const;
+    size_t framesPerBlock() const { return perBlock_; }
+
+private:
+    bool flushLocked();
+
+    RecordingWriter&     writer_;
+    std::vector<Roi>     rois_;
+    std::vector<uint8_t> block_;
+    size_t               perBlock_ {0};
+    size_t               frames_   {0};   // in block_
+
+    // Zone accumulators for block_
+    std::array<float,  ZoneMap::MAX_ZONES> min_ {};
+    std::array<float,  ZoneMap::MAX_ZONES> max_ {};
+    std::array<double, ZoneMap::MAX_ZONES> sum_ {};
+    std::array<uint32_t, ZoneMap::MAX_ZONES> count_ {};
+
+    mutable std::mutex mutex_;
+    ZoneRecorderStats  stats_;
+};
+
+struct ZoneQuery {
+    Roi     roi    {0, 0, static_cast<int>(Geometry::WIDTH), static_cast<int>(Geometry::HEIGHT)};
+    int64_t fromNs {std::numeric_limits<int64_t>::min()};
+    int64_t toNs   {std::numeric_limits<int64_t>::max()};
+    float   above  { std::numeric_limits<float>::infinity()};   ///< match if any ROI pixel is above
+    float   below  {-std::numeric_limits<float>::infinity()};   ///< or any is below
+    bool    useZoneMaps {true};   ///< false decodes every block in the span (for comparison)
+};
+
+/// One matching frame, with the ROI's extremes in it.
+struct ZoneHit {
+    uint64_t sequence    {0};
+    int64_t  timestampNs {0};
+    float    min         {0.0f};
+    float    max         {0.0f};
+};
+
+struct ZoneQueryStats {
+    uint64_t blocks     {0};   ///< in the time span
+    uint64_t candidates {0};   ///< read and decoded
+    uint64_t frames     {0};   ///< decoded
+    double   ms         {0.0};
+};
+
+/// Per-block summary of one zone, for trends without decoding frames.
+struct ZoneSummary {
+    int64_t   firstNs {0};
+    int64_t   lastNs  {0};
+    uint32_t  frames  {0};
+    ZoneRange range;
+};
+
+class RecordingIndex {
+public:
+    /// Reads the block headers of a recording made by ZoneMapRecorder.
+    explicit RecordingIndex(const std::string& path);
+    ~RecordingIndex();
+
+    RecordingIndex(const RecordingIndex&) = delete;
+    RecordingIndex& operator=(const RecordingIndex&) = delete;
+
+    bool isValid() const { return fd_ >= 0; }
+    size_t   blocks() const { return blocks_.size(); }
+    uint64_t frames() const { return frames_; }
+    /// ROIs recorded (zone SceneTiles::COUNT + i), from the first block.
+    const std::vector<Roi>& rois() const { return rois_; }
+
+    /// Frames matching q, in time order. Candidate blocks are decoded on
+    /// pool; the call waits for them (not for unrelated pool work), so it
+    /// must not be made from a task on the same pool.
+    std::vector<ZoneHit> query(const ZoneQuery& q, WorkStealingPool& pool,
+                               ZoneQueryStats* stats = nullptr) const;
+
+    /// Header summaries of one zone for blocks overlapping [from, to].
+    std::vector<ZoneSummary> summaries(size_t zone, int64_t fromNs, int64_t toNs) const;
+
+private:
+    struct Block {
+        uint64_t offset;
+        int64_t  firstNs;
+        int64_t  lastNs;
+        uint32_t frames;
+        std::array<ZoneRange, ZoneMap::MAX_ZONES> zones;
+    };
+
+    void decode(const Block& block, const ZoneQuery& q, std::vector<uint8_t>& buf,
+                std::vector<ZoneHit>& hits, uint64_t& frames) const;
+
+    int                 fd_ {-1};
+    size_t              blockBytes_ {0};
+    uint64_t            frames_ {0};
+    std::vector<Roi>    rois_;
+    std::vector<Block>  blocks_;   // file order, which is time order
+};
+
+} // namespace duosight
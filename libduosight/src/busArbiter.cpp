@@ -0,0 +1,210 @@
+/**
+ * @file busArbiter.cpp
+ * @brief Grant queue, transfer splitting and per-client accounting.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Waiters sit in a small vector under one mutex; whoever releases the
+ *   bus wakes them all and only the best-ranked one proceeds. With a
+ *   handful of clients a scan beats keeping a heap ordered.
+ */
+
+#include "busArbiter.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "metrics.hpp"
+
+namespace duosight {
+
+BusArbiter::BusArbiter(Clock now)
+    : now_(std::move(now))
+{
+    if (!now_) {
+        now_ = [] {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+    }
+}
+
+int BusArbiter::addClient(const BusClientOptions& options)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto c = std::make_unique<Client>();
+    c->options        = options;
+    c->stats.name     = options.name;
+    c->stats.priority = options.priority;
+    clients_.push_back(std::move(c));
+    return static_cast<int>(clients_.size() - 1);
+}
+
+BusClientOptions BusArbiter::client(int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_[id]->options;
+}
+
+bool BusArbiter::before(const Waiter& a, const Waiter& b)
+{
+    if (a.priority != b.priority) return a.priority > b.priority;
+    if (a.deadlineNs != b.deadlineNs) return a.deadlineNs < b.deadlineNs;
+    return a.seq < b.seq;
+}
+
+int64_t BusArbiter::acquire(int client, int64_t deadlineNs, bool resumed)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    Client& c = *clients_[client];
+    const Waiter me{client, static_cast<uint8_t>(c.options.priority), deadlineNs, seq_++};
+    const int64_t queued = now_();
+    queue_.push_back(me);
+
+    cv_.wait(lock, [&] {
+        if (busy_) return false;
+        const auto best = std::min_element(queue_.begin(), queue_.end(), before);
+        return best->seq == me.seq;
+    });
+    queue_.erase(std::find_if(queue_.begin(), queue_.end(),
+                              [&](const Waiter& w) { return w.seq == me.seq; }));
+    busy_ = true;
+
+    const int64_t granted = now_();
+    const int64_t wait    = granted - queued;
+    ++c.stats.grants;
+    c.stats.waitNs   += wait;
+    c.stats.maxWaitNs = std::max(c.stats.maxWaitNs, wait);
+    if (resumed && lastHolder_ != client) {
+        ++c.stats.yields;
+    }
+    if (c.waitSeconds) c.waitSeconds->observe(wait * 1e-9);
+    return granted;
+}
+
+void BusArbiter::release(int client, int64_t grantedNs, int64_t deadlineNs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int64_t done = now_();
+        Client& c = *clients_[client];
+        c.stats.busNs += done - grantedNs;
+        if (done > deadlineNs) {
+            ++c.stats.deadlineMisses;
+        }
+        busy_       = false;
+        lastHolder_ = client;
+    }
+    cv_.notify_all();
+}
+
+bool BusArbiter::run(int client, const std::function<bool()>& op, int64_t deadlineNs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++clients_[client]->stats.transactions;
+        if (deadlineNs == 0) {
+            deadlineNs = now_() + clients_[client]->options.budgetNs;
+        }
+    }
+    const int64_t granted = acquire(client, deadlineNs, false);
+    const bool    ok      = op();
+    release(client, granted, deadlineNs);
+    return ok;
+}
+
+bool BusArbiter::transfer(int client, I2cDevice& dev, I2cMessage* messages, size_t count)
+{
+    int64_t deadlineNs = 0;
+    bool    split      = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Client& c = *clients_[client];
+        split      = c.options.splittable;
+        deadlineNs = now_() + c.options.budgetNs;
+    }
+    if (!split || count <= 2) {
+        return run(client, [&] { return dev.transfer(messages, count); }, deadlineNs);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++clients_[client]->stats.transactions;
+    }
+    // One register access per grant: an address write and the read that
+    // follows it, or a lone message. All pieces keep the original deadline.
+    for (size_t i = 0; i < count;) {
+        const size_t n = (!messages[i].read && i + 1 < count && messages[i + 1].read) ? 2 : 1;
+        const int64_t granted = acquire(client, deadlineNs, i > 0);
+        const bool    ok      = dev.transfer(messages + i, n);
+        release(client, granted, deadlineNs);
+        if (!ok) {
+            return false;
+        }
+        i += n;
+    }
+    return true;
+}
+
+std::vector<BusClientStats> BusArbiter::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<BusClientStats> out;
+    out.reserve(clients_.size());
+    for (const auto& c : clients_) {
+        out.push_back(c->stats);
+    }
+    return out;
+}
+
+void BusArbiter::attachMetrics(MetricsRegistry& registry)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& c : clients_) {
+        const std::string label = "client=\"" + c->options.name + "\"";
+        c->waitSeconds = &registry.histogram("duosight_i2c_wait_seconds",
+                                             "Time a transaction queued for the shared I2C bus",
+                                             Histogram::exponential(0.0001, 2.0, 12), label);
+        const Client* cp = c.get();
+        registry.callbackCounter("duosight_i2c_deadline_misses_total",
+                                 "Transactions finished after their deadline",
+                                 [this, cp] {
+                                     std::lock_guard<std::mutex> l(mutex_);
+                                     return static_cast<double>(cp->stats.deadlineMisses);
+                                 }, label);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// ArbitratedDevice
+// ─────────────────────────────────────────────────────────────────────────
+
+ArbitratedDevice::ArbitratedDevice(BusArbiter& arbiter, I2cDevice& dev, const BusClientOptions& options)
+    : I2cDevice(dev.address()), arbiter_(arbiter), dev_(dev), client_(arbiter.addClient(options))
+{
+}
+
+bool ArbitratedDevice::writeBytes(const uint8_t* data, size_t length)
+{
+    return arbiter_.run(client_, [&] { return dev_.writeBytes(data, length); });
+}
+
+bool ArbitratedDevice::readBytes(uint8_t* buffer, size_t length)
+{
+    return arbiter_.run(client_, [&] { return dev_.readBytes(buffer, length); });
+}
+
+bool ArbitratedDevice::writeThenRead(const uint8_t* txData, size_t txLen, uint8_t* rxData, size_t rxLen)
+{
+    return arbiter_.run(client_, [&] { return dev_.writeThenRead(txData, txLen, rxData, rxLen); });
+}
+
+bool ArbitratedDevice::transfer(I2cMessage* messages, size_t count)
+{
+    return arbiter_.transfer(client_, dev_, messages, count);
+}
+
+} // namespace duosight
@@ -0,0 +1,261 @@
+/**
+ * @file cApi.cpp
+ * @brief duosight.h implementation: frame ring, reader cursors, borrows.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A ring slot is a FramePtr, so publishing costs a reference count and
+ *   a borrow costs another one plus a ds_frame header filled from the
+ *   packet's metadata; ds_frame::pixels points into the ThermalFrame
+ *   itself. The ring may overwrite a slot while a consumer still reads
+ *   it: the borrow keeps its own reference, so the pixels outlive the slot
+ *   until ds_reader_release(). Pipeline state is shared by the handle,
+ *   its readers and any graph sinks, so destroying the handle first is
+ *   safe. Exceptions never cross the C boundary.
+ */
+
+#include "cApi.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// The layout promised in duosight.h
+static_assert(DS_PIXELS == duosight::Geometry::PIXELS, "frame geometry");
+static_assert(sizeof(float) == 4, "float32 pixels");
+static_assert(alignof(duosight::ThermalFrame) >= DS_PIXEL_ALIGNMENT, "pixel alignment");
+static_assert(offsetof(duosight::ThermalFrame, temperatures) % DS_PIXEL_ALIGNMENT == 0,
+              "pixel alignment");
+static_assert(sizeof(duosight::ThermalFrame::temperatures) == DS_PIXELS * sizeof(float),
+              "packed rows");
+static_assert(offsetof(ds_frame, sequence) == 16 && offsetof(ds_frame, dropped) == 32
+              && offsetof(ds_frame, changed_tiles) == 40 && offsetof(ds_frame, pixels) == 48,
+              "ds_frame layout is part of the ABI");
+
+namespace {
+
+using duosight::FramePtr;
+
+struct PipelineState {
+    std::mutex              mutex;
+    std::condition_variable published;
+    std::vector<FramePtr>   ring;        // frame n lives in ring[n % size]
+    uint64_t                count  {0};  // frames published
+    bool                    closed {false};
+};
+
+/// A borrow: the header handed out plus the reference that keeps the
+/// pixels alive. header comes first so a ds_frame* identifies the borrow.
+struct Borrow {
+    ds_frame header;
+    FramePtr frame;
+};
+static_assert(offsetof(Borrow, header) == 0, "ds_frame* must identify its borrow");
+
+bool publishTo(PipelineState& state, FramePtr frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.closed) {
+            return false;
+        }
+        state.ring[state.count % state.ring.size()] = std::move(frame);
+        ++state.count;
+    }
+    state.published.notify_all();
+    return true;
+}
+
+} // namespace
+
+struct ds_pipeline {
+    std::shared_ptr<PipelineState> state;
+};
+
+struct ds_reader {
+    std::shared_ptr<PipelineState>      state;
+    uint64_t                            next {0};   // first frame not yet borrowed
+    std::vector<std::unique_ptr<Borrow>> borrows;
+};
+
+extern "C" {
+
+uint32_t ds_abi_version(void)
+{
+    return DS_ABI_VERSION;
+}
+
+ds_pipeline* ds_pipeline_create(uint32_t slots)
+{
+    try {
+        auto* p  = new ds_pipeline;
+        p->state = std::make_shared<PipelineState>();
+        p->state->ring.resize(std::max<uint32_t>(slots, 2));
+        return p;
+    } catch (const std::exception& e) {
+        std::cerr << "[CApi] pipeline create failed: " << e.what() << "\n";
+        return nullptr;
+    }
+}
+
+void ds_pipeline_destroy(ds_pipeline* pipeline)
+{
+    if (!pipeline) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pipeline->state->mutex);
+        pipeline->state->closed = true;
+    }
+    pipeline->state->published.notify_all();
+    delete pipeline;
+}
+
+ds_status ds_pipeline_publish(ds_pipeline* pipeline, const float* celsius,
+                              uint64_t sequence, int64_t timestamp_ns)
+{
+    if (!pipeline || !celsius) {
+        return DS_EINVAL;
+    }
+    try {
+        auto frame         = std::make_shared<duosight::ThermalFrame>();
+        frame->sequence    = sequence;
+        frame->timestampNs = timestamp_ns;
+        std::copy(celsius, celsius + DS_PIXELS, frame->temperatures.begin());
+        return publishTo(*pipeline->state, std::move(frame)) ? DS_OK : DS_ECLOSED;
+    } catch (const std::bad_alloc&) {
+        return DS_ENOMEM;
+    }
+}
+
+uint64_t ds_pipeline_published(const ds_pipeline* pipeline)
+{
+    if (!pipeline) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(pipeline->state->mutex);
+    return pipeline->state->count;
+}
+
+ds_reader* ds_reader_open(ds_pipeline* pipeline)
+{
+    if (!pipeline) {
+        return nullptr;
+    }
+    try {
+        auto* r  = new ds_reader;
+        r->state = pipeline->state;
+        r->borrows.reserve(DS_MAX_BORROWS);
+        std::lock_guard<std::mutex> lock(r->state->mutex);
+        r->next = r->state->count;
+        return r;
+    } catch (const std::exception& e) {
+        std::cerr << "[CApi] reader open failed: " << e.what() << "\n";
+        return nullptr;
+    }
+}
+
+void ds_reader_close(ds_reader* reader)
+{
+    delete reader;
+}
+
+ds_status ds_reader_borrow(ds_reader* reader, int32_t timeout_ms, const ds_frame** frame)
+{
+    if (!reader || !frame) {
+        return DS_EINVAL;
+    }
+    *frame = nullptr;
+    if (reader->borrows.size() >= DS_MAX_BORROWS) {
+        return DS_ELIMIT;
+    }
+
+    PipelineState& s = *reader->state;
+    auto borrow = std::unique_ptr<Borrow>(new (std::nothrow) Borrow{});
+    if (!borrow) {
+        return DS_ENOMEM;
+    }
+
+    uint64_t index;
+    {
+        std::unique_lock<std::mutex> lock(s.mutex);
+        auto ready = [&] { return s.count > reader->next || s.closed; };
+        if (timeout_ms < 0) {
+            s.published.wait(lock, ready);
+        } else if (!s.published.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready)) {
+            return DS_TIMEOUT;
+        }
+        if (s.count <= reader->next) {
+            return DS_ECLOSED;
+        }
+        // Oldest unseen frame the ring still holds
+        const uint64_t oldest = s.count > s.ring.size() ? s.count - s.ring.size() : 0;
+        index                 = std::max(reader->next, oldest);
+        borrow->frame         = s.ring[index % s.ring.size()];
+    }
+
+    const duosight::ThermalFrame& f = *borrow->frame;
+    ds_frame& h     = borrow->header;
+    h.struct_size   = sizeof(ds_frame);
+    h.width         = DS_WIDTH;
+    h.height        = DS_HEIGHT;
+    h.row_stride    = DS_ROW_STRIDE;
+    h.sequence      = f.sequence;
+    h.timestamp_ns  = f.timestampNs;
+    h.dropped       = index - reader->next;
+    h.changed_tiles = f.changedTiles;
+    h.change_score  = f.changeScore;
+    h.pixels        = f.temperatures.data();
+
+    reader->next = index + 1;
+    *frame = &borrow->header;
+    reader->borrows.push_back(std::move(borrow));
+    return DS_OK;
+}
+
+ds_status ds_reader_release(ds_reader* reader, const ds_frame* frame)
+{
+    if (!reader || !frame) {
+        return DS_EINVAL;
+    }
+    auto& b  = reader->borrows;
+    auto  it = std::find_if(b.begin(), b.end(),
+                            [&](const std::unique_ptr<Borrow>& x) { return &x->header == frame; });
+    if (it == b.end()) {
+        return DS_EINVAL;
+    }
+    b.erase(it);
+    return DS_OK;
+}
+
+} // extern "C"
+
+namespace duosight {
+
+bool publish(ds_pipeline* pipeline, FramePtr frame)
+{
+    return pipeline && frame && publishTo(*pipeline->state, std::move(frame));
+}
+
+ProcessingGraph::StageFn pipelineSink(ds_pipeline* pipeline)
+{
+    // Holds the state, not the handle: the sink keeps working (as a no-op)
+    // if the handle is destroyed before the graph
+    std::shared_ptr<PipelineState> state = pipeline ? pipeline->state : nullptr;
+    return [state](const FramePtr& frame) -> FramePtr {
+        if (state && frame) {
+            publishTo(*state, frame);
+        }
+        return nullptr;
+    };
+}
+
+} // namespace duosight
@@ -0,0 +1,222 @@
+/**
+ * @file clahe.cpp
+ * @brief Upscale, tile histograms and blended equalisation for Clahe.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Tile centres sit at (t + 0.5) * size / tiles; pixels outside the
+ *   outermost centres use the edge tile alone. Each pixel reads its level
+ *   from the four surrounding tile LUTs, blends vertically then
+ *   horizontally; both blends round the same way on every path.
+ */
+
+#include "clahe.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace duosight {
+
+namespace {
+
+constexpr int Q = 128;   // blend weight scale (Q7)
+
+inline uint8_t blend(uint8_t a, uint8_t b, uint8_t w)
+{
+    return static_cast<uint8_t>((a * (Q - w) + b * w + Q / 2) >> 7);
+}
+
+/// Source pixel and weight for each of `n` output samples over `src` inputs.
+void sampling(int n, int src, std::vector<uint16_t>& index, std::vector<float>& frac)
+{
+    index.resize(n);
+    frac.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const float pos = std::clamp((i + 0.5f) * src / n - 0.5f, 0.0f, float(src - 1));
+        const int   i0  = std::min(static_cast<int>(pos), src - 2);
+        index[i] = static_cast<uint16_t>(i0);
+        frac[i]  = pos - i0;
+    }
+}
+
+/// Neighbouring tiles and Q7 weight for each of `n` pixels over `tiles` tiles.
+void tileBlend(int n, int tiles, std::vector<uint8_t>& t0, std::vector<uint8_t>& t1,
+               std::vector<uint8_t>& w, std::vector<uint8_t>& own)
+{
+    t0.resize(n);
+    t1.resize(n);
+    w.resize(n);
+    own.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const float pos = (i + 0.5f) * tiles / n - 0.5f;   // in tile-centre units
+        own[i] = static_cast<uint8_t>(i * tiles / n);
+        if (pos <= 0.0f) {
+            t0[i] = t1[i] = 0;
+            w[i]  = 0;
+        } else if (pos >= tiles - 1) {
+            t0[i] = t1[i] = static_cast<uint8_t>(tiles - 1);
+            w[i]  = 0;
+        } else {
+            const int lo = static_cast<int>(pos);
+            t0[i] = static_cast<uint8_t>(lo);
+            t1[i] = static_cast<uint8_t>(lo + 1);
+            w[i]  = static_cast<uint8_t>(std::lround((pos - lo) * Q));
+        }
+    }
+}
+
+} // namespace
+
+Clahe::Clahe(const ClaheOptions& options)
+    : opt_(options)
+{
+    opt_.width     = std::max(opt_.width, 2);
+    opt_.height    = std::max(opt_.height, 2);
+    opt_.tilesX    = std::clamp(opt_.tilesX, 1, std::min(opt_.width, 64));
+    opt_.tilesY    = std::clamp(opt_.tilesY, 1, std::min(opt_.height, 64));
+    opt_.clipLimit = std::max(opt_.clipLimit, 1.0f);
+
+    sampling(opt_.width,  Geometry::WIDTH,  srcX_, fracX_);
+    sampling(opt_.height, Geometry::HEIGHT, srcY_, fracY_);
+    tileBlend(opt_.width,  opt_.tilesX, tileX0_, tileX1_, weightX_, tileOfX_);
+    tileBlend(opt_.height, opt_.tilesY, tileY0_, tileY1_, weightY_, tileOfY_);
+
+    for (int x = 0; x < opt_.width; ++x) {
+        if (spans_.empty() || spans_.back().t0 != tileX0_[x] || spans_.back().t1 != tileX1_[x]) {
+            spans_.push_back({x, x, tileX0_[x], tileX1_[x]});
+        }
+        spans_.back().end = x + 1;
+    }
+
+    levels_.resize(static_cast<size_t>(opt_.width) * opt_.height);
+    hist_.resize(static_cast<size_t>(opt_.tilesX) * opt_.tilesY);
+    luts_.resize(hist_.size());
+}
+
+void Clahe::upscale(const float* t, float lo, float hi)
+{
+    const float top   = BINS - 1;
+    const float scale = hi - lo > 1e-6f ? top / (hi - lo) : 0.0f;
+    for (auto& h : hist_) {
+        h.fill(0);
+    }
+
+    std::array<float, Geometry::WIDTH> row;
+    for (int y = 0; y < opt_.height; ++y) {
+        // Vertical interpolation once per output row, already in level units
+        const float* r0 = t + srcY_[y] * Geometry::WIDTH;
+        const float* r1 = r0 + Geometry::WIDTH;
+        const float  fy = fracY_[y];
+        for (size_t i = 0; i < Geometry::WIDTH; ++i) {
+            row[i] = ((r0[i] + (r1[i] - r0[i]) * fy) - lo) * scale;
+        }
+
+        uint16_t* out = levels_.data() + static_cast<size_t>(y) * opt_.width;
+        auto*    h   = hist_.data() + tileOfY_[y] * opt_.tilesX;
+        for (int x = 0; x < opt_.width; ++x) {
+            const float a = row[srcX_[x]];
+            const float g = std::clamp(a + (row[srcX_[x] + 1] - a) * fracX_[x], 0.0f, top);
+            const auto  v = static_cast<uint16_t>(g + 0.5f);
+            out[x] = v;
+            ++h[tileOfX_[x]][v];
+        }
+    }
+}
+
+void Clahe::buildLuts()
+{
+    for (size_t i = 0; i < hist_.size(); ++i) {
+        std::array<uint32_t, BINS>& h = hist_[i];
+        uint32_t n = 0;
+        for (uint32_t c : h) n += c;
+        if (n == 0) {
+            for (int v = 0; v < BINS; ++v) luts_[i][v] = static_cast<uint8_t>(v * 256 / BINS);
+            continue;
+        }
+
+        // Clip, then hand the excess back evenly so the CDF still ends at n
+        const auto limit = std::max<uint32_t>(1, static_cast<uint32_t>(opt_.clipLimit * n / BINS));
+        uint32_t excess = 0;
+        for (uint32_t& c : h) {
+            if (c > limit) {
+                excess += c - limit;
+                c = limit;
+            }
+        }
+        const uint32_t each = excess / BINS;
+        const uint32_t rest = excess % BINS;
+        for (uint32_t v = 0; v < BINS; ++v) {
+            h[v] += each + (v * rest / BINS != (v + 1) * rest / BINS);
+        }
+
+        const float scale = 255.0f / n;
+        uint32_t    cdf   = 0;
+        for (int v = 0; v < BINS; ++v) {
+            cdf += h[v];
+            luts_[i][v] = static_cast<uint8_t>(std::min(cdf * scale + 0.5f, 255.0f));
+        }
+    }
+}
+
+void Clahe::equalise(uint8_t* out)
+{
+    buildLuts();
+
+    const int tx = opt_.tilesX;
+    for (int y = 0; y < opt_.height; ++y) {
+        const Lut*      l0 = luts_.data() + tileY0_[y] * tx;
+        const Lut*      l1 = luts_.data() + tileY1_[y] * tx;
+        const uint8_t   wy = weightY_[y];
+        const uint16_t* g  = levels_.data() + static_cast<size_t>(y) * opt_.width;
+        uint8_t*        o  = out + static_cast<size_t>(y) * opt_.width;
+
+        for (const Span& span : spans_) {
+            // The four LUTs are fixed across a span
+            const uint8_t* a = l0[span.t0].data();
+            const uint8_t* b = l0[span.t1].data();
+            const uint8_t* c = l1[span.t0].data();
+            const uint8_t* d = l1[span.t1].data();
+            int x = span.begin;
+#if defined(__ARM_NEON)
+            const uint8x8_t vwy  = vdup_n_u8(wy);
+            const uint8x8_t viwy = vdup_n_u8(static_cast<uint8_t>(Q - wy));
+            alignas(8) uint8_t va[8], vb[8], vc[8], vd[8];
+            for (; x + 8 <= span.end; x += 8) {
+                // Table lookups stay scalar; both blends are vector ops over 8 pixels
+                for (int k = 0; k < 8; ++k) {
+                    const uint16_t v = g[x + k];
+                    va[k] = a[v];
+                    vb[k] = b[v];
+                    vc[k] = c[v];
+                    vd[k] = d[v];
+                }
+                const uint8x8_t left  = vrshrn_n_u16(vmlal_u8(vmull_u8(vld1_u8(va), viwy), vld1_u8(vc), vwy), 7);
+                const uint8x8_t right = vrshrn_n_u16(vmlal_u8(vmull_u8(vld1_u8(vb), viwy), vld1_u8(vd), vwy), 7);
+                const uint8x8_t wx    = vld1_u8(weightX_.data() + x);
+                const uint8x8_t iwx   = vsub_u8(vdup_n_u8(Q), wx);
+                vst1_u8(o + x, vrshrn_n_u16(vmlal_u8(vmull_u8(left, iwx), right, wx), 7));
+            }
+#endif
+            for (; x < span.end; ++x) {
+                const uint16_t v = g[x];
+                o[x] = blend(blend(a[v], c[v], wy), blend(b[v], d[v], wy), weightX_[x]);
+            }
+        }
+    }
+}
+
+void Clahe::apply(const float* temperatures, uint8_t* out)
+{
+    const auto [lo, hi] = std::minmax_element(temperatures, temperatures + Geometry::PIXELS);
+    upscale(temperatures, *lo, *hi);
+    equalise(out);
+}
+
+} // namespace duosight
@@ -0,0 +1,148 @@
+/**
+ * @file frameHistory.cpp
+ * @brief memfd + double-mmap implementation of FrameHistory.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Reserves 2x the ring size of address space, then maps the same memfd
+ *   into both halves with MAP_FIXED. Failure at any step leaves the
+ *   history invalid and is logged; nothing throws.
+ */
+
+#include "frameHistory.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace duosight {
+
+FrameHistory::FrameHistory(size_t minCapacity)
+{
+    const size_t page      = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t slotBytes = SLOT_FLOATS * sizeof(float);
+
+    // Smallest frame count whose total size is a whole number of pages,
+    // plus one spare slot for the frame the producer is writing.
+    const size_t granule = page / std::gcd(page, slotBytes);
+    capacity_ = ((std::max<size_t>(minCapacity, 1) + granule) / granule) * granule;
+    bytes_    = capacity_ * slotBytes;
+
+    const int fd = memfd_create("duosight-history", MFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[History] memfd_create failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+        std::cerr << "[History] ftruncate failed: " << std::strerror(errno) << "\n";
+        close(fd);
+        return;
+    }
+
+    void* reserve = mmap(nullptr, 2 * bytes_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserve == MAP_FAILED) {
+        std::cerr << "[History] address reservation failed: " << std::strerror(errno) << "\n";
+        close(fd);
+        return;
+    }
+
+    auto* lo = static_cast<uint8_t*>(reserve);
+    void* a = mmap(lo,          bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void* b = mmap(lo + bytes_, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);   // the mappings keep the pages alive
+
+    if (a == MAP_FAILED || b == MAP_FAILED) {
+        std::cerr << "[History] mirror mapping failed: " << std::strerror(errno) << "\n";
+        munmap(reserve, 2 * bytes_);
+        return;
+    }
+
+    base_      = reinterpret_cast<float*>(lo);
+    sequences_  = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+    timestamps_ = std::make_unique<int64_t[]>(2 * capacity_);
+}
+
+FrameHistory::~FrameHistory()
+{
+    if (base_) {
+        munmap(base_, 2 * bytes_);
+    }
+}
+
+size_t FrameHistory::size() const
+{
+    const uint64_t n = written_.load(std::memory_order_acquire);
+    return n < maxWindow() ? static_cast<size_t>(n) : maxWindow();
+}
+
+float* FrameHistory::slot(uint64_t index) const
+{
+    return base_ + (index % capacity_) * SLOT_FLOATS;
+}
+
+float* FrameHistory::beginWrite()
+{
+    return base_ ? slot(written_.load(std::memory_order_relaxed)) : nullptr;
+}
+
+void FrameHistory::commitWrite(uint64_t sequence, int64_t timestampNs)
+{
+    const uint64_t n = written_.load(std::memory_order_relaxed);
+    timestamps_[n % capacity_]             = timestampNs;
+    timestamps_[n % capacity_ + capacity_] = timestampNs;
+    sequences_[n % capacity_].store(sequence, std::memory_order_relaxed);
+    written_.store(n + 1, std::memory_order_release);
+}
+
+void FrameHistory::push(const ThermalFrame& frame)
+{
+    float* dst = beginWrite();
+    if (!dst) return;
+    std::memcpy(dst, frame.temperatures.data(), SLOT_FLOATS * sizeof(float));
+    commitWrite(frame.sequence, frame.timestampNs);
+}
+
+ProcessingGraph::StageFn FrameHistory::stage()
+{
+    return [this](const FramePtr& frame) -> FramePtr {
+        push(*frame);
+        return nullptr;
+    };
+}
+
+bool FrameHistory::window(size_t n, FrameWindow& out) const
+{
+    const uint64_t written = written_.load(std::memory_order_acquire);
+    if (!base_ || n == 0 || n > maxWindow() || n > written) {
+        return false;
+    }
+
+    const uint64_t first = written - n;
+    out = FrameWindow{};
+    out.data          = slot(first);     // runs into the mirror when it wraps
+    out.frames        = n;
+    out.firstSequence = sequences_[first % capacity_].load(std::memory_order_relaxed);
+    out.timestampsNs  = &timestamps_[first % capacity_];
+    return true;
+}
+
+bool FrameHistory::isIntact(const FrameWindow& w) const
+{
+    // Slots are overwritten oldest first, so the window is intact while its
+    // first slot still holds the frame it was taken from and is not the
+    // slot the producer may currently be filling.
+    if (!base_ || !w.data) return false;
+    const auto index   = static_cast<size_t>(w.data - base_) / SLOT_FLOATS % capacity_;
+    const auto written = written_.load(std::memory_order_acquire);
+    return sequences_[index].load(std::memory_order_relaxed) == w.firstSequence &&
+           written % capacity_ != index;
+}
+
+} // namespace duosight
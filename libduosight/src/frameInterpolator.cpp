@@ -0,0 +1,272 @@
+/**
+ * @file frameInterpolator.cpp
+ * @brief Block matching and per-block path sampling for FrameInterpolator.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Each 4x4 block is matched (SAD) against integer shifts of up to
+ *   searchRadius pixels, older frame into newer and newer into older,
+ *   edges clamped. Those vectors say where a block's content went, not
+ *   what passes through it in between, so each block then picks, from
+ *   its own and its neighbours' vectors, the one whose path best matches
+ *   the two frames at mid-phase. A vector only replaces zero motion when
+ *   it lowers the error by more than the noise floor, so sensor noise on
+ *   a static scene never invents motion. At phase a a pixel blends the
+ *   older frame sampled a*v behind it with the newer frame sampled
+ *   (1-a)*v ahead; both offsets are the same for the whole block, so the
+ *   bilinear weights are per block.
+ */
+
+#include "frameInterpolator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace duosight {
+
+namespace {
+
+constexpr int W = Geometry::WIDTH;
+constexpr int H = Geometry::HEIGHT;
+
+inline float at(const float* f, int x, int y)
+{
+    x = std::min(std::max(x, 0), W - 1);
+    y = std::min(std::max(y, 0), H - 1);
+    return f[y * W + x];
+}
+
+/// Bilinear sampler for a fixed fractional offset (ox, oy).
+struct Sampler {
+    int   ix, iy;
+    float w00, w10, w01, w11;
+
+    Sampler(float ox, float oy)
+    {
+        const float fx = std::floor(ox), fy = std::floor(oy);
+        ix = static_cast<int>(fx);
+        iy = static_cast<int>(fy);
+        const float ax = ox - fx, ay = oy - fy;
+        w00 = (1.0f - ax) * (1.0f - ay);
+        w10 = ax * (1.0f - ay);
+        w01 = (1.0f - ax) * ay;
+        w11 = ax * ay;
+    }
+
+    float operator()(const float* f, int x, int y) const
+    {
+        x += ix;
+        y += iy;
+        return w00 * at(f, x, y) + w10 * at(f, x + 1, y) + w01 * at(f, x, y + 1) + w11 * at(f, x + 1, y + 1);
+    }
+};
+
+} // namespace
+
+FrameInterpolator::FrameInterpolator(const InterpolationOptions& options)
+    : opt_(options)
+{
+    opt_.searchRadius = std::min(std::max(opt_.searchRadius, 0), 8);
+}
+
+void FrameInterpolator::push(const FramePtr& frame)
+{
+    if (!frame) {
+        return;
+    }
+    FramePtr previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous = to_;
+    }
+
+    std::array<MotionVector, BLOCKS_X * BLOCKS_Y> motion {};
+    if (previous && opt_.mode == InterpolationMode::MotionCompensated) {
+        estimateMotion(previous->temperatures.data(), frame->temperatures.data(), motion);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    from_   = std::move(previous);
+    to_     = frame;
+    motion_ = motion;
+}
+
+void FrameInterpolator::estimateMotion(const float* from, const float* to,
+                                       std::array<MotionVector, BLOCKS_X * BLOCKS_Y>& motion) const
+{
+    const int   r       = opt_.searchRadius;
+    const float minGain = opt_.noiseFloor * BLOCK * BLOCK;
+
+    // Best shift of block (bx, by) of a within b, and how much it beats
+    // zero motion
+    auto match = [&](const float* a, const float* b, int bx, int by, int& bdx, int& bdy) {
+        const int x0 = bx * BLOCK, y0 = by * BLOCK;
+        auto sad = [&](int dx, int dy) {
+            float s = 0.0f;
+            for (int y = y0; y < y0 + BLOCK; ++y) {
+                for (int x = x0; x < x0 + BLOCK; ++x) {
+                    s += std::fabs(at(b, x + dx, y + dy) - a[y * W + x]);
+                }
+            }
+            return s;
+        };
+        const float still = sad(0, 0);
+        float       best  = still;
+        bdx = bdy = 0;
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (dx == 0 && dy == 0) continue;
+                const float s = sad(dx, dy);
+                // Ties go to the shorter vector
+                if (s < best || (s == best && std::abs(dx) + std::abs(dy) < std::abs(bdx) + std::abs(bdy))) {
+                    best = s;
+                    bdx  = dx;
+                    bdy  = dy;
+                }
+            }
+        }
+        return still - best;
+    };
+
+    // Forward matches cover blocks an object leaves, backward matches the
+    // blocks it arrives in
+    std::array<MotionVector, BLOCKS_X * BLOCKS_Y> candidates {};
+    for (int by = 0; by < BLOCKS_Y; ++by) {
+        for (int bx = 0; bx < BLOCKS_X; ++bx) {
+            int fdx, fdy, bdx, bdy;
+            const float forward  = match(from, to, bx, by, fdx, fdy);
+            const float backward = match(to, from, bx, by, bdx, bdy);
+            MotionVector& v = candidates[by * BLOCKS_X + bx];
+            if (std::max(forward, backward) <= minGain) {
+                continue;
+            }
+            v = forward >= backward ? MotionVector{static_cast<int8_t>(fdx), static_cast<int8_t>(fdy)}
+                                    : MotionVector{static_cast<int8_t>(-bdx), static_cast<int8_t>(-bdy)};
+        }
+    }
+
+    // Neither is the motion *through* a block at mid-phase. Each block
+    // takes whichever neighbouring vector best explains it bilaterally:
+    // older frame half a vector behind, newer half a vector ahead.
+    for (int by = 0; by < BLOCKS_Y; ++by) {
+        for (int bx = 0; bx < BLOCKS_X; ++bx) {
+            const int x0 = bx * BLOCK, y0 = by * BLOCK;
+            auto cost = [&](MotionVector v) {
+                const Sampler back(-0.5f * v.dx, -0.5f * v.dy), ahead(0.5f * v.dx, 0.5f * v.dy);
+                float s = 0.0f;
+                for (int y = y0; y < y0 + BLOCK; ++y) {
+                    for (int x = x0; x < x0 + BLOCK; ++x) {
+                        s += std::fabs(back(from, x, y) - ahead(to, x, y));
+                    }
+                }
+                return s;
+            };
+
+            const float  still = cost(MotionVector{});
+            float        best  = still;
+            MotionVector pick {};
+            for (int ny = std::max(by - 1, 0); ny <= std::min(by + 1, BLOCKS_Y - 1); ++ny) {
+                for (int nx = std::max(bx - 1, 0); nx <= std::min(bx + 1, BLOCKS_X - 1); ++nx) {
+                    const MotionVector v = candidates[ny * BLOCKS_X + nx];
+                    if (v.dx == 0 && v.dy == 0) continue;
+                    const float s = cost(v);
+                    if (s < best) {
+                        best = s;
+                        pick = v;
+                    }
+                }
+            }
+            motion[by * BLOCKS_X + bx] = still - best > minGain ? pick : MotionVector{};
+        }
+    }
+}
+
+bool FrameInterpolator::render(int64_t nowNs, DisplayFrame& out) const
+{
+    FramePtr from, to;
+    std::array<MotionVector, BLOCKS_X * BLOCKS_Y> motion;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        from   = from_;
+        to     = to_;
+        motion = motion_;
+    }
+    if (!from || !to) {
+        return false;
+    }
+
+    // One input period of latency: nowNs == to->timestampNs shows `from`
+    const int64_t period = to->timestampNs - from->timestampNs;
+    float a = 1.0f;
+    if (period > 0 && period <= opt_.maxGapNs) {
+        a = static_cast<float>(static_cast<double>(nowNs - to->timestampNs) / static_cast<double>(period));
+        a = std::min(std::max(a, 0.0f), 1.0f);
+    }
+
+    out.timestampNs  = nowNs;
+    out.fromSequence = from->sequence;
+    out.toSequence   = to->sequence;
+    out.phase        = a;
+
+    const float* p = from->temperatures.data();
+    const float* c = to->temperatures.data();
+    float*       o = out.values.data();
+
+    if (a == 0.0f || a == 1.0f) {
+        const auto& src = a == 0.0f ? from->temperatures : to->temperatures;
+        std::copy(src.begin(), src.end(), out.values.begin());
+        return true;
+    }
+
+    const float b = 1.0f - a;
+    if (opt_.mode == InterpolationMode::Linear) {
+        for (int i = 0; i < Geometry::PIXELS; ++i) {
+            o[i] = b * p[i] + a * c[i];
+        }
+        return true;
+    }
+
+    for (int by = 0; by < BLOCKS_Y; ++by) {
+        for (int bx = 0; bx < BLOCKS_X; ++bx) {
+            const MotionVector v = motion[by * BLOCKS_X + bx];
+            const int x0 = bx * BLOCK, y0 = by * BLOCK;
+            if (v.dx == 0 && v.dy == 0) {
+                for (int y = y0; y < y0 + BLOCK; ++y) {
+                    for (int x = x0; x < x0 + BLOCK; ++x) {
+                        o[y * W + x] = b * p[y * W + x] + a * c[y * W + x];
+                    }
+                }
+                continue;
+            }
+            const Sampler back(-a * v.dx, -a * v.dy);
+            const Sampler ahead(b * v.dx, b * v.dy);
+            for (int y = y0; y < y0 + BLOCK; ++y) {
+                for (int x = x0; x < x0 + BLOCK; ++x) {
+                    o[y * W + x] = b * back(p, x, y) + a * ahead(c, x, y);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+ProcessingGraph::StageFn FrameInterpolator::stage()
+{
+    return [this](const FramePtr& frame) -> FramePtr {
+        push(frame);
+        return nullptr;
+    };
+}
+
+std::array<MotionVector, FrameInterpolator::BLOCKS_X * FrameInterpolator::BLOCKS_Y>
+FrameInterpolator::motion() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return motion_;
+}
+
+} // namespace duosight
@@ -0,0 +1,192 @@
+/**
+ * @file frameStacker.cpp
+ * @brief Accumulation and sigma-clipping passes of FrameStacker.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Values are accumulated as offsets from the first frame so the
+ *   single-pass variance (E[d^2] - E[d]^2) does not cancel catastrophically
+ *   at room temperature. Clipping passes rescan the stored frames with a
+ *   branch-free keep mask and stop early once no pixel changes its set.
+ */
+
+#include "frameStacker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace duosight {
+
+namespace {
+
+/// sum += x - ref, sumSq += (x - ref)^2 over one frame, in double.
+void accumulate(const float* x, const float* ref, double* sum, double* sumSq)
+{
+    int p = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for (; p + 4 <= Geometry::PIXELS; p += 4) {
+        const float32x4_t d  = vsubq_f32(vld1q_f32(x + p), vld1q_f32(ref + p));
+        const float64x2_t lo = vcvt_f64_f32(vget_low_f32(d));
+        const float64x2_t hi = vcvt_high_f64_f32(d);
+        vst1q_f64(sum + p,       vaddq_f64(vld1q_f64(sum + p), lo));
+        vst1q_f64(sum + p + 2,   vaddq_f64(vld1q_f64(sum + p + 2), hi));
+        vst1q_f64(sumSq + p,     vfmaq_f64(vld1q_f64(sumSq + p), lo, lo));
+        vst1q_f64(sumSq + p + 2, vfmaq_f64(vld1q_f64(sumSq + p + 2), hi, hi));
+    }
+#endif
+    for (; p < Geometry::PIXELS; ++p) {
+        const double d = static_cast<double>(x[p] - ref[p]);
+        sum[p]   += d;
+        sumSq[p] += d * d;
+    }
+}
+
+} // namespace
+
+FrameStacker::FrameStacker(const StackOptions& options)
+    : opt_(options)
+{
+    opt_.frames = std::max<size_t>(opt_.frames, 2);
+    opt_.frames = std::min<size_t>(opt_.frames, UINT16_MAX);
+}
+
+bool FrameStacker::arm(DoneFn done, int64_t fromNs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (armed_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    done_   = std::move(done);
+    count_  = 0;
+    fromNs_ = fromNs;
+    frames_.resize(opt_.frames * Geometry::PIXELS);
+    sum_.fill(0.0);
+    sumSq_.fill(0.0);
+    armed_.store(true, std::memory_order_release);
+    return true;
+}
+
+StackPtr FrameStacker::add(const ThermalFrame& frame)
+{
+    if (!armed()) {
+        return nullptr;
+    }
+
+    StackPtr result;
+    DoneFn   done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!armed_.load(std::memory_order_relaxed) || frame.timestampNs < fromNs_) {
+            return nullptr;   // finished meanwhile, or acquired before arm()
+        }
+        const float* x = frame.temperatures.data();
+        if (count_ == 0) {
+            std::copy(x, x + Geometry::PIXELS, ref_.begin());
+            firstSequence_ = frame.sequence;
+        }
+        std::copy(x, x + Geometry::PIXELS, frames_.begin() + count_ * Geometry::PIXELS);
+        accumulate(x, ref_.data(), sum_.data(), sumSq_.data());
+
+        if (++count_ < opt_.frames) {
+            return nullptr;
+        }
+
+        auto out = finish();
+        out->firstSequence = firstSequence_;
+        out->lastSequence  = frame.sequence;
+        out->timestampNs   = frame.timestampNs;
+        result = out;
+        done   = std::move(done_);
+        done_  = nullptr;
+        armed_.store(false, std::memory_order_release);
+    }
+    if (done) {
+        done(result);
+    }
+    return result;
+}
+
+std::shared_ptr<StackedFrame> FrameStacker::finish()
+{
+    auto out = std::make_shared<StackedFrame>();
+    const size_t n = count_;
+    out->frames = static_cast<uint32_t>(n);
+
+    // Offsets from ref_ throughout; the mean is shifted back at the end.
+    std::array<double, Geometry::PIXELS> mean, var;
+    std::array<uint32_t, Geometry::PIXELS> kept;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        mean[p] = sum_[p] / n;
+        var[p]  = std::max(sumSq_[p] / n - mean[p] * mean[p], 0.0);
+        kept[p] = static_cast<uint32_t>(n);
+    }
+
+    std::array<float, Geometry::PIXELS> lo, hi;
+    std::array<double, Geometry::PIXELS> s, ss;
+    std::array<uint32_t, Geometry::PIXELS> c;
+    for (int pass = 0; pass < opt_.clipPasses; ++pass) {
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            const double band = opt_.clipSigma * std::max(std::sqrt(var[p]),
+                                                          static_cast<double>(opt_.minSigma));
+            lo[p] = static_cast<float>(ref_[p] + mean[p] - band);
+            hi[p] = static_cast<float>(ref_[p] + mean[p] + band);
+        }
+        s.fill(0.0);
+        ss.fill(0.0);
+        c.fill(0);
+
+        for (size_t f = 0; f < n; ++f) {
+            const float* x = frames_.data() + f * Geometry::PIXELS;
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                const bool   keep = x[p] >= lo[p] && x[p] <= hi[p];
+                const double d    = keep ? static_cast<double>(x[p] - ref_[p]) : 0.0;
+                s[p]  += d;
+                ss[p] += d * d;
+                c[p]  += keep;
+            }
+        }
+
+        bool changed = false;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            if (c[p] == 0) continue;          // everything clipped: keep last estimate
+            changed |= c[p] != kept[p];
+            kept[p] = c[p];
+            mean[p] = s[p] / c[p];
+            var[p]  = std::max(ss[p] / c[p] - mean[p] * mean[p], 0.0);
+        }
+        if (!changed) break;
+    }
+
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        out->mean[p]     = static_cast<float>(ref_[p] + mean[p]);
+        out->variance[p] = kept[p] > 1 ? static_cast<float>(var[p] * kept[p] / (kept[p] - 1)) : 0.0f;
+        out->used[p]     = static_cast<uint16_t>(kept[p]);
+        out->rejected   += n - kept[p];
+    }
+    return out;
+}
+
+ProcessingGraph::StageFn FrameStacker::stage()
+{
+    return [this](const FramePtr& frame) -> FramePtr {
+        const StackPtr stacked = add(*frame);
+        if (!stacked) {
+            return nullptr;
+        }
+        auto out = std::make_shared<ThermalFrame>();
+        out->sequence     = stacked->lastSequence;
+        out->timestampNs  = stacked->timestampNs;
+        out->changedTiles = ~0u;
+        out->temperatures = stacked->mean;
+        return out;
+    };
+}
+
+} // namespace duosight
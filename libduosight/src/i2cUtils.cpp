@@ -54,6 +54,11 @@ I2cDevice::I2cDevice(const std::string& devicePath, uint8_t address)
     }
 }
 
+I2cDevice::I2cDevice(uint8_t address)
+    : fd_(-1), addr_(address)
+{
+}
+
 I2cDevice::~I2cDevice() {
     if (fd_ >= 0) {
         close(fd_);
@@ -96,6 +101,24 @@ bool I2cDevice::writeThenRead(const uint8_t* txData, size_t txLen, uint8_t* rxDa
     return ioctl(fd_, I2C_RDWR, &packets) >= 0;
 }
 
+bool I2cDevice::transfer(I2cMessage* messages, size_t count) {
+    if (fd_ < 0 || count == 0 || count > MAX_MESSAGES) return false;
+
+    struct i2c_msg msgs[MAX_MESSAGES];
+    for (size_t i = 0; i < count; ++i) {
+        msgs[i].addr  = addr_;
+        msgs[i].flags = messages[i].read ? I2C_M_RD : 0;
+        msgs[i].len   = static_cast<uint16_t>(messages[i].length);
+        msgs[i].buf   = messages[i].data;
+    }
+
+    struct i2c_rdwr_ioctl_data packets;
+    packets.msgs  = msgs;
+    packets.nmsgs = static_cast<uint32_t>(count);
+
+    return ioctl(fd_, I2C_RDWR, &packets) >= 0;
+}
+
 bool I2cDevice::readRegister16(uint16_t reg, uint16_t& value) {
     uint8_t tx[2] = { static_cast<uint8_t>(reg >> 8), static_cast<uint8_t>(reg & 0xFF) };
     uint8_t rx[2] = { 0 };
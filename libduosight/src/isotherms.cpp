@@ -0,0 +1,363 @@
+/**
+ * @file isotherms.cpp
+ * @brief Implementation of marching-squares isotherm extraction.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Crossings are identified by the grid edge they lie on. Horizontal
+ *   edges (between (x, y) and (x + 1, y)) are numbered first, row by row,
+ *   then vertical ones. Joining links the two crossings of every cell
+ *   segment. It walks open chains from border crossings (one link) before
+ *   closed loops (two links), so the order of lines depends only on the
+ *   classes, and a cached level joins the same way a fresh one would.
+ */
+
+#include "isotherms.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace duosight {
+
+namespace {
+
+constexpr int W = Geometry::WIDTH;
+
+constexpr uint8_t TL = 1, TR = 2, BR = 4, BL = 8;
+constexpr uint8_t WIRE_VERSION = 1;
+constexpr float   WIRE_SCALE   = 64.0f;   // 1/64 pixel
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t b = *p++;
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v)   { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t  unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+template <typename T>
+void putRaw(std::vector<uint8_t>& out, T v)
+{
+    uint8_t b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));   // native order; every target is little-endian
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+template <typename T>
+bool getRaw(const uint8_t*& p, const uint8_t* end, T& v)
+{
+    if (end - p < static_cast<std::ptrdiff_t>(sizeof(T))) {
+        return false;
+    }
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+IsothermExtractor::IsothermExtractor(const IsothermOptions& options)
+    : opt_(options)
+{
+    if (opt_.levels.size() > 255) {
+        std::cerr << "[Isotherms] " << opt_.levels.size() << " levels; keeping the first 255\n";
+        opt_.levels.resize(255);
+    }
+    for (float c : opt_.levels) {
+        Level l;
+        l.c = c;
+        levels_.push_back(std::move(l));
+    }
+    links_.resize(EDGES);
+    degree_.resize(EDGES);
+    visited_.resize(EDGES);
+}
+
+uint8_t IsothermExtractor::classify(const Level& level, int cx, int cy) const
+{
+    const float* r = &ref_[cy * W + cx];
+    return static_cast<uint8_t>((r[0] >= level.c ? TL : 0) | (r[1] >= level.c ? TR : 0)
+                              | (r[W + 1] >= level.c ? BR : 0) | (r[W] >= level.c ? BL : 0));
+}
+
+IsoPoint IsothermExtractor::crossing(int edge, float c) const
+{
+    if (edge < H_EDGES) {
+        const int y = edge / CELLS_X, x = edge % CELLS_X;
+        const float a = ref_[y * W + x], b = ref_[y * W + x + 1];
+        return {x + (c - a) / (b - a), static_cast<float>(y)};
+    }
+    const int e = edge - H_EDGES;
+    const int y = e / W, x = e % W;
+    const float a = ref_[y * W + x], b = ref_[(y + 1) * W + x];
+    return {static_cast<float>(x), y + (c - a) / (b - a)};
+}
+
+void IsothermExtractor::join(Level& level)
+{
+    std::fill(degree_.begin(), degree_.end(), 0);
+    auto link = [&](int a, int b) {
+        links_[a][degree_[a]++] = static_cast<uint16_t>(b);
+        links_[b][degree_[b]++] = static_cast<uint16_t>(a);
+    };
+
+    for (int cy = 0; cy < CELLS_Y; ++cy) {
+        for (int cx = 0; cx < CELLS_X; ++cx) {
+            const uint8_t k = level.cls[cy * CELLS_X + cx];
+            if (k == 0 || k == 15) {
+                continue;
+            }
+            const int top    = cy * CELLS_X + cx;
+            const int bottom = top + CELLS_X;
+            const int left   = H_EDGES + cy * W + cx;
+            const int right  = left + 1;
+
+            if (k == (TL | BR) || k == (TR | BL)) {
+                // Saddle: cut off the corners on the other side of the centre
+                const float* r = &ref_[cy * W + cx];
+                const bool centre = (r[0] + r[1] + r[W] + r[W + 1]) * 0.25f >= level.c;
+                if (bool(k & TL) != centre) link(left, top);
+                if (bool(k & TR) != centre) link(top, right);
+                if (bool(k & BR) != centre) link(right, bottom);
+                if (bool(k & BL) != centre) link(bottom, left);
+                continue;
+            }
+
+            int ends[2], n = 0;
+            if (bool(k & TL) != bool(k & TR)) ends[n++] = top;
+            if (bool(k & TR) != bool(k & BR)) ends[n++] = right;
+            if (bool(k & BR) != bool(k & BL)) ends[n++] = bottom;
+            if (bool(k & BL) != bool(k & TL)) ends[n++] = left;
+            link(ends[0], ends[1]);
+        }
+    }
+
+    level.chains.clear();
+    level.closed.clear();
+    std::fill(visited_.begin(), visited_.end(), 0);
+    auto walk = [&](int start) {
+        std::vector<uint16_t> chain {static_cast<uint16_t>(start)};
+        visited_[start] = 1;
+        for (int cur = start;;) {
+            int next = -1;
+            for (int i = 0; i < degree_[cur]; ++i) {
+                if (!visited_[links_[cur][i]]) {
+                    next = links_[cur][i];
+                    break;
+                }
+            }
+            if (next < 0) {
+                break;
+            }
+            chain.push_back(static_cast<uint16_t>(next));
+            visited_[next] = 1;
+            cur = next;
+        }
+        level.closed.push_back(degree_[start] == 2);
+        level.chains.push_back(std::move(chain));
+    };
+    for (int e = 0; e < EDGES; ++e) {
+        if (degree_[e] == 1 && !visited_[e]) walk(e);
+    }
+    for (int e = 0; e < EDGES; ++e) {
+        if (degree_[e] == 2 && !visited_[e]) walk(e);
+    }
+}
+
+void IsothermExtractor::place(Level& level) const
+{
+    level.points.clear();
+    for (const auto& chain : level.chains) {
+        for (uint16_t e : chain) level.points.push_back(crossing(e, level.c));
+    }
+}
+
+IsothermPtr IsothermExtractor::update(const float* temperatures, uint64_t sequence, int64_t timestampNs)
+{
+    ++stats_.frames;
+
+    // Pixels that moved beyond the tolerance, and the cells they touch
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (haveRef_ && std::fabs(temperatures[p] - ref_[p]) <= opt_.tolerance) {
+            continue;
+        }
+        ref_[p] = temperatures[p];
+        const int x = p % W, y = p / W;
+        for (int cy = std::max(y - 1, 0); cy <= std::min(y, CELLS_Y - 1); ++cy) {
+            for (int cx = std::max(x - 1, 0); cx <= std::min(x, CELLS_X - 1); ++cx) {
+                dirty_[cy * CELLS_X + cx] = 1;
+            }
+        }
+    }
+    haveRef_ = true;
+
+    for (Level& level : levels_) {
+        bool reclassed = !level.valid, moved = false;
+        for (int i = 0; i < CELLS; ++i) {
+            if (level.valid && !dirty_[i]) {
+                ++stats_.cellsReused;
+                continue;
+            }
+            ++stats_.cellsClassified;
+            const uint8_t k   = classify(level, i % CELLS_X, i / CELLS_X);
+            const uint8_t old = level.cls[i];
+            reclassed |= k != old;
+            moved     |= (k != 0 && k != 15) || (old != 0 && old != 15);
+            level.cls[i] = k;
+        }
+        if (reclassed) {
+            join(level);
+            place(level);
+            ++stats_.levelsJoined;
+        } else if (moved) {
+            place(level);
+        } else {
+            ++stats_.levelsReused;
+        }
+        level.valid = true;
+    }
+
+    auto set = std::make_shared<IsothermSet>();
+    set->sequence    = sequence;
+    set->timestampNs = timestampNs;
+    for (size_t li = 0; li < levels_.size(); ++li) {
+        const Level& level = levels_[li];
+        set->levels.push_back(level.c);
+        uint32_t offset = static_cast<uint32_t>(set->points.size());
+        for (size_t c = 0; c < level.chains.size(); ++c) {
+            Isoline line;
+            line.level  = static_cast<uint8_t>(li);
+            line.closed = level.closed[c];
+            line.first  = offset;
+            line.count  = static_cast<uint32_t>(level.chains[c].size());
+            offset += line.count;
+            set->lines.push_back(line);
+        }
+        set->points.insert(set->points.end(), level.points.begin(), level.points.end());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_ = set;
+    return set;
+}
+
+ProcessingGraph::StageFn IsothermExtractor::stage()
+{
+    return [this](const FramePtr& frame) -> FramePtr {
+        update(frame->temperatures.data(), frame->sequence, frame->timestampNs);
+        return nullptr;
+    };
+}
+
+IsothermPtr IsothermExtractor::latest() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+std::vector<uint8_t> IsothermExtractor::encode(const IsothermSet& set)
+{
+    std::vector<uint8_t> out;
+    out.reserve(24 + set.levels.size() * 2 + set.lines.size() * 4 + set.points.size() * 2);
+    out.push_back('I');
+    out.push_back('S');
+    out.push_back(WIRE_VERSION);
+    putRaw(out, set.sequence);
+    putRaw(out, set.timestampNs);
+    out.push_back(static_cast<uint8_t>(set.levels.size()));
+    for (float c : set.levels) {
+        putRaw(out, static_cast<int16_t>(std::lround(std::clamp(c, -327.0f, 327.0f) * 100.0f)));
+    }
+    putVarint(out, set.lines.size());
+    for (const Isoline& line : set.lines) {
+        out.push_back(line.level);
+        out.push_back(line.closed ? 1 : 0);
+        putVarint(out, line.count);
+        int64_t px = 0, py = 0;
+        for (uint32_t i = 0; i < line.count; ++i) {
+            const IsoPoint& p = set.points[line.first + i];
+            const int64_t qx = std::lround(p.x * WIRE_SCALE), qy = std::lround(p.y * WIRE_SCALE);
+            if (i == 0) {
+                putVarint(out, static_cast<uint64_t>(qx));
+                putVarint(out, static_cast<uint64_t>(qy));
+            } else {
+                putVarint(out, zigzag(qx - px));
+                putVarint(out, zigzag(qy - py));
+            }
+            px = qx;
+            py = qy;
+        }
+    }
+    return out;
+}
+
+bool IsothermExtractor::decode(const uint8_t* data, size_t size, IsothermSet& out)
+{
+    const uint8_t* p   = data;
+    const uint8_t* end = data + size;
+    out = IsothermSet {};
+    if (size < 3 || p[0] != 'I' || p[1] != 'S' || p[2] != WIRE_VERSION) {
+        return false;
+    }
+    p += 3;
+    uint8_t nLevels = 0;
+    if (!getRaw(p, end, out.sequence) || !getRaw(p, end, out.timestampNs) || !getRaw(p, end, nLevels)) {
+        return false;
+    }
+    for (int i = 0; i < nLevels; ++i) {
+        int16_t cc = 0;
+        if (!getRaw(p, end, cc)) return false;
+        out.levels.push_back(cc / 100.0f);
+    }
+    uint64_t nLines = 0;
+    if (!getVarint(p, end, nLines) || nLines > size) {
+        return false;
+    }
+    for (uint64_t l = 0; l < nLines; ++l) {
+        Isoline line;
+        uint8_t closed = 0;
+        uint64_t count = 0;
+        if (!getRaw(p, end, line.level) || !getRaw(p, end, closed) || !getVarint(p, end, count)
+            || line.level >= nLevels || count > size) {
+            return false;
+        }
+        line.closed = closed != 0;
+        line.first  = static_cast<uint32_t>(out.points.size());
+        line.count  = static_cast<uint32_t>(count);
+        int64_t qx = 0, qy = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t a = 0, b = 0;
+            if (!getVarint(p, end, a) || !getVarint(p, end, b)) return false;
+            qx = i == 0 ? static_cast<int64_t>(a) : qx + unzigzag(a);
+            qy = i == 0 ? static_cast<int64_t>(b) : qy + unzigzag(b);
+            out.points.push_back({qx / WIRE_SCALE, qy / WIRE_SCALE});
+        }
+        out.lines.push_back(line);
+    }
+    return p == end;
+}
+
+} // namespace duosight
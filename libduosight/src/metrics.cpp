@@ -0,0 +1,218 @@
+/**
+ * @file metrics.cpp
+ * @brief Instrument updates and Prometheus text rendering.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Histograms store non-cumulative bucket counts so observe() touches one
+ *   bucket; render() accumulates them into the cumulative `le` series the
+ *   format expects. A scrape can see a count that is one observation
+ *   ahead of its buckets; Prometheus tolerates that.
+ */
+
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace duosight {
+
+namespace {
+
+uint64_t toBits(double v)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits)
+{
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void writeValue(std::ostringstream& os, double v)
+{
+    if (std::isnan(v))      os << "NaN";
+    else if (std::isinf(v)) os << (v > 0 ? "+Inf" : "-Inf");
+    else                    os << v;
+}
+
+std::string withLabels(const std::string& labels, const std::string& extra = "")
+{
+    if (labels.empty() && extra.empty()) return "";
+    if (labels.empty())                  return "{" + extra + "}";
+    if (extra.empty())                   return "{" + labels + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+} // namespace
+
+// ────────────────────────────────────────────────────────────────
+//  Instruments
+// ────────────────────────────────────────────────────────────────
+
+void Gauge::set(double v) noexcept
+{
+    bits_.store(toBits(v), std::memory_order_relaxed);
+}
+
+void Gauge::add(double v) noexcept
+{
+    uint64_t old = bits_.load(std::memory_order_relaxed);
+    while (!bits_.compare_exchange_weak(old, toBits(fromBits(old) + v),
+                                        std::memory_order_relaxed)) {
+    }
+}
+
+double Gauge::value() const noexcept
+{
+    return fromBits(bits_.load(std::memory_order_relaxed));
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds))
+    , buckets_(std::make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1))
+{
+    std::sort(bounds_.begin(), bounds_.end());
+}
+
+void Histogram::observe(double v) noexcept
+{
+    // Bounds are few (≈10), a linear scan beats a binary search here.
+    size_t i = 0;
+    while (i < bounds_.size() && v > bounds_[i]) {
+        ++i;
+    }
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+    sum_.add(v);
+    count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<double> Histogram::exponential(double start, double factor, size_t n)
+{
+    std::vector<double> b(n);
+    for (size_t i = 0; i < n; ++i) {
+        b[i] = start;
+        start *= factor;
+    }
+    return b;
+}
+
+// ────────────────────────────────────────────────────────────────
+//  Registry
+// ────────────────────────────────────────────────────────────────
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string& name, const std::string& help,
+                                                 Type type, const std::string& labels)
+{
+    auto fam = std::find_if(families_.begin(), families_.end(),
+                            [&](const Family& f) { return f.name == name; });
+    if (fam == families_.end()) {
+        families_.push_back({name, help, type, {}});
+        fam = std::prev(families_.end());
+    } else if (fam->type != type) {
+        std::cerr << "[Metrics] " << name << " re-registered with another type\n";
+    }
+
+    for (Series& s : fam->series) {
+        if (s.labels == labels) return s;
+    }
+    fam->series.push_back({});
+    fam->series.back().labels = labels;
+    return fam->series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Counter, labels);
+    if (!s.counter) s.counter = std::make_unique<Counter>();
+    return *s.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Gauge, labels);
+    if (!s.gauge) s.gauge = std::make_unique<Gauge>();
+    return *s.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      std::vector<double> bounds, const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Histogram, labels);
+    if (!s.histogram) s.histogram = std::make_unique<Histogram>(std::move(bounds));
+    return *s.histogram;
+}
+
+void MetricsRegistry::callbackGauge(const std::string& name, const std::string& help,
+                                    std::function<double()> fn, const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    series(name, help, Type::Gauge, labels).callback = std::move(fn);
+}
+
+void MetricsRegistry::callbackCounter(const std::string& name, const std::string& help,
+                                      std::function<double()> fn, const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    series(name, help, Type::Counter, labels).callback = std::move(fn);
+}
+
+std::string MetricsRegistry::render() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream os;
+    os.precision(10);
+
+    for (const Family& f : families_) {
+        static const char* TYPES[] = {"counter", "gauge", "histogram"};
+        os << "# HELP " << f.name << ' ' << f.help << '\n'
+           << "# TYPE " << f.name << ' ' << TYPES[static_cast<int>(f.type)] << '\n';
+
+        for (const Series& s : f.series) {
+            if (s.histogram) {
+                const Histogram& h = *s.histogram;
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i <= h.bounds().size(); ++i) {
+                    cumulative += h.bucket(i);
+                    std::ostringstream le;
+                    le.precision(10);
+                    le << "le=\"";
+                    if (i < h.bounds().size()) le << h.bounds()[i];
+                    else                       le << "+Inf";
+                    le << '"';
+                    os << f.name << "_bucket" << withLabels(s.labels, le.str())
+                       << ' ' << cumulative << '\n';
+                }
+                os << f.name << "_sum" << withLabels(s.labels) << ' ';
+                writeValue(os, h.sum());
+                os << '\n' << f.name << "_count" << withLabels(s.labels)
+                   << ' ' << cumulative << '\n';
+            } else {
+                os << f.name << withLabels(s.labels) << ' ';
+                if (s.counter)       os << s.counter->value();
+                else if (s.gauge)    writeValue(os, s.gauge->value());
+                else if (s.callback) writeValue(os, s.callback());
+                else                 os << 0;
+                os << '\n';
+            }
+        }
+    }
+    return os.str();
+}
+
+} // namespace duosight
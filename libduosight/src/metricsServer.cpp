@@ -0,0 +1,229 @@
+/**
+ * @file metricsServer.cpp
+ * @brief poll()-based single-thread HTTP server for /metrics.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   All sockets are non-blocking. A connection reads until the end of the
+ *   request header, gets its whole response rendered into a buffer, and is
+ *   closed once the buffer is sent. Idle or oversized requests are dropped
+ *   so a misbehaving client cannot pin connection slots.
+ */
+
+#include "metricsServer.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace duosight {
+
+namespace {
+
+constexpr size_t MAX_CONNECTIONS  = 32;
+constexpr size_t MAX_REQUEST      = 8192;
+constexpr int    IDLE_TIMEOUT_MS  = 5000;
+constexpr int    POLL_INTERVAL_MS = 1000;
+
+struct Connection {
+    int         fd {-1};
+    std::string request;
+    std::string response;
+    size_t      sent {0};
+    int64_t     lastActiveMs {0};
+};
+
+int64_t nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string httpResponse(const char* status, const std::string& contentType,
+                         const std::string& body)
+{
+    std::string r = "HTTP/1.1 ";
+    r += status;
+    r += "\r\nContent-Type: " + contentType;
+    r += "\r\nContent-Length: " + std::to_string(body.size());
+    r += "\r\nConnection: close\r\n\r\n";
+    r += body;
+    return r;
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry, uint16_t port,
+                             const std::string& bindAddress)
+    : registry_(registry)
+{
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        std::cerr << "[Metrics] socket failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+    const int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "[Metrics] bad bind address " << bindAddress << "\n";
+        close(listenFd_);
+        listenFd_ = -1;
+        return;
+    }
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || listen(listenFd_, 16) != 0) {
+        std::cerr << "[Metrics] cannot listen on " << bindAddress << ":" << port
+                  << ": " << std::strerror(errno) << "\n";
+        close(listenFd_);
+        listenFd_ = -1;
+        return;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        std::cerr << "[Metrics] eventfd failed: " << std::strerror(errno) << "\n";
+        close(listenFd_);
+        listenFd_ = -1;
+        return;
+    }
+
+    thread_ = std::thread(&MetricsServer::run, this);
+    std::clog << "[Metrics] serving http://" << bindAddress << ":" << port_ << "/metrics\n";
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+void MetricsServer::stop()
+{
+    if (thread_.joinable()) {
+        const uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+        thread_.join();
+    }
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+    }
+    if (wakeFd_ >= 0) {
+        close(wakeFd_);
+        wakeFd_ = -1;
+    }
+}
+
+void MetricsServer::run()
+{
+    std::vector<Connection> conns;
+    std::vector<pollfd>     fds;
+
+    for (;;) {
+        fds.clear();
+        fds.push_back({wakeFd_, POLLIN, 0});
+        fds.push_back({listenFd_, static_cast<short>(conns.size() < MAX_CONNECTIONS ? POLLIN : 0), 0});
+        for (const Connection& c : conns) {
+            fds.push_back({c.fd, static_cast<short>(c.response.empty() ? POLLIN : POLLOUT), 0});
+        }
+
+        if (poll(fds.data(), fds.size(), POLL_INTERVAL_MS) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Metrics] poll failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            break;
+        }
+
+        const int64_t now = nowMs();
+        for (size_t i = 0; i < conns.size(); ++i) {
+            Connection& c  = conns[i];
+            const short ev = fds[i + 2].revents;
+            bool done = false;
+
+            // Data first: a client may half-close right after its request.
+            if (ev & POLLIN) {
+                char buf[1024];
+                const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+                if (n <= 0) {
+                    done = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                } else {
+                    c.request.append(buf, static_cast<size_t>(n));
+                    c.lastActiveMs = now;
+                    if (c.request.find("\r\n\r\n") != std::string::npos
+                        || c.request.find("\n\n") != std::string::npos) {
+                        const bool isGet     = c.request.compare(0, 4, "GET ") == 0;
+                        const size_t pathEnd = c.request.find(' ', 4);
+                        const std::string path = isGet ? c.request.substr(4, pathEnd - 4) : "";
+                        if (!isGet) {
+                            c.response = httpResponse("405 Method Not Allowed", "text/plain", "GET only\n");
+                        } else if (path == "/metrics" || path.compare(0, 9, "/metrics?") == 0) {
+                            c.response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                                      registry_.render());
+                            scrapes_.fetch_add(1, std::memory_order_relaxed);
+                        } else {
+                            c.response = httpResponse("404 Not Found", "text/plain", "try /metrics\n");
+                        }
+                    } else if (c.request.size() > MAX_REQUEST) {
+                        done = true;
+                    }
+                }
+            } else if (ev & POLLOUT) {
+                const ssize_t n = send(c.fd, c.response.data() + c.sent,
+                                       c.response.size() - c.sent, MSG_NOSIGNAL);
+                if (n > 0) {
+                    c.sent        += static_cast<size_t>(n);
+                    c.lastActiveMs = now;
+                    done = c.sent == c.response.size();
+                } else {
+                    done = errno != EAGAIN && errno != EWOULDBLOCK;
+                }
+            } else if (ev & (POLLERR | POLLHUP | POLLNVAL)) {
+                done = true;
+            }
+
+            if (done || now - c.lastActiveMs > IDLE_TIMEOUT_MS) {
+                close(c.fd);
+                c.fd = -1;
+            }
+        }
+        conns.erase(std::remove_if(conns.begin(), conns.end(),
+                                   [](const Connection& c) { return c.fd < 0; }),
+                    conns.end());
+
+        if (fds[1].revents & POLLIN) {
+            while (conns.size() < MAX_CONNECTIONS) {
+                const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) break;
+                conns.push_back({fd, {}, {}, 0, now});
+            }
+        }
+    }
+
+    for (const Connection& c : conns) {
+        close(c.fd);
+    }
+}
+
+} // namespace duosight
@@ -0,0 +1,218 @@
+/**
+ * @file nucTable.cpp
+ * @brief Calibration cache file format.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Layout (native endianness, the file never leaves the device):
+ *     header  magic "DSCALIB", version, table count, CRC-32 of the rest
+ *     eeprom  832 words
+ *     tables  count x { ta, vdd, offset[768], gain[768] }
+ *   save() writes beside the final name, fsyncs the file, renames it into
+ *   place and fsyncs the directory, so once it returns true the new cache
+ *   survives a power cut. A cut before then leaves the old cache, or on
+ *   file systems that do not order the rename a torn one; load() catches
+ *   that with the CRC and the reader falls back to dumping the EEPROM.
+ */
+
+#include "nucTable.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace duosight {
+
+namespace {
+
+constexpr char     MAGIC[8]   = "DSCALIB";
+constexpr uint32_t VERSION    = 2;
+constexpr uint32_t MAX_TABLES = 64;
+
+struct Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t tables;
+    uint32_t crc;        ///< CRC-32 over everything after the header
+};
+
+constexpr size_t TABLE_BYTES = 2 * sizeof(float) + 2 * sizeof(NucTable::offset);
+
+uint32_t crc32(const char* data, size_t size)
+{
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+template <typename T>
+void append(std::vector<char>& out, const T* data, size_t bytes)
+{
+    const char* p = reinterpret_cast<const char*>(data);
+    out.insert(out.end(), p, p + bytes);
+}
+
+bool writeAll(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/// fsync the directory holding path so a rename into it is durable.
+bool syncDirectory(const std::string& path)
+{
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+bool CalibrationCache::load(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    const std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Header h{};
+    if (file.size() >= sizeof(h)) {
+        std::memcpy(&h, file.data(), sizeof(h));
+    }
+    if (file.size() < sizeof(h) || std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0
+        || h.version != VERSION || h.tables > MAX_TABLES) {
+        std::cerr << "[Calibration] " << path << " is not a calibration cache (or an old one)\n";
+        return false;
+    }
+    const size_t payload = sizeof(eeprom) + h.tables * TABLE_BYTES;
+    if (file.size() != sizeof(h) + payload) {
+        std::cerr << "[Calibration] " << path << " is truncated\n";
+        return false;
+    }
+    const char* p = file.data() + sizeof(h);
+    if (crc32(p, payload) != h.crc) {
+        std::cerr << "[Calibration] " << path << " fails its CRC\n";
+        return false;
+    }
+
+    auto take = [&p](void* dst, size_t bytes) {
+        std::memcpy(dst, p, bytes);
+        p += bytes;
+    };
+    std::array<uint16_t, Eeprom::WORDS> image{};
+    take(image.data(), sizeof(image));
+
+    std::vector<NucTable> tables(h.tables);
+    for (NucTable& t : tables) {
+        take(&t.ta, sizeof(t.ta));
+        take(&t.vdd, sizeof(t.vdd));
+        take(t.offset.data(), sizeof(t.offset));
+        take(t.gain.data(), sizeof(t.gain));
+    }
+
+    eeprom = image;
+    nuc    = std::move(tables);
+    return true;
+}
+
+bool CalibrationCache::save(const std::string& path) const
+{
+    Header h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.tables  = static_cast<uint32_t>(std::min<size_t>(nuc.size(), MAX_TABLES));
+
+    std::vector<char> file(sizeof(h));
+    file.reserve(sizeof(h) + sizeof(eeprom) + h.tables * TABLE_BYTES);
+    append(file, eeprom.data(), sizeof(eeprom));
+    for (uint32_t i = 0; i < h.tables; ++i) {
+        const NucTable& t = nuc[i];
+        append(file, &t.ta, sizeof(t.ta));
+        append(file, &t.vdd, sizeof(t.vdd));
+        append(file, t.offset.data(), sizeof(t.offset));
+        append(file, t.gain.data(), sizeof(t.gain));
+    }
+    h.crc = crc32(file.data() + sizeof(h), file.size() - sizeof(h));
+    std::memcpy(file.data(), &h, sizeof(h));
+
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[Calibration] failed to create " << tmp << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    const bool written = writeAll(fd, file.data(), file.size()) && ::fsync(fd) == 0;
+    const int  err     = errno;
+    if (::close(fd) != 0 || !written) {
+        std::cerr << "[Calibration] failed to write " << tmp << ": " << std::strerror(written ? errno : err)
+                  << "\n";
+        std::remove(tmp.c_str());
+        return false;
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "[Calibration] failed to replace " << path << "\n";
+        std::remove(tmp.c_str());
+        return false;
+    }
+    if (!syncDirectory(path)) {
+        std::cerr << "[Calibration] failed to sync the directory of " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool CalibrationCache::sameDevice(const uint16_t* id) const
+{
+    const int first = Eeprom::DEVICE_ID - Eeprom::BASE;
+    return std::equal(id, id + Eeprom::ID_WORDS, eeprom.begin() + first);
+}
+
+void CalibrationCache::addNuc(const NucTable& table, float tolerance)
+{
+    nuc.erase(std::remove_if(nuc.begin(), nuc.end(), [&](const NucTable& t) {
+                  return std::fabs(t.ta - table.ta) <= tolerance;
+              }), nuc.end());
+    nuc.push_back(table);
+    std::sort(nuc.begin(), nuc.end(), [](const NucTable& a, const NucTable& b) { return a.ta < b.ta; });
+}
+
+} // namespace duosight
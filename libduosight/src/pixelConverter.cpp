@@ -0,0 +1,560 @@
+/**
+ * @file pixelConverter.cpp
+ * @brief Implementation of per-pixel conversion and LazyFrame.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   The expressions below deliberately mirror MLX90640_CalculateTo from
+ *   the Melexis library (including its double-precision literals), so a
+ *   pixel converted here matches the library result bit for bit on the
+ *   same toolchain. Keep them in step if the submodule is updated.
+ *
+ *   CoefficientCache's four-lane path is the same arithmetic in single
+ *   precision. Its range selection (ct[1..3]) becomes three compares and
+ *   a chain of selects, so all lanes run the same instructions whatever
+ *   temperature they hold. Only the SIMD wrapper below differs per target.
+ */
+
+#include "pixelConverter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace duosight {
+
+namespace {
+constexpr uint16_t CTRL_MEAS_MODE_MASK = 0x1000;   // CTRL1 bit 12: chess pattern
+constexpr int      WORD_CTRL    = 832;
+constexpr int      WORD_SUBPAGE = 833;
+constexpr int      WORD_GAIN    = 778;
+constexpr int      WORD_CP_SP0  = 776;
+constexpr int      WORD_CP_SP1  = 808;
+
+// ── Four float lanes ──────────────────────────────────────────────────────
+#if defined(__ARM_NEON) && defined(__aarch64__)
+using V = float32x4_t;
+using M = uint32x4_t;
+inline V    vload(const float* p)    { return vld1q_f32(p); }
+inline void vstore(float* p, V v)    { vst1q_f32(p, v); }
+inline V    vsplat(float x)          { return vdupq_n_f32(x); }
+inline V    vadd(V a, V b)           { return vaddq_f32(a, b); }
+inline V    vsub(V a, V b)           { return vsubq_f32(a, b); }
+inline V    vmul(V a, V b)           { return vmulq_f32(a, b); }
+inline V    vdiv(V a, V b)           { return vdivq_f32(a, b); }
+inline V    vsqrt(V a)               { return vsqrtq_f32(a); }
+inline M    vless(V a, V b)          { return vcltq_f32(a, b); }
+inline V    vselect(M m, V a, V b)   { return vbslq_f32(m, a, b); }
+#elif defined(__SSE2__)
+using V = __m128;
+using M = __m128;
+inline V    vload(const float* p)    { return _mm_load_ps(p); }
+inline void vstore(float* p, V v)    { _mm_store_ps(p, v); }
+inline V    vsplat(float x)          { return _mm_set1_ps(x); }
+inline V    vadd(V a, V b)           { return _mm_add_ps(a, b); }
+inline V    vsub(V a, V b)           { return _mm_sub_ps(a, b); }
+inline V    vmul(V a, V b)           { return _mm_mul_ps(a, b); }
+inline V    vdiv(V a, V b)           { return _mm_div_ps(a, b); }
+inline V    vsqrt(V a)               { return _mm_sqrt_ps(a); }
+inline M    vless(V a, V b)          { return _mm_cmplt_ps(a, b); }
+inline V    vselect(M m, V a, V b)   { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+#else
+struct V { float v[4]; };
+struct M { bool  m[4]; };
+template <typename F>
+inline V    lanes(F f)               { V r; for (int i = 0; i < 4; ++i) r.v[i] = f(i); return r; }
+inline V    vload(const float* p)    { return lanes([&](int i) { return p[i]; }); }
+inline void vstore(float* p, V v)    { for (int i = 0; i < 4; ++i) p[i] = v.v[i]; }
+inline V    vsplat(float x)          { return lanes([&](int) { return x; }); }
+inline V    vadd(V a, V b)           { return lanes([&](int i) { return a.v[i] + b.v[i]; }); }
+inline V    vsub(V a, V b)           { return lanes([&](int i) { return a.v[i] - b.v[i]; }); }
+inline V    vmul(V a, V b)           { return lanes([&](int i) { return a.v[i] * b.v[i]; }); }
+inline V    vdiv(V a, V b)           { return lanes([&](int i) { return a.v[i] / b.v[i]; }); }
+inline V    vsqrt(V a)               { return lanes([&](int i) { return std::sqrt(a.v[i]); }); }
+inline M    vless(V a, V b)          { M r; for (int i = 0; i < 4; ++i) r.m[i] = a.v[i] < b.v[i]; return r; }
+inline V    vselect(M m, V a, V b)   { return lanes([&](int i) { return m.m[i] ? a.v[i] : b.v[i]; }); }
+#endif
+
+inline V root4(V a) { return vsqrt(vsqrt(a)); }
+} // namespace
+
+PixelConverter::PixelConverter(const paramsMLX90640& params)
+    : params_(params)
+{
+    const float ktaScale   = std::pow(2, static_cast<double>(params.ktaScale));
+    const float kvScale    = std::pow(2, static_cast<double>(params.kvScale));
+    const float alphaScale = std::pow(2, static_cast<double>(params.alphaScale));
+
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        const int8_t ilPattern         = p / 32 - (p / 64) * 2;
+        const int8_t chessPattern      = ilPattern ^ (p - (p / 2) * 2);
+        const int8_t conversionPattern = ((p + 2) / 4 - (p + 3) / 4 + (p + 1) / 4 - p / 4)
+                                       * (1 - 2 * ilPattern);
+
+        ilPattern_[p]    = static_cast<uint8_t>(ilPattern);
+        chessPattern_[p] = static_cast<uint8_t>(chessPattern);
+        factoryOffset_[p] = params.offset[p];
+        factoryKta_[p]    = params.kta[p] / ktaScale;
+        kv_[p]            = params.kv[p] / kvScale;
+        factoryAlpha_[p]  = SCALEALPHA * alphaScale / params.alpha[p];
+        ilCorr_[p]        = params.ilChessC[2] * (2 * ilPattern - 1)
+                          - params.ilChessC[1] * conversionPattern;
+    }
+    applyNuc({});
+}
+
+SubpageTerms PixelConverter::prepare(const uint16_t* words, float emissivity, float tr) const
+{
+    // The Melexis helpers take non-const pointers but never write.
+    auto* frame = const_cast<uint16_t*>(words);
+
+    SubpageTerms t;
+    t.subpage    = words[WORD_SUBPAGE] & 1;
+    t.vdd        = MLX90640_GetVdd(frame, &params_);
+    t.ta         = MLX90640_GetTa(frame, &params_);
+    t.emissivity = emissivity;
+    if (tr < -273.0f) {
+        tr = t.ta;
+    }
+
+    const uint8_t mode = (words[WORD_CTRL] & CTRL_MEAS_MODE_MASK) >> 5;
+    t.chessMode = mode != 0;
+    t.calibMode = mode == params_.calibrationModeEE;
+
+    float ta4 = (t.ta + 273.15);
+    ta4 = ta4 * ta4;
+    ta4 = ta4 * ta4;
+    float tr4 = (tr + 273.15);
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+    t.taTr = tr4 - (tr4 - ta4) / emissivity;
+
+    t.alphaCorrR[0] = 1 / (1 + params_.ksTo[0] * 40);
+    t.alphaCorrR[1] = 1;
+    t.alphaCorrR[2] = (1 + params_.ksTo[1] * params_.ct[2]);
+    t.alphaCorrR[3] = t.alphaCorrR[2] * (1 + params_.ksTo[2] * (params_.ct[3] - params_.ct[2]));
+
+    t.gain = static_cast<float>(params_.gainEE) / static_cast<int16_t>(words[WORD_GAIN]);
+
+    const float ta  = t.ta;
+    const float vdd = t.vdd;
+    if (t.subpage == 0) {
+        t.irDataCP = static_cast<float>(static_cast<int16_t>(words[WORD_CP_SP0])) * t.gain;
+        t.irDataCP = t.irDataCP - params_.cpOffset[0] * (1 + params_.cpKta * (ta - 25))
+                                                      * (1 + params_.cpKv * (vdd - 3.3));
+    } else {
+        t.irDataCP = static_cast<float>(static_cast<int16_t>(words[WORD_CP_SP1])) * t.gain;
+        if (t.calibMode) {
+            t.irDataCP = t.irDataCP - params_.cpOffset[1] * (1 + params_.cpKta * (ta - 25))
+                                                          * (1 + params_.cpKv * (vdd - 3.3));
+        } else {
+            t.irDataCP = t.irDataCP - (params_.cpOffset[1] + params_.ilChessC[0])
+                                      * (1 + params_.cpKta * (ta - 25))
+                                      * (1 + params_.cpKv * (vdd - 3.3));
+        }
+    }
+    return t;
+}
+
+float PixelConverter::toTemperature(const uint16_t* words, const SubpageTerms& t, int p) const
+{
+    const float ta  = t.ta;
+    const float vdd = t.vdd;
+
+    float irData = static_cast<float>(static_cast<int16_t>(words[p])) * t.gain;
+    irData = irData - offset_[p] * (1 + kta_[p] * (ta - 25)) * (1 + kv_[p] * (vdd - 3.3));
+    if (!t.calibMode) {
+        irData = irData + ilCorr_[p];
+    }
+    irData = irData - params_.tgc * t.irDataCP;
+    irData = irData / t.emissivity;
+
+    float alphaCompensated = alpha_[p];
+    alphaCompensated = alphaCompensated * (1 + params_.KsTa * (ta - 25));
+
+    return radiometric(irData, alphaCompensated,
+                       alphaCompensated * alphaCompensated * alphaCompensated,
+                       alphaCompensated * (1 - params_.ksTo[1] * 273.15), t);
+}
+
+float PixelConverter::radiometric(float irData, float ac, float ac3, double acK,
+                                  const SubpageTerms& t) const
+{
+    float Sx = ac3 * (irData + ac * t.taTr);
+    // sqrt() on doubles, as the C library does after argument promotion
+    Sx = std::sqrt(std::sqrt(static_cast<double>(Sx))) * params_.ksTo[1];
+
+    float To = std::sqrt(std::sqrt(irData / (acK + Sx) + t.taTr)) - 273.15;
+
+    int range = 3;
+    if (To < params_.ct[1])      range = 0;
+    else if (To < params_.ct[2]) range = 1;
+    else if (To < params_.ct[3]) range = 2;
+
+    To = std::sqrt(std::sqrt(static_cast<double>(
+             irData / (ac * t.alphaCorrR[range]
+                       * (1 + params_.ksTo[range] * (To - params_.ct[range]))) + t.taTr))) - 273.15;
+    return To;
+}
+
+void PixelConverter::convertSubpage(const uint16_t* words, const SubpageTerms& t, float* result) const
+{
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (inSubpage(p, t)) {
+            result[p] = toTemperature(words, t, p);
+        }
+    }
+}
+
+double PixelConverter::signalFor(const SubpageTerms& t, float tempC, float alpha) const
+{
+    // Invert the final (range-corrected) stage of toTemperature(); its
+    // first-pass estimate only selects the range, which is resolved here
+    // from the target temperature itself.
+    int range = 3;
+    if (tempC < params_.ct[1])      range = 0;
+    else if (tempC < params_.ct[2]) range = 1;
+    else if (tempC < params_.ct[3]) range = 2;
+
+    const double alphaCompensated = alpha * (1 + params_.KsTa * (t.ta - 25));
+    double k4 = tempC + 273.15;
+    k4 = k4 * k4;
+    k4 = k4 * k4;
+
+    const double irData = (k4 - t.taTr) * alphaCompensated * t.alphaCorrR[range]
+                        * (1 + params_.ksTo[range] * (tempC - params_.ct[range]));
+    return irData * t.emissivity;
+}
+
+double PixelConverter::offsetFor(int p, const SubpageTerms& t, float offset, float kta) const
+{
+    double term = offset * (1 + kta * (t.ta - 25)) * (1 + kv_[p] * (t.vdd - 3.3));
+    if (!t.calibMode) {
+        term -= ilCorr_[p];
+    }
+    return term;
+}
+
+float PixelConverter::signalBound(int p, const SubpageTerms& t, float tempC) const
+{
+    return static_cast<float>(signalFor(t, tempC, alpha_[p]) + offsetFor(p, t, offset_[p], kta_[p]));
+}
+
+double PixelConverter::factorySignal(int p, const SubpageTerms& t, float measuredC) const
+{
+    // What the pixel actually read (raw * gain - tgc * CP), then the
+    // factory offset removed: the signal the EEPROM calibration sees.
+    const double raw = signalFor(t, measuredC, alpha_[p]) + offsetFor(p, t, offset_[p], kta_[p]);
+    return raw - offsetFor(p, t, factoryOffset_[p], factoryKta_[p]);
+}
+
+void PixelConverter::applyNuc(const std::vector<NucTable>& tables)
+{
+    offset_ = factoryOffset_;
+    kta_    = factoryKta_;
+    alpha_  = factoryAlpha_;
+    nucGain_.fill(1.0f);
+    if (tables.empty()) {
+        return;
+    }
+
+    // Offsets were measured at each table's Vdd; the conversion scales the
+    // offset term by (1 + Kv (Vdd - 3.3)), so store them divided by it.
+    double taMean = 0.0;
+    for (const NucTable& t : tables) taMean += t.ta;
+    taMean /= tables.size();
+    double taVar = 0.0;
+    for (const NucTable& t : tables) taVar += (t.ta - taMean) * (t.ta - taMean);
+    const bool fitTa = taVar / tables.size() >= 0.25;   // spread ≥ 0.5 °C
+
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        double dMean = 0.0, gMean = 0.0, cov = 0.0;
+        for (const NucTable& t : tables) {
+            dMean += t.offset[p] / (1 + kv_[p] * (t.vdd - 3.3));
+            gMean += t.gain[p];
+        }
+        dMean /= tables.size();
+        gMean /= tables.size();
+        if (fitTa) {
+            for (const NucTable& t : tables) {
+                cov += (t.ta - taMean) * (t.offset[p] / (1 + kv_[p] * (t.vdd - 3.3)) - dMean);
+            }
+        }
+
+        // offset(Ta) = a + b (Ta - 25), merged into offset * (1 + Kta (Ta - 25))
+        const double b = fitTa ? cov / taVar : 0.0;
+        const double a = dMean - b * (taMean - 25.0);
+        const double o = factoryOffset_[p] + a;
+        offset_[p] = static_cast<float>(o);
+        if (std::fabs(o) > 1e-3) {
+            kta_[p] = static_cast<float>((factoryOffset_[p] * factoryKta_[p] + b) / o);
+        }
+
+        // A responsivity error scales irData; dividing it out is the same
+        // as scaling alpha, in both conversion passes.
+        nucGain_[p] = static_cast<float>(gMean);
+        alpha_[p]   = static_cast<float>(factoryAlpha_[p] * gMean);
+    }
+}
+
+NucTable PixelConverter::measureNuc(const SubpageTerms& t, const float* measured, float referenceC) const
+{
+    NucTable nuc;
+    nuc.ta  = t.ta;
+    nuc.vdd = t.vdd;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        const double g = nucGain_[p];
+        nuc.offset[p] = static_cast<float>(factorySignal(p, t, measured[p])
+                                           - g * signalFor(t, referenceC, factoryAlpha_[p]));
+        nuc.gain[p]   = static_cast<float>(g);
+    }
+    return nuc;
+}
+
+NucTable PixelConverter::measureNuc(const SubpageTerms& t, const float* cold, float coldC,
+                                    const float* hot, float hotC) const
+{
+    NucTable nuc;
+    nuc.ta  = t.ta;
+    nuc.vdd = t.vdd;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        const double x1 = factorySignal(p, t, cold[p]);
+        const double x2 = factorySignal(p, t, hot[p]);
+        const double s1 = signalFor(t, coldC, factoryAlpha_[p]);
+        const double s2 = signalFor(t, hotC, factoryAlpha_[p]);
+        const double g  = std::fabs(s2 - s1) > 1e-6 ? (x2 - x1) / (s2 - s1) : 1.0;
+        nuc.offset[p] = static_cast<float>(x1 - g * s1);
+        nuc.gain[p]   = static_cast<float>(g);
+    }
+    return nuc;
+}
+
+// ────────────────────────────────────────────────────────────────
+//  CoefficientCache
+// ────────────────────────────────────────────────────────────────
+
+CoefficientCache::CoefficientCache(const PixelConverter& converter,
+                                   const CoefficientCacheOptions& options)
+    : conv_(converter), opt_(options)
+{
+    for (int chess = 0; chess < 2; ++chess) {
+        for (int sp = 0; sp < 2; ++sp) {
+            SubpageTerms t;
+            t.chessMode = chess != 0;
+            t.subpage   = sp;
+            Block& b = blocks_[chess * 2 + sp];
+            int    i = 0;
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                if (conv_.inSubpage(p, t)) b.pixel[i++] = static_cast<uint16_t>(p);
+            }
+        }
+    }
+}
+
+SubpageTerms CoefficientCache::prepare(const uint16_t* words, float emissivity, float tr)
+{
+    const SubpageTerms t = conv_.prepare(words, emissivity, tr);
+    ++stats_.subpages;
+    if (!valid_ || std::fabs(t.ta - ta_) > opt_.taEpsilon || std::fabs(t.vdd - vdd_) > opt_.vddEpsilon) {
+        refresh(t.ta, t.vdd);
+    }
+    return t;
+}
+
+void CoefficientCache::refresh(float ta, float vdd)
+{
+    // Same expressions as PixelConverter::toTemperature(), evaluated once
+    const paramsMLX90640& pr = conv_.params_;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        offsetTerm_[p] = conv_.offset_[p] * (1 + conv_.kta_[p] * (ta - 25)) * (1 + conv_.kv_[p] * (vdd - 3.3));
+        float ac = conv_.alpha_[p];
+        ac = ac * (1 + pr.KsTa * (ta - 25));
+        ac_[p]  = ac;
+        ac3_[p] = ac * ac * ac;
+        acK_[p] = ac * (1 - pr.ksTo[1] * 273.15);
+    }
+    if (opt_.vectorised) {
+        for (Block& b : blocks_) {
+            for (int i = 0; i < LANES; ++i) {
+                const int p = b.pixel[i];
+                b.offsetTerm[i] = static_cast<float>(offsetTerm_[p]);
+                b.ilCorr[i]     = conv_.ilCorr_[p];
+                b.ac[i]         = ac_[p];
+                b.ac3[i]        = ac3_[p];
+                b.acK[i]        = static_cast<float>(acK_[p]);
+            }
+        }
+    }
+    ta_    = ta;
+    vdd_   = vdd;
+    valid_ = true;
+    ++stats_.refreshes;
+}
+
+float CoefficientCache::toTemperature(const uint16_t* words, const SubpageTerms& t, int p) const
+{
+    float irData = static_cast<float>(static_cast<int16_t>(words[p])) * t.gain;
+    irData = irData - offsetTerm_[p];
+    if (!t.calibMode) {
+        irData = irData + conv_.ilCorr_[p];
+    }
+    irData = irData - conv_.params_.tgc * t.irDataCP;
+    irData = irData / t.emissivity;
+    return conv_.radiometric(irData, ac_[p], ac3_[p], acK_[p], t);
+}
+
+void CoefficientCache::convertSubpage(const uint16_t* words, const SubpageTerms& t, float* result) const
+{
+    if (opt_.vectorised) {
+        convertLanes(words, t, result);
+        return;
+    }
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (conv_.inSubpage(p, t)) {
+            result[p] = toTemperature(words, t, p);
+        }
+    }
+}
+
+void CoefficientCache::convertLanes(const uint16_t* words, const SubpageTerms& t, float* result) const
+{
+    const paramsMLX90640& pr = conv_.params_;
+    const Block&          b  = blocks_[(t.chessMode ? 2 : 0) + t.subpage];
+
+    alignas(16) float raw[LANES];
+    alignas(16) float to[LANES];
+    for (int i = 0; i < LANES; ++i) {
+        raw[i] = static_cast<float>(static_cast<int16_t>(words[b.pixel[i]]));
+    }
+
+    const V gain   = vsplat(t.gain);
+    const V one    = vsplat(1.0f);
+    const V cpTerm = vsplat(pr.tgc * t.irDataCP);
+    const V emiss  = vsplat(t.emissivity);
+    const V taTr   = vsplat(t.taTr);
+    const V ksTo1  = vsplat(pr.ksTo[1]);
+    const V kelvin = vsplat(273.15f);
+    const V ct1 = vsplat(pr.ct[1]), ct2 = vsplat(pr.ct[2]), ct3 = vsplat(pr.ct[3]);
+    V acr[4], ks[4], ct[4];
+    for (int r = 0; r < 4; ++r) {
+        acr[r] = vsplat(t.alphaCorrR[r]);
+        ks[r]  = vsplat(pr.ksTo[r]);
+        ct[r]  = vsplat(pr.ct[r]);
+    }
+    const bool ilCorrect = !t.calibMode;
+
+    for (int i = 0; i < LANES; i += 4) {
+        V ir = vsub(vmul(vload(raw + i), gain), vload(&b.offsetTerm[i]));
+        if (ilCorrect) {
+            ir = vadd(ir, vload(&b.ilCorr[i]));
+        }
+        ir = vdiv(vsub(ir, cpTerm), emiss);
+
+        const V ac = vload(&b.ac[i]);
+        V sx = vmul(vload(&b.ac3[i]), vadd(ir, vmul(ac, taTr)));
+        sx = vmul(root4(sx), ksTo1);
+        V To = vsub(root4(vadd(vdiv(ir, vadd(vload(&b.acK[i]), sx)), taTr)), kelvin);
+
+        // range 3 unless below ct[3], 2 unless below ct[2], ...
+        const M b1 = vless(To, ct1), b2 = vless(To, ct2), b3 = vless(To, ct3);
+        const V rAcr = vselect(b1, acr[0], vselect(b2, acr[1], vselect(b3, acr[2], acr[3])));
+        const V rKs  = vselect(b1, ks[0],  vselect(b2, ks[1],  vselect(b3, ks[2],  ks[3])));
+        const V rCt  = vselect(b1, ct[0],  vselect(b2, ct[1],  vselect(b3, ct[2],  ct[3])));
+
+        To = vsub(root4(vadd(vdiv(ir, vmul(vmul(ac, rAcr), vadd(one, vmul(rKs, vsub(To, rCt))))), taTr)), kelvin);
+        vstore(to + i, To);
+    }
+    for (int i = 0; i < LANES; ++i) {
+        result[b.pixel[i]] = to[i];
+    }
+}
+
+// ────────────────────────────────────────────────────────────────
+//  LazyFrame
+// ────────────────────────────────────────────────────────────────
+
+LazyFrame::LazyFrame(const PixelConverter& converter)
+    : conv_(converter)
+{
+}
+
+void LazyFrame::update(const uint16_t* words, float emissivity, float tr)
+{
+    const int sp = words[Geometry::WORDS - 1] & 1;
+    std::copy(words, words + Geometry::WORDS, raw_[sp].begin());
+    terms_[sp] = conv_.prepare(raw_[sp].data(), emissivity, tr);
+    have_[sp]  = true;
+
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (conv_.inSubpage(p, terms_[sp])) {
+            valid_.reset(p);
+        }
+    }
+}
+
+float LazyFrame::pixel(int index)
+{
+    if (valid_.test(index)) {
+        return cache_[index];
+    }
+
+    // The pixel belongs to whichever subpage measures it in this pattern.
+    const int sp = conv_.inSubpage(index, terms_[0]) ? 0 : 1;
+    if (!have_[sp]) {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+
+    cache_[index] = conv_.toTemperature(raw_[sp].data(), terms_[sp], index);
+    valid_.set(index);
+    ++conversions_;
+    return cache_[index];
+}
+
+RoiStats LazyFrame::roi(const Roi& r)
+{
+    RoiStats s;
+    s.min = std::numeric_limits<float>::max();
+    s.max = std::numeric_limits<float>::lowest();
+
+    const int x0 = std::clamp(r.x, 0, static_cast<int>(Geometry::WIDTH));
+    const int y0 = std::clamp(r.y, 0, static_cast<int>(Geometry::HEIGHT));
+    const int x1 = std::clamp(r.x + r.w, x0, static_cast<int>(Geometry::WIDTH));
+    const int y1 = std::clamp(r.y + r.h, y0, static_cast<int>(Geometry::HEIGHT));
+
+    double sum = 0.0;
+    int    n   = 0;
+    for (int row = y0; row < y1; ++row) {
+        for (int col = x0; col < x1; ++col) {
+            const int   i = row * Geometry::WIDTH + col;
+            const float v = pixel(i);
+            sum += v;
+            ++n;
+            s.min = std::min(s.min, v);
+            if (v > s.max) {
+                s.max     = v;
+                s.hottest = i;
+            }
+        }
+    }
+    s.mean = n ? static_cast<float>(sum / n) : 0.0f;
+    return s;
+}
+
+const float* LazyFrame::full()
+{
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        pixel(p);
+    }
+    return cache_.data();
+}
+
+} // namespace duosight
@@ -0,0 +1,283 @@
+/**
+ * @file processingGraph.cpp
+ * @brief Implementation of the declarative processing graph.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Scheduling uses one "scheduled" flag per node: whoever enqueues onto
+ *   an idle node submits a single task for it, and that task keeps
+ *   draining the node's input edges before releasing the flag.
+ */
+
+#include "processingGraph.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace duosight {
+
+namespace {
+
+// Frames processed per task before yielding the worker to other nodes.
+constexpr int BATCH_PER_TASK = 4;
+
+std::string trim(const std::string& s)
+{
+    const auto b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return {};
+    const auto e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+/// Copy of kept that also reports the tiles changed on dropped.
+FramePtr carryChanges(const ThermalFrame& dropped, const ThermalFrame& kept)
+{
+    auto merged = std::make_shared<ThermalFrame>(kept);
+    merged->changedTiles |= dropped.changedTiles;
+    merged->changeScore   = std::max(merged->changeScore, dropped.changeScore);
+    return merged;
+}
+
+} // namespace
+
+const char* toString(NodeKind kind)
+{
+    switch (kind) {
+    case NodeKind::Source:     return "source";
+    case NodeKind::Conversion: return "conversion";
+    case NodeKind::Filter:     return "filter";
+    case NodeKind::Detector:   return "detector";
+    case NodeKind::Sink:       return "sink";
+    }
+    return "?";
+}
+
+ProcessingGraph::ProcessingGraph(WorkStealingPool& pool)
+    : pool_(pool)
+{
+}
+
+ProcessingGraph::~ProcessingGraph()
+{
+    // Outstanding tasks reference our nodes; let them finish first.
+    drain();
+}
+
+ProcessingGraph::Node* ProcessingGraph::find(const std::string& name) const
+{
+    auto it = nodes_.find(name);
+    return it == nodes_.end() ? nullptr : it->second.get();
+}
+
+bool ProcessingGraph::addSource(const std::string& name)
+{
+    return addNode(name, NodeKind::Source, nullptr);
+}
+
+bool ProcessingGraph::addNode(const std::string& name, NodeKind kind, StageFn fn)
+{
+    if (name.empty() || find(name)) {
+        std::cerr << "[Graph] Duplicate or empty node name '" << name << "'\n";
+        return false;
+    }
+    if (kind != NodeKind::Source && !fn) {
+        std::cerr << "[Graph] Node '" << name << "' has no stage function\n";
+        return false;
+    }
+
+    auto node  = std::make_unique<Node>();
+    node->name = name;
+    node->kind = kind;
+    node->fn   = std::move(fn);
+    order_.push_back(node.get());
+    nodes_.emplace(name, std::move(node));
+    return true;
+}
+
+bool ProcessingGraph::connect(const std::string& from, const std::string& to, size_t capacity)
+{
+    Node* src = find(from);
+    Node* dst = find(to);
+    if (!src || !dst) {
+        std::cerr << "[Graph] connect: unknown node '" << (src ? to : from) << "'\n";
+        return false;
+    }
+    if (dst->kind == NodeKind::Source) {
+        std::cerr << "[Graph] connect: source '" << to << "' cannot have inputs\n";
+        return false;
+    }
+
+    auto edge      = std::make_unique<Edge>();
+    edge->to       = dst;
+    edge->capacity = std::max<size_t>(1, capacity);
+    src->outputs.push_back(edge.get());
+    dst->inputs.push_back(edge.get());
+    edges_.push_back(std::move(edge));
+    return true;
+}
+
+bool ProcessingGraph::configure(const std::string& spec)
+{
+    std::string flat = spec;
+    std::replace(flat.begin(), flat.end(), ';', '\n');
+
+    std::istringstream lines(flat);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        std::string prev;
+        size_t pos = 0;
+        while (pos <= line.size()) {
+            const size_t arrow = line.find("->", pos);
+            std::string tok = trim(line.substr(pos, arrow == std::string::npos
+                                                   ? std::string::npos : arrow - pos));
+            pos = (arrow == std::string::npos) ? line.size() + 1 : arrow + 2;
+
+            size_t capacity = DEFAULT_EDGE_CAPACITY;
+            if (const auto lb = tok.find('['); lb != std::string::npos) {
+                capacity = std::strtoul(tok.c_str() + lb + 1, nullptr, 10);
+                tok = trim(tok.substr(0, lb));
+            }
+            if (!find(tok)) {
+                std::cerr << "[Graph] configure: unknown node '" << tok << "'\n";
+                return false;
+            }
+            if (!prev.empty() && !connect(prev, tok, capacity)) {
+                return false;
+            }
+            prev = tok;
+        }
+    }
+    return true;
+}
+
+bool ProcessingGraph::push(const std::string& source, FramePtr frame)
+{
+    Node* node = find(source);
+    if (!node || node->kind != NodeKind::Source || !frame) {
+        return false;
+    }
+    node->processed.fetch_add(1, std::memory_order_relaxed);
+    forward(*node, frame);
+    return true;
+}
+
+void ProcessingGraph::forward(Node& from, const FramePtr& frame)
+{
+    for (Edge* edge : from.outputs) {
+        Node&    to = *edge->to;
+        FramePtr in = frame;
+        {
+            std::lock_guard<std::mutex> lock(to.mutex);
+            if (edge->queue.size() >= edge->capacity) {
+                const FramePtr dropped = std::move(edge->queue.front());
+                edge->queue.pop_front();           // keep the freshest frames
+                to.dropped.fetch_add(1, std::memory_order_relaxed);
+                // The consumer never sees the dropped frame, so the frame
+                // now next in line must report its changed tiles too
+                FramePtr& next = edge->queue.empty() ? in : edge->queue.front();
+                if (dropped->changedTiles & ~next->changedTiles) {
+                    next = carryChanges(*dropped, *next);
+                }
+            }
+            edge->queue.push_back(std::move(in));
+        }
+        schedule(to);
+    }
+}
+
+void ProcessingGraph::schedule(Node& node)
+{
+    bool expected = false;
+    if (node.scheduled.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        pool_.submit([this, &node] { runNode(node); });
+    }
+}
+
+bool ProcessingGraph::popInput(Node& node, FramePtr& out)
+{
+    std::lock_guard<std::mutex> lock(node.mutex);
+    const size_t n = node.inputs.size();
+    for (size_t k = 0; k < n; ++k) {
+        Edge* edge = node.inputs[(node.nextInput + k) % n];
+        if (!edge->queue.empty()) {
+            out = std::move(edge->queue.front());
+            edge->queue.pop_front();
+            node.nextInput = (node.nextInput + k + 1) % n;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProcessingGraph::runNode(Node& node)
+{
+    for (int i = 0; i < BATCH_PER_TASK; ++i) {
+        FramePtr in;
+        if (!popInput(node, in)) {
+            node.scheduled.store(false, std::memory_order_release);
+            // A producer may have enqueued between the failed pop and the
+            // flag release; if so, reclaim the node rather than strand it.
+            bool pending = false;
+            {
+                std::lock_guard<std::mutex> lock(node.mutex);
+                for (const Edge* e : node.inputs) pending |= !e->queue.empty();
+            }
+            if (pending) schedule(node);
+            return;
+        }
+
+        const int64_t t0  = monotonicNowNs();
+        FramePtr      out = node.fn(in);
+        const auto    dt  = static_cast<uint64_t>(monotonicNowNs() - t0);
+
+        node.processed.fetch_add(1, std::memory_order_relaxed);
+        node.totalNs.fetch_add(dt, std::memory_order_relaxed);
+        uint64_t prevMax = node.maxNs.load(std::memory_order_relaxed);
+        while (dt > prevMax &&
+               !node.maxNs.compare_exchange_weak(prevMax, dt, std::memory_order_relaxed)) {
+        }
+
+        if (out) forward(node, out);
+    }
+
+    // Batch exhausted: requeue behind other nodes instead of hogging a core.
+    pool_.submit([this, &node] { runNode(node); });
+}
+
+void ProcessingGraph::drain()
+{
+    pool_.waitIdle();
+}
+
+std::vector<NodeStats> ProcessingGraph::stats() const
+{
+    std::vector<NodeStats> out;
+    out.reserve(order_.size());
+    for (const Node* node : order_) {
+        NodeStats s;
+        s.name      = node->name;
+        s.kind      = node->kind;
+        s.processed = node->processed.load(std::memory_order_relaxed);
+        s.dropped   = node->dropped.load(std::memory_order_relaxed);
+        if (node->kind != NodeKind::Source && s.processed > 0) {
+            s.meanUs = node->totalNs.load(std::memory_order_relaxed) / 1e3 / s.processed;
+        }
+        s.maxUs = node->maxNs.load(std::memory_order_relaxed) / 1e3;
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            for (const Edge* e : node->inputs) s.queueDepth += e->queue.size();
+        }
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+} // namespace duosight
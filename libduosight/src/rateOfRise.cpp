@@ -0,0 +1,280 @@
+/**
+ * @file rateOfRise.cpp
+ * @brief Implementation of the sliding-window per-pixel slope map.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   With n samples at times t <= 0, the least-squares slope is
+ *
+ *       (n sum(t y) - sum(t) sum(y)) / (n sum(t^2) - sum(t)^2)
+ *
+ *   The denominator is shared by all pixels. Moving the origin forward by
+ *   dt turns each t into t - dt: sum(t y) loses dt sum(y), sum(t) loses
+ *   n dt, and sum(t^2) changes by n dt^2 - 2 dt sum(t). The shared sums
+ *   are kept in double; only the per-pixel ones are float. The slope does
+ *   not change when a constant is subtracted from y, so each pixel's sums
+ *   are of y - anchor, with the anchor moved to the newest sample at every
+ *   resync.
+ */
+
+#include "rateOfRise.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace duosight {
+
+namespace {
+
+constexpr int W = Geometry::WIDTH, H = Geometry::HEIGHT;
+
+// ── Four float lanes ──────────────────────────────────────────────────────
+#if defined(__ARM_NEON) && defined(__aarch64__)
+using V = float32x4_t;
+inline V    vload(const float* p)    { return vld1q_f32(p); }
+inline void vstore(float* p, V v)    { vst1q_f32(p, v); }
+inline V    vsplat(float x)          { return vdupq_n_f32(x); }
+inline V    vadd(V a, V b)           { return vaddq_f32(a, b); }
+inline V    vsub(V a, V b)           { return vsubq_f32(a, b); }
+inline V    vmul(V a, V b)           { return vmulq_f32(a, b); }
+#elif defined(__SSE2__)
+using V = __m128;
+inline V    vload(const float* p)    { return _mm_loadu_ps(p); }
+inline void vstore(float* p, V v)    { _mm_storeu_ps(p, v); }
+inline V    vsplat(float x)          { return _mm_set1_ps(x); }
+inline V    vadd(V a, V b)           { return _mm_add_ps(a, b); }
+inline V    vsub(V a, V b)           { return _mm_sub_ps(a, b); }
+inline V    vmul(V a, V b)           { return _mm_mul_ps(a, b); }
+#else
+struct V { float v[4]; };
+template <typename F>
+inline V    lanes(F f)               { V r; for (int i = 0; i < 4; ++i) r.v[i] = f(i); return r; }
+inline V    vload(const float* p)    { return lanes([&](int i) { return p[i]; }); }
+inline void vstore(float* p, V v)    { for (int i = 0; i < 4; ++i) p[i] = v.v[i]; }
+inline V    vsplat(float x)          { return lanes([&](int) { return x; }); }
+inline V    vadd(V a, V b)           { return lanes([&](int i) { return a.v[i] + b.v[i]; }); }
+inline V    vsub(V a, V b)           { return lanes([&](int i) { return a.v[i] - b.v[i]; }); }
+inline V    vmul(V a, V b)           { return lanes([&](int i) { return a.v[i] * b.v[i]; }); }
+#endif
+
+static_assert(Geometry::PIXELS % 4 == 0, "whole vectors");
+
+} // namespace
+
+RateOfRise::RateOfRise(const RiseOptions& options)
+    : opt_(options), history_(std::max<size_t>(options.window, 2))
+{
+    opt_.window     = std::max<size_t>(opt_.window, 2);
+    opt_.minSamples = std::clamp<size_t>(opt_.minSamples, 2, opt_.window);
+}
+
+void RateOfRise::reset()
+{
+    count_ = 0;
+    sumY_.fill(0.0f);
+    sumTY_.fill(0.0f);
+    sumT_  = 0.0;
+    sumTT_ = 0.0;
+    sinceResync_ = 0;
+}
+
+void RateOfRise::resync()
+{
+    FrameWindow w;
+    history_.window(count_, w);
+    const float* newest = w.frame(count_ - 1);
+    std::copy(newest, newest + Geometry::PIXELS, anchor_.begin());
+
+    std::array<double, Geometry::PIXELS> y {}, ty {};
+    sumT_  = 0.0;
+    sumTT_ = 0.0;
+    for (size_t i = 0; i < count_; ++i) {
+        const double t = (w.timestampNs(i) - originNs_) / 1e9;
+        const float* s = w.frame(i);
+        sumT_  += t;
+        sumTT_ += t * t;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            const double v = s[p] - anchor_[p];
+            y[p]  += v;
+            ty[p] += t * v;
+        }
+    }
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        sumY_[p]  = static_cast<float>(y[p]);
+        sumTY_[p] = static_cast<float>(ty[p]);
+    }
+    sinceResync_ = 0;
+    ++resyncs_;
+}
+
+RisePtr RateOfRise::update(const float* temperatures, int64_t timestampNs, uint64_t sequence)
+{
+    if (!history_.isValid()) {
+        return nullptr;   // FrameHistory has logged why
+    }
+    if (count_ && timestampNs <= originNs_) {
+        reset();   // clock went backwards: start a new fit
+    }
+    if (!count_) {
+        std::copy(temperatures, temperatures + Geometry::PIXELS, anchor_.begin());
+    }
+
+    // Move the origin to this frame
+    const double dt = count_ ? (timestampNs - originNs_) / 1e9 : 0.0;
+    sumTT_ += count_ * dt * dt - 2.0 * dt * sumT_;
+    sumT_  -= count_ * dt;
+    originNs_ = timestampNs;
+
+    // The oldest sample leaves once the window is full. The history keeps
+    // a spare slot for the new one, so the oldest is still readable.
+    FrameWindow  w;
+    const bool   full   = count_ == opt_.window && history_.window(count_, w);
+    const float* oldest = full ? w.frame(0) : nullptr;
+    const double tOld   = full ? (w.timestampNs(0) - timestampNs) / 1e9 : 0.0;
+    float*       sample = history_.beginWrite();
+    if (full) {
+        sumT_  -= tOld;
+        sumTT_ -= tOld * tOld;
+    } else {
+        ++count_;
+    }
+
+    const V vdt  = vsplat(static_cast<float>(dt));
+    const V vold = vsplat(static_cast<float>(tOld));
+    for (int p = 0; p < Geometry::PIXELS; p += 4) {
+        const V raw = vload(temperatures + p);
+        const V ref = vload(&anchor_[p]);
+        const V y   = vsub(raw, ref);
+        const V old = full ? vsub(vload(oldest + p), ref) : vsplat(0.0f);
+        const V sy  = vload(&sumY_[p]);
+        vstore(&sumTY_[p], vsub(vsub(vload(&sumTY_[p]), vmul(vdt, sy)), vmul(vold, old)));
+        vstore(&sumY_[p], vadd(vsub(sy, old), y));
+        vstore(sample + p, raw);
+    }
+    history_.commitWrite(sequence, timestampNs);
+
+    if (++sinceResync_ >= opt_.window) {
+        resync();
+    }
+
+    auto map = std::make_shared<RiseMap>();
+    map->sequence    = sequence;
+    map->timestampNs = timestampNs;
+    map->samples     = static_cast<uint32_t>(count_);
+    const double n   = static_cast<double>(count_);
+    const double den = n * sumTT_ - sumT_ * sumT_;
+    map->valid = count_ >= opt_.minSamples && den > 0.0;
+    if (map->valid) {
+        const V a = vsplat(static_cast<float>(60.0 * n / den));
+        const V b = vsplat(static_cast<float>(60.0 * sumT_ / den));
+        for (int p = 0; p < Geometry::PIXELS; p += 4) {
+            vstore(&map->cPerMin[p], vsub(vmul(a, vload(&sumTY_[p])), vmul(b, vload(&sumY_[p]))));
+        }
+        rank(*map);
+    } else {
+        map->roiCPerMin.assign(opt_.rois.size(), 0.0f);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_ = map;
+    return map;
+}
+
+void RateOfRise::rank(RiseMap& map)
+{
+    const auto& rate = map.cPerMin;
+
+    // Fastest pixels
+    const size_t k = std::min<size_t>(opt_.topK, Geometry::PIXELS);
+    for (int p = 0; p < Geometry::PIXELS; ++p) order_[p] = p;
+    auto faster = [&](int a, int b) { return rate[a] > rate[b] || (rate[a] == rate[b] && a < b); };
+    std::nth_element(order_.begin(), order_.begin() + k, order_.end(), faster);
+    std::sort(order_.begin(), order_.begin() + k, faster);
+    for (size_t i = 0; i < k && rate[order_[i]] > 0.0f; ++i) {
+        map.fastest.push_back({order_[i], rate[order_[i]]});
+    }
+
+    // Rising regions: 4-connected pixels above the region threshold
+    label_.fill(-1);
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (label_[p] >= 0 || !(rate[p] >= opt_.regionCPerMin)) {
+            continue;
+        }
+        RiseRegion r;
+        int x0 = W, y0 = H, x1 = -1, y1 = -1;
+        double sum = 0.0;
+        int top = 0;
+        stack_[top++] = p;
+        label_[p] = static_cast<int>(map.regions.size());
+        while (top) {
+            const int q = stack_[--top];
+            const int x = q % W, y = q / W;
+            x0 = std::min(x0, x);
+            x1 = std::max(x1, x);
+            y0 = std::min(y0, y);
+            y1 = std::max(y1, y);
+            sum += rate[q];
+            ++r.pixels;
+            if (rate[q] > r.peakCPerMin || r.peakPixel < 0) {
+                r.peakCPerMin = rate[q];
+                r.peakPixel   = q;
+            }
+            const int next[4] = {x > 0 ? q - 1 : -1, x < W - 1 ? q + 1 : -1,
+                                 y > 0 ? q - W : -1, y < H - 1 ? q + W : -1};
+            for (int nq : next) {
+                if (nq >= 0 && label_[nq] < 0 && rate[nq] >= opt_.regionCPerMin) {
+                    label_[nq] = label_[p];
+                    stack_[top++] = nq;
+                }
+            }
+        }
+        r.box         = {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+        r.meanCPerMin = static_cast<float>(sum / r.pixels);
+        map.regions.push_back(r);
+    }
+    std::sort(map.regions.begin(), map.regions.end(),
+              [](const RiseRegion& a, const RiseRegion& b) { return a.peakCPerMin > b.peakCPerMin; });
+    if (map.regions.size() > opt_.topK) {
+        map.regions.resize(opt_.topK);
+    }
+
+    // Configured ROIs
+    for (const Roi& roi : opt_.rois) {
+        const int rx0 = std::clamp(roi.x, 0, W), ry0 = std::clamp(roi.y, 0, H);
+        const int rx1 = std::clamp(roi.x + roi.w, rx0, W), ry1 = std::clamp(roi.y + roi.h, ry0, H);
+        double sum = 0.0;
+        for (int y = ry0; y < ry1; ++y) {
+            for (int x = rx0; x < rx1; ++x) sum += rate[y * W + x];
+        }
+        const int n = (rx1 - rx0) * (ry1 - ry0);
+        map.roiCPerMin.push_back(n ? static_cast<float>(sum / n) : 0.0f);
+    }
+}
+
+ProcessingGraph::StageFn RateOfRise::stage(MapFn onMap)
+{
+    return [this, onMap](const FramePtr& frame) -> FramePtr {
+        const RisePtr map = update(frame->temperatures.data(), frame->timestampNs, frame->sequence);
+        if (onMap && map) {
+            onMap(map);
+        }
+        return nullptr;
+    };
+}
+
+RisePtr RateOfRise::latest() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+} // namespace duosight
@@ -0,0 +1,716 @@
+/**
+ * @file recordingWriter.cpp
+ * @brief io_uring and thread-pool write paths for RecordingWriter.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A block moves from free to filling (producer), then to queued, and
+ *   then to in flight (writer side). When its write completes it is free
+ *   again. Only the hand-overs take mutex_, and no system call is made
+ *   while it is held, so the producer waits at most for another thread's
+ *   few list operations.
+ *
+ *   The ring thread keeps a POLL_ADD on the eventfd armed at all times,
+ *   and sleeps in io_uring_enter() until any completion arrives. That is
+ *   either a finished write or a wake-up from append() or close(). The
+ *   kernel must support IORING_OP_WRITE (5.6); this is probed at set-up.
+ *
+ *   EAGAIN or EBUSY from io_uring_enter() means nothing was submitted:
+ *   the thread reaps what has completed and submits again. Any other
+ *   error retires the ring. Until a write's completion has been reaped
+ *   the kernel may still read its block, so each outstanding write is
+ *   cancelled and its completion awaited first. Only then is a cancelled
+ *   block queued again, for `threads` pwrite() workers. A block whose
+ *   completion never arrives is copied into a fresh buffer and the old
+ *   one is left to the kernel, never freed or refilled.
+ */
+
+#include "recordingWriter.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "metrics.hpp"
+
+// Older kernel headers lack io_uring; only the Threads backend is built then.
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define DUOSIGHT_IO_URING 1
+#endif
+
+namespace duosight {
+
+namespace {
+
+constexpr size_t   ALIGN    = 4096;            // O_DIRECT buffer, offset and length alignment
+constexpr uint64_t POLL_TAG   = ~uint64_t{0};   // user_data of the eventfd poll
+constexpr uint64_t CANCEL_TAG = POLL_TAG - 1;   // user_data of IORING_OP_ASYNC_CANCEL
+constexpr int      BUSY_WAITS = 1000;           // 1 ms each with nothing to reap, then give up
+
+} // namespace
+
+const char* toString(RecordingBackend backend)
+{
+    switch (backend) {
+        case RecordingBackend::Auto:    return "auto";
+        case RecordingBackend::IoUring: return "io_uring";
+        case RecordingBackend::Threads: return "threads";
+    }
+    return "?";
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// io_uring set-up (raw syscalls)
+// ─────────────────────────────────────────────────────────────────────────
+
+struct RecordingWriter::Ring {
+    int fd    {-1};
+    int event {-1};
+#ifdef DUOSIGHT_IO_URING
+    void*          sqMap   {nullptr};
+    size_t         sqLen   {0};
+    void*          cqMap   {nullptr};
+    size_t         cqLen   {0};
+    io_uring_sqe*  sqes    {nullptr};
+    size_t         sqesLen {0};
+    unsigned*      sqTail  {nullptr};
+    unsigned*      sqMask  {nullptr};
+    unsigned*      sqArray {nullptr};
+    unsigned*      cqHead  {nullptr};
+    unsigned*      cqTail  {nullptr};
+    unsigned*      cqMask  {nullptr};
+    io_uring_cqe*  cqes    {nullptr};
+    unsigned       pending {0};   // SQEs written since the last enter
+    RecordingOptions::RingFaults faults;
+    int            calls   {0};
+
+    bool setup(unsigned entries)
+    {
+        io_uring_params p {};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+        if (fd < 0) {
+            std::clog << "[Recorder] io_uring_setup: " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        // IORING_OP_WRITE arrived in 5.6, as did the probe itself.
+        std::vector<uint8_t> buf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(buf.data());
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0
+            || probe->ops_len <= IORING_OP_WRITE
+            || !(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED)) {
+            std::clog << "[Recorder] io_uring lacks IORING_OP_WRITE\n";
+            return false;
+        }
+
+        sqLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            sqLen = cqLen = std::max(sqLen, cqLen);
+        }
+        sqMap = mmap(nullptr, sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqMap == MAP_FAILED) {
+            sqMap = nullptr;
+            std::clog << "[Recorder] io_uring mmap: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        if (single) {
+            cqMap = sqMap;
+        } else {
+            cqMap = mmap(nullptr, cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqMap == MAP_FAILED) {
+                cqMap = nullptr;
+                std::clog << "[Recorder] io_uring mmap: " << std::strerror(errno) << "\n";
+                return false;
+            }
+        }
+        sqesLen = p.sq_entries * sizeof(io_uring_sqe);
+        void* s = mmap(nullptr, sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (s == MAP_FAILED) {
+            std::clog << "[Recorder] io_uring mmap: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe*>(s);
+
+        auto* sq = static_cast<uint8_t*>(sqMap);
+        auto* cq = static_cast<uint8_t*>(cqMap);
+        sqTail  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask  = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cqHead  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask  = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+        event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (event < 0) {
+            std::clog << "[Recorder] eventfd: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    io_uring_sqe* next()
+    {
+        const unsigned tail = *sqTail;   // only this thread moves the tail
+        const unsigned i    = tail & *sqMask;
+        io_uring_sqe* sqe   = &sqes[i];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[i] = i;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++pending;
+        return sqe;
+    }
+
+    /// Submits what next() prepared and waits for at least one completion.
+    /// 0 or the errno; after EAGAIN or EBUSY nothing was submitted.
+    int enter()
+    {
+        ++calls;
+        if (faults.busyEvery > 0 && calls % faults.busyEvery == 0) {
+            return EBUSY;
+        }
+        if (faults.failAt > 0 && calls >= faults.failAt && calls < faults.failAt + faults.failCount) {
+            return EIO;
+        }
+        for (;;) {
+            const long r = syscall(__NR_io_uring_enter, fd, pending, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r >= 0) {
+                pending -= static_cast<unsigned>(r);
+                return 0;
+            }
+            if (errno != EINTR) {
+                return errno;
+            }
+        }
+    }
+
+    ~Ring()
+    {
+        if (sqes)                    munmap(sqes, sqesLen);
+        if (cqMap && cqMap != sqMap) munmap(cqMap, cqLen);
+        if (sqMap)                   munmap(sqMap, sqLen);
+        if (event >= 0)              ::close(event);
+        if (fd >= 0)                 ::close(fd);
+    }
+#else
+    bool setup(unsigned)
+    {
+        std::clog << "[Recorder] built without io_uring headers\n";
+        return false;
+    }
+#endif
+};
+
+// ─────────────────────────────────────────────────────────────────────────
+// Open / close
+// ─────────────────────────────────────────────────────────────────────────
+
+RecordingWriter::RecordingWriter(const std::string& path, const RecordingOptions& options)
+    : opt_(options)
+{
+    opt_.blockBytes = std::max(ALIGN, (opt_.blockBytes + ALIGN - 1) / ALIGN * ALIGN);
+    opt_.buffers    = std::max<size_t>(opt_.buffers, 2);
+    opt_.threads    = std::max(opt_.threads, 1);
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (opt_.direct) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd_ < 0 && errno == EINVAL) {
+            std::clog << "[Recorder] " << path << ": O_DIRECT refused, writing through the page cache\n";
+        }
+        direct_ = fd_ >= 0;
+    }
+    if (fd_ < 0) {
+        fd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        std::cerr << "[Recorder] open " << path << " failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    blocks_.resize(opt_.buffers);
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        blocks_[i].data = static_cast<uint8_t*>(std::aligned_alloc(ALIGN, opt_.blockBytes));
+        if (!blocks_[i].data) {
+            std::cerr << "[Recorder] cannot allocate " << opt_.buffers << " x " << opt_.blockBytes
+                      << " byte buffers\n";
+            ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+        free_.push_back(static_cast<int>(i));
+    }
+    allocateAhead(0);
+
+    if (opt_.backend != RecordingBackend::Threads) {
+        ring_ = std::make_unique<Ring>();
+        unsigned entries = 1;
+        while (entries < 2 * opt_.buffers + 2) entries <<= 1;   // a write and a cancel per block, the poll
+        if (ring_->setup(entries)) {
+#ifdef DUOSIGHT_IO_URING
+            ring_->faults = opt_.ringFaults;
+#endif
+            backend_ = RecordingBackend::IoUring;
+        } else {
+            ring_.reset();
+            std::clog << "[Recorder] falling back to " << opt_.threads << " writer thread(s)\n";
+        }
+    }
+    stats_.backend = backend_;
+    stats_.direct  = direct_;
+    stats_.writers = backend_ == RecordingBackend::IoUring ? 1 : static_cast<uint32_t>(opt_.threads);
+
+    if (backend_ == RecordingBackend::IoUring) {
+        workers_.emplace_back(&RecordingWriter::ringLoop, this);
+    } else {
+        for (int i = 0; i < opt_.threads; ++i) {
+            workers_.emplace_back(&RecordingWriter::threadLoop, this);
+        }
+    }
+}
+
+RecordingWriter::~RecordingWriter()
+{
+    close();
+    for (Block& b : blocks_) {
+        std::free(b.data);
+    }
+}
+
+bool RecordingWriter::close()
+{
+    uint64_t bytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) {
+            return closeOk_;
+        }
+        closing_ = true;
+        if (filling_ >= 0) {
+            Block& b = blocks_[filling_];
+            std::memset(b.data + b.used, 0, opt_.blockBytes - b.used);   // O_DIRECT writes whole blocks
+            queueFilling();
+        }
+        bytes = stats_.bytes;
+    }
+    wake();
+    for (std::thread& t : workers_) {
+        t.join();
+    }
+    workers_.clear();
+    for (std::thread& t : fallbackWorkers_) {   // complete once the ring thread has exited
+        t.join();
+    }
+    fallbackWorkers_.clear();
+    ring_.reset();
+
+    if (fd_ < 0) {
+        return closeOk_ = false;
+    }
+    bool ok = true;
+    if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0 || fdatasync(fd_) != 0) {
+        std::cerr << "[Recorder] trimming the recording failed: " << std::strerror(errno) << "\n";
+        ok = false;
+    }
+    ::close(fd_);
+    fd_ = -1;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closeOk_ = ok && stats_.writeErrors == 0;
+}
+
+void RecordingWriter::allocateAhead(uint64_t end)
+{
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    const uint64_t step = opt_.preallocBytes;
+    if (!canAllocate_ || !step || end + step / 2 <= allocated_) {
+        return;
+    }
+    const uint64_t target = (end + step + opt_.blockBytes - 1) / opt_.blockBytes * opt_.blockBytes;
+    if (fallocate(fd_, 0, static_cast<off_t>(allocated_), static_cast<off_t>(target - allocated_)) != 0) {
+        std::clog << "[Recorder] fallocate: " << std::strerror(errno) << "; blocks will be allocated as written\n";
+        canAllocate_ = false;
+        return;
+    }
+    allocated_ = target;
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// Producer side
+// ─────────────────────────────────────────────────────────────────────────
+
+bool RecordingWriter::append(const void* data, size_t bytes)
+{
+    const auto*  src = static_cast<const uint8_t*>(data);
+    const size_t B   = opt_.blockBytes;
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0 || closing_) {
+            return false;
+        }
+        const size_t room = (filling_ >= 0 ? B - blocks_[filling_].used : 0) + free_.size() * B;
+        if (bytes > room) {
+            ++stats_.drops;
+            stats_.droppedBytes += bytes;
+            return false;
+        }
+        stats_.bytes += bytes;
+        while (bytes) {
+            if (filling_ < 0) {
+                filling_ = free_.back();
+                free_.pop_back();
+                blocks_[filling_].used   = 0;
+                blocks_[filling_].offset = nextOffset_;
+                nextOffset_ += B;
+            }
+            Block& b = blocks_[filling_];
+            const size_t n = std::min(bytes, B - b.used);
+            std::memcpy(b.data + b.used, src, n);
+            b.used += n;
+            src    += n;
+            bytes  -= n;
+            if (b.used == B) {
+                queueFilling();
+                queued = true;
+            }
+        }
+    }
+    if (queued) {
+        wake();
+    }
+    return true;
+}
+
+bool RecordingWriter::append(const ThermalFrame& frame)
+{
+    uint8_t record[sizeof(FrameRecord) + Geometry::PIXELS * sizeof(float)];
+    FrameRecord h;
+    h.bytes       = sizeof(record);
+    h.sequence    = frame.sequence;
+    h.timestampNs = frame.timestampNs;
+    std::memcpy(record, &h, sizeof(h));
+    std::memcpy(record + sizeof(h), frame.temperatures.data(), Geometry::PIXELS * sizeof(float));
+    return append(record, sizeof(record));
+}
+
+ProcessingGraph::StageFn RecordingWriter::stage()
+{
+    return [this](const FramePtr& frame) -> FramePtr {
+        append(*frame);
+        return nullptr;
+    };
+}
+
+void RecordingWriter::queueFilling()
+{
+    Block& b   = blocks_[filling_];
+    b.done     = 0;
+    b.queuedNs = monotonicNowNs();
+    queued_.push_back(filling_);
+    filling_ = -1;
+    stats_.queueDepth    = static_cast<uint32_t>(queued_.size()) + inFlight_;
+    stats_.maxQueueDepth = std::max(stats_.maxQueueDepth, stats_.queueDepth);
+}
+
+void RecordingWriter::wake()
+{
+    if (ring_) {
+        const uint64_t one = 1;
+        if (write(ring_->event, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            std::cerr << "[Recorder] eventfd write: " << std::strerror(errno) << "\n";
+        }
+    }
+    cv_.notify_all();   // also reaches a ring thread that fell back to threadLoop()
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// Writer side
+// ─────────────────────────────────────────────────────────────────────────
+
+bool RecordingWriter::writeRest(Block& b)
+{
+    while (b.done < opt_.blockBytes) {
+        const ssize_t n = pwrite(fd_, b.data + b.done, opt_.blockBytes - b.done,
+                                 static_cast<off_t>(b.offset + b.done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (n == 0) errno = EIO;
+            return false;
+        }
+        b.done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void RecordingWriter::finished(int index, int64_t result)
+{
+    Block& b = blocks_[index];
+    const int64_t ns = monotonicNowNs() - b.queuedNs;
+    ++stats_.writes;
+    stats_.writeNs   += ns;
+    stats_.maxWriteNs = std::max(stats_.maxWriteNs, ns);
+    if (latency_) {
+        latency_->observe(ns * 1e-9);
+    }
+    if (result < 0) {
+        if (!stats_.writeErrors) {
+            std::cerr << "[Recorder] write at offset " << b.offset << " failed: "
+                      << std::strerror(static_cast<int>(-result)) << "\n";
+        }
+        ++stats_.writeErrors;
+    }
+    --inFlight_;
+    free_.push_back(index);
+    stats_.queueDepth = static_cast<uint32_t>(queued_.size()) + inFlight_;
+}
+
+void RecordingWriter::threadLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return !queued_.empty() || closing_; });
+        if (queued_.empty()) {
+            return;   // closing, nothing left
+        }
+        const int i = queued_.front();
+        queued_.pop_front();
+        ++inFlight_;
+        Block& b = blocks_[i];
+        lock.unlock();
+
+        allocateAhead(b.offset + opt_.blockBytes);
+        const int64_t result = writeRest(b) ? static_cast<int64_t>(b.done) : -errno;
+
+        lock.lock();
+        finished(i, result);
+    }
+}
+
+void RecordingWriter::ringLoop()
+{
+#ifdef DUOSIGHT_IO_URING
+    Ring& r = *ring_;
+    bool polling    = false;
+    bool cancelling = false;
+    std::vector<int>  take, retry;
+    std::vector<bool> owned(blocks_.size(), false);   // write submitted, completion not reaped
+    size_t outstanding = 0;
+    take.reserve(blocks_.size());
+
+    // Handles the completions that are ready; returns how many writes they
+    // finished. While cancelling, a write that never ran goes to retry.
+    auto reap = [&]() {
+        size_t   reaped = 0;
+        unsigned head   = *r.cqHead;
+        const unsigned tail = __atomic_load_n(r.cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = r.cqes[head & *r.cqMask];
+            if (cqe.user_data == POLL_TAG) {
+                uint64_t count;
+                if (read(r.event, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                    std::cerr << "[Recorder] eventfd read: " << std::strerror(errno) << "\n";
+                }
+                polling = false;
+                continue;
+            }
+            if (cqe.user_data == CANCEL_TAG) {
+                continue;
+            }
+            const int i = static_cast<int>(cqe.user_data);
+            owned[i] = false;
+            --outstanding;
+            ++reaped;
+            Block& b = blocks_[i];
+            int64_t result = cqe.res;
+            if (cancelling && (result == -ECANCELED || result == -EINTR)) {
+                retry.push_back(i);
+                continue;
+            }
+            if (result >= 0) {
+                b.done = static_cast<size_t>(result);
+                if (b.done < opt_.blockBytes) {
+                    result = writeRest(b) ? static_cast<int64_t>(b.done) : -errno;   // short write, rare
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished(i, result);
+        }
+        __atomic_store_n(r.cqHead, head, __ATOMIC_RELEASE);
+        return reaped;
+    };
+
+    int err   = 0;
+    int waits = 0;
+    for (;;) {
+        if (!polling) {
+            io_uring_sqe* sqe  = r.next();
+            sqe->opcode        = IORING_OP_POLL_ADD;
+            sqe->fd            = r.event;
+            sqe->poll32_events = POLLIN;
+            sqe->user_data     = POLL_TAG;
+            polling = true;
+        }
+
+        take.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_ && queued_.empty() && inFlight_ == 0) {
+                return;
+            }
+            while (!queued_.empty()) {
+                take.push_back(queued_.front());
+                queued_.pop_front();
+                ++inFlight_;
+            }
+        }
+        for (int i : take) {
+            Block& b = blocks_[i];
+            allocateAhead(b.offset + opt_.blockBytes);
+            io_uring_sqe* sqe = r.next();
+            sqe->opcode    = IORING_OP_WRITE;
+            sqe->fd        = fd_;
+            sqe->addr      = reinterpret_cast<uint64_t>(b.data);
+            sqe->len       = static_cast<uint32_t>(opt_.blockBytes);
+            sqe->off       = b.offset;
+            sqe->user_data = static_cast<uint64_t>(i);
+            owned[i] = true;
+            ++outstanding;
+        }
+
+        err = r.enter();
+        if (err == EAGAIN || err == EBUSY) {
+            // Completion ring full or the kernel short of memory; the
+            // prepared entries stay queued for the next attempt
+            if (reap() == 0) {
+                if (++waits > BUSY_WAITS) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            continue;
+        }
+        if (err != 0) {
+            break;
+        }
+        waits = 0;
+        reap();
+    }
+
+    // The ring is unusable. Cancel every write it may still hold and wait
+    // for each completion before its block is touched again.
+    std::cerr << "[Recorder] io_uring_enter: " << std::strerror(err) << "; cancelling " << outstanding
+              << " write(s) and falling back to " << opt_.threads << " writer thread(s)\n";
+    cancelling = true;
+    for (size_t i = 0; i < owned.size(); ++i) {
+        if (!owned[i]) continue;
+        io_uring_sqe* sqe = r.next();
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->addr      = static_cast<uint64_t>(i);   // user_data of the write
+        sqe->user_data = CANCEL_TAG;
+    }
+    waits = 0;
+    while (outstanding > 0) {
+        const int e = r.enter();
+        if (e == 0) {
+            reap();
+        } else if ((e == EAGAIN || e == EBUSY) && waits < BUSY_WAITS) {
+            if (reap() == 0) {
+                ++waits;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        } else {
+            break;
+        }
+    }
+    if (outstanding > 0) {
+        // Completions that will never be reaped: the kernel may still read
+        // those buffers, so they are left to it and the data is rewritten
+        // from copies
+        std::cerr << "[Recorder] " << outstanding << " write(s) could not be reaped; "
+                  << "abandoning their buffers\n";
+        for (size_t i = 0; i < owned.size(); ++i) {
+            if (!owned[i]) continue;
+            Block& b = blocks_[i];
+            auto* copy = static_cast<uint8_t*>(std::aligned_alloc(ALIGN, opt_.blockBytes));
+            if (!copy) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                finished(static_cast<int>(i), -ENOMEM);
+                continue;
+            }
+            std::memcpy(copy, b.data, opt_.blockBytes);
+            b.data = copy;   // the old buffer is deliberately leaked
+            retry.push_back(static_cast<int>(i));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::sort(retry.begin(), retry.end(),
+                  [this](int a, int b) { return blocks_[a].offset < blocks_[b].offset; });
+        for (auto it = retry.rbegin(); it != retry.rend(); ++it) {
+            blocks_[*it].done = 0;
+            queued_.push_front(*it);
+            --inFlight_;
+        }
+        stats_.queueDepth = static_cast<uint32_t>(queued_.size()) + inFlight_;
+        stats_.backend    = RecordingBackend::Threads;
+        stats_.writers    = static_cast<uint32_t>(opt_.threads);
+        for (int k = 1; k < opt_.threads; ++k) {   // this thread is the first
+            fallbackWorkers_.emplace_back(&RecordingWriter::threadLoop, this);
+        }
+    }
+    cv_.notify_all();
+#endif
+    threadLoop();
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// Statistics
+// ─────────────────────────────────────────────────────────────────────────
+
+RecordingStats RecordingWriter::stats() const
+{
+    RecordingStats st;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        st = stats_;
+    }
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    st.preallocated = allocated_;
+    return st;
+}
+
+void RecordingWriter::attachMetrics(MetricsRegistry& registry, const std::string& name)
+{
+    const std::string label = "recording=\"" + name + "\"";
+    Histogram& h = registry.histogram("duosight_recording_write_seconds",
+                                      "Time a recording block spent queued and being written",
+                                      Histogram::exponential(0.0001, 2.0, 14), label);
+    registry.callbackGauge("duosight_recording_queue_depth",
+                           "Recording blocks queued or in flight",
+                           [this] { return static_cast<double>(stats().queueDepth); }, label);
+    registry.callbackCounter("duosight_recording_dropped_bytes_total",
+                             "Recorded bytes dropped because no buffer was free",
+                             [this] { return static_cast<double>(stats().droppedBytes); }, label);
+    std::lock_guard<std::mutex> lock(mutex_);
+    latency_ = &h;
+}
+
+} // namespace duosight
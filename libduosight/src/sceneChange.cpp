@@ -0,0 +1,159 @@
+/**
+ * @file sceneChange.cpp
+ * @brief SAD-based scene change detection.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A tile row is 8 contiguous floats, i.e. two 128-bit vectors, so the
+ *   NEON path handles a whole row with two absolute-difference/accumulate
+ *   pairs. Other targets use a plain loop the compiler can vectorise.
+ */
+
+#include "sceneChange.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace duosight {
+
+namespace {
+
+using namespace SceneTiles;
+
+inline float tileSad(const float* a, const float* b)
+{
+#if defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (int r = 0; r < SIZE; ++r, a += Geometry::WIDTH, b += Geometry::WIDTH) {
+        acc = vaddq_f32(acc, vabdq_f32(vld1q_f32(a),     vld1q_f32(b)));
+        acc = vaddq_f32(acc, vabdq_f32(vld1q_f32(a + 4), vld1q_f32(b + 4)));
+    }
+    return vaddvq_f32(acc);
+#else
+    float lanes[SIZE] = {};
+    for (int r = 0; r < SIZE; ++r, a += Geometry::WIDTH, b += Geometry::WIDTH) {
+        for (int c = 0; c < SIZE; ++c) {
+            lanes[c] += std::fabs(a[c] - b[c]);
+        }
+    }
+    float sum = 0.0f;
+    for (float v : lanes) sum += v;
+    return sum;
+#endif
+}
+
+} // namespace
+
+SceneChangeDetector::SceneChangeDetector(float tileThreshold)
+    : threshold_(tileThreshold)
+{
+}
+
+SceneChange SceneChangeDetector::update(const float* t)
+{
+    SceneChange out;
+    ++frames_;
+
+    if (!haveRef_) {
+        std::copy(t, t + Geometry::PIXELS, ref_.begin());
+        haveRef_ = true;
+        return out;                      // first frame: everything is new
+    }
+
+    out.changedTiles = 0;
+    float total = 0.0f;
+    for (int ty = 0; ty < ROWS; ++ty) {
+        for (int tx = 0; tx < COLS; ++tx) {
+            const int   origin = ty * SIZE * Geometry::WIDTH + tx * SIZE;
+            const float sad    = tileSad(t + origin, ref_.data() + origin);
+            total += sad;
+
+            if (sad > threshold_ * SIZE * SIZE) {
+                out.changedTiles |= 1u << (ty * COLS + tx);
+                for (int r = 0; r < SIZE; ++r) {
+                    const int row = origin + r * Geometry::WIDTH;
+                    std::copy(t + row, t + row + SIZE, ref_.begin() + row);
+                }
+            }
+        }
+    }
+    out.score = total / Geometry::PIXELS;
+    if (!out.changed()) ++unchanged_;
+    return out;
+}
+
+SceneChange SceneChangeDetector::updateRaw(const uint16_t* words)
+{
+    SceneChange out;
+    ++frames_;
+
+    const int sp = words[Geometry::WORDS - 1] & 1;
+    auto&     ref = rawRef_[sp];
+    if (!haveRawRef_[sp]) {
+        for (int p = 0; p < Geometry::PIXELS; ++p) ref[p] = static_cast<int16_t>(words[p]);
+        haveRawRef_[sp] = true;
+        return out;
+    }
+
+    // Only pixels measured in this subpage are compared; the rest of RAM
+    // was refreshed by the other subpage in between. Tiles are even-sized
+    // and aligned, so the pattern within a tile depends only on (r, c) and
+    // every tile holds exactly half its pixels from each subpage.
+    const bool chess = (words[Geometry::WORDS - 2] & 0x1000) != 0;
+
+    out.changedTiles = 0;
+    int64_t total = 0;
+    for (int ty = 0; ty < ROWS; ++ty) {
+        for (int tx = 0; tx < COLS; ++tx) {
+            const int origin = ty * SIZE * Geometry::WIDTH + tx * SIZE;
+            int32_t   sad    = 0;
+            for (int r = 0; r < SIZE; ++r) {
+                const int row = origin + r * Geometry::WIDTH;
+                for (int c = 0; c < SIZE; ++c) {
+                    const int own = (((chess ? r + c : r) & 1) == sp);
+                    sad += own * std::abs(static_cast<int16_t>(words[row + c]) - ref[row + c]);
+                }
+            }
+            total += sad;
+
+            if (sad > threshold_ * SIZE * SIZE / 2) {
+                out.changedTiles |= 1u << (ty * COLS + tx);
+                for (int r = 0; r < SIZE; ++r) {
+                    const int row = origin + r * Geometry::WIDTH;
+                    for (int c = 0; c < SIZE; ++c) {
+                        ref[row + c] = static_cast<int16_t>(words[row + c]);
+                    }
+                }
+            }
+        }
+    }
+    out.score = static_cast<float>(total) / (Geometry::PIXELS / 2);
+    if (!out.changed()) ++unchanged_;
+    return out;
+}
+
+ProcessingGraph::StageFn gateOnChange(ProcessingGraph::StageFn stage, GateStats& stats)
+{
+    return [stage = std::move(stage), &stats](const FramePtr& frame) -> FramePtr {
+        if (frame->changedTiles == 0) {
+            stats.skipped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        const int64_t t0  = monotonicNowNs();
+        FramePtr      out = stage(frame);
+        stats.passedNs.fetch_add(static_cast<uint64_t>(monotonicNowNs() - t0),
+                                 std::memory_order_relaxed);
+        stats.passed.fetch_add(1, std::memory_order_relaxed);
+        return out;
+    };
+}
+
+} // namespace duosight
@@ -0,0 +1,373 @@
+/**
+ * @file simulatedMlx90640.cpp
+ * @brief Register model and fault injection for SimulatedMlx90640.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Every transaction first advances the clock (virtual mode) and lets the
+ *   sensor produce any subpages that have fallen due, then applies bus
+ *   faults, then serves or stores register words.
+ */
+
+#include "simulatedMlx90640.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+namespace duosight {
+
+const char* toString(SimFault fault)
+{
+    switch (fault) {
+    case SimFault::Nack:         return "nack";
+    case SimFault::ShortRead:    return "short-read";
+    case SimFault::BitFlip:      return "bit-flip";
+    case SimFault::DelayedReady: return "delayed-ready";
+    case SimFault::StuckReady:   return "stuck-ready";
+    case SimFault::OverrunBurst: return "overrun-burst";
+    case SimFault::Hang:         return "hang";
+    }
+    return "?";
+}
+
+SimulatedMlx90640::SimulatedMlx90640(const paramsMLX90640& params, const SceneConfig& scene,
+                                     const Options& options)
+    : I2cDevice(options.address), opt_(options), scene_(params, scene), rng_(options.seed),
+      virtualNs_(options.busClock ? options.busClock : std::make_shared<int64_t>(0))
+{
+    ctrl1_ = static_cast<uint16_t>(0x0001 | ((scene.refreshCode << refresh::SHIFT) & refresh::MASK)
+                                   | ((scene.resolution & 0x03) << 10)
+                                   | (scene.chess ? 0x1000 : 0x0000));
+    periodNs_      = subpagePeriodNs(scene.refreshCode & 0x07);
+    startNs_       = clockNs();
+    nextSubpageNs_ = startNs_ + periodNs_;
+}
+
+void SimulatedMlx90640::setEeprom(const uint16_t* words, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::copy(words, words + std::min(count, eeprom_.size()), eeprom_.begin());
+}
+
+void SimulatedMlx90640::addFault(const ScriptedFault& fault)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    script_.push_back(fault);
+}
+
+void SimulatedMlx90640::setFaultRates(const FaultRates& rates)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    rates_ = rates;
+}
+
+int64_t SimulatedMlx90640::clockNs() const
+{
+    if (opt_.virtualTime) return *virtualNs_;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t SimulatedMlx90640::subpagePeriodNs(int refreshCode) const
+{
+    return static_cast<int64_t>(refresh::TABLE[refreshCode].sec_subpage * 1e9 * (1.0 + opt_.clockPpm * 1e-6));
+}
+
+int64_t SimulatedMlx90640::nowNs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clockNs() - startNs_;
+}
+
+void SimulatedMlx90640::advance(int64_t ns)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (opt_.virtualTime) *virtualNs_ += ns;
+    produceDue();
+}
+
+std::vector<FaultEvent> SimulatedMlx90640::faultLog() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return log_;
+}
+
+SimStats SimulatedMlx90640::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void SimulatedMlx90640::log(SimFault fault, std::string detail)
+{
+    FaultEvent ev{clockNs() - startNs_, stats_.produced, fault, std::move(detail)};
+    ++stats_.faults;
+    if (opt_.logFaults) {
+        std::clog << "[SimMLX] t=" << ev.timeNs / 1e6 << " ms subpage=" << ev.subpage
+                  << " fault=" << toString(fault)
+                  << (ev.detail.empty() ? "" : " ") << ev.detail << "\n";
+    }
+    log_.push_back(std::move(ev));
+}
+
+void SimulatedMlx90640::tick(size_t bytes)
+{
+    ++stats_.transactions;
+    clockBytes(bytes + 1);
+}
+
+void SimulatedMlx90640::clockBytes(size_t bytes)
+{
+    if (opt_.virtualTime) {
+        // 9 clocks per byte incl. ACK
+        *virtualNs_ += static_cast<int64_t>(bytes * 9 * 1'000'000'000ull / opt_.busHz);
+    }
+    produceDue();
+}
+
+void SimulatedMlx90640::produceDue()
+{
+    const int64_t now = clockNs();
+    while (now >= nextSubpageNs_) {
+        if (nextSubpageNs_ >= hangUntilNs_) {
+            produce(nextSubpageNs_);
+        }
+        nextSubpageNs_ += periodNs_;
+    }
+}
+
+void SimulatedMlx90640::armScripted()
+{
+    for (auto it = script_.begin(); it != script_.end();) {
+        if (it->atSubpage != stats_.produced) { ++it; continue; }
+
+        std::ostringstream d;
+        switch (it->fault) {
+        case SimFault::Nack:      nackBudget_      += it->count; d << "x" << it->count; break;
+        case SimFault::ShortRead: shortReadBudget_ += it->count; d << "x" << it->count; break;
+        case SimFault::BitFlip:   bitFlipBudget_   += it->count; d << "x" << it->count; break;
+        case SimFault::DelayedReady:
+            readyDelayNs_ = int64_t(it->durationUs) * 1000;
+            d << it->durationUs << " us";
+            break;
+        case SimFault::StuckReady:
+            stuckSubpages_ = it->count;
+            d << it->count << " subpages";
+            break;
+        case SimFault::OverrunBurst:
+            // Pull the next `count` measurements forward to "now".
+            nextSubpageNs_ -= int64_t(it->count) * periodNs_;
+            d << it->count << " subpages";
+            break;
+        case SimFault::Hang:
+            hangUntilNs_ = clockNs() + int64_t(it->durationUs) * 1000;
+            d << it->durationUs << " us";
+            break;
+        }
+        // Bus-level budgets are logged as they fire; the rest are logged here.
+        if (it->fault != SimFault::Nack && it->fault != SimFault::ShortRead &&
+            it->fault != SimFault::BitFlip) {
+            log(it->fault, d.str());
+        }
+        it = script_.erase(it);
+    }
+}
+
+void SimulatedMlx90640::produce(int64_t dueNs)
+{
+    ++stats_.produced;
+    armScripted();
+
+    if (unread_) {
+        ++stats_.overwritten;
+        status_ |= Status::OVERRUN;
+    }
+
+    scene_.nextSubpage(ram_.data());
+    ram_[Geometry::WORDS - 2] = ctrl1_;
+
+    status_ = static_cast<uint16_t>((status_ & ~Status::SUBPAGE_MASK) | ram_[Geometry::WORDS - 1]);
+    status_ |= Status::NEW_DATA_READY;
+    // Timed from the schedule, not from whenever the bus next looked
+    readyAtNs_    = dueNs + readyDelayNs_;
+    readyDelayNs_ = 0;
+    unread_       = true;
+
+    if (stuckSubpages_ > 0) --stuckSubpages_;
+}
+
+uint16_t SimulatedMlx90640::readWord(uint16_t reg) const
+{
+    if (reg >= RAM_BASE && reg < RAM_BASE + 832) return ram_[reg - RAM_BASE];
+    if (reg >= EEPROM_BASE && reg < EEPROM_BASE + 832) return eeprom_[reg - EEPROM_BASE];
+    if (reg == Status::REG) {
+        uint16_t s = status_;
+        if (clockNs() < readyAtNs_) s &= ~Status::NEW_DATA_READY;   // not raised yet
+        return s;
+    }
+    if (reg == CTRL1_REG)   return ctrl1_;
+    if (reg == I2C_CFG_REG) return i2cCfg_;
+    return 0;
+}
+
+bool SimulatedMlx90640::injectTransactionFault(uint8_t* rx, size_t rxLen, bool isRead)
+{
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+
+    if (clockNs() < hangUntilNs_) {
+        return true;                                  // hung sensor: silent NACK
+    }
+    if (nackBudget_ > 0 || (rates_.nack > 0 && u(rng_) < rates_.nack)) {
+        if (nackBudget_ > 0) --nackBudget_;
+        log(SimFault::Nack, isRead ? "read" : "write");
+        return true;
+    }
+    if (!isRead || rxLen == 0) {
+        return false;
+    }
+    if (shortReadBudget_ > 0 || (rates_.shortRead > 0 && u(rng_) < rates_.shortRead)) {
+        if (shortReadBudget_ > 0) --shortReadBudget_;
+        const size_t keep = std::uniform_int_distribution<size_t>(0, rxLen - 1)(rng_);
+        std::fill(rx + keep, rx + rxLen, 0xFF);
+        log(SimFault::ShortRead, std::to_string(keep) + "/" + std::to_string(rxLen) + " bytes");
+    }
+    if (bitFlipBudget_ > 0 || (rates_.bitFlip > 0 && u(rng_) < rates_.bitFlip)) {
+        if (bitFlipBudget_ > 0) --bitFlipBudget_;
+        const size_t bit = std::uniform_int_distribution<size_t>(0, rxLen * 8 - 1)(rng_);
+        rx[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+        log(SimFault::BitFlip, "byte " + std::to_string(bit / 8) + " bit " + std::to_string(bit % 8));
+    }
+    return false;
+}
+
+void SimulatedMlx90640::serveRead(uint16_t reg, uint8_t* rx, size_t rxLen) const
+{
+    for (size_t i = 0; i < rxLen / 2; ++i) {
+        const uint16_t w = readWord(static_cast<uint16_t>(reg + i));
+        rx[2 * i]     = static_cast<uint8_t>(w >> 8);
+        rx[2 * i + 1] = static_cast<uint8_t>(w & 0xFF);
+    }
+}
+
+void SimulatedMlx90640::consumeIfBurst(uint16_t reg, size_t rxLen)
+{
+    // A RAM burst covering the pixel block consumes the pending subpage.
+    if (unread_ && reg <= RAM_BASE && reg + rxLen / 2 >= RAM_BASE + Geometry::PIXELS) {
+        unread_ = false;
+        ++stats_.delivered;
+        stats_.readyToReadNs += std::max<int64_t>(clockNs() - readyAtNs_, 0);
+    }
+}
+
+void SimulatedMlx90640::storeWord(uint16_t reg, uint16_t value)
+{
+    if (reg == Status::REG) {
+        // NEW_DATA_READY and OVERRUN are cleared by writing 0 to them.
+        uint16_t keep = Status::SUBPAGE_MASK;
+        if (stuckSubpages_ > 0) keep |= Status::NEW_DATA_READY;
+        status_ = static_cast<uint16_t>((status_ & keep) | (value & ~(Status::NEW_DATA_READY |
+                                                                      Status::OVERRUN |
+                                                                      Status::SUBPAGE_MASK)));
+    } else if (reg == CTRL1_REG) {
+        // Modelled: the measurement in progress is abandoned and a new one
+        // started. Otherwise a new rate applies from the next subpage.
+        ctrl1_    = value;
+        periodNs_ = subpagePeriodNs((value & refresh::MASK) >> refresh::SHIFT);
+        if (opt_.ctrl1Restarts) {
+            nextSubpageNs_ = clockNs() + periodNs_;
+        }
+    } else if (reg == I2C_CFG_REG) {
+        i2cCfg_ = value;
+    } else if (reg >= EEPROM_BASE && reg < EEPROM_BASE + 832) {
+        eeprom_[reg - EEPROM_BASE] = value;
+    }
+}
+
+bool SimulatedMlx90640::writeThenRead(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    tick(txLen + rxLen);
+    if (txLen != 2 || (rxLen & 1)) {
+        return false;
+    }
+
+    const uint16_t reg = static_cast<uint16_t>((tx[0] << 8) | tx[1]);
+    serveRead(reg, rx, rxLen);
+    if (injectTransactionFault(rx, rxLen, true)) {
+        return false;
+    }
+    consumeIfBurst(reg, rxLen);
+    return true;
+}
+
+bool SimulatedMlx90640::transfer(I2cMessage* messages, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.transactions;
+    if (count == 0 || count > MAX_MESSAGES) {
+        return false;
+    }
+
+    // Each register access is served when its bytes have crossed the bus,
+    // so a STATUS read at the front of a long transaction sees the sensor
+    // as it was then, not as it is once the RAM block has followed. A NACK
+    // anywhere fails the whole transaction, as the adapter reports it.
+    struct Read { uint16_t reg; I2cMessage* msg; };
+    std::vector<Read> reads;
+    for (size_t i = 0; i < count; ++i) {
+        I2cMessage& m = messages[i];
+        if (m.read || m.length < 2) {
+            return false;                                   // reads need a register address first
+        }
+        const uint16_t reg = static_cast<uint16_t>((m.data[0] << 8) | m.data[1]);
+        if (m.length == 2 && i + 1 < count && messages[i + 1].read && !(messages[i + 1].length & 1)) {
+            I2cMessage& rx = messages[i + 1];
+            clockBytes(m.length + rx.length + 2);           // address byte before each message
+            serveRead(reg, rx.data, rx.length);
+            reads.push_back({reg, &rx});
+            ++i;
+        } else if (m.length == 4) {
+            clockBytes(m.length + 1);
+            if (injectTransactionFault(nullptr, 0, false)) return false;
+            storeWord(reg, static_cast<uint16_t>((m.data[2] << 8) | m.data[3]));
+        } else {
+            return false;
+        }
+    }
+    for (const Read& r : reads) {
+        if (injectTransactionFault(r.msg->data, r.msg->length, true)) {
+            return false;
+        }
+    }
+    for (const Read& r : reads) {
+        consumeIfBurst(r.reg, r.msg->length);
+    }
+    return true;
+}
+
+bool SimulatedMlx90640::writeBytes(const uint8_t* data, size_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    tick(length);
+    if (length != 4 || injectTransactionFault(nullptr, 0, false)) {
+        return false;
+    }
+    storeWord(static_cast<uint16_t>((data[0] << 8) | data[1]),
+              static_cast<uint16_t>((data[2] << 8) | data[3]));
+    return true;
+}
+
+bool SimulatedMlx90640::readBytes(uint8_t*, size_t)
+{
+    // The MLX90640 needs a register address first; plain reads are invalid.
+    std::lock_guard<std::mutex> lock(mutex_);
+    tick(0);
+    return false;
+}
+
+} // namespace duosight
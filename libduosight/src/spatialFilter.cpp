@@ -0,0 +1,295 @@
+/**
+ * @file spatialFilter.cpp
+ * @brief Implementation of the sorting-network medians and the LUT bilateral.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Every kernel reads a replicate-padded copy of the input, so the inner
+ *   loops have no edge cases. Each step loads the window of four adjacent
+ *   output pixels as shifted vectors and runs the same compare-exchange
+ *   or weighting sequence on all four lanes. A row whose width is not a
+ *   multiple of four finishes with one vector stored through a scratch
+ *   buffer. The padded rows have slack, so its loads stay in bounds.
+ */
+
+#include "spatialFilter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace duosight {
+
+namespace {
+
+// ── Four float lanes ──────────────────────────────────────────────────────
+#if defined(__ARM_NEON) && defined(__aarch64__)
+using V = float32x4_t;
+inline V    vload(const float* p)        { return vld1q_f32(p); }
+inline void vstore(float* p, V v)        { vst1q_f32(p, v); }
+inline V    vsplat(float x)              { return vdupq_n_f32(x); }
+inline V    vadd(V a, V b)               { return vaddq_f32(a, b); }
+inline V    vsub(V a, V b)               { return vsubq_f32(a, b); }
+inline V    vmul(V a, V b)               { return vmulq_f32(a, b); }
+inline V    vdiv(V a, V b)               { return vdivq_f32(a, b); }
+inline V    vmin(V a, V b)               { return vminq_f32(a, b); }
+inline V    vmax(V a, V b)               { return vmaxq_f32(a, b); }
+inline V    vabs(V a)                    { return vabsq_f32(a); }
+inline void vindex(int32_t* p, V a)      { vst1q_s32(p, vcvtq_s32_f32(a)); }
+#elif defined(__SSE2__)
+using V = __m128;
+inline V    vload(const float* p)        { return _mm_loadu_ps(p); }
+inline void vstore(float* p, V v)        { _mm_storeu_ps(p, v); }
+inline V    vsplat(float x)              { return _mm_set1_ps(x); }
+inline V    vadd(V a, V b)               { return _mm_add_ps(a, b); }
+inline V    vsub(V a, V b)               { return _mm_sub_ps(a, b); }
+inline V    vmul(V a, V b)               { return _mm_mul_ps(a, b); }
+inline V    vdiv(V a, V b)               { return _mm_div_ps(a, b); }
+inline V    vmin(V a, V b)               { return _mm_min_ps(a, b); }
+inline V    vmax(V a, V b)               { return _mm_max_ps(a, b); }
+inline V    vabs(V a)                    { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline void vindex(int32_t* p, V a)      { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvttps_epi32(a)); }
+#else
+struct V { float v[4]; };
+template <typename F>
+inline V    lanes(F f)                   { V r; for (int i = 0; i < 4; ++i) r.v[i] = f(i); return r; }
+inline V    vload(const float* p)        { return lanes([&](int i) { return p[i]; }); }
+inline void vstore(float* p, V v)        { for (int i = 0; i < 4; ++i) p[i] = v.v[i]; }
+inline V    vsplat(float x)              { return lanes([&](int) { return x; }); }
+inline V    vadd(V a, V b)               { return lanes([&](int i) { return a.v[i] + b.v[i]; }); }
+inline V    vsub(V a, V b)               { return lanes([&](int i) { return a.v[i] - b.v[i]; }); }
+inline V    vmul(V a, V b)               { return lanes([&](int i) { return a.v[i] * b.v[i]; }); }
+inline V    vdiv(V a, V b)               { return lanes([&](int i) { return a.v[i] / b.v[i]; }); }
+inline V    vmin(V a, V b)               { return lanes([&](int i) { return std::min(a.v[i], b.v[i]); }); }
+inline V    vmax(V a, V b)               { return lanes([&](int i) { return std::max(a.v[i], b.v[i]); }); }
+inline V    vabs(V a)                    { return lanes([&](int i) { return std::fabs(a.v[i]); }); }
+inline void vindex(int32_t* p, V a)      { for (int i = 0; i < 4; ++i) p[i] = static_cast<int32_t>(a.v[i]); }
+#endif
+
+/// Compare-exchange: a gets the smaller, b the larger.
+inline void cx(V& a, V& b)
+{
+    const V lo = vmin(a, b);
+    b = vmax(a, b);
+    a = lo;
+}
+
+// Median of 9 (Paeth): 19 compare-exchanges
+inline V median9(V* p)
+{
+    cx(p[1], p[2]); cx(p[4], p[5]); cx(p[7], p[8]);
+    cx(p[0], p[1]); cx(p[3], p[4]); cx(p[6], p[7]);
+    cx(p[1], p[2]); cx(p[4], p[5]); cx(p[7], p[8]);
+    cx(p[0], p[3]); cx(p[5], p[8]); cx(p[4], p[7]);
+    cx(p[3], p[6]); cx(p[1], p[4]); cx(p[2], p[5]);
+    cx(p[4], p[7]); cx(p[4], p[2]); cx(p[6], p[4]);
+    cx(p[4], p[2]);
+    return p[4];
+}
+
+// Median of 25 (Devillard): 99 compare-exchanges
+inline V median25(V* p)
+{
+    cx(p[0],  p[1]);  cx(p[3],  p[4]);  cx(p[2],  p[4]);  cx(p[2],  p[3]);  cx(p[6],  p[7]);
+    cx(p[5],  p[7]);  cx(p[5],  p[6]);  cx(p[9],  p[10]); cx(p[8],  p[10]); cx(p[8],  p[9]);
+    cx(p[12], p[13]); cx(p[11], p[13]); cx(p[11], p[12]); cx(p[15], p[16]); cx(p[14], p[16]);
+    cx(p[14], p[15]); cx(p[18], p[19]); cx(p[17], p[19]); cx(p[17], p[18]); cx(p[21], p[22]);
+    cx(p[20], p[22]); cx(p[20], p[21]); cx(p[23], p[24]); cx(p[2],  p[5]);  cx(p[3],  p[6]);
+    cx(p[0],  p[6]);  cx(p[0],  p[3]);  cx(p[4],  p[7]);  cx(p[1],  p[7]);  cx(p[1],  p[4]);
+    cx(p[11], p[14]); cx(p[8],  p[14]); cx(p[8],  p[11]); cx(p[12], p[15]); cx(p[9],  p[15]);
+    cx(p[9],  p[12]); cx(p[13], p[16]); cx(p[10], p[16]); cx(p[10], p[13]); cx(p[20], p[23]);
+    cx(p[17], p[23]); cx(p[17], p[20]); cx(p[21], p[24]); cx(p[18], p[24]); cx(p[18], p[21]);
+    cx(p[19], p[22]); cx(p[8],  p[17]); cx(p[9],  p[18]); cx(p[0],  p[18]); cx(p[0],  p[9]);
+    cx(p[10], p[19]); cx(p[1],  p[19]); cx(p[1],  p[10]); cx(p[11], p[20]); cx(p[2],  p[20]);
+    cx(p[2],  p[11]); cx(p[12], p[21]); cx(p[3],  p[21]); cx(p[3],  p[12]); cx(p[13], p[22]);
+    cx(p[4],  p[22]); cx(p[4],  p[13]); cx(p[14], p[23]); cx(p[5],  p[23]); cx(p[5],  p[14]);
+    cx(p[15], p[24]); cx(p[6],  p[24]); cx(p[6],  p[15]); cx(p[7],  p[16]); cx(p[7],  p[19]);
+    cx(p[13], p[21]); cx(p[15], p[23]); cx(p[7],  p[13]); cx(p[7],  p[15]); cx(p[1],  p[9]);
+    cx(p[3],  p[11]); cx(p[5],  p[17]); cx(p[11], p[17]); cx(p[9],  p[17]); cx(p[4],  p[10]);
+    cx(p[6],  p[12]); cx(p[7],  p[14]); cx(p[4],  p[6]);  cx(p[4],  p[7]);  cx(p[12], p[14]);
+    cx(p[10], p[14]); cx(p[6],  p[7]);  cx(p[10], p[12]); cx(p[6],  p[10]); cx(p[6],  p[17]);
+    cx(p[12], p[17]); cx(p[7],  p[17]); cx(p[7],  p[10]); cx(p[12], p[18]); cx(p[7],  p[12]);
+    cx(p[10], p[18]); cx(p[12], p[20]); cx(p[10], p[20]); cx(p[10], p[12]);
+    return p[12];
+}
+
+} // namespace
+
+const char* toString(SpatialKind kind)
+{
+    switch (kind) {
+    case SpatialKind::Median3:   return "median3";
+    case SpatialKind::Median5:   return "median5";
+    case SpatialKind::Bilateral: return "bilateral";
+    }
+    return "?";
+}
+
+SpatialFilter::SpatialFilter(const SpatialFilterOptions& options)
+    : opt_(options)
+{
+    opt_.width  = std::max(opt_.width, 1);
+    opt_.height = std::max(opt_.height, 1);
+    if (opt_.radius < 1 || opt_.radius > BORDER) {
+        std::clog << "[SpatialFilter] bilateral radius " << opt_.radius << " clamped to 1.."
+                  << BORDER << "\n";
+        opt_.radius = std::clamp(opt_.radius, 1, BORDER);
+    }
+
+    stride_ = opt_.width + 2 * BORDER + 3;
+    padded_.assign(static_cast<size_t>(stride_) * (opt_.height + 2 * BORDER), 0.0f);
+
+    // Range weights at bin centres; the last bin (4 sigma and beyond) is 0
+    const float span = 4.0f * opt_.sigmaRange;
+    lutScale_ = (LUT_SIZE - 1) / span;
+    for (int i = 0; i < LUT_SIZE - 1; ++i) {
+        const float d = (i + 0.5f) / lutScale_;
+        rangeLut_[i] = std::exp(-d * d / (2.0f * opt_.sigmaRange * opt_.sigmaRange));
+    }
+    rangeLut_[LUT_SIZE - 1] = 0.0f;
+
+    const int r = opt_.radius, n = 2 * r + 1;
+    for (int dy = -r; dy <= r; ++dy) {
+        for (int dx = -r; dx <= r; ++dx) {
+            spaceWeight_[(dy + r) * n + (dx + r)] =
+                std::exp(-static_cast<float>(dx * dx + dy * dy) / (2.0f * opt_.sigmaSpace * opt_.sigmaSpace));
+        }
+    }
+}
+
+void SpatialFilter::pad(const float* in)
+{
+    const int w = opt_.width, h = opt_.height;
+    for (int y = -BORDER; y < h + BORDER; ++y) {
+        const float* src = in + std::clamp(y, 0, h - 1) * w;
+        float*       dst = &padded_[(y + BORDER) * stride_];
+        std::fill(dst, dst + BORDER, src[0]);
+        std::copy(src, src + w, dst + BORDER);
+        std::fill(dst + BORDER + w, dst + stride_, src[w - 1]);
+    }
+}
+
+void SpatialFilter::median3(const float* in, float* out)
+{
+    pad(in);
+    const int w = opt_.width;
+    alignas(16) float tail[4];
+    for (int y = 0; y < opt_.height; ++y) {
+        const float* c = &padded_[(y + BORDER) * stride_ + BORDER];
+        for (int x = 0; x < w; x += 4) {
+            V p[9];
+            for (int dy = -1, k = 0; dy <= 1; ++dy) {
+                const float* row = c + dy * stride_ + x;
+                p[k++] = vload(row - 1);
+                p[k++] = vload(row);
+                p[k++] = vload(row + 1);
+            }
+            const V m = median9(p);
+            if (x + 4 <= w) {
+                vstore(out + y * w + x, m);
+            } else {
+                vstore(tail, m);
+                std::copy(tail, tail + (w - x), out + y * w + x);
+            }
+        }
+    }
+}
+
+void SpatialFilter::median5(const float* in, float* out)
+{
+    pad(in);
+    const int w = opt_.width;
+    alignas(16) float tail[4];
+    for (int y = 0; y < opt_.height; ++y) {
+        const float* c = &padded_[(y + BORDER) * stride_ + BORDER];
+        for (int x = 0; x < w; x += 4) {
+            V p[25];
+            for (int dy = -2, k = 0; dy <= 2; ++dy) {
+                const float* row = c + dy * stride_ + x;
+                for (int dx = -2; dx <= 2; ++dx) p[k++] = vload(row + dx);
+            }
+            const V m = median25(p);
+            if (x + 4 <= w) {
+                vstore(out + y * w + x, m);
+            } else {
+                vstore(tail, m);
+                std::copy(tail, tail + (w - x), out + y * w + x);
+            }
+        }
+    }
+}
+
+void SpatialFilter::bilateral(const float* in, float* out)
+{
+    pad(in);
+    const int w = opt_.width, r = opt_.radius, n = 2 * r + 1;
+    const V scale  = vsplat(lutScale_);
+    const V last   = vsplat(static_cast<float>(LUT_SIZE - 1));
+    alignas(16) int32_t idx[4];
+    alignas(16) float   rw[4];
+    alignas(16) float   tail[4];
+    for (int y = 0; y < opt_.height; ++y) {
+        const float* c = &padded_[(y + BORDER) * stride_ + BORDER];
+        for (int x = 0; x < w; x += 4) {
+            const V centre = vload(c + x);
+            V num = vsplat(0.0f), den = vsplat(0.0f);
+            for (int dy = -r; dy <= r; ++dy) {
+                const float* row = c + dy * stride_ + x;
+                for (int dx = -r; dx <= r; ++dx) {
+                    const V v = vload(row + dx);
+                    vindex(idx, vmin(vmul(vabs(vsub(v, centre)), scale), last));
+                    for (int i = 0; i < 4; ++i) rw[i] = rangeLut_[idx[i]];
+                    const V wt = vmul(vload(rw), vsplat(spaceWeight_[(dy + r) * n + (dx + r)]));
+                    num = vadd(num, vmul(wt, v));
+                    den = vadd(den, wt);
+                }
+            }
+            // The centre always has weight ~1, so den never vanishes
+            const V f = vdiv(num, den);
+            if (x + 4 <= w) {
+                vstore(out + y * w + x, f);
+            } else {
+                vstore(tail, f);
+                std::copy(tail, tail + (w - x), out + y * w + x);
+            }
+        }
+    }
+}
+
+void SpatialFilter::apply(SpatialKind kind, const float* in, float* out)
+{
+    switch (kind) {
+    case SpatialKind::Median3:   median3(in, out);   break;
+    case SpatialKind::Median5:   median5(in, out);   break;
+    case SpatialKind::Bilateral: bilateral(in, out); break;
+    }
+}
+
+ProcessingGraph::StageFn SpatialFilter::stage(SpatialKind kind)
+{
+    if (opt_.width != static_cast<int>(Geometry::WIDTH) || opt_.height != static_cast<int>(Geometry::HEIGHT)) {
+        std::cerr << "[SpatialFilter] stage() needs the " << Geometry::WIDTH << "x" << Geometry::HEIGHT
+                  << " grid; frames pass through unfiltered\n";
+        return [](const FramePtr& frame) { return frame; };
+    }
+    return [this, kind](const FramePtr& frame) -> FramePtr {
+        auto out = std::make_shared<ThermalFrame>();
+        out->sequence     = frame->sequence;
+        out->timestampNs  = frame->timestampNs;
+        out->changedTiles = frame->changedTiles;
+        out->changeScore  = frame->changeScore;
+        apply(kind, frame->temperatures.data(), out->temperatures.data());
+        return out;
+    };
+}
+
+} // namespace duosight
@@ -0,0 +1,324 @@
+/**
+ * @file staggerCoordinator.cpp
+ * @brief Poll loop, phase check and CTRL1 re-phasing for StaggerCoordinator.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   One pass of next() does the first of: a re-phase that is due (or so
+ *   close that a burst would delay it), the RAM burst of the sensor that
+ *   has been ready longest, a STATUS probe of every sensor due for one.
+ *   Otherwise it sleeps until the next of those.
+ */
+
+#include "staggerCoordinator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace duosight {
+
+namespace {
+
+constexpr uint16_t CTRL1_REG = 0x800D;
+
+} // namespace
+
+StaggerCoordinator::StaggerCoordinator(const std::vector<I2cDevice*>& sensors,
+                                       const StaggerOptions& options, FetchClock clock)
+    : opt_(options), clock_(std::move(clock))
+{
+    if (!clock_.now) {
+        clock_.now = [] {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+    }
+    if (!clock_.sleep) {
+        clock_.sleep = [](int64_t ns) { std::this_thread::sleep_for(std::chrono::nanoseconds(ns)); };
+    }
+    opt_.periodNs   = std::max<int64_t>(opt_.periodNs, 1'000'000);
+    opt_.checkEvery = std::max<uint32_t>(opt_.checkEvery, 1);
+
+    FetchOptions fo;
+    fo.speculative = false;
+    fo.periodNs    = opt_.periodNs;
+    fo.pollNs      = opt_.pollNs;
+    fo.warmup      = 4;
+    for (I2cDevice* bus : sensors) {
+        Sensor s;
+        s.bus           = bus;
+        s.fetcher       = std::make_unique<SubpageFetcher>(*bus, fo, clock_);
+        s.stats.address = bus->address();
+        sensors_.push_back(std::move(s));
+    }
+    originNs_     = clock_.now();
+    windowNs_     = originNs_;
+    restartLagNs_ = opt_.periodNs;   // the restarted measurement takes one period
+}
+
+int64_t StaggerCoordinator::wrap(int64_t ns) const
+{
+    const int64_t p = opt_.periodNs;
+    return ((ns % p) + p + p / 2) % p - p / 2;
+}
+
+int64_t StaggerCoordinator::phaseOf(const Sensor& s) const
+{
+    const int64_t p = opt_.periodNs;
+    return ((s.fetcher->lastReadyNs() - originNs_) % p + p) % p;
+}
+
+int StaggerCoordinator::next(uint16_t* words, FetchResult* result)
+{
+    const int64_t deadline = clock_.now() + 4 * opt_.periodNs;
+    const int64_t hold     = burstNs_ + opt_.pollNs;   // no burst may start this close to a restart
+
+    for (;;) {
+        const int64_t now = clock_.now();
+        if (now > deadline) {
+            return -2;
+        }
+
+        Sensor* rephase = nullptr;
+        for (auto& s : sensors_) {
+            if (s.restartAtNs >= 0 && (!rephase || s.restartAtNs < rephase->restartAtNs)) rephase = &s;
+        }
+        if (rephase && rephase->restartAtNs - now <= hold) {
+            if (rephase->restartAtNs > now) {
+                clock_.sleep(rephase->restartAtNs - now);
+            }
+            if (!restart(*rephase)) {
+                return -1;
+            }
+            continue;
+        }
+
+        Sensor* ready = nullptr;
+        for (auto& s : sensors_) {
+            if (s.readyAtNs >= 0 && (!ready || s.readyAtNs < ready->readyAtNs)) ready = &s;
+        }
+        if (ready) {
+            Sensor& s = *ready;
+            const int64_t t0 = clock_.now();
+            const FetchResult r = s.fetcher->collect(words);
+            const int64_t t1 = clock_.now();
+            busNs_ += t1 - t0;
+            s.readyAtNs = -1;
+            if (r.subpage < 0) {
+                ++s.stats.failures;
+                s.dueNs = t1 + opt_.pollNs;
+                return -1;
+            }
+            burstNs_ = std::max(burstNs_, t1 - t0);
+            ++s.stats.subpages;
+            s.stats.overruns += r.overrun ? 1 : 0;
+
+            const SubpageFetcher& f = *s.fetcher;
+            if (f.locked()) {
+                // A flag raised during another sensor's burst is only seen
+                // after it; the model still places it where it was raised
+                s.stats.queuedNs += std::max<int64_t>(t0 - f.lastReadyNs(), 0);
+                // Bracket the next flag: one probe just before it is due
+                s.dueNs         = f.lastReadyNs() + f.periodNs() - opt_.pollNs;
+                s.stats.phaseNs = phaseOf(s);
+            } else {
+                s.dueNs = t1 + opt_.pollNs;
+            }
+            if (result) {
+                *result = r;
+            }
+            check();
+            return static_cast<int>(&s - sensors_.data());
+        }
+
+        // When one sensor is due, probe them all: a sensor whose flag rises
+        // now must be seen now, not after the burst that is about to start
+        bool any = false;
+        for (const auto& s : sensors_) {
+            any = any || (s.readyAtNs < 0 && s.dueNs <= now);
+        }
+        bool found = false;
+        for (auto& s : sensors_) {
+            if (!any || s.readyAtNs >= 0) continue;
+            const int64_t t0 = clock_.now();
+            const int     p  = s.fetcher->probe();
+            busNs_ += clock_.now() - t0;
+            if (p < 0) {
+                ++s.stats.failures;
+                s.dueNs = t0 + opt_.pollNs;
+                return -1;
+            }
+            if (p > 0) {
+                s.readyAtNs = t0;
+                found       = true;
+            } else {
+                s.dueNs = std::max(s.dueNs, t0 + opt_.pollNs);
+            }
+        }
+        if (found) {
+            continue;
+        }
+
+        int64_t wake = std::numeric_limits<int64_t>::max();
+        for (const auto& s : sensors_) {
+            wake = std::min(wake, s.dueNs);
+            if (s.restartAtNs >= 0) wake = std::min(wake, s.restartAtNs - hold);
+        }
+        const int64_t t = clock_.now();
+        if (wake > t) {
+            clock_.sleep(std::min(wake, deadline + 1) - t);
+        }
+    }
+}
+
+bool StaggerCoordinator::restart(Sensor& s)
+{
+    // Rewriting CTRL1 with its own value is assumed to restart the
+    // measurement; check() verifies that it did
+    const uint8_t reg[2] = {static_cast<uint8_t>(CTRL1_REG >> 8), static_cast<uint8_t>(CTRL1_REG & 0xFF)};
+    uint8_t ctrl[2] = {};
+    const int64_t t0 = clock_.now();
+    bool ok = s.bus->writeThenRead(reg, 2, ctrl, 2);
+    if (ok) {
+        const uint8_t tx[4] = {reg[0], reg[1], ctrl[0], ctrl[1]};
+        ok = s.bus->writeBytes(tx, 4);
+    }
+    busNs_ += clock_.now() - t0;
+    s.restartAtNs = -1;
+    if (!ok) {
+        ++s.stats.failures;
+        s.targetNs = -1;
+        std::cerr << "[Stagger] failed to restart sensor 0x" << std::hex << int(s.stats.address)
+                  << std::dec << "\n";
+        return false;
+    }
+    ++s.stats.rephases;
+    s.fetcher->setPeriod(opt_.periodNs);
+    s.dueNs = t0;                        // a subpage from before the restart may be waiting
+    return true;
+}
+
+void StaggerCoordinator::check()
+{
+    if (!opt_.enabled || sensors_.size() < 2 || ++sinceCheck_ < opt_.checkEvery) {
+        return;
+    }
+    for (const auto& s : sensors_) {
+        if (!s.fetcher->locked() || s.restartAtNs >= 0) {
+            return;                      // wait until every phase is measured
+        }
+    }
+    sinceCheck_ = 0;
+
+    const size_t  n    = sensors_.size();
+    const int64_t slot = opt_.periodNs / static_cast<int64_t>(n);
+    const int64_t tol  = static_cast<int64_t>(opt_.tolerance * slot);
+
+    // Where the re-phased sensors landed against where they were sent. A
+    // phase that stayed put means the write did not restart the sensor.
+    for (auto& s : sensors_) {
+        if (s.targetNs < 0) continue;
+        const int64_t moved = wrap(phaseOf(s) - s.fromNs);
+        const int64_t err   = wrap(phaseOf(s) - s.targetNs);
+        if (2 * std::llabs(moved) < std::llabs(wrap(s.targetNs - s.fromNs))) {
+            if (++s.missed >= MAX_MISSED_REPHASES && !s.stats.rephaseOff) {
+                s.stats.rephaseOff = true;
+                std::cerr << "[Stagger] rewriting CTRL1 did not move the ready phase of sensor 0x"
+                          << std::hex << int(s.stats.address) << std::dec << "; no longer re-phasing it\n";
+            }
+        } else {
+            s.missed = 0;
+            if (std::llabs(err) < slot / 2) {
+                restartLagNs_ += err / 2;
+            }
+        }
+        s.targetNs = -1;
+    }
+
+    // Keep the circular order; try each sensor as the anchor of the evenly
+    // spaced targets and take the one that moves fewest (then least).
+    // Sensors that cannot be re-phased must not be asked to move.
+    std::vector<int64_t> phase(n);
+    std::vector<size_t>  order(n);
+    for (size_t i = 0; i < n; ++i) phase[i] = phaseOf(sensors_[i]);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return phase[a] < phase[b]; });
+
+    size_t  bestAnchor = 0, bestMoves = n + 1;
+    int64_t bestDev    = std::numeric_limits<int64_t>::max();
+    for (size_t a = 0; a < n; ++a) {
+        size_t  moves = 0;
+        int64_t dev   = 0;
+        for (size_t k = 0; k < n; ++k) {
+            const int64_t d = std::llabs(wrap(phase[order[(a + k) % n]] - phase[order[a]] -
+                                              static_cast<int64_t>(k) * slot));
+            if (d > tol) moves += sensors_[order[(a + k) % n]].stats.rephaseOff ? n + 1 : 1;
+            dev   += d;
+        }
+        if (moves < bestMoves || (moves == bestMoves && dev < bestDev)) {
+            bestAnchor = a;
+            bestMoves  = moves;
+            bestDev    = dev;
+        }
+    }
+    for (size_t k = 0; k < n; ++k) {
+        const size_t  i      = order[(bestAnchor + k) % n];
+        const int64_t target = phase[order[bestAnchor]] + static_cast<int64_t>(k) * slot;
+        if (std::llabs(wrap(phase[i] - target)) > tol && !sensors_[i].stats.rephaseOff) {
+            schedule(sensors_[i], target);
+        }
+    }
+}
+
+void StaggerCoordinator::schedule(Sensor& s, int64_t targetNs)
+{
+    // Restart at t with (t + lag - origin) = target (mod P), far enough
+    // ahead that the burst in progress and one poll fit before it
+    const int64_t p        = opt_.periodNs;
+    const int64_t target   = (targetNs % p + p) % p;
+    const int64_t earliest = clock_.now() + burstNs_ + 2 * opt_.pollNs;
+    const int64_t offset   = ((target - restartLagNs_ - (earliest - originNs_)) % p + p) % p;
+    s.restartAtNs = earliest + offset;
+    s.targetNs    = target;
+    s.fromNs      = phaseOf(s);
+
+    char line[96];
+    std::snprintf(line, sizeof line, "[Stagger] 0x%02x ready phase %.2f ms -> %.2f ms\n",
+                  s.stats.address, phaseOf(s) / 1e6, target / 1e6);
+    std::clog << line;
+}
+
+StaggerStats StaggerCoordinator::stats() const
+{
+    StaggerStats out;
+    out.elapsedNs = clock_.now() - windowNs_;
+    out.busNs     = busNs_;
+    for (const auto& s : sensors_) {
+        out.sensors.push_back(s.stats);
+    }
+    return out;
+}
+
+void StaggerCoordinator::resetStats()
+{
+    windowNs_ = clock_.now();
+    busNs_    = 0;
+    for (auto& s : sensors_) {
+        const StaggerSensorStats keep = s.stats;
+        s.stats            = {};
+        s.stats.address    = keep.address;
+        s.stats.phaseNs    = keep.phaseNs;
+        s.stats.rephaseOff = keep.rephaseOff;
+    }
+}
+
+} // namespace duosight
@@ -0,0 +1,324 @@
+/**
+ * @file subpageFetcher.cpp
+ * @brief Clock model, speculative bursts and polling fallback.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A speculative burst is one I2C_RDWR of six messages (address + read
+ *   for STATUS, RAM and CTRL1). NEW_DATA_READY is cleared only after a
+ *   hit, once the data is in hand, so a miss cannot swallow a flag raised
+ *   just after its STATUS read.
+ */
+
+#include "subpageFetcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace duosight {
+
+namespace {
+
+constexpr uint16_t RAM_BASE  = 0x0400;
+constexpr uint16_t CTRL1_REG = 0x800D;
+constexpr int      RAM_WORDS = 832;
+
+inline uint16_t be16(const uint8_t* b) { return static_cast<uint16_t>((b[0] << 8) | b[1]); }
+
+} // namespace
+
+SubpageFetcher::SubpageFetcher(I2cDevice& bus, const FetchOptions& options, FetchClock clock)
+    : bus_(bus), opt_(options), clock_(std::move(clock))
+{
+    if (!clock_.now) {
+        clock_.now = [] {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+    }
+    if (!clock_.sleep) {
+        clock_.sleep = [](int64_t ns) { std::this_thread::sleep_for(std::chrono::nanoseconds(ns)); };
+    }
+    opt_.window = std::max<uint32_t>(opt_.window, 1);
+    setPeriod(opt_.periodNs);
+}
+
+void SubpageFetcher::setPeriod(int64_t periodNs)
+{
+    opt_.periodNs = std::max<int64_t>(periodNs, 1'000'000);
+    period_       = static_cast<double>(opt_.periodNs);
+    locked_       = false;
+    anchored_     = false;
+    brackets_     = 0;
+    missStreak_   = 0;
+    seenNotReady_ = false;
+    predicted_    = 0;
+    speculating_  = opt_.speculative;
+    windowTries_  = 0;
+    windowHits_   = 0;
+    backoffLeft_  = 0;
+}
+
+bool SubpageFetcher::readStatus(uint16_t& status)
+{
+    uint8_t tx[2] = {static_cast<uint8_t>(Status::REG >> 8), static_cast<uint8_t>(Status::REG & 0xFF)};
+    uint8_t rx[2] = {};
+    ++stats_.transactions;
+    ++stats_.statusPolls;
+    if (!bus_.writeThenRead(tx, 2, rx, 2)) {
+        return false;
+    }
+    status = be16(rx);
+    return true;
+}
+
+bool SubpageFetcher::readBlock(uint16_t* words)
+{
+    uint8_t ramReg[2]  = {static_cast<uint8_t>(RAM_BASE >> 8), static_cast<uint8_t>(RAM_BASE & 0xFF)};
+    uint8_t ctrlReg[2] = {static_cast<uint8_t>(CTRL1_REG >> 8), static_cast<uint8_t>(CTRL1_REG & 0xFF)};
+    uint8_t ctrl[2]    = {};
+    I2cMessage msgs[4] = {{false, ramReg, 2}, {true, ramBytes_.data(), ramBytes_.size()},
+                          {false, ctrlReg, 2}, {true, ctrl, 2}};
+    ++stats_.transactions;
+    if (!bus_.transfer(msgs, 4)) {
+        return false;
+    }
+    for (int i = 0; i < RAM_WORDS; ++i) words[i] = be16(&ramBytes_[2 * i]);
+    words[RAM_WORDS] = be16(ctrl);
+    return true;
+}
+
+bool SubpageFetcher::speculate(uint16_t& status, uint16_t* words)
+{
+    uint8_t statusReg[2] = {static_cast<uint8_t>(Status::REG >> 8), static_cast<uint8_t>(Status::REG & 0xFF)};
+    uint8_t ramReg[2]    = {static_cast<uint8_t>(RAM_BASE >> 8), static_cast<uint8_t>(RAM_BASE & 0xFF)};
+    uint8_t ctrlReg[2]   = {static_cast<uint8_t>(CTRL1_REG >> 8), static_cast<uint8_t>(CTRL1_REG & 0xFF)};
+    uint8_t st[2] = {}, ctrl[2] = {};
+    I2cMessage msgs[6] = {{false, statusReg, 2}, {true, st, 2},
+                          {false, ramReg, 2},    {true, ramBytes_.data(), ramBytes_.size()},
+                          {false, ctrlReg, 2},   {true, ctrl, 2}};
+    ++stats_.transactions;
+    if (!bus_.transfer(msgs, 6)) {
+        return false;
+    }
+    status = be16(st);
+    if (status & Status::NEW_DATA_READY) {
+        for (int i = 0; i < RAM_WORDS; ++i) words[i] = be16(&ramBytes_[2 * i]);
+        words[RAM_WORDS] = be16(ctrl);
+    }
+    return true;
+}
+
+bool SubpageFetcher::clearReady()
+{
+    // Same value MLX90640_GetFrameData writes: keep the step-mode bits,
+    // clear NEW_DATA_READY and OVERRUN
+    const uint8_t tx[4] = {static_cast<uint8_t>(Status::REG >> 8), static_cast<uint8_t>(Status::REG & 0xFF),
+                           0x00, 0x30};
+    ++stats_.transactions;
+    return bus_.writeBytes(tx, 4);
+}
+
+void SubpageFetcher::learn(int64_t readyLo, int64_t readyHi, int64_t guessNs)
+{
+    // A narrow bracket (polls either side of the flag) pins the ready time
+    // to its midpoint. The period is measured against the first bracket, so
+    // its error shrinks with every subpage in between; a bracket far off the
+    // fitted schedule (sensor stalled, rate changed) starts a new baseline.
+    // A wide one (a missed burst, then the poll after it) says little; the
+    // model's own prediction, kept inside the bracket, is the better guess.
+    const int64_t width = readyHi - readyLo;
+    if (width > 2 * opt_.pollNs) {
+        lastReadyNs_ = std::clamp(guessNs, readyLo, readyHi);
+        return;
+    }
+    const int64_t estimate = readyLo + width / 2;
+    if (anchored_) {
+        const double  span = static_cast<double>(estimate - anchorNs_);
+        const int64_t n    = std::llround(span / period_);
+        const double  off  = span - static_cast<double>(n) * period_;
+        if (n >= 1 && std::fabs(off) < period_ / 8) {
+            const double measured = span / static_cast<double>(n);
+            if (std::fabs(measured - opt_.periodNs) < 0.1 * opt_.periodNs) {
+                period_ = measured;
+            }
+        } else if (n != 0) {
+            anchorNs_ = estimate;
+            brackets_ = 0;
+        }
+    } else {
+        anchorNs_ = estimate;
+        anchored_ = true;
+    }
+    ++brackets_;
+    lastReadyNs_ = estimate;
+    locked_      = brackets_ >= opt_.warmup;
+}
+
+void SubpageFetcher::track(bool hit)
+{
+    // Phase steps alone settle at MISS_STEPS hits per miss only if the
+    // period is right; this integral term takes out what the brackets left
+    // of the period error. A hit means the model ran late, a miss early.
+    const double k = static_cast<double>(stepNs()) / 8.0;
+    period_ += hit ? -k / MISS_STEPS : k;
+    period_  = std::clamp(period_, 0.9 * opt_.periodNs, 1.1 * opt_.periodNs);
+    missStreak_ = hit ? 0 : missStreak_;
+}
+
+void SubpageFetcher::account(bool hit)
+{
+    hit ? ++stats_.hits : ++stats_.misses;
+    ++windowTries_;
+    windowHits_ += hit ? 1 : 0;
+    if (windowTries_ < opt_.window) {
+        return;
+    }
+    const double rate = static_cast<double>(windowHits_) / windowTries_;
+    windowTries_ = windowHits_ = 0;
+    if (rate < opt_.minHitRate) {
+        speculating_ = false;
+        backoffLeft_ = opt_.backoff;
+        ++stats_.fallbacks;
+        std::clog << "[Fetch] speculation hit rate " << static_cast<int>(rate * 100)
+                  << "%, polling for " << opt_.backoff << " subpages\n";
+    }
+}
+
+FetchResult SubpageFetcher::fetch(uint16_t* words)
+{
+    FetchResult r;
+    const int64_t deadline = clock_.now() + opt_.timeoutPeriods * opt_.periodNs;
+
+    if (speculating_ && locked_) {
+        int64_t predicted = lastReadyNs_ + static_cast<int64_t>(period_);
+        const int64_t now = clock_.now();
+        if (predicted > now) {
+            clock_.sleep(predicted - now);
+        }
+        const int64_t t = clock_.now();
+        uint16_t status = 0;
+        if (!speculate(status, words)) {
+            r.subpage = -1;
+            return r;
+        }
+        const bool hit = status & Status::NEW_DATA_READY;
+        track(hit);
+        if (hit) {
+            r.dataNs     = clock_.now();
+            r.detectNs   = t;
+            r.speculated = true;
+            r.overrun    = status & Status::OVERRUN;
+            r.subpage    = status & Status::SUBPAGE_MASK;
+            words[RAM_WORDS + 1] = static_cast<uint16_t>(r.subpage);
+            if (!clearReady()) {
+                r.subpage = -1;
+                return r;
+            }
+            // Ready at or before t: probe a step earlier next time
+            lastReadyNs_ = t - stepNs();
+            account(true);
+            ++stats_.subpages;
+            stats_.detectToDataNs += r.dataNs - r.detectNs;
+            return r;
+        }
+        // Ready after t: assume later next time, doubling the jump while
+        // misses keep coming (a stall or a large phase error)
+        predicted   += std::min<int64_t>((MISS_STEPS * stepNs()) << std::min<uint32_t>(missStreak_, 6),
+                                         opt_.periodNs / 4);
+        ++missStreak_;
+        seenNotReady_ = true;
+        notReadyAt_   = t;
+        predicted_    = predicted;
+        account(false);
+    }
+
+    for (;;) {
+        if (clock_.now() > deadline) {
+            r.subpage = -2;
+            return r;
+        }
+        r = poll(words);
+        if (r.subpage != FetchResult::NOT_READY) {
+            return r;
+        }
+        clock_.sleep(opt_.pollNs);
+    }
+}
+
+int SubpageFetcher::probe()
+{
+    const int64_t t = clock_.now();
+    uint16_t status = 0;
+    if (!readStatus(status)) {
+        return -1;
+    }
+    if (!(status & Status::NEW_DATA_READY)) {
+        seenNotReady_ = true;
+        notReadyAt_   = t;
+        return 0;
+    }
+    if (!readySeen_) {
+        readySeen_ = true;
+        readyAt_   = t;
+    }
+    readyStatus_ = status;
+    return 1;
+}
+
+FetchResult SubpageFetcher::collect(uint16_t* words)
+{
+    FetchResult r;
+    if (!readySeen_) {
+        r.subpage = FetchResult::NOT_READY;
+        return r;
+    }
+    readySeen_ = false;
+    const int64_t t = readyAt_;
+    if (!clearReady() || !readBlock(words)) {
+        r.subpage = -1;
+        return r;
+    }
+    r.dataNs   = clock_.now();
+    r.detectNs = t;
+    r.overrun  = readyStatus_ & Status::OVERRUN;
+    r.subpage  = readyStatus_ & Status::SUBPAGE_MASK;
+    words[RAM_WORDS + 1] = static_cast<uint16_t>(r.subpage);
+
+    if (seenNotReady_) {
+        const int64_t guess = predicted_ ? predicted_
+                            : locked_    ? lastReadyNs_ + static_cast<int64_t>(period_)
+                                         : t;
+        learn(notReadyAt_, t, guess);
+    } else if (!locked_) {
+        lastReadyNs_ = t;                // ready for a while; no timing information
+    } else {
+        lastReadyNs_ += static_cast<int64_t>(period_);
+    }
+    seenNotReady_ = false;
+    predicted_    = 0;
+    ++stats_.subpages;
+    stats_.detectToDataNs += r.dataNs - r.detectNs;
+    if (!speculating_ && opt_.speculative && backoffLeft_ > 0 && --backoffLeft_ == 0) {
+        speculating_ = true;
+    }
+    return r;
+}
+
+FetchResult SubpageFetcher::poll(uint16_t* words)
+{
+    FetchResult r;
+    switch (probe()) {
+    case 1:  return collect(words);
+    case 0:  r.subpage = FetchResult::NOT_READY; return r;
+    default: r.subpage = -1; return r;
+    }
+}
+
+} // namespace duosight
@@ -0,0 +1,128 @@
+/**
+ * @file syntheticScene.cpp
+ * @brief Inverse radiometric model for SyntheticScene.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Auxiliary words are solved in the order the Melexis API reads them
+ *   (Vdd, then Ta from PTAT/Vbe, gain, compensation pixels), so the terms
+ *   PixelConverter::prepare() derives from them equal the configured
+ *   values. Pixel words then come from PixelConverter::signalBound(),
+ *   the exact inverse of the per-pixel conversion.
+ */
+
+#include "syntheticScene.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace duosight {
+
+namespace {
+constexpr double TA_VBE_NOMINAL = 19000.0;   // typical Ta_Vbe reading
+
+uint16_t toWord(double v)
+{
+    const double r = std::nearbyint(std::clamp(v, -32768.0, 32767.0));
+    return static_cast<uint16_t>(static_cast<int16_t>(r));
+}
+} // namespace
+
+SyntheticScene::SyntheticScene(const paramsMLX90640& params, const SceneConfig& cfg)
+    : params_(params), conv_(params), cfg_(cfg),
+      rng_(cfg.seed), noise_(0.0f, std::max(cfg.noiseC, 0.0f))
+{
+    subpagePeriod_ = refresh::TABLE[cfg_.refreshCode & 0x07].sec_subpage;
+
+    std::uniform_real_distribution<float> px(0.0f, Geometry::WIDTH - 1.0f);
+    std::uniform_real_distribution<float> py(0.0f, Geometry::HEIGHT - 1.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    for (int i = 0; i < cfg_.blobs; ++i) {
+        const float a = angle(rng_);
+        blobs_.push_back({px(rng_), py(rng_),
+                          cfg_.blobSpeed * std::cos(a), cfg_.blobSpeed * std::sin(a)});
+    }
+}
+
+void SyntheticScene::renderField(double t)
+{
+    const float base = cfg_.backgroundC + static_cast<float>(cfg_.sceneDriftCPerSec * t);
+    const float inv2s2 = 1.0f / (2.0f * cfg_.blobRadius * cfg_.blobRadius);
+
+    for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
+        for (int col = 0; col < static_cast<int>(Geometry::WIDTH); ++col) {
+            float v = base + cfg_.gradientCPerCol * col + cfg_.gradientCPerRow * row;
+            for (const Blob& b : blobs_) {
+                const float dx = col - b.x;
+                const float dy = row - b.y;
+                v += (cfg_.blobPeakC - base) * std::exp(-(dx * dx + dy * dy) * inv2s2);
+            }
+            truth_[row * Geometry::WIDTH + col] = v;
+        }
+    }
+}
+
+void SyntheticScene::writeAux(uint16_t* w, int sp, float ta) const
+{
+    const auto& p = params_;
+
+    // CTRL1: subpages enabled, refresh, resolution, pattern
+    w[832] = static_cast<uint16_t>(0x0001 | ((cfg_.refreshCode << refresh::SHIFT) & refresh::MASK)
+                                   | ((cfg_.resolution & 0x03) << 10)
+                                   | (cfg_.chess ? 0x1000 : 0x0000));
+    w[833] = static_cast<uint16_t>(sp);
+
+    // Vdd = (rc * raw - vdd25) / kVdd + 3.3
+    const double rc  = std::pow(2.0, p.resolutionEE) / std::pow(2.0, cfg_.resolution & 0x03);
+    w[810] = toWord(((cfg_.vdd - 3.3) * p.kVdd + p.vdd25) / rc);
+    const float vdd = MLX90640_GetVdd(w, &p);     // exact value the API will see
+
+    // Ta from PTAT: ptatArt = ptat / (ptat * alphaPTAT + vbe) * 2^18.
+    // One PTAT count is ~0.1 °C, so round PTAT first and solve Vbe (about
+    // 100x finer) for the remainder.
+    const double ptatArt = ((ta - 25.0) * p.KtPTAT + p.vPTAT25) * (1 + p.KvPTAT * (vdd - 3.3));
+    const double q       = ptatArt / 262144.0;
+    const double ptat    = std::nearbyint(q * TA_VBE_NOMINAL / (1.0 - q * p.alphaPTAT));
+    w[800] = toWord(ptat);
+    w[768] = toWord(ptat * (1.0 / q - p.alphaPTAT));
+    const float taSeen = MLX90640_GetTa(w, &p);
+
+    // Unity gain; compensation pixels read their own offset (zero signal)
+    w[778] = toWord(p.gainEE);
+    const double cpScale = (1 + p.cpKta * (taSeen - 25)) * (1 + p.cpKv * (vdd - 3.3));
+    const bool   calib   = (cfg_.chess ? 128 : 0) == p.calibrationModeEE;
+    w[776] = toWord(p.cpOffset[0] * cpScale);
+    w[808] = toWord((p.cpOffset[1] + (calib ? 0.0f : p.ilChessC[0])) * cpScale);
+}
+
+void SyntheticScene::nextSubpage(uint16_t* words)
+{
+    subpage_  = 1 - subpage_;
+    timeSec_ += subpagePeriod_;
+
+    for (Blob& b : blobs_) {
+        b.x += b.vx * static_cast<float>(subpagePeriod_);
+        b.y += b.vy * static_cast<float>(subpagePeriod_);
+        if (b.x < 0 || b.x > Geometry::WIDTH - 1)  { b.vx = -b.vx; b.x = std::clamp(b.x, 0.0f, Geometry::WIDTH - 1.0f); }
+        if (b.y < 0 || b.y > Geometry::HEIGHT - 1) { b.vy = -b.vy; b.y = std::clamp(b.y, 0.0f, Geometry::HEIGHT - 1.0f); }
+    }
+    renderField(timeSec_);
+
+    const float ta = cfg_.ambientC + static_cast<float>(cfg_.ambientDriftCPerSec * timeSec_);
+    writeAux(ram_.data(), subpage_, ta);
+
+    const SubpageTerms t = conv_.prepare(ram_.data(), cfg_.emissivity);
+    const float cp = conv_.tgc() * t.irDataCP;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (!conv_.inSubpage(p, t)) continue;
+        const float target = truth_[p] + (cfg_.noiseC > 0.0f ? noise_(rng_) : 0.0f);
+        ram_[p] = toWord((conv_.signalBound(p, t, target) + cp) / t.gain);
+    }
+
+    std::copy(ram_.begin(), ram_.end(), words);
+}
+
+} // namespace duosight
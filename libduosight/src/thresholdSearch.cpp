@@ -0,0 +1,116 @@
+/**
+ * @file thresholdSearch.cpp
+ * @brief Implementation of the bounded early-out temperature search.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   The screen is a straight loop over float arrays with no data-dependent
+ *   work, which the compiler vectorises well on both NEON and SSE.
+ *   Everything expensive happens on candidates only.
+ */
+
+#include "thresholdSearch.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace duosight {
+
+ThresholdSearch::ThresholdSearch(const PixelConverter& converter, float guardC)
+    : conv_(converter), guardC_(guardC)
+{
+}
+
+void ThresholdSearch::screen(const uint16_t* words, const SubpageTerms& t)
+{
+    if (!valid_ || calib_ != t.calibMode ||
+        std::fabs(t.ta - ta_) > TA_EPSILON || std::fabs(t.vdd - vdd_) > VDD_EPSILON) {
+        const float* alpha = conv_.coefficients().alpha;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            offset_[p]   = static_cast<float>(conv_.boundOffset(p, t));
+            invAlpha_[p] = 1.0f / alpha[p];
+        }
+        valid_ = true;
+        ta_    = t.ta;
+        vdd_   = t.vdd;
+        calib_ = t.calibMode;
+        ++stats_.rebuilds;
+    }
+    constexpr float NONE = -std::numeric_limits<float>::infinity();
+    if (!haveOwn_ || chess_ != t.chessMode) {
+        SubpageTerms probe = t;
+        for (int sp = 0; sp < 2; ++sp) {
+            probe.subpage = sp;
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                own_[sp][p] = conv_.inSubpage(p, probe) ? 0.0f : NONE;
+            }
+        }
+        chess_   = t.chessMode;
+        haveOwn_ = true;
+    }
+
+    // Pixel reads at least T when raw * gain - tgc * CP >= bound(T), i.e.
+    // when its level reaches boundScale(T)
+    const float gain = t.gain;
+    const float cp   = conv_.tgc() * t.irDataCP;
+    const float* own = own_[t.subpage & 1].data();
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        const float signal = static_cast<float>(static_cast<int16_t>(words[p])) * gain - cp;
+        level_[p] = (signal - offset_[p]) * invAlpha_[p] + own[p];
+    }
+    ++stats_.subpages;
+    stats_.screened += Geometry::PIXELS / 2;
+}
+
+size_t ThresholdSearch::overThreshold(const uint16_t* words, float thresholdC,
+                                      std::vector<ThresholdHit>& hits)
+{
+    const SubpageTerms t = conv_.prepare(words);
+    screen(words, t);
+
+    const float bound = static_cast<float>(conv_.boundScale(t, thresholdC - guardC_));
+    size_t n = 0;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (level_[p] < bound) continue;
+        const float temp = conv_.toTemperature(words, t, p);
+        ++stats_.converted;
+        if (temp >= thresholdC) {
+            hits.push_back({p, temp});
+            ++n;
+        }
+    }
+    return n;
+}
+
+ThresholdHit ThresholdSearch::hottest(const uint16_t* words)
+{
+    const SubpageTerms t = conv_.prepare(words);
+    screen(words, t);
+
+    int top = 0;
+    for (int p = 1; p < Geometry::PIXELS; ++p) {
+        if (level_[p] > level_[top]) top = p;
+    }
+    ThresholdHit best {top, conv_.toTemperature(words, t, top)};
+    ++stats_.converted;
+
+    // Every pixel below the bound is colder than best; the bound follows
+    // best up as hotter pixels turn up. Ties go to the lower index, as in
+    // a full pass.
+    float bound = static_cast<float>(conv_.boundScale(t, best.temperature - guardC_));
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        if (level_[p] < bound || p == top) continue;
+        const float temp = conv_.toTemperature(words, t, p);
+        ++stats_.converted;
+        if (temp > best.temperature || (temp == best.temperature && p < best.pixel)) {
+            best  = {p, temp};
+            bound = static_cast<float>(conv_.boundScale(t, best.temperature - guardC_));
+        }
+    }
+    return best;
+}
+
+} // namespace duosight
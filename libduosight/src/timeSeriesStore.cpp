@@ -0,0 +1,789 @@
+/**
+ * @file timeSeriesStore.cpp
+ * @brief Block format, bit-level codecs and tier roll-up for TimeSeriesStore.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Block 0 holds the file header and series table; every other block
+ *   starts with a BlockHeader followed by an MSB-first bit stream:
+ *
+ *     timestamp  first in the header, then delta-of-delta in buckets
+ *                '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+32 bits
+ *     Xor        first value raw (32 bits), then '0' for a repeat, or '1'
+ *                and the XOR's meaningful bits, reusing the previous
+ *                leading/trailing-zero window when it fits ('10') or
+ *                sending a new one ('11' + 5-bit lead + 5-bit length)
+ *     FixedPoint round(v / quantum) delta-coded with the timestamp buckets
+ *
+ *   A block is sealed when the worst-case next point would not fit, so
+ *   every block decodes on its own. On open, the newest block of each
+ *   column is decoded once to recover the encoder state, and the open
+ *   tier buckets are rebuilt from the samples after the last emitted one.
+ */
+
+#include "timeSeriesStore.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace duosight {
+
+namespace {
+
+constexpr char     FILE_MAGIC[8]  = {'D', 'S', 'T', 'S', 'D', 'B', '1', '\0'};
+constexpr uint32_t FILE_VERSION   = 1;
+constexpr uint32_t BLOCK_MAGIC    = 0x4B4C4254;   // "TBLK"
+constexpr size_t   GROW_BLOCKS    = 256;          // minimum file growth (1 MiB)
+
+struct SeriesRecord {
+    char     name[TimeSeriesStore::NAME_BYTES];
+    uint8_t  encoding;
+    uint8_t  pad[3];
+    float    quantum;
+};
+
+struct FileHeader {
+    char         magic[8];
+    uint32_t     version;
+    uint32_t     blockBytes;
+    uint32_t     seriesCount;
+    uint32_t     reserved;
+    uint64_t     blockCount;   // blocks in use, header block included
+    SeriesRecord series[TimeSeriesStore::MAX_SERIES];
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint16_t column;
+    uint16_t reserved;
+    uint32_t count;
+    uint32_t bits;        // payload bits written
+    int64_t  firstMs;
+    int64_t  lastMs;
+    float    minValue;    // over finite values; +inf/-inf while none
+    float    maxValue;
+};
+
+static_assert(sizeof(FileHeader) <= TimeSeriesStore::BLOCK_BYTES, "series table exceeds block 0");
+static_assert(sizeof(BlockHeader) == 40, "block header layout changed");
+
+constexpr uint32_t PAYLOAD_BITS   = (TimeSeriesStore::BLOCK_BYTES - sizeof(BlockHeader)) * 8;
+constexpr uint32_t MAX_POINT_BITS = (4 + 32) + (2 + 5 + 5 + 32);   // timestamp + Xor worst case
+
+BlockHeader* headerOf(uint8_t* blk) { return reinterpret_cast<BlockHeader*>(blk); }
+const BlockHeader* headerOf(const uint8_t* blk) { return reinterpret_cast<const BlockHeader*>(blk); }
+
+// ── Bit stream ──────────────────────────────────────────────────
+
+void putBits(uint8_t* buf, uint32_t& pos, uint64_t value, int n)
+{
+    while (n > 0) {
+        const int free = 8 - static_cast<int>(pos & 7);
+        const int take = std::min(free, n);
+        const uint8_t bits = static_cast<uint8_t>((value >> (n - take)) & ((1u << take) - 1));
+        buf[pos >> 3] |= static_cast<uint8_t>(bits << (free - take));
+        pos += take;
+        n   -= take;
+    }
+}
+
+uint64_t getBits(const uint8_t* buf, uint32_t& pos, int n)
+{
+    // Fast path: one big-endian 64-bit load covers any field up to 56 bits.
+    if ((pos >> 3) + 8 <= PAYLOAD_BITS / 8) {
+        uint64_t word;
+        std::memcpy(&word, buf + (pos >> 3), sizeof(word));
+        word = __builtin_bswap64(word) << (pos & 7);
+        pos += n;
+        return word >> (64 - n);
+    }
+
+    uint64_t value = 0;
+    while (n > 0) {
+        const int avail = 8 - static_cast<int>(pos & 7);
+        const int take  = std::min(avail, n);
+        const uint8_t bits = (buf[pos >> 3] >> (avail - take)) & ((1u << take) - 1);
+        value = (value << take) | bits;
+        pos += take;
+        n   -= take;
+    }
+    return value;
+}
+
+bool fitsInt32(int64_t v)
+{
+    return v >= std::numeric_limits<int32_t>::min() && v <= std::numeric_limits<int32_t>::max();
+}
+
+void putSigned(uint8_t* buf, uint32_t& pos, int64_t v)
+{
+    if (v == 0) {
+        putBits(buf, pos, 0b0, 1);
+    } else if (v >= -63 && v <= 64) {
+        putBits(buf, pos, 0b10, 2);
+        putBits(buf, pos, static_cast<uint64_t>(v + 63), 7);
+    } else if (v >= -255 && v <= 256) {
+        putBits(buf, pos, 0b110, 3);
+        putBits(buf, pos, static_cast<uint64_t>(v + 255), 9);
+    } else if (v >= -2047 && v <= 2048) {
+        putBits(buf, pos, 0b1110, 4);
+        putBits(buf, pos, static_cast<uint64_t>(v + 2047), 12);
+    } else {
+        putBits(buf, pos, 0b1111, 4);
+        putBits(buf, pos, static_cast<uint32_t>(static_cast<int32_t>(v)), 32);
+    }
+}
+
+int64_t getSigned(const uint8_t* buf, uint32_t& pos)
+{
+    if (!getBits(buf, pos, 1)) return 0;
+    if (!getBits(buf, pos, 1)) return static_cast<int64_t>(getBits(buf, pos, 7)) - 63;
+    if (!getBits(buf, pos, 1)) return static_cast<int64_t>(getBits(buf, pos, 9)) - 255;
+    if (!getBits(buf, pos, 1)) return static_cast<int64_t>(getBits(buf, pos, 12)) - 2047;
+    return static_cast<int32_t>(static_cast<uint32_t>(getBits(buf, pos, 32)));
+}
+
+uint32_t floatBits(float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits)
+{
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+int64_t quantise(float v, float quantum)
+{
+    const double q = std::nearbyint(static_cast<double>(v) / quantum);
+    return static_cast<int64_t>(std::clamp(q, -2147483648.0, 2147483647.0));
+}
+
+int64_t bucketStart(int64_t t, int64_t width)
+{
+    return t - (((t % width) + width) % width);   // floor, also for t < 0
+}
+
+} // namespace
+
+// ────────────────────────────────────────────────────────────────
+//  Open / close
+// ────────────────────────────────────────────────────────────────
+
+TimeSeriesStore::TimeSeriesStore(const std::string& path, bool readOnly)
+    : readOnly_(readOnly)
+{
+    fd_ = ::open(path.c_str(), readOnly ? O_RDONLY | O_CLOEXEC : O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "[TSDB] open " << path << " failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    struct stat st {};
+    fstat(fd_, &st);
+    const bool fresh = st.st_size == 0;
+    if (fresh && readOnly_) {
+        std::cerr << "[TSDB] " << path << " is empty\n";
+        return;
+    }
+
+    size_t bytes = static_cast<size_t>(st.st_size);
+    if (fresh) {
+        bytes = GROW_BLOCKS * BLOCK_BYTES;
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            std::cerr << "[TSDB] ftruncate failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+    }
+    if (!mapFile(bytes)) {
+        return;
+    }
+
+    auto* hdr = reinterpret_cast<FileHeader*>(base_);
+    if (fresh) {
+        std::memcpy(hdr->magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        hdr->version    = FILE_VERSION;
+        hdr->blockBytes = BLOCK_BYTES;
+        hdr->blockCount = 1;
+        return;
+    }
+
+    if (std::memcmp(hdr->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+        || hdr->version != FILE_VERSION || hdr->blockBytes != BLOCK_BYTES
+        || hdr->seriesCount > MAX_SERIES || hdr->blockCount * BLOCK_BYTES > bytes) {
+        std::cerr << "[TSDB] " << path << " is not a compatible store\n";
+        munmap(base_, mapped_);
+        base_ = nullptr;
+        return;
+    }
+
+    for (uint32_t s = 0; s < hdr->seriesCount; ++s) {
+        const SeriesRecord& rec = hdr->series[s];
+        Series series;
+        series.name             = std::string(rec.name, strnlen(rec.name, NAME_BYTES));
+        series.options.encoding = static_cast<SeriesEncoding>(rec.encoding);
+        series.options.quantum  = rec.quantum;
+        series_.push_back(std::move(series));
+    }
+    columns_.resize(series_.size() * COLUMNS_PER_SERIES);
+
+    loadIndex();
+    for (size_t s = 0; s < series_.size(); ++s) {
+        restoreBuckets(static_cast<int>(s));
+    }
+}
+
+TimeSeriesStore::~TimeSeriesStore()
+{
+    if (base_) {
+        if (!readOnly_) {
+            msync(base_, mapped_, MS_SYNC);
+        }
+        munmap(base_, mapped_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+SeriesOptions TimeSeriesStore::columnOptions(int column) const
+{
+    // Counts are small integers; keep them exact whatever the series uses.
+    const bool isCount = (column % COLUMNS_PER_SERIES) % FIELDS == 0
+                      && column % COLUMNS_PER_SERIES != 0;
+    return isCount ? SeriesOptions{} : series_[column / COLUMNS_PER_SERIES].options;
+}
+
+bool TimeSeriesStore::mapFile(size_t bytes)
+{
+    const int prot = readOnly_ ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* p = mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        std::cerr << "[TSDB] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    base_   = static_cast<uint8_t*>(p);
+    mapped_ = bytes;
+    return true;
+}
+
+bool TimeSeriesStore::reserveBlock(uint32_t& index)
+{
+    auto* hdr = reinterpret_cast<FileHeader*>(base_);
+    if ((hdr->blockCount + 1) * BLOCK_BYTES > mapped_) {
+        // Grow by an eighth (at least 1 MiB) so a long-lived file does not
+        // remap on every block.
+        const size_t grow  = std::max(GROW_BLOCKS * BLOCK_BYTES,
+                                      (mapped_ / 8 / BLOCK_BYTES) * BLOCK_BYTES);
+        const size_t bytes = mapped_ + grow;
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            std::cerr << "[TSDB] ftruncate failed: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        void* p = mremap(base_, mapped_, bytes, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            std::cerr << "[TSDB] mremap failed: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        base_   = static_cast<uint8_t*>(p);
+        mapped_ = bytes;
+        hdr     = reinterpret_cast<FileHeader*>(base_);
+    }
+    index = static_cast<uint32_t>(hdr->blockCount++);
+    return true;
+}
+
+// ────────────────────────────────────────────────────────────────
+//  Decoding
+// ────────────────────────────────────────────────────────────────
+
+namespace {
+
+/// Decodes a block from the start, calling fn(timeMs, value) until it
+/// returns false. cur ends in the encoder state after the last point read.
+template <typename Cursor, typename Fn>
+void decodeBlock(const uint8_t* blk, const SeriesOptions& opt, Cursor& cur, Fn&& fn)
+{
+    const BlockHeader* h = headerOf(blk);
+    const uint8_t* buf   = blk + sizeof(BlockHeader);
+    cur = Cursor{};
+
+    for (uint32_t i = 0; i < h->count; ++i) {
+        int64_t t;
+        if (i == 0) {
+            t = h->firstMs;
+        } else {
+            cur.prevDelta += getSigned(buf, cur.bitPos);
+            t = cur.prevMs + cur.prevDelta;
+        }
+        cur.prevMs = t;
+
+        float v;
+        if (opt.encoding == SeriesEncoding::FixedPoint) {
+            cur.prevQ += getSigned(buf, cur.bitPos);
+            v = static_cast<float>(static_cast<double>(cur.prevQ) * opt.quantum);
+        } else {
+            if (i == 0) {
+                cur.prevBits = static_cast<uint32_t>(getBits(buf, cur.bitPos, 32));
+            } else if (getBits(buf, cur.bitPos, 1)) {
+                if (getBits(buf, cur.bitPos, 1)) {
+                    cur.lead  = static_cast<uint8_t>(getBits(buf, cur.bitPos, 5));
+                    const int len = static_cast<int>(getBits(buf, cur.bitPos, 5)) + 1;
+                    cur.trail = static_cast<uint8_t>(32 - cur.lead - len);
+                }
+                const int len = 32 - cur.lead - cur.trail;
+                cur.prevBits ^= static_cast<uint32_t>(getBits(buf, cur.bitPos, len)) << cur.trail;
+            }
+            v = bitsFloat(cur.prevBits);
+        }
+        ++cur.count;
+
+        if (!fn(t, v)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+void TimeSeriesStore::loadIndex()
+{
+    const auto* hdr = reinterpret_cast<const FileHeader*>(base_);
+    for (uint64_t i = 1; i < hdr->blockCount; ++i) {
+        const BlockHeader* h = headerOf(block(static_cast<uint32_t>(i)));
+        if (h->magic != BLOCK_MAGIC || h->column >= columns_.size() || h->count == 0) {
+            std::cerr << "[TSDB] skipping damaged block " << i << "\n";
+            continue;
+        }
+        columns_[h->column].blocks.push_back({h->firstMs, h->lastMs, static_cast<uint32_t>(i)});
+        if (h->column % COLUMNS_PER_SERIES == 0) {
+            samples_ += h->count;
+        }
+    }
+
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        Column& col = columns_[c];
+        if (col.blocks.empty()) continue;
+        decodeBlock(block(col.blocks.back().index), columnOptions(static_cast<int>(c)), col.cursor,
+                    [](int64_t, float) { return true; });
+    }
+    for (size_t s = 0; s < series_.size(); ++s) {
+        const Column& raw = columns_[rawColumn(static_cast<int>(s))];
+        if (!raw.blocks.empty()) {
+            series_[s].lastMs = raw.cursor.prevMs;
+        }
+    }
+}
+
+template <typename Fn>
+void TimeSeriesStore::scanColumn(int column, int64_t fromMs, int64_t toMs, Fn&& fn) const
+{
+    const auto& blocks = columns_[column].blocks;
+    const auto  opt    = columnOptions(column);
+
+    // Blocks of one column are in time order; skip those ending before from.
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), fromMs,
+                               [](const BlockRef& b, int64_t t) { return b.lastMs < t; });
+    Cursor cur;
+    for (; it != blocks.end() && it->firstMs <= toMs; ++it) {
+        bool past = false;
+        decodeBlock(block(it->index), opt, cur, [&](int64_t t, float v) {
+            if (t > toMs) {
+                past = true;
+                return false;
+            }
+            if (t >= fromMs) {
+                fn(t, v);
+            }
+            return true;
+        });
+        if (past) break;
+    }
+}
+
+// ────────────────────────────────────────────────────────────────
+//  Series and appends
+// ────────────────────────────────────────────────────────────────
+
+int TimeSeriesStore::findSeries(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t s = 0; s < series_.size(); ++s) {
+        if (series_[s].name == name) return static_cast<int>(s);
+    }
+    return -1;
+}
+
+size_t TimeSeriesStore::seriesCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return series_.size();
+}
+
+int TimeSeriesStore::addSeries(const std::string& name, const SeriesOptions& options)
+{
+    const int existing = findSeries(name);
+    if (existing >= 0 || !isValid() || readOnly_) {
+        return existing;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (name.empty() || name.size() >= NAME_BYTES || series_.size() >= MAX_SERIES
+        || (options.encoding == SeriesEncoding::FixedPoint && !(options.quantum > 0.0f))) {
+        std::cerr << "[TSDB] cannot add series '" << name << "'\n";
+        return -1;
+    }
+
+    auto* hdr = reinterpret_cast<FileHeader*>(base_);
+    SeriesRecord& rec = hdr->series[series_.size()];
+    std::memset(&rec, 0, sizeof(rec));
+    std::memcpy(rec.name, name.data(), name.size());
+    rec.encoding = static_cast<uint8_t>(options.encoding);
+    rec.quantum  = options.quantum;
+    hdr->seriesCount = static_cast<uint32_t>(series_.size() + 1);
+
+    Series s;
+    s.name    = name;
+    s.options = options;
+    series_.push_back(std::move(s));
+    columns_.resize(series_.size() * COLUMNS_PER_SERIES);
+    return static_cast<int>(series_.size() - 1);
+}
+
+bool TimeSeriesStore::append(int series, int64_t timeMs, float value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (readOnly_ || !base_ || series < 0 || series >= static_cast<int>(series_.size())) {
+        return false;
+    }
+    Series& s = series_[series];
+    if (timeMs < s.lastMs) {
+        std::cerr << "[TSDB] " << s.name << ": timestamp " << timeMs
+                  << " before " << s.lastMs << ", dropped\n";
+        return false;
+    }
+    const bool finite = std::isfinite(value);
+    if (!finite && s.options.encoding == SeriesEncoding::FixedPoint) {
+        return false;
+    }
+
+    if (!appendColumn(rawColumn(series), timeMs, value)) {
+        return false;
+    }
+    s.lastMs = timeMs;
+    ++samples_;
+    if (finite) {
+        feedTier(series, 0, timeMs, value, value, value, 1);
+    }
+    return true;
+}
+
+bool TimeSeriesStore::appendColumn(int column, int64_t timeMs, float value)
+{
+    Column& col = columns_[column];
+    Cursor& cur = col.cursor;
+    const SeriesOptions opt = columnOptions(column);
+    const bool fixed = opt.encoding == SeriesEncoding::FixedPoint;
+    const int64_t q  = fixed ? quantise(value, opt.quantum) : 0;
+
+    bool seal = col.blocks.empty() || cur.bitPos + MAX_POINT_BITS > PAYLOAD_BITS;
+    if (!seal) {
+        const int64_t dod = (timeMs - cur.prevMs) - cur.prevDelta;
+        seal = !fitsInt32(dod) || (fixed && !fitsInt32(q - cur.prevQ));
+    }
+
+    if (seal) {
+        uint32_t index;
+        if (!reserveBlock(index)) {
+            return false;
+        }
+        BlockHeader* h = headerOf(block(index));
+        std::memset(block(index), 0, BLOCK_BYTES);
+        h->magic    = BLOCK_MAGIC;
+        h->column   = static_cast<uint16_t>(column);
+        h->firstMs  = timeMs;
+        h->lastMs   = timeMs;
+        h->minValue =  std::numeric_limits<float>::infinity();
+        h->maxValue = -std::numeric_limits<float>::infinity();
+        col.blocks.push_back({timeMs, timeMs, index});
+        cur = Cursor{};
+    }
+
+    uint8_t*     blk = block(col.blocks.back().index);
+    BlockHeader* h   = headerOf(blk);
+    uint8_t*     buf = blk + sizeof(BlockHeader);
+
+    if (cur.count > 0) {
+        const int64_t delta = timeMs - cur.prevMs;
+        putSigned(buf, cur.bitPos, delta - cur.prevDelta);
+        cur.prevDelta = delta;
+    }
+    cur.prevMs = timeMs;
+
+    if (fixed) {
+        putSigned(buf, cur.bitPos, q - cur.prevQ);
+        cur.prevQ = q;
+    } else {
+        const uint32_t bits = floatBits(value);
+        if (cur.count == 0) {
+            putBits(buf, cur.bitPos, bits, 32);
+        } else {
+            const uint32_t x = bits ^ cur.prevBits;
+            if (x == 0) {
+                putBits(buf, cur.bitPos, 0b0, 1);
+            } else {
+                const int lead  = std::min(__builtin_clz(x), 31);
+                const int trail = __builtin_ctz(x);
+                if (cur.lead != 0xff && lead >= cur.lead && trail >= cur.trail) {
+                    putBits(buf, cur.bitPos, 0b10, 2);
+                    putBits(buf, cur.bitPos, x >> cur.trail, 32 - cur.lead - cur.trail);
+                } else {
+                    const int len = 32 - lead - trail;
+                    putBits(buf, cur.bitPos, 0b11, 2);
+                    putBits(buf, cur.bitPos, static_cast<uint64_t>(lead), 5);
+                    putBits(buf, cur.bitPos, static_cast<uint64_t>(len - 1), 5);
+                    putBits(buf, cur.bitPos, x >> trail, len);
+                    cur.lead  = static_cast<uint8_t>(lead);
+                    cur.trail = static_cast<uint8_t>(trail);
+                }
+            }
+        }
+        cur.prevBits = bits;
+    }
+    ++cur.count;
+
+    if (std::isfinite(value)) {
+        h->minValue = std::min(h->minValue, value);
+        h->maxValue = std::max(h->maxValue, value);
+    }
+    h->lastMs = timeMs;
+    h->bits   = cur.bitPos;
+    h->count  = cur.count;   // last, so a torn append leaves the old count
+    col.blocks.back().lastMs = timeMs;
+    return true;
+}
+
+// ────────────────────────────────────────────────────────────────
+//  Tiers
+// ────────────────────────────────────────────────────────────────
+
+void TimeSeriesStore::feedTier(int series, int tier, int64_t timeMs,
+                               float mn, float mx, double sum, uint32_t count)
+{
+    const int64_t start = bucketStart(timeMs, TIER_MS[tier]);
+    Bucket& b = series_[series].open[tier];
+
+    if (b.count && b.startMs != start) {
+        const Bucket done = b;
+        b = Bucket{};
+        if (!readOnly_) {
+            appendColumn(tierColumn(series, tier, Field::Min),   done.startMs, done.min);
+            appendColumn(tierColumn(series, tier, Field::Max),   done.startMs, done.max);
+            appendColumn(tierColumn(series, tier, Field::Mean),  done.startMs,
+                         static_cast<float>(done.sum / done.count));
+            appendColumn(tierColumn(series, tier, Field::Count), done.startMs,
+                         static_cast<float>(done.count));
+        }
+        if (tier + 1 < TIERS) {
+            feedTier(series, tier + 1, done.startMs, done.min, done.max, done.sum, done.count);
+        }
+    }
+
+    if (!b.count) {
+        b.startMs = start;
+        b.min     = mn;
+        b.max     = mx;
+        b.sum     = sum;
+        b.count   = count;
+    } else {
+        b.min    = std::min(b.min, mn);
+        b.max    = std::max(b.max, mx);
+        b.sum   += sum;
+        b.count += count;
+    }
+}
+
+void TimeSeriesStore::restoreBuckets(int series)
+{
+    constexpr int64_t END = std::numeric_limits<int64_t>::max();
+
+    // Top-down, so any bucket emitted while rebuilding a lower tier lands
+    // in an already restored parent.
+    for (int tier = TIERS - 1; tier >= 0; --tier) {
+        const Column& own = columns_[tierColumn(series, tier, Field::Min)];
+        const int64_t from = own.blocks.empty() ? std::numeric_limits<int64_t>::min()
+                                                : own.cursor.prevMs + TIER_MS[tier];
+        if (tier == 0) {
+            scanColumn(rawColumn(series), from, END, [&](int64_t t, float v) {
+                if (std::isfinite(v)) feedTier(series, 0, t, v, v, v, 1);
+            });
+            continue;
+        }
+
+        // Children are stored column-wise with identical timestamps.
+        std::vector<Sample> mn, mx, mean, count;
+        auto collect = [&](Field f, std::vector<Sample>& out) {
+            scanColumn(tierColumn(series, tier - 1, f), from, END,
+                       [&](int64_t t, float v) { out.push_back({t, v}); });
+        };
+        collect(Field::Min, mn);
+        collect(Field::Max, mx);
+        collect(Field::Mean, mean);
+        collect(Field::Count, count);
+        const size_t n = std::min({mn.size(), mx.size(), mean.size(), count.size()});
+        for (size_t i = 0; i < n; ++i) {
+            const auto c = static_cast<uint32_t>(std::lround(count[i].value));
+            feedTier(series, tier, mn[i].timeMs, mn[i].value, mx[i].value,
+                     static_cast<double>(mean[i].value) * c, c);
+        }
+    }
+}
+
+// ────────────────────────────────────────────────────────────────
+//  Queries
+// ────────────────────────────────────────────────────────────────
+
+std::vector<TimeSeriesStore::Bucket> TimeSeriesStore::pendingBuckets(int series, int tier) const
+{
+    // Samples not yet emitted at this tier sit in its own open bucket and
+    // in the open buckets below it, which may already belong to the next
+    // bucket at this width.
+    std::vector<Bucket> pending;
+    for (int j = tier; j >= 0; --j) {
+        const Bucket& b = series_[series].open[j];
+        if (!b.count) continue;
+        const int64_t start = bucketStart(b.startMs, TIER_MS[tier]);
+        if (pending.empty() || pending.back().startMs != start) {
+            pending.push_back(b);
+            pending.back().startMs = start;
+        } else {
+            Bucket& p = pending.back();
+            p.min    = std::min(p.min, b.min);
+            p.max    = std::max(p.max, b.max);
+            p.sum   += b.sum;
+            p.count += b.count;
+        }
+    }
+    return pending;
+}
+
+size_t TimeSeriesStore::queryLocked(int series, Tier tier, Field field,
+                                    int64_t fromMs, int64_t toMs, std::vector<Sample>& out) const
+{
+    if (!base_ || series < 0 || series >= static_cast<int>(series_.size()) || fromMs > toMs) {
+        return 0;
+    }
+    const size_t before = out.size();
+    auto emit = [&out](int64_t t, float v) { out.push_back({t, v}); };
+
+    if (tier == Tier::Raw) {
+        scanColumn(rawColumn(series), fromMs, toMs, emit);
+        return out.size() - before;
+    }
+
+    const int k = static_cast<int>(tier) - 1;
+    scanColumn(tierColumn(series, k, field), fromMs, toMs, emit);
+
+    for (const Bucket& b : pendingBuckets(series, k)) {
+        if (b.startMs < fromMs || b.startMs > toMs) continue;
+        float v = 0.0f;
+        switch (field) {
+            case Field::Min:   v = b.min; break;
+            case Field::Max:   v = b.max; break;
+            case Field::Mean:  v = static_cast<float>(b.sum / b.count); break;
+            case Field::Count: v = static_cast<float>(b.count); break;
+        }
+        out.push_back({b.startMs, v});
+    }
+    return out.size() - before;
+}
+
+size_t TimeSeriesStore::query(int series, int64_t fromMs, int64_t toMs,
+                              std::vector<Sample>& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queryLocked(series, Tier::Raw, Field::Mean, fromMs, toMs, out);
+}
+
+size_t TimeSeriesStore::query(int series, Tier tier, Field field, int64_t fromMs, int64_t toMs,
+                              std::vector<Sample>& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queryLocked(series, tier, field, fromMs, toMs, out);
+}
+
+size_t TimeSeriesStore::query(int series, Tier tier, int64_t fromMs, int64_t toMs,
+                              std::vector<Aggregate>& out) const
+{
+    if (tier == Tier::Raw) {
+        return 0;
+    }
+    std::vector<Sample> mn, mx, mean, count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queryLocked(series, tier, Field::Min,   fromMs, toMs, mn);
+        queryLocked(series, tier, Field::Max,   fromMs, toMs, mx);
+        queryLocked(series, tier, Field::Mean,  fromMs, toMs, mean);
+        queryLocked(series, tier, Field::Count, fromMs, toMs, count);
+    }
+
+    const size_t n = std::min({mn.size(), mx.size(), mean.size(), count.size()});
+    out.reserve(out.size() + n);
+    for (size_t i = 0; i < n; ++i) {
+        out.push_back({mn[i].timeMs, mn[i].value, mx[i].value, mean[i].value,
+                       static_cast<uint32_t>(std::lround(count[i].value))});
+    }
+    return n;
+}
+
+Tier TimeSeriesStore::tierFor(int64_t fromMs, int64_t toMs, size_t maxPoints)
+{
+    const int64_t span = std::max<int64_t>(toMs - fromMs, 0) + 1;
+    for (int k = 0; k < TIERS; ++k) {
+        if (static_cast<uint64_t>((span + TIER_MS[k] - 1) / TIER_MS[k]) <= maxPoints) {
+            return static_cast<Tier>(k + 1);
+        }
+    }
+    return Tier::Hour;
+}
+
+void TimeSeriesStore::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_ && !readOnly_) {
+        msync(base_, mapped_, MS_ASYNC);
+    }
+}
+
+StoreStats TimeSeriesStore::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    StoreStats st;
+    if (base_) {
+        const auto* hdr = reinterpret_cast<const FileHeader*>(base_);
+        st.blocks  = hdr->blockCount - 1;
+        st.bytes   = hdr->blockCount * BLOCK_BYTES;
+        st.samples = samples_;
+        for (size_t s = 0; s < series_.size(); ++s) {
+            st.rawBlocks += columns_[rawColumn(static_cast<int>(s))].blocks.size();
+        }
+    }
+    return st;
+}
+
+} // namespace duosight
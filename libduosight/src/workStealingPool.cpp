@@ -0,0 +1,146 @@
+/**
+ * @file workStealingPool.cpp
+ * @brief Implementation of the work-stealing thread pool.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Deques are guarded by one small mutex each; contention only happens
+ *   when a thief and the owner touch the same deque. Sleeping workers are
+ *   parked on a single condition variable and woken per submit.
+ */
+
+#include "workStealingPool.hpp"
+
+#include <algorithm>
+
+namespace duosight {
+
+namespace {
+// Identifies the pool/worker the current thread belongs to, so that
+// submits from inside a task land on the submitting worker's own deque.
+thread_local const WorkStealingPool* t_pool  = nullptr;
+thread_local unsigned                t_index = 0;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned workers)
+{
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+
+    threads_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        threads_.emplace_back([this, i] { run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    const unsigned target = (t_pool == this)
+                          ? t_index
+                          : next_.fetch_add(1, std::memory_order_relaxed) % workerCount();
+    {
+        // Count the task before it becomes visible so a worker that steals
+        // it immediately never drives the counter below zero. Taking
+        // sleepMutex_ orders the increment against a worker about to park.
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        queued_.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+void WorkStealingPool::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    idle_.wait(lock, [this] {
+        return queued_.load(std::memory_order_acquire) == 0 &&
+               running_.load(std::memory_order_acquire) == 0;
+    });
+}
+
+bool WorkStealingPool::popLocal(unsigned index, Task& out)
+{
+    Worker& w = *workers_[index];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.tasks.empty()) return false;
+    out = std::move(w.tasks.back());
+    w.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, Task& out)
+{
+    const unsigned n = workerCount();
+    for (unsigned k = 1; k < n; ++k) {
+        Worker& victim = *workers_[(thief + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(unsigned index)
+{
+    t_pool  = this;
+    t_index = index;
+
+    for (;;) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                running_.fetch_add(1, std::memory_order_relaxed);
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            task();
+            task = nullptr;   // release captures before reporting idle
+
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            running_.fetch_sub(1, std::memory_order_relaxed);
+            if (running_.load(std::memory_order_relaxed) == 0 &&
+                queued_.load(std::memory_order_relaxed) == 0) {
+                idle_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] {
+            return stop_.load() || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace duosight
@@ -0,0 +1,413 @@
+/**
+ * @file zoneMap.cpp
+ * @brief Zone-mapped recording blocks: layout, incremental summaries, pruned queries.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Block layout (blockBytes, one RecordingWriter write each):
+ *
+ *     ZoneBlockHeader   spans, ROI rectangles, one ZoneRange per zone
+ *     FrameRecord + PIXELS floats, `frames` times
+ *     zero padding
+ *
+ *   Min and max are exact over a zone's pixels (NaN skipped), so "no
+ *   pixel above T" can be decided from the header alone. Means are over
+ *   pixels and frames.
+ */
+
+#include "zoneMap.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+
+namespace duosight {
+
+namespace {
+
+constexpr int      W           = Geometry::WIDTH, H = Geometry::HEIGHT;
+constexpr uint32_t BLOCK_MAGIC = 0x425A5344;   // "DSZB"
+constexpr size_t   RECORD      = sizeof(FrameRecord) + Geometry::PIXELS * sizeof(float);
+
+struct ZoneBlockHeader {
+    uint32_t  magic;
+    uint32_t  blockBytes;
+    uint16_t  frames;
+    uint8_t   zones;
+    uint8_t   rois;
+    uint32_t  recordBytes;
+    uint64_t  firstSequence;
+    uint64_t  lastSequence;
+    int64_t   firstNs;
+    int64_t   lastNs;
+    int16_t   roi[ZoneMap::MAX_ROIS][4];   // x, y, w, h
+    ZoneRange zone[ZoneMap::MAX_ZONES];
+};
+
+static_assert(sizeof(ZoneBlockHeader) == 592, "zone block header layout changed");
+static_assert(sizeof(ZoneBlockHeader) % 8 == 0 && RECORD % 8 == 0, "records stay 8-byte aligned");
+
+ZoneBlockHeader* headerOf(uint8_t* blk) { return reinterpret_cast<ZoneBlockHeader*>(blk); }
+
+Roi clampRoi(const Roi& r)
+{
+    const int x0 = std::clamp(r.x, 0, W), y0 = std::clamp(r.y, 0, H);
+    const int x1 = std::clamp(r.x + r.w, x0, W), y1 = std::clamp(r.y + r.h, y0, H);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+bool contains(const Roi& outer, const Roi& inner)
+{
+    return inner.x >= outer.x && inner.y >= outer.y
+        && inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+bool readAt(int fd, void* buf, size_t bytes, uint64_t offset)
+{
+    auto* p = static_cast<uint8_t*>(buf);
+    while (bytes) {
+        const ssize_t n = pread(fd, p, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────
+// ZoneMapRecorder
+// ─────────────────────────────────────────────────────────────────────────
+
+ZoneMapRecorder::ZoneMapRecorder(RecordingWriter& writer, const ZoneMapOptions& options)
+    : writer_(writer)
+{
+    for (const Roi& r : options.rois) {
+        if (rois_.size() == ZoneMap::MAX_ROIS) {
+            std::clog << "[ZoneMap] only the first " << ZoneMap::MAX_ROIS << " ROIs are summarised\n";
+            break;
+        }
+        rois_.push_back(clampRoi(r));
+    }
+    block_.assign(writer.options().blockBytes, 0);
+    perBlock_ = (block_.size() - sizeof(ZoneBlockHeader)) / RECORD;   // >= 1 with 4 KiB blocks
+    min_.fill(std::numeric_limits<float>::infinity());
+    max_.fill(-std::numeric_limits<float>::infinity());
+}
+
+ZoneMapRecorder::~ZoneMapRecorder()
+{
+    finish();
+}
+
+bool ZoneMapRecorder::append(const ThermalFrame& frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ZoneBlockHeader* h = headerOf(block_.data());
+    if (frames_ == 0) {
+        h->firstSequence = frame.sequence;
+        h->firstNs       = frame.timestampNs;
+    }
+    h->lastSequence = frame.sequence;
+    h->lastNs       = frame.timestampNs;
+
+    FrameRecord rec;
+    rec.bytes       = RECORD;
+    rec.sequence    = frame.sequence;
+    rec.timestampNs = frame.timestampNs;
+    uint8_t* at = block_.data() + sizeof(ZoneBlockHeader) + frames_ * RECORD;
+    std::memcpy(at, &rec, sizeof(rec));
+    std::memcpy(at + sizeof(rec), frame.temperatures.data(), Geometry::PIXELS * sizeof(float));
+
+    auto accumulate = [&](size_t z, const Roi& r) {
+        float mn = min_[z], mx = max_[z];
+        double sum = 0.0;
+        uint32_t n = 0;
+        for (int y = r.y; y < r.y + r.h; ++y) {
+            for (int x = r.x; x < r.x + r.w; ++x) {
+                const float v = frame.temperatures[y * W + x];
+                if (std::isnan(v)) continue;   // as in decode(), where NaN never compares
+                mn = std::min(mn, v);
+                mx = std::max(mx, v);
+                sum += v;
+                ++n;
+            }
+        }
+        min_[z] = mn;
+        max_[z] = mx;
+        sum_[z] += sum;
+        count_[z] += n;
+    };
+    for (int t = 0; t < SceneTiles::COUNT; ++t) {
+        accumulate(t, {(t % SceneTiles::COLS) * SceneTiles::SIZE, (t / SceneTiles::COLS) * SceneTiles::SIZE,
+                       SceneTiles::SIZE, SceneTiles::SIZE});
+    }
+    for (size_t i = 0; i < rois_.size(); ++i) {
+        accumulate(SceneTiles::COUNT + i, rois_[i]);
+    }
+
+    ++frames_;
+    ++stats_.frames;
+    return frames_ < perBlock_ || flushLocked();
+}
+
+bool ZoneMapRecorder::flushLocked()
+{
+    if (!frames_) {
+        return true;
+    }
+    ZoneBlockHeader* h = headerOf(block_.data());
+    h->magic       = BLOCK_MAGIC;
+    h->blockBytes  = static_cast<uint32_t>(block_.size());
+    h->frames      = static_cast<uint16_t>(frames_);
+    h->zones       = static_cast<uint8_t>(SceneTiles::COUNT + rois_.size());
+    h->rois        = static_cast<uint8_t>(rois_.size());
+    h->recordBytes = RECORD;
+    std::memset(h->roi, 0, sizeof(h->roi));
+    for (size_t i = 0; i < rois_.size(); ++i) {
+        h->roi[i][0] = static_cast<int16_t>(rois_[i].x);
+        h->roi[i][1] = static_cast<int16_t>(rois_[i].y);
+        h->roi[i][2] = static_cast<int16_t>(rois_[i].w);
+        h->roi[i][3] = static_cast<int16_t>(rois_[i].h);
+    }
+    for (size_t z = 0; z < ZoneMap::MAX_ZONES; ++z) {
+        h->zone[z] = {min_[z], max_[z], count_[z] ? static_cast<float>(sum_[z] / count_[z]) : 0.0f};
+    }
+    const size_t used = sizeof(ZoneBlockHeader) + frames_ * RECORD;
+    std::memset(block_.data() + used, 0, block_.size() - used);
+
+    const bool ok = writer_.append(block_.data(), block_.size());
+    if (ok) {
+        ++stats_.blocks;
+    } else {
+        ++stats_.droppedBlocks;
+        stats_.droppedFrames += frames_;
+    }
+
+    frames_ = 0;
+    min_.fill(std::numeric_limits<float>::infinity());
+    max_.fill(-std::numeric_limits<float>::infinity());
+    sum_.fill(0.0);
+    count_.fill(0);
+    return ok;
+}
+
+bool ZoneMapRecorder::finish()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flushLocked();
+}
+
+ProcessingGraph::StageFn ZoneMapRecorder::stage()
+{
+    return [this](const FramePtr& frame) -> FramePtr {
+        append(*frame);
+        return nullptr;
+    };
+}
+
+ZoneRecorderStats ZoneMapRecorder::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// RecordingIndex
+// ─────────────────────────────────────────────────────────────────────────
+
+RecordingIndex::RecordingIndex(const std::string& path)
+{
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        std::cerr << "[ZoneMap] open " << path << " failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+    struct stat st {};
+    fstat(fd_, &st);
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (size == 0) {
+        return;   // nothing recorded yet
+    }
+
+    ZoneBlockHeader h;
+    if (!readAt(fd_, &h, sizeof(h), 0) || h.magic != BLOCK_MAGIC || h.recordBytes != RECORD
+        || h.blockBytes < sizeof(ZoneBlockHeader) + RECORD || h.rois > ZoneMap::MAX_ROIS) {
+        std::cerr << "[ZoneMap] " << path << " is not a zone-mapped recording\n";
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    blockBytes_ = h.blockBytes;
+    for (int i = 0; i < h.rois; ++i) {
+        rois_.push_back({h.roi[i][0], h.roi[i][1], h.roi[i][2], h.roi[i][3]});
+    }
+
+    const size_t perBlock = (blockBytes_ - sizeof(ZoneBlockHeader)) / RECORD;
+    for (uint64_t offset = 0; offset + sizeof(h) <= size; offset += blockBytes_) {
+        if (!readAt(fd_, &h, sizeof(h), offset) || h.magic != BLOCK_MAGIC || h.blockBytes != blockBytes_
+            || h.frames == 0 || h.frames > perBlock || h.rois != rois_.size()) {
+            std::cerr << "[ZoneMap] skipping damaged block at " << offset << "\n";
+            continue;
+        }
+        Block b;
+        b.offset  = offset;
+        b.firstNs = h.firstNs;
+        b.lastNs  = h.lastNs;
+        b.frames  = h.frames;
+        std::copy(std::begin(h.zone), std::end(h.zone), b.zones.begin());
+        blocks_.push_back(b);
+        frames_ += h.frames;
+    }
+}
+
+RecordingIndex::~RecordingIndex()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void RecordingIndex::decode(const Block& block, const ZoneQuery& q, std::vector<uint8_t>& buf,
+                            std::vector<ZoneHit>& hits, uint64_t& frames) const
+{
+    const size_t bytes = sizeof(ZoneBlockHeader) + block.frames * RECORD;
+    if (!readAt(fd_, buf.data(), bytes, block.offset)) {
+        std::cerr << "[ZoneMap] reading block at " << block.offset << " failed\n";
+        return;
+    }
+    const Roi& r = q.roi;
+    for (uint32_t i = 0; i < block.frames; ++i) {
+        const uint8_t* at = buf.data() + sizeof(ZoneBlockHeader) + i * RECORD;
+        FrameRecord rec;
+        std::memcpy(&rec, at, sizeof(rec));
+        if (rec.timestampNs < q.fromNs || rec.timestampNs > q.toNs) {
+            continue;
+        }
+        ++frames;
+        const auto* t = reinterpret_cast<const float*>(at + sizeof(rec));
+        float mn = std::numeric_limits<float>::infinity(), mx = -mn;
+        for (int y = r.y; y < r.y + r.h; ++y) {
+            for (int x = r.x; x < r.x + r.w; ++x) {
+                mn = std::min(mn, t[y * W + x]);
+                mx = std::max(mx, t[y * W + x]);
+            }
+        }
+        if (mx > q.above || mn < q.below) {
+            hits.push_back({rec.sequence, rec.timestampNs, mn, mx});
+        }
+    }
+}
+
+std::vector<ZoneHit> RecordingIndex::query(const ZoneQuery& query, WorkStealingPool& pool,
+                                           ZoneQueryStats* stats) const
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    ZoneQuery q = query;
+    q.roi = clampRoi(q.roi);
+    std::vector<ZoneHit> hits;
+    ZoneQueryStats st;
+    if (fd_ < 0 || q.roi.w == 0 || q.roi.h == 0 || q.fromNs > q.toNs) {
+        if (stats) *stats = st;
+        return hits;
+    }
+
+    // Zones bounding the ROI: the tiles it touches, and recorded ROIs that contain it
+    std::vector<size_t> tiles, outer;
+    for (int t = 0; t < SceneTiles::COUNT; ++t) {
+        const Roi tile {(t % SceneTiles::COLS) * SceneTiles::SIZE, (t / SceneTiles::COLS) * SceneTiles::SIZE,
+                        SceneTiles::SIZE, SceneTiles::SIZE};
+        if (q.roi.x < tile.x + tile.w && tile.x < q.roi.x + q.roi.w
+            && q.roi.y < tile.y + tile.h && tile.y < q.roi.y + q.roi.h) {
+            tiles.push_back(t);
+        }
+    }
+    for (size_t i = 0; i < rois_.size(); ++i) {
+        if (contains(rois_[i], q.roi)) outer.push_back(SceneTiles::COUNT + i);
+    }
+
+    std::vector<const Block*> candidates;
+    for (const Block& b : blocks_) {
+        if (b.lastNs < q.fromNs || b.firstNs > q.toNs) {
+            continue;
+        }
+        ++st.blocks;
+        if (q.useZoneMaps) {
+            float hi = -std::numeric_limits<float>::infinity(), lo = -hi;
+            for (size_t z : tiles) {
+                hi = std::max(hi, b.zones[z].max);
+                lo = std::min(lo, b.zones[z].min);
+            }
+            for (size_t z : outer) {
+                hi = std::min(hi, b.zones[z].max);
+                lo = std::max(lo, b.zones[z].min);
+            }
+            if (!(hi > q.above || lo < q.below)) {
+                continue;
+            }
+        }
+        candidates.push_back(&b);
+    }
+    st.candidates = candidates.size();
+
+    // Contiguous runs of candidates per task, so the parts concatenate in time order
+    const size_t tasks = std::min<size_t>(candidates.size(), size_t(pool.workerCount()) * 4);
+    std::vector<std::vector<ZoneHit>> parts(tasks);
+    std::vector<uint64_t>             decoded(tasks, 0);
+    std::mutex              doneMutex;
+    std::condition_variable doneCv;
+    size_t                  remaining = tasks;
+    for (size_t k = 0; k < tasks; ++k) {
+        const size_t from = k * candidates.size() / tasks, to = (k + 1) * candidates.size() / tasks;
+        pool.submit([&, k, from, to] {
+            std::vector<uint8_t> buf(blockBytes_);
+            for (size_t i = from; i < to; ++i) {
+                decode(*candidates[i], q, buf, parts[k], decoded[k]);
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            --remaining;
+            doneCv.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCv.wait(lock, [&] { return remaining == 0; });
+    }
+
+    for (size_t k = 0; k < tasks; ++k) {
+        hits.insert(hits.end(), parts[k].begin(), parts[k].end());
+        st.frames += decoded[k];
+    }
+    st.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (stats) *stats = st;
+    return hits;
+}
+
+std::vector<ZoneSummary> RecordingIndex::summaries(size_t zone, int64_t fromNs, int64_t toNs) const
+{
+    std::vector<ZoneSummary> out;
+    if (zone >= SceneTiles::COUNT + rois_.size()) {
+        return out;
+    }
+    for (const Block& b : blocks_) {
+        if (b.lastNs >= fromNs && b.firstNs <= toNs) {
+            out.push_back({b.firstNs, b.lastNs, b.frames, b.zones[zone]});
+        }
+    }
+    return out;
+}
+
+} // namespace duosight
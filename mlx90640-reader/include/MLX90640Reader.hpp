@@ -12,9 +12,16 @@
 #include <cstdint>
 #include <iostream>
 #include <array>
+#include <memory>
+#include <mutex>
+#include <string>
 #include "MLX90640Regs.hpp"
 #include "MLX90640_API.h"
 #include "i2cUtils.hpp"
+#include "metrics.hpp"
+#include "nucTable.hpp"
+#include "pixelConverter.hpp"
+#include "subpageFetcher.hpp"
 
 #ifndef MLX90640_PARAMS_SIZE
 #define MLX90640_PARAMS_SIZE 1664
@@ -23,48 +30,6 @@
 namespace duosight
 {
 
-// -----------------------------------------------------------------
-// Refresh-rate constants and table
-// -----------------------------------------------------------------
-namespace refresh
-{
-    inline constexpr unsigned SHIFT = 5;              // bits 7:5 in CTRL1
-    inline constexpr uint16_t MASK  = 0b111 << SHIFT; // mask for bits 7:5
-
-    // 3-bit refresh codes (unshifted)
-    inline constexpr uint8_t FR0P5 = 0b000;  // 0.5 Hz full frame
-    inline constexpr uint8_t FR1   = 0b001;  // 1 Hz
-    inline constexpr uint8_t FR2   = 0b010;  // 2 Hz
-    inline constexpr uint8_t FR4   = 0b011;  // 4 Hz
-    inline constexpr uint8_t FR8   = 0b100;  // 8 Hz
-    inline constexpr uint8_t FR16  = 0b101;  // 16 Hz
-    inline constexpr uint8_t FR32  = 0b110;  // 32 Hz
-    inline constexpr uint8_t FR64  = 0b111;  // 64 Hz
-
-    struct RateInfo {
-        float hz_full_frame;    // Full-frame rate in Hz
-        float sec_subpage;      // Seconds per subpage in chess mode
-    };
-
-    inline constexpr RateInfo TABLE[] = {
-        {0.5f,    1.0f},         // FR0P5
-        {1.0f,    0.5f},         // FR1
-        {2.0f,    0.25f},        // FR2
-        {4.0f,    0.125f},       // FR4
-        {8.0f,    0.0625f},      // FR8
-        {16.0f,   0.03125f},     // FR16
-        {32.0f,   0.015625f},    // FR32
-        {64.0f,   0.0078125f}    // FR64
-    };
-
-    struct RefreshInfo {
-        int   code;              // 0..7 (refresh code from register)
-        float hz;                // full-frame rate in Hz (-1 if invalid)
-        float subpage_period_s;  // seconds per subpage (-1 if invalid)
-    };
-} // namespace refresh
-
-
 // -----------------------------------------------------------------
 // MLX90640Reader class
 // -----------------------------------------------------------------
@@ -73,7 +38,12 @@ public:
     MLX90640Reader(I2cDevice &bus, uint8_t address);
     ~MLX90640Reader();
 
-    bool initialize();                                 
+    /// cachePath names a calibration cache (EEPROM image + NUC tables).
+    /// When it holds this sensor's image the EEPROM dump is skipped; when
+    /// missing or unreadable it is written after the dump. A cache from
+    /// another sensor is left untouched and caching is off for the run.
+    /// Empty disables caching.
+    bool initialize(const std::string& cachePath = "");
     bool waitForNewFrame(int &subpageOut, std::array<uint16_t, duosight::Geometry::WORDS> &dest);
     void sleepNow(int delay);
     bool ackClear(void);
@@ -89,14 +59,73 @@ public:
     // New helper for CTRL1-based timing
     refresh::RefreshInfo readRefreshRate(bool verbose = false) const;
 
+    /// Calibration extracted by initialize(); feeds PixelConverter/LazyFrame.
+    const paramsMLX90640& params() const { return params_; }
+
+    /// Registers frame, error and latency instruments plus temperature
+    /// gauges; readFrame() updates them lock-free from then on.
+    void attachMetrics(MetricsRegistry& registry);
+
+    /// Measures a one-point NUC table from a uniform scene (typically a
+    /// FrameStacker mean) at the current Ta, adds it to the calibration
+    /// cache and saves the cache. Folded in before the next frame is
+    /// converted. Callable from any thread.
+    bool addNuc(const float* uniformScene, float referenceC);
+
+    /// Drops all NUC tables, back to the factory calibration.
+    bool clearNuc();
+
+    size_t nucTables() const;
+
+    /// Acquire subpages with speculative STATUS + RAM bursts
+    /// (SubpageFetcher) instead of MLX90640_GetFrameData's polling.
+    /// Call from the acquisition thread, between frames.
+    void setSpeculative(bool on);
+
+    /// Hit rate and latency counters; null until the first speculative frame.
+    const SubpageFetcher* fetcher() const { return fetcher_.get(); }
+
 private:
     /* The reader does *not* own the bus; caller keeps it alive. */
     I2cDevice* bus_ {nullptr};
     uint8_t    address_ {0x33};
 
+    void countSubpageFailure(int rc);
+    void applyPendingNuc();
+    int  grab(uint16_t* words, float subpagePeriodS);
+
+    // Instruments, all null until attachMetrics()
+    struct Instruments {
+        Counter*   frames         {nullptr};
+        Counter*   i2cErrors      {nullptr};
+        Counter*   subpageSkips   {nullptr};
+        Histogram* readSeconds    {nullptr};
+        Gauge*     ambientC       {nullptr};
+        Gauge*     minC           {nullptr};
+        Gauge*     maxC           {nullptr};
+        Gauge*     meanC          {nullptr};
+    } metrics_;
+
     // Calibration and scratch buffers
     uint16_t       eepromData_[832] {};
     paramsMLX90640 params_{};
+
+    // Conversion coefficients (factory + folded NUC). Only the acquisition
+    // thread converts; NUC changes are queued under calibMutex_ and folded
+    // in at the start of the next readFrame(). coeffCache_ refers to
+    // *converter_ and is invalidated whenever a NUC is folded in.
+    std::unique_ptr<PixelConverter>   converter_;
+    std::unique_ptr<CoefficientCache> coeffCache_;
+    mutable std::mutex                calibMutex_;
+    CalibrationCache                  cache_;
+    std::string                       cachePath_;
+    SubpageTerms                      lastTerms_ {};
+    bool                              nucPending_ {false};
+
+    // Speculative acquisition; without it GetFrameData polls as before
+    bool                            speculative_ {false};
+    std::unique_ptr<SubpageFetcher> fetcher_;
+    int64_t                         fetchPeriodNs_ {0};
 };
 
 } // namespace duosight
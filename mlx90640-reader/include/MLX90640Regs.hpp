@@ -11,6 +11,7 @@
  *   • Polling parameters                   – helper values for wait-loops
  *   • Default IR scene assumptions         – emissivity & ambient temperature
  *   • ADC resolution codes (reg 0x800D)    – 16- to 19-bit
+ *   • Refresh-rate codes (reg 0x800D)      – 0.5 to 64 Hz, subpage periods
  *   • Status register 0x8000 bit masks     – every documented flag
  *
  *  Copyright (c) 2025  Highland Biosciences  –  Dr Richard Day
@@ -79,6 +80,46 @@ inline constexpr int ADC_18bit = 2; // power-on default
 inline constexpr int ADC_19bit = 3; // slowest – lowest noise
 } // namespace Resolution
 
+// ────────────────────────────────────────────────────────────────
+//  Refresh rate (CTRL reg 0x800D) and subpage periods
+// ────────────────────────────────────────────────────────────────
+namespace refresh {
+inline constexpr unsigned SHIFT = 7;              // bits 9:7 in CTRL1
+inline constexpr uint16_t MASK  = 0b111 << SHIFT; // 0x0380, mask for bits 9:7
+
+// 3-bit refresh codes (unshifted)
+inline constexpr uint8_t FR0P5 = 0b000;  // 0.5 Hz full frame
+inline constexpr uint8_t FR1   = 0b001;  // 1 Hz
+inline constexpr uint8_t FR2   = 0b010;  // 2 Hz
+inline constexpr uint8_t FR4   = 0b011;  // 4 Hz
+inline constexpr uint8_t FR8   = 0b100;  // 8 Hz
+inline constexpr uint8_t FR16  = 0b101;  // 16 Hz
+inline constexpr uint8_t FR32  = 0b110;  // 32 Hz
+inline constexpr uint8_t FR64  = 0b111;  // 64 Hz
+
+struct RateInfo {
+    float hz_full_frame;    // Full-frame rate in Hz
+    float sec_subpage;      // Seconds per subpage in chess mode
+};
+
+inline constexpr RateInfo TABLE[] = {
+    {0.5f,    1.0f},         // FR0P5
+    {1.0f,    0.5f},         // FR1
+    {2.0f,    0.25f},        // FR2
+    {4.0f,    0.125f},       // FR4
+    {8.0f,    0.0625f},      // FR8
+    {16.0f,   0.03125f},     // FR16
+    {32.0f,   0.015625f},    // FR32
+    {64.0f,   0.0078125f}    // FR64
+};
+
+struct RefreshInfo {
+    int   code;              // 0..7 (refresh code from register)
+    float hz;                // full-frame rate in Hz (-1 if invalid)
+    float subpage_period_s;  // seconds per subpage (-1 if invalid)
+};
+} // namespace refresh
+
 // ────────────────────────────────────────────────────────────────
 //  STATUS register (0x8000) – full bit-map
 // ────────────────────────────────────────────────────────────────
@@ -92,4 +133,14 @@ inline constexpr uint16_t OVERRUN         = 0b0000'0000'0001'0000; // bit 4: Dat
 inline constexpr uint16_t INTERFACE_ERROR = 0b1000'0000'0000'0000; // bit 15: Interface error
 } // namespace Status
 
+// ────────────────────────────────────────────────────────────────
+//  EEPROM (0x2400) – calibration image
+// ────────────────────────────────────────────────────────────────
+namespace Eeprom {
+inline constexpr uint16_t BASE      = 0x2400;
+inline constexpr int      WORDS     = 832;
+inline constexpr uint16_t DEVICE_ID = 0x2407;   // 3 words, unique per sensor
+inline constexpr int      ID_WORDS  = 3;
+} // namespace Eeprom
+
 } // namespace duosight
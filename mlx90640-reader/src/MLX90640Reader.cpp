@@ -8,7 +8,10 @@
  *
  * Summary:
  *   Provides initialization of the MLX90640 sensor and reading of thermal frame data.
- *   Uses the official Melexis API for parameter extraction and temperature conversion.
+ *   Uses the official Melexis API for parameter extraction; conversion goes through
+ *   PixelConverter (same arithmetic as MLX90640_CalculateTo) so user NUC tables apply,
+ *   with its Ta/Vdd-dependent per-pixel factors held in a CoefficientCache, which
+ *   converts four pixels at a time (within 1e-3 °C of the scalar arithmetic).
  */
 
 #include <iostream>
@@ -25,10 +28,21 @@
 #include "MLX90640Regs.hpp"
 #include "MLX90640_API.h"
 #include "mlx90640Transport.h"
+#include "subpageMerge.hpp"
 #include <algorithm>
 
 namespace duosight {
 
+namespace {
+/// Default epsilons, four-lane conversion
+CoefficientCacheOptions cacheOptions()
+{
+    CoefficientCacheOptions o;
+    o.vectorised = true;
+    return o;
+}
+} // namespace
+
 MLX90640Reader::MLX90640Reader(I2cDevice& bus, uint8_t address)
     : bus_{&bus}, address_{address}
 {
@@ -51,7 +65,7 @@ refresh::RefreshInfo MLX90640Reader::readRefreshRate(bool verbose) const
 
     static const float lut[8] = { 0.5f, 1, 2, 4, 8, 16, 32, 64 };
 
-    info.code = (ctrl >> 7) & 0x07;
+    info.code = (ctrl & refresh::MASK) >> refresh::SHIFT;
     if (info.code >= 0 && info.code < 8) {
         info.hz = lut[info.code];
         info.subpage_period_s = 1.0f / (info.hz * 2.0f);
@@ -69,7 +83,25 @@ refresh::RefreshInfo MLX90640Reader::readRefreshRate(bool verbose) const
 }
 
 
-bool MLX90640Reader::initialize()
+void MLX90640Reader::attachMetrics(MetricsRegistry& registry)
+{
+    metrics_.frames       = &registry.counter("duosight_frames_total",
+                                              "Complete frames read from the sensor");
+    metrics_.i2cErrors    = &registry.counter("duosight_i2c_errors_total",
+                                              "Failed I2C transfers during frame reads");
+    metrics_.subpageSkips = &registry.counter("duosight_subpage_overruns_total",
+                                              "Subpages that arrived out of order (one was missed)");
+    metrics_.readSeconds  = &registry.histogram("duosight_frame_read_seconds",
+                                                "Time to read and convert both subpages",
+                                                Histogram::exponential(0.005, 2.0, 10));
+    metrics_.ambientC     = &registry.gauge("duosight_ambient_celsius", "Sensor die temperature (Ta)");
+    metrics_.minC         = &registry.gauge("duosight_frame_celsius", "Latest frame statistics", "stat=\"min\"");
+    metrics_.maxC         = &registry.gauge("duosight_frame_celsius", "Latest frame statistics", "stat=\"max\"");
+    metrics_.meanC        = &registry.gauge("duosight_frame_celsius", "Latest frame statistics", "stat=\"mean\"");
+}
+
+
+bool MLX90640Reader::initialize(const std::string& cachePath)
 {
     std::clog << "[MLX90640] --- initialize() ---\n";
 
@@ -82,16 +114,50 @@ bool MLX90640Reader::initialize()
     }
 
     // ─────────────────────────────────────────────
-    // 1) EEPROM → params
+    // 1) EEPROM (or the cached image of it) → params
     // ─────────────────────────────────────────────
-    if (MLX90640_DumpEE(address_, eepromData_) != 0) {
-        std::cerr << "[MLX90640] EEPROM dump failed\n";
-        return false;
+    std::lock_guard<std::mutex> lock(calibMutex_);
+    cachePath_ = cachePath;
+    bool fromCache = false;
+    if (!cachePath_.empty() && cache_.load(cachePath_)) {
+        uint16_t id[Eeprom::ID_WORDS] {};
+        const bool idRead = MLX90640_I2CRead(address_, Eeprom::DEVICE_ID, Eeprom::ID_WORDS, id) == 0;
+        if (idRead && cache_.sameDevice(id)) {
+            std::copy(cache_.eeprom.begin(), cache_.eeprom.end(), eepromData_);
+            fromCache = true;
+            std::clog << "[MLX90640] EEPROM image from " << cachePath_ << ", "
+                      << cache_.nuc.size() << " NUC table(s)\n";
+        } else {
+            if (idRead) {
+                std::clog << "[MLX90640] " << cachePath_ << " belongs to another sensor; "
+                          << "leaving it untouched, caching disabled\n";
+            } else {
+                std::cerr << "[MLX90640] failed to read the device ID; leaving " << cachePath_
+                          << " untouched, caching disabled\n";
+            }
+            cache_ = CalibrationCache{};
+            cachePath_.clear();
+        }
+    }
+    if (!fromCache) {
+        if (MLX90640_DumpEE(address_, eepromData_) != 0) {
+            std::cerr << "[MLX90640] EEPROM dump failed\n";
+            return false;
+        }
+        std::copy(eepromData_, eepromData_ + Eeprom::WORDS, cache_.eeprom.begin());
+        if (!cachePath_.empty()) {
+            cache_.save(cachePath_);
+        }
     }
     if (MLX90640_ExtractParameters(eepromData_, &params_) != 0) {
         std::cerr << "[MLX90640] Parameter extraction failed\n";
         return false;
     }
+    coeffCache_.reset();
+    converter_ = std::make_unique<PixelConverter>(params_);
+    converter_->applyNuc(cache_.nuc);
+    coeffCache_ = std::make_unique<CoefficientCache>(*converter_, cacheOptions());
+    nucPending_ = false;
     std::clog << "[MLX90640] Parameters extracted OK\n";
 
     // ─────────────────────────────────────────────
@@ -154,6 +220,87 @@ void MLX90640Reader::sleepNow(int delay)
 }
 
 
+bool MLX90640Reader::addNuc(const float* uniformScene, float referenceC)
+{
+    std::lock_guard<std::mutex> lock(calibMutex_);
+    if (!converter_) {
+        return false;
+    }
+    cache_.addNuc(converter_->measureNuc(lastTerms_, uniformScene, referenceC));
+    nucPending_ = true;
+    std::clog << "[MLX90640] NUC table captured at Ta=" << lastTerms_.ta << " °C ("
+              << cache_.nuc.size() << " in use)\n";
+    return cachePath_.empty() || cache_.save(cachePath_);
+}
+
+
+bool MLX90640Reader::clearNuc()
+{
+    std::lock_guard<std::mutex> lock(calibMutex_);
+    cache_.nuc.clear();
+    nucPending_ = true;
+    return cachePath_.empty() || cache_.save(cachePath_);
+}
+
+
+size_t MLX90640Reader::nucTables() const
+{
+    std::lock_guard<std::mutex> lock(calibMutex_);
+    return cache_.nuc.size();
+}
+
+
+void MLX90640Reader::applyPendingNuc()
+{
+    std::lock_guard<std::mutex> lock(calibMutex_);
+    if (!converter_) {                       // readFrame() without initialize()
+        converter_  = std::make_unique<PixelConverter>(params_);
+        coeffCache_ = std::make_unique<CoefficientCache>(*converter_, cacheOptions());
+    }
+    if (nucPending_) {
+        converter_->applyNuc(cache_.nuc);
+        coeffCache_->invalidate();           // its factors came from the old coefficients
+        nucPending_ = false;
+    }
+}
+
+
+void MLX90640Reader::countSubpageFailure(int rc)
+{
+    // GetFrameData returns the subpage it read, or a negative I2C error.
+    Counter* c = rc < 0 ? metrics_.i2cErrors : metrics_.subpageSkips;
+    if (c) c->inc();
+}
+
+
+void MLX90640Reader::setSpeculative(bool on)
+{
+    speculative_ = on;
+    if (!on) {
+        fetcher_.reset();
+    }
+}
+
+
+int MLX90640Reader::grab(uint16_t* words, float subpagePeriodS)
+{
+    if (!speculative_) {
+        return MLX90640_GetFrameData(address_, words);
+    }
+    // The fetcher's clock model is per refresh rate; rebuild it on a change
+    const int64_t periodNs = static_cast<int64_t>(subpagePeriodS * 1e9);
+    if (!fetcher_ || periodNs != fetchPeriodNs_) {
+        FetchOptions opt;
+        opt.periodNs   = periodNs;
+        opt.pollNs     = std::max<int64_t>(periodNs / 32, 200'000);
+        fetcher_       = std::make_unique<SubpageFetcher>(*bus_, opt);
+        fetchPeriodNs_ = periodNs;
+        std::clog << "[MLX90640] speculative acquisition, " << periodNs / 1000 << " us/subpage\n";
+    }
+    return fetcher_->fetch(words).subpage;
+}
+
+
 bool MLX90640Reader::readFrame(std::vector<float> &frameData)
 {
     using namespace duosight;
@@ -165,10 +312,14 @@ bool MLX90640Reader::readFrame(std::vector<float> &frameData)
         std::cerr << "[MLX90640] I²C device not open\n";
         return false;
     }
+    applyPendingNuc();
+
+    const auto started = std::chrono::steady_clock::now();
 
     // --- Read refresh rate info ---
     const auto ri = readRefreshRate(true); // verbose prints rate/subpage time
     if (ri.code < 0 || ri.subpage_period_s <= 0.0f) {
+        if (metrics_.i2cErrors) metrics_.i2cErrors->inc();
         std::cerr << "[MLX90640] ❌ Invalid refresh rate — cannot proceed\n";
         return false;
     }
@@ -179,77 +330,57 @@ bool MLX90640Reader::readFrame(std::vector<float> &frameData)
 
     std::array<uint16_t, Geometry::WORDS> subpage0{};
     std::array<uint16_t, Geometry::WORDS> subpage1{};
-    std::vector<float> subframe0{};
-    std::vector<float> subframe1{};
+    std::array<float, Geometry::PIXELS> subframe0{};
+    std::array<float, Geometry::PIXELS> subframe1{};
     
     int sp = -1;
 
     // --- First subpage ---
-    sp = MLX90640_GetFrameData(address_, subpage0.data());
+    sp = grab(subpage0.data(), ri.subpage_period_s);
     if (sp != 0) {
+        countSubpageFailure(sp);
         std::clog << "[MLX90640] GetFrameData failed for first subpage rc=" << sp << "\n";
         return false;
     }
 
-    std::clog << "\n";
-
-    Ta = MLX90640_GetTa(subpage0.data(), &params_);
-    std::clog << "[MLX90640] --- Dump first 40 words of subpage0 \n";
-    
-        
-    std::clog << "\n";
-    
-    // --- Convert to temperatures ---
-    subframe0.resize(Geometry::WIDTH * Geometry::HEIGHT);
-        
-    MLX90640_CalculateTo(subpage0.data(),
-                         &params_,
-                         IRParams::EMISSIVITY,
-                         Ta,
-                         subframe0.data());
+    // --- Convert to temperatures (factory + NUC; Ta/Vdd factors cached) ---
+    const SubpageTerms terms0 = coeffCache_->prepare(subpage0.data());
+    coeffCache_->convertSubpage(subpage0.data(), terms0, subframe0.data());
 
         
     // --- Second subpage ---
-    sp = MLX90640_GetFrameData(address_, subpage1.data());
+    sp = grab(subpage1.data(), ri.subpage_period_s);
     if (sp != 1) {
+        countSubpageFailure(sp);
         std::clog << "[MLX90640] GetFrameData failed for second subpage rc=" << sp << "\n";
         return false;
     } 
        
-    Ta = MLX90640_GetTa(subpage1.data(), &params_);
-    
     // --- Convert to temperatures ---
-    subframe1.resize(Geometry::WIDTH * Geometry::HEIGHT);
-
-    MLX90640_CalculateTo(subpage1.data(),
-                         &params_,
-                         IRParams::EMISSIVITY,
-                         Ta,
-                         subframe1.data());
+    const SubpageTerms terms1 = coeffCache_->prepare(subpage1.data());
+    coeffCache_->convertSubpage(subpage1.data(), terms1, subframe1.data());
+    Ta = terms1.ta;
+    {
+        std::lock_guard<std::mutex> lock(calibMutex_);
+        lastTerms_ = terms1;
+    }
     
-    frameData.resize(Geometry::WIDTH * Geometry::HEIGHT);
-
-
-   // assumes: WIDTH * HEIGHT == Geometry::PIXELS
-std::clog << "[MLX90640] --- Image Dump (" << Geometry::WIDTH << " x " << Geometry::HEIGHT << ")\n";
-
-for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
-    for (int col = 0; col < static_cast<int>(Geometry::WIDTH); ++col) {
-        const int i = (row * static_cast<int>(Geometry::WIDTH)) + col;
-
-        // --- Merge subpages into a complete frame ---
-        frameData[i] = (Geometry::PIXEL_TO_SUBPAGE[i] == 0)
-                     ? subframe0[i]
-                     : subframe1[i];
-
-        // print with a space between values; no trailing space at EOL
-        std::clog << frameData[i];
-        if (col + 1 < static_cast<int>(Geometry::WIDTH)) {
-            std::clog << ' ';
-        }
+    // --- Merge subpages: each pixel from the subpage that refreshed it ---
+    frameData.resize(Geometry::PIXELS);
+    mergeSubpages(terms1.chessMode, subframe0.data(), subframe1.data(), frameData.data());
+
+    if (metrics_.frames) {
+        const auto [lo, hi] = std::minmax_element(frameData.begin(), frameData.end());
+        double sum = 0.0;
+        for (float v : frameData) sum += v;
+        metrics_.frames->inc();
+        metrics_.readSeconds->observe(std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - started).count());
+        metrics_.ambientC->set(Ta);
+        metrics_.minC->set(*lo);
+        metrics_.maxC->set(*hi);
+        metrics_.meanC->set(sum / frameData.size());
     }
-    std::clog << '\n'; // newline after exactly WIDTH datapoints
-}
 
     return true;
 }
@@ -14,7 +14,31 @@
  *
  *   It uses the DuoSight I2cDevice class and MLX90640Reader wrapper
  *   to communicate with the sensor, and renders thermal data using a
- *   simple blue-to-red linear gradient.
+ *   simple blue-to-red gradient. The view is upscaled to 640x480 and
+ *   contrast-equalised per tile (CLAHE) so small gradients stay visible
+ *   next to a hot object; the min/max/avg readout uses raw temperatures.
+ *
+ *   Acquisition runs on its own thread and publishes each merged frame into
+ *   a duosight::ProcessingGraph; rendering is one sink of that graph, so
+ *   further branches (recording, analytics) can be added in the startup
+ *   spec without touching the acquisition loop. Set DUOSIGHT_GRAPH to
+ *   override the default wiring. Frames are tagged with a scene-change
+ *   mask and rendering is skipped while nothing in view changes. Set
+ *   DUOSIGHT_TSDB to a file path to keep min/max/mean trend history, and
+ *   DUOSIGHT_METRICS_PORT to serve acquisition health at /metrics. The
+ *   snapshot button stacks the next 64 frames into a low-noise mean and
+ *   variance image (CSV) while the live view keeps running; the flat-field
+ *   button stacks a uniform scene into a NUC table that is folded into the
+ *   conversion. The tables and the EEPROM image are kept on disk only if
+ *   DUOSIGHT_CALIBRATION names the cache file.
+ *   DUOSIGHT_DISPLAY_HZ (e.g. 60) redraws the view at that rate from
+ *   motion-compensated frames interpolated between measurements; those
+ *   are marked as display-only and never reach the readout.
+ *   DUOSIGHT_SPECULATIVE=1 reads each predicted subpage with one combined
+ *   STATUS + RAM transaction instead of polling STATUS first.
+ *   The viewer has no in-process foreign consumer, so it wires no
+ *   duosight.h pipeline. Hosts that have one add a pipelineSink() node
+ *   (cApi.hpp) to the same graph.
  *
  *   Intended for hardware validation and GUI integration testing.
  */
@@ -22,19 +46,43 @@
 #include <iostream>
 #include <algorithm>
 #include <numeric>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QPushButton>
+#include <QtCore/QMetaObject>
 #include <QtCore/QTimer>
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
 
 #include "MLX90640Reader.hpp"
 #include "MLX90640Regs.hpp"
+#include "busArbiter.hpp"
+#include "clahe.hpp"
+#include "frameInterpolator.hpp"
+#include "frameStacker.hpp"
 #include "i2cUtils.hpp"
+#include "metrics.hpp"
+#include "metricsServer.hpp"
 #include "mlx90640Transport.h"
+#include "processingGraph.hpp"
+#include "sceneChange.hpp"
+#include "timeSeriesStore.hpp"
+#include "workStealingPool.hpp"
+
+// Default stage wiring; DUOSIGHT_GRAPH replaces it at startup.
+static constexpr const char* DEFAULT_GRAPH = "source -> render[1]; source -> stack[8]";
 
 QRgb mapTemperatureToColor(float temp, float minT, float maxT) {
     float t = (temp - minT) / (maxT - minT);
@@ -54,12 +102,26 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // initialise the reader
-    duosight::MLX90640Reader sensor(bus, duosight::Bus::SLAVE_ADDR);
-    if (!sensor.initialize()) {
+    // Bus transfers queue at one arbiter. The MLX90640 is its only client
+    // so far: this viewer polls none of the housekeeping devices on
+    // /dev/i2c-3. A poller added here gets its own ArbitratedDevice at
+    // BusPriority::Housekeeping (splittable for bulk reads) so it never
+    // holds up a subpage burst; other processes are not arbitrated.
+    duosight::BusArbiter       arbiter;
+    duosight::ArbitratedDevice sensorBus(arbiter, bus,
+                                         {"mlx90640", duosight::BusPriority::Critical, 20'000'000, false});
+
+    // initialise the reader; EEPROM image and NUC tables are cached on disk
+    // only when DUOSIGHT_CALIBRATION names the file
+    const char* calibration = std::getenv("DUOSIGHT_CALIBRATION");
+    duosight::MLX90640Reader sensor(sensorBus, duosight::Bus::SLAVE_ADDR);
+    if (!sensor.initialize(calibration ? calibration : "")) {
         qCritical("❌ Sensor init failed");
         return 1;
     }
+    if (const char* spec = std::getenv("DUOSIGHT_SPECULATIVE"); spec && std::atoi(spec) != 0) {
+        sensor.setSpeculative(true);
+    }
 
     // GUI layout
     QWidget window;
@@ -71,47 +133,250 @@ int main(int argc, char *argv[]) {
     imageLabel->setAlignment(Qt::AlignCenter);
     layout->addWidget(imageLabel);
     layout->addWidget(infoLabel);
+    QPushButton *stackButton = new QPushButton("📸 Low-noise snapshot");
+    layout->addWidget(stackButton);
+    QPushButton *nucButton = new QPushButton("🎯 Flat-field (uniform scene)");
+    layout->addWidget(nucButton);
 
     window.setLayout(layout);
     window.setWindowTitle("MLX90640 Live Viewer");
     window.show();
 
-    // Live frame update
-    QTimer *timer = new QTimer;
-    QObject::connect(timer, &QTimer::timeout, [&]() {
-        std::vector<float> frame;
+    // Processing graph: acquisition publishes, stages run on the pool
+    duosight::WorkStealingPool pool;
+    duosight::ProcessingGraph  graph(pool);
 
-        if (!sensor.readFrame(frame)) {
-            infoLabel->setText("❌ Frame read failed");
-            return;
-        }
+    duosight::GateStats renderGate;
 
-        float minT = *std::min_element(frame.begin(), frame.end());
-        float maxT = *std::max_element(frame.begin(), frame.end());
-        float avgT = std::accumulate(frame.begin(), frame.end(), 0.0f) / frame.size();
+    // Display-only contrast: CLAHE on the upscaled image, temperatures untouched
+    auto clahe = std::make_shared<duosight::Clahe>();
+    auto grey  = std::make_shared<std::vector<uint8_t>>(clahe->width() * clahe->height());
+    std::array<QRgb, 256> palette;
+    for (int v = 0; v < 256; ++v) {
+        palette[v] = mapTemperatureToColor(static_cast<float>(v), 0.0f, 255.0f);
+    }
 
-        QImage img(duosight::Geometry::WIDTH,
-                duosight::Geometry::HEIGHT,
-                QImage::Format_RGB888);
+    // Optional display upconversion: DUOSIGHT_DISPLAY_HZ=60 redraws the view
+    // at that rate from frames interpolated between measurements. Those are
+    // display-only; the readout and every other branch see measured frames.
+    const char* displayHz = std::getenv("DUOSIGHT_DISPLAY_HZ");
+    const int   upconvertHz = displayHz ? std::atoi(displayHz) : 0;
 
-        // Optional: clear to a known background
-        img.fill(qRgb(0, 0, 0));
+    auto toImage = [clahe, grey, palette](const float* values, float lo, float hi) {
+        clahe->upscale(values, lo, hi);
+        clahe->equalise(grey->data());
 
-        for (int i = 0; i < duosight::Geometry::HEIGHT; ++i) {
-            for (int j = 0; j < duosight::Geometry::WIDTH; ++j) {
-                float t = frame[i * duosight::Geometry::WIDTH + j];
-                img.setPixel(j, i, mapTemperatureToColor(t, minT, maxT));
+        QImage img(clahe->width(), clahe->height(), QImage::Format_RGB888);
+        for (int y = 0; y < clahe->height(); ++y) {
+            const uint8_t* g = grey->data() + y * clahe->width();
+            uchar* line = img.scanLine(y);
+            for (int x = 0; x < clahe->width(); ++x) {
+                const QRgb c = palette[g[x]];
+                line[3 * x]     = static_cast<uchar>(qRed(c));
+                line[3 * x + 1] = static_cast<uchar>(qGreen(c));
+                line[3 * x + 2] = static_cast<uchar>(qBlue(c));
             }
         }
+        return img;
+    };
 
-        QPixmap pixmap = QPixmap::fromImage(img.scaled(320, 240));
-        imageLabel->setPixmap(pixmap);
-        infoLabel->setText(QString("🌡️ Min: %1 °C | Max: %2 °C | Avg: %3 °C")
+    graph.addSource("source");
+    graph.addNode("render", duosight::NodeKind::Sink, duosight::gateOnChange(
+                  [imageLabel, infoLabel, toImage, upconvertHz](const duosight::FramePtr& frame) -> duosight::FramePtr {
+        const auto& t = frame->temperatures;
+        float minT = *std::min_element(t.begin(), t.end());
+        float maxT = *std::max_element(t.begin(), t.end());
+        float avgT = std::accumulate(t.begin(), t.end(), 0.0f) / t.size();
+
+        const QString info = QString("🌡️ Min: %1 °C | Max: %2 °C | Avg: %3 °C%4")
             .arg(minT, 0, 'f', 2)
             .arg(maxT, 0, 'f', 2)
-            .arg(avgT, 0, 'f', 2));
+            .arg(avgT, 0, 'f', 2)
+            .arg(upconvertHz > 0 ? " | view interpolated, not radiometric" : "");
+
+        // QPixmap and widgets belong to the GUI thread
+        if (upconvertHz > 0) {
+            QMetaObject::invokeMethod(infoLabel, [infoLabel, info]() {
+                infoLabel->setText(info);
+            }, Qt::QueuedConnection);
+            return nullptr;
+        }
+        const QImage img = toImage(t.data(), minT, maxT);
+        QMetaObject::invokeMethod(imageLabel, [imageLabel, infoLabel, img, info]() {
+            imageLabel->setPixmap(QPixmap::fromImage(img));
+            infoLabel->setText(info);
+        }, Qt::QueuedConnection);
+        return nullptr;
+    }, renderGate));
+
+    // Inspection snapshots: the stacker sees the same frames as the view
+    duosight::FrameStacker stacker;
+    graph.addNode("stack", duosight::NodeKind::Filter, stacker.stage());
+    QObject::connect(stackButton, &QPushButton::clicked, [&stacker, infoLabel]() {
+        stacker.arm([infoLabel](const duosight::StackPtr& s) {
+            const std::string path = "duosight-stack-" + std::to_string(s->lastSequence) + ".csv";
+            std::ofstream csv(path);
+            for (const auto* plane : {&s->mean, &s->variance}) {
+                for (int i = 0; i < duosight::Geometry::PIXELS; ++i) {
+                    csv << (*plane)[i] << ((i + 1) % duosight::Geometry::WIDTH ? ',' : '\n');
+                }
+                csv << '\n';
+            }
+            const QString info = QString("📸 %1 frames stacked, %2 samples clipped → %3")
+                .arg(s->frames).arg(s->rejected).arg(QString::fromStdString(path));
+            QMetaObject::invokeMethod(infoLabel, [infoLabel, info]() {
+                infoLabel->setText(info);
+            }, Qt::QueuedConnection);
+        });
+    });
+
+    // Flat-field: stack a uniform scene (shutter or blackbody) and fold the
+    // residual pattern into the conversion. DUOSIGHT_NUC_REFERENCE gives the
+    // blackbody temperature; otherwise the scene mean is the reference.
+    QObject::connect(nucButton, &QPushButton::clicked, [&stacker, &sensor, infoLabel, calibration]() {
+        const bool armed = stacker.arm([&sensor, infoLabel, calibration](const duosight::StackPtr& s) {
+            const auto& m = s->mean;
+            const char* ref = std::getenv("DUOSIGHT_NUC_REFERENCE");
+            const float referenceC = ref ? std::strtof(ref, nullptr)
+                                         : std::accumulate(m.begin(), m.end(), 0.0f) / m.size();
+            const bool saved = sensor.addNuc(m.data(), referenceC);
+            const QString info = QString("🎯 Flat-field at %1 °C applied (%2 table(s))%3")
+                .arg(referenceC, 0, 'f', 2).arg(sensor.nucTables())
+                .arg(!calibration ? " — not saved (DUOSIGHT_CALIBRATION unset)"
+                                  : saved ? "" : " — not saved");
+            QMetaObject::invokeMethod(infoLabel, [infoLabel, info]() {
+                infoLabel->setText(info);
+            }, Qt::QueuedConnection);
+        });
+        if (!armed) {
+            infoLabel->setText("⏳ A capture is already running");
+        }
+    });
+
+    // Optional trend history of frame statistics in a compressed store
+    std::string wiring = DEFAULT_GRAPH;
+    std::unique_ptr<duosight::TimeSeriesStore> history;
+    if (const char* path = std::getenv("DUOSIGHT_TSDB")) {
+        history = std::make_unique<duosight::TimeSeriesStore>(path);
+        if (history->isValid()) {
+            const duosight::SeriesOptions opt{duosight::SeriesEncoding::FixedPoint, 0.01f};
+            const std::array<int, 3> ids = {history->addSeries("frame.min", opt),
+                                            history->addSeries("frame.max", opt),
+                                            history->addSeries("frame.mean", opt)};
+            duosight::TimeSeriesStore* store = history.get();
+            graph.addNode("history", duosight::NodeKind::Sink,
+                          [store, ids](const duosight::FramePtr& frame) -> duosight::FramePtr {
+                const auto& t = frame->temperatures;
+                const auto [lo, hi] = std::minmax_element(t.begin(), t.end());
+                const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                store->append(ids[0], nowMs, *lo);
+                store->append(ids[1], nowMs, *hi);
+                store->append(ids[2], nowMs, std::accumulate(t.begin(), t.end(), 0.0f) / t.size());
+                return nullptr;
+            });
+            wiring += "; source -> history[8]";
+        }
+    }
+
+    // Upconverted view: the interpolator is fed from the graph and drawn
+    // from a GUI-thread timer at the display rate
+    duosight::FrameInterpolator interpolator;
+    QTimer displayTimer;
+    if (upconvertHz > 0) {
+        graph.addNode("interpolate", duosight::NodeKind::Sink, interpolator.stage());
+        wiring += "; source -> interpolate[1]";
+        imageLabel->setToolTip("Interpolated between measured frames (display only, not radiometric)");
+        QObject::connect(&displayTimer, &QTimer::timeout,
+                         [&interpolator, imageLabel, toImage, shown = uint64_t{0}]() mutable {
+            duosight::DisplayFrame df;
+            if (!interpolator.render(duosight::monotonicNowNs(), df)
+                || (df.phase == 1.0f && df.toSequence == shown)) {
+                return;
+            }
+            shown = df.phase == 1.0f ? df.toSequence : 0;
+            const auto [lo, hi] = std::minmax_element(df.values.begin(), df.values.end());
+            imageLabel->setPixmap(QPixmap::fromImage(toImage(df.values.data(), *lo, *hi)));
+        });
+        displayTimer.start(std::max(1, 1000 / upconvertHz));
+    }
+
+    const char* spec = std::getenv("DUOSIGHT_GRAPH");
+    if (!graph.configure(spec ? spec : wiring)) {
+        qCritical("❌ Invalid processing graph");
+        return 1;
+    }
+
+    // Optional /metrics endpoint: DUOSIGHT_METRICS_PORT=9464 (loopback unless
+    // DUOSIGHT_METRICS_BIND says otherwise)
+    duosight::MetricsRegistry metrics;
+    std::unique_ptr<duosight::MetricsServer> metricsServer;
+    if (const char* port = std::getenv("DUOSIGHT_METRICS_PORT")) {
+        sensor.attachMetrics(metrics);
+        arbiter.attachMetrics(metrics);
+        for (const auto& node : graph.stats()) {
+            const std::string stage  = node.name;
+            const std::string labels = "stage=\"" + stage + "\"";
+            auto pick = [&graph, stage](auto field) {
+                return [&graph, stage, field]() {
+                    for (const auto& s : graph.stats()) {
+                        if (s.name == stage) return static_cast<double>(field(s));
+                    }
+                    return 0.0;
+                };
+            };
+            metrics.callbackCounter("duosight_stage_frames_total", "Frames handled per graph stage",
+                                    pick([](const duosight::NodeStats& s) { return s.processed; }), labels);
+            metrics.callbackCounter("duosight_stage_dropped_total", "Frames dropped at a stage's input",
+                                    pick([](const duosight::NodeStats& s) { return s.dropped; }), labels);
+            metrics.callbackGauge("duosight_stage_mean_seconds", "Mean stage execution time",
+                                  pick([](const duosight::NodeStats& s) { return s.meanUs * 1e-6; }), labels);
+            metrics.callbackGauge("duosight_stage_queue_depth", "Frames waiting at a stage",
+                                  pick([](const duosight::NodeStats& s) { return s.queueDepth; }), labels);
+        }
+        const char* bind = std::getenv("DUOSIGHT_METRICS_BIND");
+        metricsServer = std::make_unique<duosight::MetricsServer>(
+            metrics, static_cast<uint16_t>(std::atoi(port)), bind ? bind : "127.0.0.1");
+    }
+
+    // Live frame acquisition
+    std::atomic<bool> running{true};
+    std::thread acquisition([&]() {
+        uint64_t sequence = 0;
+        std::vector<float> frame;
+        duosight::SceneChangeDetector sceneChange;
+
+        while (running) {
+            if (!sensor.readFrame(frame)) {
+                QMetaObject::invokeMethod(infoLabel, [infoLabel]() {
+                    infoLabel->setText("❌ Frame read failed");
+                }, Qt::QueuedConnection);
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                continue;
+            }
+
+            auto packet = std::make_shared<duosight::ThermalFrame>();
+            packet->sequence    = ++sequence;
+            packet->timestampNs = duosight::monotonicNowNs();
+            std::copy(frame.begin(), frame.end(), packet->temperatures.begin());
+
+            const auto change    = sceneChange.update(packet->temperatures.data());
+            packet->changedTiles = change.changedTiles;
+            packet->changeScore  = change.score;
+            graph.push("source", packet);
+        }
     });
-    timer->start(500);  // ~2 fps for the moment
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, [&running]() { running = false; });
 
-    return app.exec();
+    const int rc = app.exec();
+    acquisition.join();
+    graph.drain();
+    for (const auto& s : graph.stats()) {
+        std::clog << "[Graph] " << s.name << ": " << s.processed << " frames, "
+                  << s.dropped << " dropped, mean " << s.meanUs << " us, max "
+                  << s.maxUs << " us\n";
+    }
+    std::clog << "[Graph] render skipped " << renderGate.skipped << " static frames, saving "
+              << renderGate.savedMs() << " ms CPU\n";
+    return rc;
 }
@@ -6,7 +6,8 @@
 #
 # Summary:
 #   Script to run diagnostic tests for DuoSight components.
-#   Verifies both i2cUtils logic and MLX90640 sensor capture.
+#   Verifies i2cUtils logic and MLX90640 sensor capture, then runs the
+#   libduosight tests, which need no hardware.
 
 echo "=== DuoSight Self-Test Suite ==="
 
@@ -38,6 +39,30 @@ run_test() {
 
 run_test ./test_i2cUtils "I2C Utility Unit Test"
 run_test ./test_mlx90640_reader "MLX90640 Sensor Self-Test"
+run_test ./test_processing_graph "Processing Graph Test"
+run_test ./test_frame_history "Frame History Test"
+run_test ./test_lazy_frame "Lazy Frame Test"
+run_test ./test_threshold_search "Threshold Search Test"
+run_test ./test_scene_change "Scene Change Test"
+run_test ./test_synthetic_scene "Synthetic Scene Test"
+run_test ./test_fault_injection "Fault Injection Test"
+run_test ./test_time_series_store "Time-Series Store Test"
+run_test ./test_metrics "Metrics Test"
+run_test ./test_frame_stacker "Frame Stacker Test"
+run_test ./test_clahe "CLAHE Test"
+run_test ./test_nuc "NUC Test"
+run_test ./test_c_abi "C ABI Test"
+run_test ./test_frame_interpolator "Frame Interpolator Test"
+run_test ./test_subpage_merge "Subpage Merge Test"
+run_test ./test_subpage_fetcher "Subpage Fetcher Test"
+run_test ./test_bus_arbiter "Bus Arbiter Test"
+run_test ./test_stagger_coordinator "Stagger Coordinator Test"
+run_test ./test_coefficient_cache "Coefficient Cache Test"
+run_test ./test_spatial_filter "Spatial Filter Test"
+run_test ./test_isotherms "Isotherms Test"
+run_test ./test_rate_of_rise "Rate of Rise Test"
+run_test ./test_recording_writer "Recording Writer Test"
+run_test ./test_zone_map "Zone Map Test"
 
 echo "=== Self-Test Complete ==="
 exit $PASS
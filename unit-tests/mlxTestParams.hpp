@@ -0,0 +1,87 @@
+/**
+ * @file mlxTestParams.hpp
+ * @brief Nominal MLX90640 calibration and raw subpages for hardware-free tests.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Builds a paramsMLX90640 with values typical of a production sensor
+ *   (chess calibration, 18-bit ADC) and raw subpage words whose auxiliary
+ *   block decodes to Ta ≈ 25 °C and Vdd = 3.3 V, so conversion code can
+ *   be exercised on a desk without the EEPROM of a real device.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include "MLX90640_API.h"
+#include "MLX90640Regs.hpp"
+
+namespace duosight::test {
+
+inline paramsMLX90640 makeNominalParams(uint32_t seed = 1)
+{
+    paramsMLX90640 p{};
+    p.kVdd              = -3200;
+    p.vdd25             = -12544;
+    p.KvPTAT            = 0.0053f;
+    p.KtPTAT            = 42.0f;
+    p.vPTAT25           = 12200;
+    p.alphaPTAT         = 9.0f;
+    p.gainEE            = 5900;
+    p.tgc               = 0.0f;
+    p.cpKv              = 0.375f;
+    p.cpKta             = 0.0044f;
+    p.resolutionEE      = 2;
+    p.calibrationModeEE = 128;          // chess
+    p.KsTa              = -0.002f;
+    for (float& k : p.ksTo) k = -0.0008f;
+    p.ct[0] = -40; p.ct[1] = 0; p.ct[2] = 160; p.ct[3] = 320; p.ct[4] = 400;
+    p.alphaScale = 12;
+    p.ktaScale   = 14;
+    p.kvScale    = 8;
+    p.cpAlpha[0] = p.cpAlpha[1] = 4.6e-9f;
+    p.cpOffset[0] = p.cpOffset[1] = -60;
+    p.ilChessC[0] = 0.0625f; p.ilChessC[1] = 2.0f; p.ilChessC[2] = 0.4f;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> alpha(32000, 36000), offset(-90, -30),
+                                       kta(50, 80), kv(80, 110);
+    for (int i = 0; i < Geometry::PIXELS; ++i) {
+        p.alpha[i]  = static_cast<uint16_t>(alpha(rng));
+        p.offset[i] = static_cast<int16_t>(offset(rng));
+        p.kta[i]    = static_cast<int8_t>(kta(rng));
+        p.kv[i]     = static_cast<int8_t>(kv(rng));
+    }
+    return p;
+}
+
+/// Raw subpage words: pixel = offset + signal, aux words for Ta≈25 °C,
+/// Vdd=3.3 V, unity gain, CTRL1 = chess / 18-bit / FR2.
+inline std::array<uint16_t, Geometry::WORDS>
+makeSubpageWords(const paramsMLX90640& p, int subpage, uint32_t seed = 7, int maxSignal = 400)
+{
+    std::array<uint16_t, Geometry::WORDS> w{};
+    std::mt19937 rng(seed + subpage);
+    std::uniform_int_distribution<int> signal(0, maxSignal);
+
+    for (int i = 0; i < Geometry::PIXELS; ++i) {
+        w[i] = static_cast<uint16_t>(static_cast<int16_t>(p.offset[i] + signal(rng)));
+    }
+    w[768] = 19000;                                        // Ta_Vbe
+    w[800] = 1522;                                         // Ta_PTAT
+    w[810] = static_cast<uint16_t>(p.vdd25);               // Vdd
+    w[778] = static_cast<uint16_t>(p.gainEE);              // gain
+    w[776] = static_cast<uint16_t>(static_cast<int16_t>(p.cpOffset[0]));
+    w[808] = static_cast<uint16_t>(static_cast<int16_t>(p.cpOffset[1]));
+    w[832] = 0x1901;                                       // CTRL1
+    w[833] = static_cast<uint16_t>(subpage);
+    return w;
+}
+
+} // namespace duosight::test
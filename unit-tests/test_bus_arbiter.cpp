@@ -0,0 +1,234 @@
+/**
+ * @file test_bus_arbiter.cpp
+ * @brief Shared-bus arbitration: subpage bursts against housekeeping traffic.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Fake devices occupy a common "wire" for the time their bytes take at
+ *   1 MHz, and flag any overlap. An MLX90640 client issues a 15 ms combined
+ *   burst every subpage while an EEPROM (0x50) is dumped continuously and
+ *   four temperature sensors (0x48-0x4b) are polled. The same load runs
+ *   once first-come first-served (one priority, nothing split) and once
+ *   arbitrated; the per-client wait times of both are reported. Checks
+ *   that the bursts stop queueing behind the dump and that the housekeeping
+ *   data still arrives intact. No hardware needed.
+ */
+
+#include "busArbiter.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace duosight;
+
+struct Wire {
+    std::atomic<bool>     busy {false};
+    std::atomic<uint64_t> collisions {0};
+};
+
+/// Register file that reads back (register + offset) & 0xFF, and takes
+/// 9 bit times per byte on the shared wire.
+class FakeDevice : public I2cDevice {
+public:
+    FakeDevice(uint8_t address, Wire& wire) : I2cDevice(address), wire_(wire) {}
+
+    bool isOpen() const override { return true; }
+    bool writeBytes(const uint8_t*, size_t length) override { occupy(length + 1); return true; }
+    bool readBytes(uint8_t* buffer, size_t length) override
+    {
+        occupy(length + 1);
+        std::fill(buffer, buffer + length, 0);
+        return true;
+    }
+    bool writeThenRead(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) override
+    {
+        I2cMessage m[2] = {{false, const_cast<uint8_t*>(tx), txLen}, {true, rx, rxLen}};
+        return transfer(m, 2);
+    }
+    bool transfer(I2cMessage* messages, size_t count) override
+    {
+        size_t bytes = 0;
+        for (size_t i = 0; i < count; ++i) bytes += messages[i].length + 1;
+        occupy(bytes);
+        uint16_t reg = 0;
+        for (size_t i = 0; i < count; ++i) {
+            I2cMessage& m = messages[i];
+            if (!m.read) {
+                reg = static_cast<uint16_t>((m.data[0] << 8) | (m.length > 1 ? m.data[1] : 0));
+                continue;
+            }
+            for (size_t b = 0; b < m.length; ++b) m.data[b] = static_cast<uint8_t>(reg + b);
+        }
+        return true;
+    }
+
+private:
+    void occupy(size_t bytes)
+    {
+        if (wire_.busy.exchange(true)) {
+            ++wire_.collisions;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(bytes * 9));
+        wire_.busy = false;
+    }
+
+    Wire& wire_;
+};
+
+struct LoadResult {
+    std::vector<BusClientStats> stats;
+    uint64_t collisions {0};
+    uint64_t badDumps   {0};
+    uint64_t dumps      {0};
+};
+
+LoadResult runLoad(bool arbitrated)
+{
+    using namespace std::chrono;
+    Wire       wire;
+    BusArbiter arbiter;
+    FakeDevice mlx(0x33, wire), eeprom(0x50, wire);
+    std::vector<std::unique_ptr<FakeDevice>> temps;
+    for (uint8_t a = 0x48; a <= 0x4b; ++a) temps.push_back(std::make_unique<FakeDevice>(a, wire));
+
+    auto opts = [&](const char* name, BusPriority p, int64_t budgetNs, bool split) {
+        return arbitrated ? BusClientOptions{name, p, budgetNs, split}
+                          : BusClientOptions{name, BusPriority::Normal, 1'000'000'000, false};
+    };
+    ArbitratedDevice mlxBus(arbiter, mlx, opts("mlx90640", BusPriority::Critical, 20'000'000, false));
+    ArbitratedDevice eeBus(arbiter, eeprom, opts("eeprom", BusPriority::Housekeeping, 500'000'000, true));
+    std::vector<std::unique_ptr<ArbitratedDevice>> tempBuses;
+    const char* tempNames[] = {"tmp-0x48", "tmp-0x49", "tmp-0x4a", "tmp-0x4b"};
+    for (size_t i = 0; i < temps.size(); ++i) {
+        tempBuses.push_back(std::make_unique<ArbitratedDevice>(
+            arbiter, *temps[i], opts(tempNames[i], BusPriority::Normal, 20'000'000, false)));
+    }
+
+    std::atomic<bool> stop {false};
+    LoadResult r;
+
+    // Subpage bursts: STATUS + RAM + CTRL1 in one transaction every 31.25 ms
+    std::thread mlxThread([&] {
+        std::vector<uint8_t> ram(1664);
+        uint8_t st[2], ctrl[2], sReg[2] = {0x80, 0x00}, rReg[2] = {0x04, 0x00}, cReg[2] = {0x80, 0x0D};
+        auto next = steady_clock::now();
+        while (!stop) {
+            next += microseconds(31'250);
+            std::this_thread::sleep_until(next);
+            I2cMessage m[6] = {{false, sReg, 2}, {true, st, 2}, {false, rReg, 2},
+                               {true, ram.data(), ram.size()}, {false, cReg, 2}, {true, ctrl, 2}};
+            mlxBus.transfer(m, 6);
+        }
+    });
+
+    // EEPROM dump, back to back: 256 bytes as 16 accesses of 16 bytes
+    std::thread eeThread([&] {
+        std::vector<std::array<uint8_t, 2>>  addr(16);
+        std::vector<std::array<uint8_t, 16>> data(16);
+        while (!stop) {
+            std::vector<I2cMessage> m;
+            for (int i = 0; i < 16; ++i) {
+                addr[i] = {0x00, static_cast<uint8_t>(i * 16)};
+                m.push_back({false, addr[i].data(), 2});
+                m.push_back({true, data[i].data(), 16});
+            }
+            eeBus.transfer(m.data(), m.size());
+            bool ok = true;
+            for (int i = 0; i < 16; ++i) {
+                for (int b = 0; b < 16; ++b) ok = ok && data[i][b] == static_cast<uint8_t>(i * 16 + b);
+            }
+            ++r.dumps;
+            r.badDumps += ok ? 0 : 1;
+        }
+    });
+
+    // Temperature sensors, each polled every 10 ms
+    std::thread tempThread([&] {
+        auto next = steady_clock::now();
+        while (!stop) {
+            next += milliseconds(10);
+            std::this_thread::sleep_until(next);
+            for (auto& b : tempBuses) {
+                uint8_t reg = 0x00, rx[2];
+                b->writeThenRead(&reg, 1, rx, 2);
+            }
+        }
+    });
+
+    std::this_thread::sleep_for(milliseconds(1500));
+    stop = true;
+    mlxThread.join();
+    eeThread.join();
+    tempThread.join();
+
+    r.stats      = arbiter.stats();
+    r.collisions = wire.collisions;
+    return r;
+}
+
+const BusClientStats& find(const LoadResult& r, const char* name)
+{
+    for (const auto& s : r.stats) {
+        if (s.name == name) return s;
+    }
+    return r.stats.front();
+}
+
+void report(const char* label, const LoadResult& r)
+{
+    for (const auto& s : r.stats) {
+        std::cout << "[BENCH] " << label << " " << s.name << ": " << s.transactions << " transactions, "
+                  << s.grants << " grants, wait mean " << s.meanWaitNs() / 1e3 << " us max "
+                  << s.maxWaitNs / 1e3 << " us, " << s.yields << " yields, " << s.deadlineMisses
+                  << " deadline misses\n";
+    }
+}
+
+} // namespace
+
+int main() {
+    const LoadResult fifo = runLoad(false);
+    const LoadResult arb  = runLoad(true);
+    report("fifo      ", fifo);
+    report("arbitrated", arb);
+
+    bool ok = true;
+    if (fifo.collisions || arb.collisions) {
+        std::cerr << "[FAIL] transfers overlapped on the wire\n";
+        ok = false;
+    }
+    if (arb.badDumps || arb.dumps == 0) {
+        std::cerr << "[FAIL] " << arb.badDumps << "/" << arb.dumps << " split EEPROM dumps corrupted\n";
+        ok = false;
+    }
+    const BusClientStats& mlxFifo = find(fifo, "mlx90640");
+    const BusClientStats& mlxArb  = find(arb, "mlx90640");
+    // At most one in-flight EEPROM access (~0.2 ms) or temperature read;
+    // the rest is scheduler wake-up latency
+    if (mlxArb.maxWaitNs >= mlxFifo.maxWaitNs || mlxArb.meanWaitNs() > 1e6) {
+        std::cerr << "[FAIL] subpage burst still queues behind housekeeping (mean "
+                  << mlxArb.meanWaitNs() / 1e3 << " us, max " << mlxArb.maxWaitNs / 1e3 << " us)\n";
+        ok = false;
+    }
+    const BusClientStats& ee = find(arb, "eeprom");
+    if (ee.yields == 0) {
+        std::cerr << "[FAIL] EEPROM dump never gave way between accesses\n";
+        ok = false;
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] subpage bursts wait " << mlxFifo.meanWaitNs() / mlxArb.meanWaitNs()
+              << "x less with arbitration; split dumps intact\n";
+    return 0;
+}
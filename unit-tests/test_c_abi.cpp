@@ -0,0 +1,265 @@
+/**
+ * @file test_c_abi.cpp
+ * @brief Functional test for the duosight.h C ABI and frame borrowing.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Runs the processing graph into a ds_pipeline and consumes it on
+ *   another thread through the C interface only, as an FFI binding would.
+ *   Checks that every borrowed pixel pointer is the acquisition frame's
+ *   own array (no copy anywhere on the way), the layout guarantees, drop
+ *   accounting, that a borrow outlives its ring slot and ends on release,
+ *   the borrow limit and shutdown. Reports borrow/release cost against a
+ *   frame copy. No hardware needed.
+ */
+
+#include "cApi.hpp"
+#include "processingGraph.hpp"
+#include "workStealingPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace duosight;
+
+constexpr int FRAMES = 4000;
+
+float pixelValue(uint64_t seq, int p)
+{
+    return 20.0f + static_cast<float>(seq % 1000) * 0.01f + static_cast<float>(p) * 1e-3f;
+}
+
+/// What a foreign consumer sees: duosight.h only.
+struct ConsumerResult {
+    int      received {0};
+    uint64_t dropped  {0};
+    int      errors   {0};
+};
+
+ConsumerResult consume(ds_pipeline* pipeline, const std::vector<FramePtr>& produced,
+                       std::atomic<bool>& ready)
+{
+    ConsumerResult r;
+    ds_reader* reader = ds_reader_open(pipeline);
+    ready = true;
+    uint64_t lastSeq = 0;
+
+    for (;;) {
+        const ds_frame* f = nullptr;
+        const int st = ds_reader_borrow(reader, 2000, &f);
+        if (st == DS_ECLOSED || st == DS_TIMEOUT) break;
+        if (st != DS_OK) { ++r.errors; break; }
+
+        const bool layout = f->struct_size == sizeof(ds_frame) && f->width == DS_WIDTH
+                         && f->height == DS_HEIGHT && f->row_stride == DS_ROW_STRIDE
+                         && reinterpret_cast<uintptr_t>(f->pixels) % DS_PIXEL_ALIGNMENT == 0;
+        // Zero copy: the pointer is the producer's own array
+        const bool same = f->sequence >= 1 && f->sequence <= produced.size()
+                       && f->pixels == produced[f->sequence - 1]->temperatures.data();
+        // Row 23, column 31 through the stride, as a strided binding indexes
+        const float* last = reinterpret_cast<const float*>(
+            reinterpret_cast<const char*>(f->pixels) + 23 * f->row_stride) + 31;
+        const bool values = f->pixels[0] == pixelValue(f->sequence, 0)
+                         && *last == pixelValue(f->sequence, 767);
+        const bool order  = f->sequence > lastSeq && f->sequence - lastSeq - 1 == f->dropped;
+
+        if (!layout || !same || !values || (lastSeq && !order)) {
+            if (r.errors++ == 0) {
+                std::cerr << "[FAIL] frame " << f->sequence << ": layout " << layout << " same "
+                          << same << " values " << values << " order " << order << "\n";
+            }
+        }
+        lastSeq   = f->sequence;
+        r.dropped += f->dropped;
+        ++r.received;
+        ds_reader_release(reader, f);
+        if (lastSeq == produced.size()) break;
+    }
+    ds_reader_close(reader);
+    return r;
+}
+
+} // namespace
+
+int main() {
+    if (ds_abi_version() != DS_ABI_VERSION) {
+        std::cerr << "[FAIL] ABI version mismatch\n";
+        return 1;
+    }
+
+    // 1) Graph -> pipeline -> C consumer on another thread
+    {
+        std::vector<FramePtr> produced;
+        for (int i = 0; i < FRAMES; ++i) {
+            auto f         = std::make_shared<ThermalFrame>();
+            f->sequence    = static_cast<uint64_t>(i + 1);
+            f->timestampNs = monotonicNowNs();
+            for (int p = 0; p < Geometry::PIXELS; ++p) f->temperatures[p] = pixelValue(f->sequence, p);
+            produced.push_back(std::move(f));
+        }
+
+        ds_pipeline*     pipeline = ds_pipeline_create(8);
+        WorkStealingPool pool(2);
+        ProcessingGraph  graph(pool);
+        graph.addSource("sensor");
+        graph.addNode("ffi", NodeKind::Sink, pipelineSink(pipeline));
+        graph.configure("sensor -> ffi[64]");
+
+        std::atomic<bool> ready {false};
+        ConsumerResult    result;
+        std::thread consumer([&] { result = consume(pipeline, produced, ready); });
+        while (!ready) std::this_thread::yield();
+
+        for (int i = 0; i < FRAMES; ++i) {
+            graph.push("sensor", produced[i]);
+            if (i % 32 == 0) graph.drain();
+        }
+        graph.drain();
+        const uint64_t published = ds_pipeline_published(pipeline);
+        consumer.join();
+        ds_pipeline_destroy(pipeline);
+
+        std::cout << "[INFO] published " << published << ", consumer borrowed " << result.received
+                  << " and was told of " << result.dropped << " drops\n";
+        if (result.errors || result.received == 0
+            || result.received + result.dropped != published) {
+            std::cerr << "[FAIL] consumer saw copies, bad layout or lost frames silently\n";
+            return 1;
+        }
+    }
+
+    // 2) A borrow outlives its slot and ends on release
+    {
+        ds_pipeline* pipeline = ds_pipeline_create(2);
+        ds_reader*   reader   = ds_reader_open(pipeline);
+
+        auto frame = std::make_shared<ThermalFrame>();
+        frame->sequence = 1;
+        frame->temperatures.fill(37.0f);
+        std::weak_ptr<const ThermalFrame> watch = frame;
+        publish(pipeline, frame);
+        frame.reset();
+
+        const ds_frame* f = nullptr;
+        if (ds_reader_borrow(reader, 0, &f) != DS_OK) {
+            std::cerr << "[FAIL] borrow of a published frame\n";
+            return 1;
+        }
+        for (uint64_t s = 2; s < 10; ++s) {                     // overwrite every slot
+            auto other = std::make_shared<ThermalFrame>();
+            other->sequence = s;
+            publish(pipeline, std::move(other));
+        }
+        if (watch.expired() || f->pixels[767] != 37.0f) {
+            std::cerr << "[FAIL] borrowed frame did not survive its ring slot\n";
+            return 1;
+        }
+        const ds_frame* next = nullptr;
+        if (ds_reader_borrow(reader, 0, &next) != DS_OK || next->sequence != 8 || next->dropped != 6) {
+            std::cerr << "[FAIL] overrun reader should resume at the oldest slot with drops reported\n";
+            return 1;
+        }
+        ds_reader_release(reader, f);
+        if (!watch.expired()) {
+            std::cerr << "[FAIL] released frame is still referenced\n";
+            return 1;
+        }
+        if (ds_reader_release(reader, f) != DS_EINVAL) {
+            std::cerr << "[FAIL] double release accepted\n";
+            return 1;
+        }
+        ds_reader_release(reader, next);
+        if (ds_reader_borrow(reader, 0, &next) != DS_OK || next->sequence != 9 || next->dropped != 0) {
+            std::cerr << "[FAIL] reader did not continue in order after an overrun\n";
+            return 1;
+        }
+        ds_reader_release(reader, next);
+
+        // 3) Borrow limit, timeouts, the copying C producer, shutdown
+        std::vector<const ds_frame*> held;
+        std::vector<float> celsius(DS_PIXELS, 25.0f);
+        int st = DS_OK;
+        for (unsigned i = 0; i <= DS_MAX_BORROWS && st == DS_OK; ++i) {
+            ds_pipeline_publish(pipeline, celsius.data(), 100 + i, monotonicNowNs());
+            const ds_frame* h = nullptr;
+            st = ds_reader_borrow(reader, 0, &h);
+            if (st == DS_OK) {
+                held.push_back(h);
+                if (reinterpret_cast<uintptr_t>(h->pixels) % DS_PIXEL_ALIGNMENT != 0) {
+                    std::cerr << "[FAIL] C-published frame is misaligned\n";
+                    return 1;
+                }
+            }
+        }
+        if (st != DS_ELIMIT || held.size() != DS_MAX_BORROWS) {
+            std::cerr << "[FAIL] borrow limit not enforced\n";
+            return 1;
+        }
+        for (const ds_frame* h : held) ds_reader_release(reader, h);
+        const ds_frame* h = nullptr;
+        if (ds_reader_borrow(reader, 0, &h) != DS_OK || ds_reader_borrow(reader, 5, &h) != DS_TIMEOUT) {
+            std::cerr << "[FAIL] poll / timeout\n";
+            return 1;
+        }
+        const ds_frame* kept = nullptr;
+        ds_pipeline_publish(pipeline, celsius.data(), 200, 0);
+        ds_reader_borrow(reader, 0, &kept);
+
+        std::thread closer([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            ds_pipeline_destroy(pipeline);
+        });
+        const ds_frame* none = nullptr;
+        st = ds_reader_borrow(reader, -1, &none);
+        closer.join();
+        if (st != DS_ECLOSED || kept->pixels[0] != 25.0f) {
+            std::cerr << "[FAIL] shutdown should wake readers and keep borrows valid\n";
+            return 1;
+        }
+        ds_reader_close(reader);   // releases what is still held
+    }
+
+    // 4) Borrow + release vs copying a frame out
+    {
+        ds_pipeline* pipeline = ds_pipeline_create(4);
+        ds_reader*   reader   = ds_reader_open(pipeline);
+        auto frame = std::make_shared<ThermalFrame>();
+        std::vector<float> sink(DS_PIXELS);
+
+        constexpr int ITER = 200000;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITER; ++i) {
+            publish(pipeline, frame);
+            const ds_frame* f = nullptr;
+            ds_reader_borrow(reader, 0, &f);
+            ds_reader_release(reader, f);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITER; ++i) {
+            publish(pipeline, frame);
+            const ds_frame* f = nullptr;
+            ds_reader_borrow(reader, 0, &f);
+            std::memcpy(sink.data(), f->pixels, DS_PIXELS * sizeof(float));
+            ds_reader_release(reader, f);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        const double borrowNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITER;
+        const double copyNs   = std::chrono::duration<double, std::nano>(t2 - t1).count() / ITER;
+        std::cout << "[BENCH] publish + borrow + release: " << borrowNs << " ns/frame; with a "
+                  << "768-float copy out: " << copyNs << " ns/frame\n";
+        ds_reader_close(reader);
+        ds_pipeline_destroy(pipeline);
+    }
+
+    std::cout << "[PASS] C ABI hands consumers the acquisition frames without copying\n";
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_clahe.cpp
+ * @brief Functional test and benchmark for the CLAHE display transform.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Builds a frame with a 1 °C background gradient beside an 80 °C hot
+ *   spot. Under the linear min/max mapping the gradient spans a handful
+ *   of grey levels; after equalisation it must span several times more
+ *   without banding, keep its direction, and leave the temperature array
+ *   bit-identical.
+ *   Then times the full transform at 640x480. No hardware needed.
+ */
+
+#include "clahe.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace duosight;
+
+struct Contrast {
+    double local {0.0};   ///< mean |difference| across one sensor pixel
+    int    hi    {0};
+    double left  {0.0};
+    double right {0.0};
+};
+
+/// Local contrast over the background quadrant away from the hot spot,
+/// brightest value there, and mean brightness of its left and right halves.
+Contrast background(const uint8_t* img, int w, int h)
+{
+    Contrast c;
+    const int step = w / Geometry::WIDTH;
+    const int x0 = w / 2, y0 = h / 2;
+    size_t n = 0, nl = 0, nr = 0;
+    for (int y = y0; y < h; ++y) {
+        for (int x = x0; x < w; ++x) {
+            const int v = img[y * w + x];
+            c.hi = std::max(c.hi, v);
+            if (x + step < w) {
+                c.local += std::abs(img[y * w + x + step] - v);
+                ++n;
+            }
+            if (x < x0 + (w - x0) / 2) { c.left += v; ++nl; }
+            else                       { c.right += v; ++nr; }
+        }
+    }
+    c.local /= n;
+    c.left  /= nl;
+    c.right /= nr;
+    return c;
+}
+
+} // namespace
+
+int main() {
+    std::vector<float> t(Geometry::PIXELS);
+    std::mt19937 rng(5);
+    std::normal_distribution<float> netd(0.0f, 0.05f);   // sensor noise
+    constexpr int W = Geometry::WIDTH, H = Geometry::HEIGHT;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            const bool hot = x >= 2 && x < 7 && y >= 2 && y < 7;
+            t[y * W + x] = (hot ? 80.0f : 22.0f + 1.0f * x / (W - 1)) + netd(rng);
+        }
+    }
+    const std::vector<float> before = t;
+
+    Clahe clahe;
+    const int w = clahe.width(), h = clahe.height();
+    std::vector<uint8_t> out(static_cast<size_t>(w) * h);
+    clahe.apply(t.data(), out.data());
+
+    // What the plain min/max mapping would show on an 8-bit palette
+    std::vector<uint8_t> plain(out.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        plain[i] = static_cast<uint8_t>(clahe.levels()[i] * 256 / Clahe::BINS);
+    }
+    const Contrast linear = background(plain.data(), w, h);
+    const Contrast eq     = background(out.data(), w, h);
+    std::cout << "[INFO] background local contrast " << linear.local << " grey levels/pixel linear, "
+              << eq.local << " after CLAHE\n";
+
+    if (std::memcmp(before.data(), t.data(), t.size() * sizeof(float)) != 0) {
+        std::cerr << "[FAIL] temperatures modified by the display transform\n";
+        return 1;
+    }
+    if (eq.local < 3.0 * linear.local || eq.right <= eq.left) {
+        std::cerr << "[FAIL] gradient not enhanced (left " << eq.left << ", right " << eq.right << ")\n";
+        return 1;
+    }
+
+    // The hot spot must stay the brightest thing in view
+    const int hotPixel = out[(4 * h / H) * w + 4 * w / W];
+    if (hotPixel < eq.hi) {
+        std::cerr << "[FAIL] hot spot " << hotPixel << " darker than background " << eq.hi << "\n";
+        return 1;
+    }
+
+    // A flat frame must not turn into noise
+    std::vector<float> flat(Geometry::PIXELS, 25.0f);
+    clahe.apply(flat.data(), out.data());
+    const auto [fl, fh] = std::minmax_element(out.begin(), out.end());
+    if (*fh - *fl > 1) {
+        std::cerr << "[FAIL] flat frame rendered with range " << *fh - *fl << "\n";
+        return 1;
+    }
+
+    constexpr int RUNS = 200;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; ++i) {
+        t[i % Geometry::PIXELS] += 0.01f;   // keep the optimiser honest
+        clahe.apply(t.data(), out.data());
+    }
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - t0).count() / RUNS;
+    std::cout << "[BENCH] " << w << "x" << h << " upscale + CLAHE: " << ms << " ms/frame\n";
+
+    std::cout << "[PASS] CLAHE enhances the background gradient and leaves temperatures intact\n";
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_coefficient_cache.cpp
+ * @brief Ta/Vdd-dependent coefficient caching: exactness, refresh rate, saving.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   With both epsilons at 0 a CoefficientCache must convert every pixel
+ *   exactly as PixelConverter does. A synthetic scene whose Ta warms slowly
+ *   (sensor self-heating) is then run for several minutes at 8 Hz with the
+ *   default epsilons. The test reports how often the factors were
+ *   refreshed and the largest error against the uncached path, and it
+ *   times prepare + convert per subpage with and without the cache. The
+ *   four-lane path must agree with the scalar one to 1e-3 °C over a scene
+ *   reaching 200 °C in both readout patterns, and its cost per subpage is
+ *   reported next to the scalar cached path. No hardware needed.
+ */
+
+#include "pixelConverter.hpp"
+#include "syntheticScene.hpp"
+#include "mlxTestParams.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace duosight;
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    const paramsMLX90640 params = test::makeNominalParams();
+    const PixelConverter conv(params);
+    bool ok = true;
+
+    SceneConfig scene;
+    scene.refreshCode         = refresh::FR8;
+    scene.ambientC            = 24.0f;
+    scene.ambientDriftCPerSec = 0.005f;
+    scene.blobPeakC           = 120.0f;
+
+    std::array<uint16_t, Geometry::WORDS> words {};
+    std::vector<float> want(Geometry::PIXELS), got(Geometry::PIXELS);
+
+    // 1) Epsilon 0: a refresh on every Ta/Vdd change, results bit for bit
+    {
+        SyntheticScene sim(params, scene);
+        CoefficientCacheOptions exact;
+        exact.taEpsilon  = 0.0f;
+        exact.vddEpsilon = 0.0f;
+        CoefficientCache cache(conv, exact);
+        uint64_t mismatches = 0;
+        for (int i = 0; i < 64; ++i) {
+            sim.nextSubpage(words.data());
+            const SubpageTerms t = cache.prepare(words.data());
+            conv.convertSubpage(words.data(), t, want.data());
+            cache.convertSubpage(words.data(), t, got.data());
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                if (conv.inSubpage(p, t) && got[p] != want[p]) ++mismatches;
+            }
+        }
+        if (mismatches) {
+            std::cerr << "[FAIL] " << mismatches << " pixels differ with epsilon 0\n";
+            ok = false;
+        }
+    }
+
+    // 2) Steady state with the default epsilons: 5 minutes at 8 Hz
+    {
+        SyntheticScene sim(params, scene);
+        CoefficientCache cache(conv);
+        float maxErr = 0.0f;
+        const int subpages = 300 * 8 * 2;
+        for (int i = 0; i < subpages; ++i) {
+            sim.nextSubpage(words.data());
+            const SubpageTerms t = cache.prepare(words.data());
+            conv.convertSubpage(words.data(), t, want.data());
+            cache.convertSubpage(words.data(), t, got.data());
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                if (conv.inSubpage(p, t)) maxErr = std::max(maxErr, std::fabs(got[p] - want[p]));
+            }
+        }
+        const CoefficientCacheStats& st = cache.stats();
+        std::cout << "[INFO] Ta drift " << scene.ambientDriftCPerSec * 300.0f << " °C over "
+                  << st.subpages << " subpages: " << st.refreshes << " refreshes ("
+                  << st.refreshRate() * 100.0 << "%), max error " << maxErr << " °C\n";
+        if (st.refreshRate() > 0.02 || st.refreshes < 2 || maxErr > 0.05f) {
+            std::cerr << "[FAIL] refresh rate " << st.refreshRate() << ", max error " << maxErr << " °C\n";
+            ok = false;
+        }
+    }
+
+    // 3) Per-subpage cost in steady state (no refresh inside the loop)
+    {
+        constexpr int ROUNDS = 2000;
+        SyntheticScene sim(params, scene);
+        std::array<std::array<uint16_t, Geometry::WORDS>, 2> pair {};
+        sim.nextSubpage(pair[0].data());
+        sim.nextSubpage(pair[1].data());
+        CoefficientCache cache(conv);
+        float sink = 0.0f;
+
+        // Interleaved repetitions, best of each: a shared machine only ever
+        // adds time, so the minimum is the fairest estimate of either cost
+        auto timeUncached = [&] {
+            const auto t0 = Clock::now();
+            for (int r = 0; r < ROUNDS; ++r) {
+                const uint16_t* w = pair[r & 1].data();
+                const SubpageTerms t = conv.prepare(w);
+                conv.convertSubpage(w, t, want.data());
+                sink += want[r % Geometry::PIXELS];
+            }
+            return std::chrono::duration<double>(Clock::now() - t0).count() / ROUNDS;
+        };
+        auto timeCached = [&] {
+            const auto t0 = Clock::now();
+            for (int r = 0; r < ROUNDS; ++r) {
+                const uint16_t* w = pair[r & 1].data();
+                const SubpageTerms t = cache.prepare(w);
+                cache.convertSubpage(w, t, got.data());
+                sink += got[r % Geometry::PIXELS];
+            }
+            return std::chrono::duration<double>(Clock::now() - t0).count() / ROUNDS;
+        };
+        double plain = 1e30, cached = 1e30;
+        for (int rep = 0; rep < 7; ++rep) {
+            plain  = std::min(plain, timeUncached());
+            cached = std::min(cached, timeCached());
+        }
+
+        // Reported, not asserted: the saving is a few percent at best and
+        // depends on the compiler and core, so timing is no pass criterion
+        std::cout << "[BENCH] per subpage (best of 7): uncached " << plain * 1e6 << " us, cached "
+                  << cached * 1e6 << " us (" << (1.0 - cached / plain) * 100.0
+                  << "% saved, " << cache.stats().refreshes << " refresh) [sink " << sink << "]\n";
+    }
+
+    // 4) Four-lane path: agreement across all ranges, then cost
+    {
+        SceneConfig hot = scene;
+        hot.blobPeakC   = 200.0f;
+        CoefficientCacheOptions lanesOpt;
+        lanesOpt.vectorised = true;
+        float maxErr = 0.0f;
+        for (const bool chess : {true, false}) {
+            hot.chess = chess;
+            SyntheticScene   sim(params, hot);
+            CoefficientCache scalar(conv), lanes(conv, lanesOpt);
+            for (int i = 0; i < 64; ++i) {
+                sim.nextSubpage(words.data());
+                const SubpageTerms t = scalar.prepare(words.data());
+                lanes.prepare(words.data());
+                scalar.convertSubpage(words.data(), t, want.data());
+                lanes.convertSubpage(words.data(), t, got.data());
+                for (int p = 0; p < Geometry::PIXELS; ++p) {
+                    if (conv.inSubpage(p, t)) maxErr = std::max(maxErr, std::fabs(got[p] - want[p]));
+                }
+            }
+        }
+
+        constexpr int ROUNDS = 2000;
+        SyntheticScene sim(params, scene);
+        std::array<std::array<uint16_t, Geometry::WORDS>, 2> pair {};
+        sim.nextSubpage(pair[0].data());
+        sim.nextSubpage(pair[1].data());
+        CoefficientCache scalar(conv), lanes(conv, lanesOpt);
+        float sink = 0.0f;
+        auto time = [&](CoefficientCache& cache, std::vector<float>& out) {
+            const auto t0 = Clock::now();
+            for (int r = 0; r < ROUNDS; ++r) {
+                const uint16_t* w = pair[r & 1].data();
+                const SubpageTerms t = cache.prepare(w);
+                cache.convertSubpage(w, t, out.data());
+                sink += out[r % Geometry::PIXELS];
+            }
+            return std::chrono::duration<double>(Clock::now() - t0).count() / ROUNDS;
+        };
+        double plain = 1e30, fast = 1e30;
+        for (int rep = 0; rep < 7; ++rep) {
+            plain = std::min(plain, time(scalar, want));
+            fast  = std::min(fast, time(lanes, got));
+        }
+        std::cout << "[BENCH] four-lane path: max error " << maxErr << " °C, per subpage (best of 7) "
+                  << fast * 1e6 << " us vs " << plain * 1e6 << " us scalar cached ("
+                  << plain / fast << "x) [sink " << sink << "]\n";
+        if (maxErr > 1e-3f) {
+            std::cerr << "[FAIL] four-lane path differs by " << maxErr << " °C\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] cached Ta/Vdd factors exact at epsilon 0, rarely refreshed, four-lane path agrees\n";
+    return 0;
+}
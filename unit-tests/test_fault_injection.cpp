@@ -0,0 +1,136 @@
+/**
+ * @file test_fault_injection.cpp
+ * @brief Acquisition recovery under scripted faults on the simulated sensor.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Runs a polling acquisition loop through the normal MLX90640 transport
+ *   against SimulatedMlx90640 in virtual time, with one of each fault type
+ *   scripted along the way plus a background rate of random bit flips.
+ *   Reports recovery time per fault and overall frame loss, and checks the
+ *   run is bit-for-bit reproducible. No hardware needed.
+ */
+
+#include "simulatedMlx90640.hpp"
+#include "mlx90640Transport.h"
+#include "mlxTestParams.hpp"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+struct RunResult {
+    duosight::SimStats                 sim;
+    std::vector<duosight::FaultEvent>  faults;
+    std::vector<int64_t>               goodFramesNs;   // completion time
+    std::vector<int64_t>               goodStartNs;    // STATUS poll that found it
+    uint64_t busErrors  {0};
+    uint64_t corrupted  {0};
+};
+
+RunResult runScenario(const paramsMLX90640& params)
+{
+    using namespace duosight;
+
+    SceneConfig scene;
+    scene.refreshCode = refresh::FR16;
+
+    SimulatedMlx90640::Options opt;
+    opt.logFaults = false;
+    SimulatedMlx90640 sim(params, scene, opt);
+
+    sim.addFault({10, SimFault::Nack, 5});
+    sim.addFault({20, SimFault::ShortRead, 1});
+    sim.addFault({30, SimFault::DelayedReady, 1, 20'000});
+    sim.addFault({40, SimFault::StuckReady, 3});
+    sim.addFault({50, SimFault::OverrunBurst, 4});
+    sim.addFault({60, SimFault::Hang, 1, 1'500'000});
+    sim.setFaultRates({0.0, 0.0, 0.002});
+
+    mlx90640_set_i2c_device(&sim);
+
+    RunResult r;
+    std::array<uint16_t, 832> words{};
+    const int64_t POLL_NS    = 1'000'000;       // reader sleeps 1 ms between polls
+    const int64_t HORIZON_NS = 6'000'000'000;
+
+    while (sim.nowNs() < HORIZON_NS) {
+        const int64_t start = sim.nowNs();
+        uint16_t status = 0;
+        if (MLX90640_I2CRead(Bus::SLAVE_ADDR, Status::REG, 1, &status) != 0) {
+            ++r.busErrors;
+            sim.advance(POLL_NS);
+            continue;
+        }
+        if (!(status & Status::NEW_DATA_READY)) {
+            sim.advance(POLL_NS);
+            continue;
+        }
+        if (MLX90640_I2CWrite(Bus::SLAVE_ADDR, Status::REG, 0x0030) != 0 ||
+            MLX90640_I2CRead(Bus::SLAVE_ADDR, 0x0400, 832, words.data()) != 0) {
+            ++r.busErrors;
+            continue;
+        }
+        // Gain word is constant for a healthy sensor: cheap integrity check
+        if (static_cast<int16_t>(words[778]) != params.gainEE) {
+            ++r.corrupted;
+            continue;
+        }
+        r.goodFramesNs.push_back(sim.nowNs());
+        r.goodStartNs.push_back(start);
+    }
+
+    mlx90640_set_i2c_device(nullptr);
+    r.sim    = sim.stats();
+    r.faults = sim.faultLog();
+    return r;
+}
+
+} // namespace
+
+int main() {
+    using namespace duosight;
+
+    const paramsMLX90640 params = test::makeNominalParams();
+    const RunResult a = runScenario(params);
+    const RunResult b = runScenario(params);
+
+    for (const auto& ev : a.faults) {
+        // First frame whose acquisition cycle began after the fault
+        int64_t next = -1;
+        for (size_t i = 0; i < a.goodFramesNs.size(); ++i) {
+            if (a.goodStartNs[i] >= ev.timeNs) { next = a.goodFramesNs[i]; break; }
+        }
+        std::cout << "[INFO] " << toString(ev.fault) << " @" << ev.timeNs / 1e6 << " ms ("
+                  << ev.detail << "): recovered after "
+                  << (next < 0 ? -1.0 : (next - ev.timeNs) / 1e6) << " ms\n";
+    }
+    const double loss = 1.0 - double(a.goodFramesNs.size()) / double(a.sim.produced);
+    std::cout << "[INFO] produced=" << a.sim.produced << " good=" << a.goodFramesNs.size()
+              << " overwritten=" << a.sim.overwritten << " busErrors=" << a.busErrors
+              << " corrupted=" << a.corrupted << " faults=" << a.sim.faults
+              << " frame loss=" << loss * 100.0 << " %\n";
+
+    if (a.goodFramesNs != b.goodFramesNs || a.sim.faults != b.sim.faults) {
+        std::cerr << "[FAIL] fault scenario is not reproducible\n";
+        return 1;
+    }
+    bool sawAll[7] = {};
+    for (const auto& ev : a.faults) sawAll[static_cast<int>(ev.fault)] = true;
+    for (bool s : sawAll) {
+        if (!s) {
+            std::cerr << "[FAIL] not every fault type was injected and logged\n";
+            return 1;
+        }
+    }
+    if (a.goodFramesNs.empty() || a.goodFramesNs.back() < 5'000'000'000) {
+        std::cerr << "[FAIL] acquisition did not recover\n";
+        return 1;
+    }
+    std::cout << "[PASS] acquisition recovers from every injected fault\n";
+    return 0;
+}
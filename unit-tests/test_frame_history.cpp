@@ -0,0 +1,103 @@
+/**
+ * @file test_frame_history.cpp
+ * @brief Functional test for the mirrored FrameHistory ring.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Pushes more frames than the ring holds and checks that windows which
+ *   wrap around the end of the ring are still contiguous, carry the right
+ *   frames in order and report overwrite correctly. Then fills a history
+ *   through its graph stage and checks the window's frames and timestamps.
+ *   No hardware needed.
+ */
+
+#include "frameHistory.hpp"
+
+#include <iostream>
+#include <memory>
+
+int main() {
+    using namespace duosight;
+
+    FrameHistory history(10);
+    if (!history.isValid()) {
+        std::cerr << "[FAIL] could not create mirrored mapping\n";
+        return 1;
+    }
+    std::cout << "[INFO] requested 10 frames, capacity " << history.capacity() << "\n";
+
+    const size_t total = history.capacity() * 2 + 3;   // forces wrap-around
+    for (size_t i = 0; i < total; ++i) {
+        ThermalFrame f;
+        f.sequence    = 100 + i;
+        f.timestampNs = 1000 * static_cast<int64_t>(i);
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            f.temperatures[p] = static_cast<float>(i) + p * 1e-3f;
+        }
+        history.push(f);
+    }
+
+    const size_t n = history.maxWindow();
+    FrameWindow w;
+    if (!history.window(n, w) || w.frames != n) {
+        std::cerr << "[FAIL] window(" << n << ") unavailable\n";
+        return 1;
+    }
+
+    // Walk the window as one flat tensor: must match frame-major order.
+    const size_t first = total - n;
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t p = 0; p < static_cast<size_t>(Geometry::PIXELS); p += 97) {
+            const float expect = static_cast<float>(first + k) + p * 1e-3f;
+            if (w.data[k * w.frameStride + p] != expect) {
+                std::cerr << "[FAIL] frame " << k << " pixel " << p << " mismatch\n";
+                return 1;
+            }
+        }
+    }
+    if (w.firstSequence != 100 + first || !history.isIntact(w) ||
+        w.timestampNs(0) != 1000 * static_cast<int64_t>(first) ||
+        w.timestampNs(n - 1) != 1000 * static_cast<int64_t>(total - 1)) {
+        std::cerr << "[FAIL] window metadata wrong (first=" << w.firstSequence << ")\n";
+        return 1;
+    }
+
+    ThermalFrame next;
+    next.sequence = 100 + total;
+    history.push(next);      // producer now fills the window's first slot
+    history.push(next);
+    if (history.isIntact(w)) {
+        std::cerr << "[FAIL] overwritten window still reported intact\n";
+        return 1;
+    }
+
+    // As a graph sink
+    {
+        WorkStealingPool pool(2);
+        ProcessingGraph  graph(pool);
+        FrameHistory     fed(8);
+        graph.addSource("source");
+        graph.addNode("history", NodeKind::Sink, fed.stage());
+        graph.configure("source -> history[32]");
+        for (int i = 0; i < 20; ++i) {
+            auto f = std::make_shared<ThermalFrame>();
+            f->sequence    = 500 + i;
+            f->timestampNs = 7 * i;
+            f->temperatures.fill(static_cast<float>(i));
+            graph.push("source", f);
+        }
+        graph.drain();
+        FrameWindow g;
+        if (!fed.window(8, g) || g.firstSequence != 512 || g.timestampNs(0) != 7 * 12 ||
+            g.frame(7)[Geometry::PIXELS - 1] != 19.0f) {
+            std::cerr << "[FAIL] graph-fed history holds the wrong frames\n";
+            return 1;
+        }
+    }
+
+    std::cout << "[PASS] mirrored history yields contiguous wrapped windows\n";
+    return 0;
+}
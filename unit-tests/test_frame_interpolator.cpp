@@ -0,0 +1,181 @@
+/**
+ * @file test_frame_interpolator.cpp
+ * @brief Functional test and benchmark for display frame-rate upconversion.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Moves a warm blob across a noisy background between two measured
+ *   frames and compares the synthesised midpoint with the true scene: the
+ *   motion-compensated output must keep the blob whole and land it in the
+ *   right place, where a cross-fade leaves two half-strength ghosts.
+ *   Checks that the phase endpoints reproduce the measured frames exactly,
+ *   that noise on a static scene invents no motion and that long gaps hold
+ *   the newer frame. Times motion estimation and output frames. No
+ *   hardware needed.
+ */
+
+#include "frameInterpolator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+
+using namespace duosight;
+
+constexpr int     W      = Geometry::WIDTH;
+constexpr int     H      = Geometry::HEIGHT;
+constexpr int64_t PERIOD = 250'000'000;   // FR4
+
+static_assert(!DisplayFrame::radiometric, "interpolated frames are display-only");
+
+/// Background with a slight gradient plus a Gaussian blob at (cx, cy).
+void scene(float* t, float cx, float cy, std::mt19937* rng = nullptr)
+{
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            const float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+            t[y * W + x] = 22.0f + 0.05f * x + 10.0f * std::exp(-d2 / (2.0f * 1.8f * 1.8f))
+                         + (rng ? noise(*rng) : 0.0f);
+        }
+    }
+}
+
+FramePtr frame(uint64_t seq, int64_t ts, float cx, float cy, std::mt19937& rng)
+{
+    auto f = std::make_shared<ThermalFrame>();
+    f->sequence    = seq;
+    f->timestampNs = ts;
+    scene(f->temperatures.data(), cx, cy, &rng);
+    return f;
+}
+
+struct Error {
+    double rms  {0.0};
+    float  peak {0.0f};
+};
+
+Error compare(const DisplayFrame& out, const float* truth)
+{
+    Error e;
+    for (int i = 0; i < Geometry::PIXELS; ++i) {
+        e.rms += (out.values[i] - truth[i]) * (out.values[i] - truth[i]);
+    }
+    e.rms  = std::sqrt(e.rms / Geometry::PIXELS);
+    e.peak = *std::max_element(out.values.begin(), out.values.end());
+    return e;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(11);
+
+    // 1) Moving blob: midpoint against the true scene
+    {
+        FrameInterpolator mc, linear({InterpolationMode::Linear});
+        const FramePtr a = frame(1, 0, 10.0f, 10.0f, rng);
+        const FramePtr b = frame(2, PERIOD, 14.0f, 12.0f, rng);
+        for (auto* fi : {&mc, &linear}) {
+            fi->push(a);
+            fi->push(b);
+        }
+
+        std::array<float, Geometry::PIXELS> truth;
+        scene(truth.data(), 12.0f, 11.0f);
+        const float truePeak = *std::max_element(truth.begin(), truth.end());
+
+        DisplayFrame outMc, outLinear;
+        mc.render(PERIOD + PERIOD / 2, outMc);
+        linear.render(PERIOD + PERIOD / 2, outLinear);
+        const Error em = compare(outMc, truth.data());
+        const Error el = compare(outLinear, truth.data());
+        std::cout << "[INFO] midpoint of a 4.5 px move: motion-compensated " << em.rms
+                  << " °C rms (peak " << em.peak << "), cross-fade " << el.rms << " (peak "
+                  << el.peak << "), true peak " << truePeak << "\n";
+        if (outMc.phase != 0.5f || outMc.fromSequence != 1 || outMc.toSequence != 2) {
+            std::cerr << "[FAIL] display timing: phase " << outMc.phase << "\n";
+            return 1;
+        }
+        if (em.rms > 0.5 * el.rms || std::fabs(em.peak - truePeak) > 1.5f) {
+            std::cerr << "[FAIL] motion compensation did not track the blob\n";
+            return 1;
+        }
+
+        // Endpoints are the measured frames, bit for bit
+        DisplayFrame start, end;
+        mc.render(PERIOD, start);
+        mc.render(3 * PERIOD, end);
+        if (start.values != a->temperatures || end.values != b->temperatures) {
+            std::cerr << "[FAIL] phase 0 / 1 must reproduce the measured frames\n";
+            return 1;
+        }
+    }
+
+    // 2) Static noisy scene: no motion invented; long gaps hold
+    {
+        FrameInterpolator fi;
+        DisplayFrame out;
+        if (fi.render(0, out)) {
+            std::cerr << "[FAIL] rendered before two frames arrived\n";
+            return 1;
+        }
+        fi.push(frame(1, 0, 16.0f, 12.0f, rng));
+        fi.push(frame(2, PERIOD, 16.0f, 12.0f, rng));
+        for (const MotionVector& v : fi.motion()) {
+            if (v.dx || v.dy) {
+                std::cerr << "[FAIL] sensor noise produced a motion vector\n";
+                return 1;
+            }
+        }
+
+        const FramePtr late = frame(3, PERIOD + 5'000'000'000LL, 16.0f, 12.0f, rng);
+        fi.push(late);
+        fi.render(late->timestampNs + PERIOD / 2, out);
+        if (out.phase != 1.0f || out.values != late->temperatures) {
+            std::cerr << "[FAIL] a long gap should hold the newer frame\n";
+            return 1;
+        }
+    }
+
+    // 3) Cost: motion estimation per measured frame, one output at 60 Hz
+    {
+        FrameInterpolator fi;
+        std::vector<FramePtr> frames;
+        for (int i = 0; i < 16; ++i) {
+            frames.push_back(frame(i + 1, i * PERIOD, 6.0f + i, 8.0f + 0.5f * i, rng));
+        }
+        constexpr int ITER = 400;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITER; ++i) fi.push(frames[i % frames.size()]);
+        auto t1 = std::chrono::steady_clock::now();
+
+        fi.push(frames[0]);
+        fi.push(frames[1]);
+        DisplayFrame out;
+        float sink = 0.0f;
+        constexpr int OUT = 20000;
+        for (int i = 0; i < OUT; ++i) {
+            fi.render(PERIOD + (i % 15) * PERIOD / 15, out);
+            sink += out.values[i % Geometry::PIXELS];
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        const double pushUs   = std::chrono::duration<double, std::micro>(t1 - t0).count() / ITER;
+        const double renderUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / OUT;
+        std::cout << "[BENCH] motion estimation " << pushUs << " us per measured frame, "
+                  << renderUs << " us per output frame (checksum " << sink << ")\n";
+        if (renderUs > 1000.0) {
+            std::cerr << "[WARN] output frame above the 1 ms budget\n";
+        }
+    }
+
+    std::cout << "[PASS] interpolated display frames track motion and stay display-only\n";
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_frame_stacker.cpp
+ * @brief Functional test and benchmark for sigma-clipped FrameStacker.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Stacks noisy frames of a known scene with injected hot transients and
+ *   checks that the clipped mean lands within the expected sqrt(N) noise
+ *   floor, that the variance estimate matches the injected noise and that
+ *   the transients are rejected. Then runs the stacker as a graph branch
+ *   beside a live-view sink to show a capture neither stalls nor skips
+ *   live frames. No hardware needed.
+ */
+
+#include "frameStacker.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+
+using namespace duosight;
+
+constexpr float NOISE = 0.5f;
+
+float truth(int p)
+{
+    return 22.0f + 0.3f * (p % Geometry::WIDTH) + ((p / Geometry::WIDTH) > 12 ? 8.0f : 0.0f);
+}
+
+std::shared_ptr<ThermalFrame> noisyFrame(uint64_t seq, std::mt19937& rng, uint64_t& spikes)
+{
+    std::normal_distribution<float>        noise(0.0f, NOISE);
+    std::uniform_real_distribution<float>  u(0.0f, 1.0f);
+    auto f = std::make_shared<ThermalFrame>();
+    f->sequence    = seq;
+    f->timestampNs = monotonicNowNs();
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        f->temperatures[p] = truth(p) + noise(rng);
+        if (u(rng) < 0.02f) {                 // transient, e.g. a passing hand
+            f->temperatures[p] += 15.0f;
+            ++spikes;
+        }
+    }
+    return f;
+}
+
+double rmsError(const StackedFrame& s)
+{
+    double e = 0.0;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        e += (s.mean[p] - truth(p)) * (s.mean[p] - truth(p));
+    }
+    return std::sqrt(e / Geometry::PIXELS);
+}
+
+} // namespace
+
+int main() {
+    constexpr size_t N = 64;
+
+    // Same input stacked with and without clipping
+    std::mt19937 rng(11);
+    uint64_t spikes = 0;
+    std::vector<std::shared_ptr<ThermalFrame>> input;
+    for (size_t i = 0; i < N; ++i) {
+        input.push_back(noisyFrame(i + 1, rng, spikes));
+    }
+
+    FrameStacker clipped({N, 3.0f, 3, 0.05f});
+    FrameStacker plain({N, 3.0f, 0, 0.05f});
+    clipped.arm(nullptr, 0);   // frames made before arming: stack them all
+    plain.arm(nullptr, 0);
+
+    StackPtr a, b;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (const auto& f : input) {
+        a = clipped.add(*f);
+    }
+    const double stackUs = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - t0).count();
+    for (const auto& f : input) {
+        b = plain.add(*f);
+    }
+    if (!a || !b || a->frames != N || clipped.armed() || a->firstSequence != 1 || a->lastSequence != N) {
+        std::cerr << "[FAIL] capture did not complete after " << N << " frames\n";
+        return 1;
+    }
+
+    double meanVar = 0.0;
+    for (int p = 0; p < Geometry::PIXELS; ++p) meanVar += a->variance[p];
+    meanVar /= Geometry::PIXELS;
+
+    const double floor = NOISE / std::sqrt(double(N));
+    std::cout << "[INFO] single-frame sigma " << NOISE << " C, sqrt(N) floor " << floor << " C\n";
+    std::cout << "[INFO] clipped rms error " << rmsError(*a) << " C, unclipped "
+              << rmsError(*b) << " C\n";
+    std::cout << "[INFO] rejected " << a->rejected << " samples (" << spikes
+              << " transients injected), mean variance " << meanVar << "\n";
+    std::cout << "[BENCH] " << N << "-frame stack incl. clipping: " << stackUs << " us ("
+              << stackUs / N << " us/frame)\n";
+
+    if (rmsError(*a) > 1.5 * floor || rmsError(*b) < 2.0 * rmsError(*a)) {
+        std::cerr << "[FAIL] clipping did not remove transients\n";
+        return 1;
+    }
+    if (a->rejected < spikes || a->rejected > spikes + spikes / 2 + 50) {
+        std::cerr << "[FAIL] rejected " << a->rejected << " for " << spikes << " transients\n";
+        return 1;
+    }
+    if (std::fabs(meanVar - NOISE * NOISE) > 0.15 * NOISE * NOISE) {
+        std::cerr << "[FAIL] variance estimate " << meanVar << " vs " << NOISE * NOISE << "\n";
+        return 1;
+    }
+
+    // Frames acquired before arm() are not stacked
+    {
+        FrameStacker late({2});
+        auto stale = noisyFrame(1, rng, spikes);
+        late.arm();
+        late.add(*stale);
+        late.add(*noisyFrame(2, rng, spikes));
+        const StackPtr s = late.add(*noisyFrame(3, rng, spikes));
+        if (!s || s->firstSequence != 2) {
+            std::cerr << "[FAIL] a frame from before arm() was stacked\n";
+            return 1;
+        }
+    }
+
+    // As a graph branch next to the live view
+    WorkStealingPool pool(2);
+    ProcessingGraph  graph(pool);
+    FrameStacker     stacker({N});
+    std::atomic<uint64_t> live{0}, snapshots{0};
+    StackPtr captured;
+
+    graph.addSource("source");
+    graph.addNode("render", NodeKind::Sink, [&live](const FramePtr&) -> FramePtr {
+        live.fetch_add(1);
+        return nullptr;
+    });
+    graph.addNode("stack", NodeKind::Filter, stacker.stage());
+    graph.addNode("snapshot", NodeKind::Sink, [&snapshots](const FramePtr&) -> FramePtr {
+        snapshots.fetch_add(1);
+        return nullptr;
+    });
+    graph.configure("source -> render[64]; source -> stack[64] -> snapshot");
+
+    constexpr int LIVE = 200;
+    for (int i = 0; i < LIVE; ++i) {
+        if (i == 20) {
+            stacker.arm([&captured](const StackPtr& s) { captured = s; });
+        }
+        graph.push("source", noisyFrame(1000 + i, rng, spikes));
+        if (i % 32 == 0) graph.drain();   // stay within queue depth, as a paced sensor would
+    }
+    graph.drain();
+
+    if (live != LIVE || snapshots != 1 || !captured || captured->firstSequence != 1020
+        || captured->frames != N) {
+        std::cerr << "[FAIL] graph capture: live=" << live << " snapshots=" << snapshots << "\n";
+        return 1;
+    }
+
+    std::cout << "[PASS] stacking reaches the sqrt(N) floor and rejects transients\n";
+    return 0;
+}
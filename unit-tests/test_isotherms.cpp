@@ -0,0 +1,268 @@
+/**
+ * @file test_isotherms.cpp
+ * @brief Marching-squares isotherms: geometry, topology, caching, wire format.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A Gaussian hot spot must give one closed contour per level at the
+ *   analytic radius. On random fields, every crossed grid edge must appear
+ *   exactly once, consecutive points must share a cell, and open lines
+ *   must end on the border. A blob moving over a still background is then
+ *   contoured with the cache and from scratch. With tolerance 0 the
+ *   output must be identical. With 0.1 °C noise and the default tolerance
+ *   every crossing must stay within the tolerance of its level; the test
+ *   reports how much work the cache skipped and the time per frame
+ *   (report only). Finally, encoded sets must decode to within the
+ *   quantisation, and the encoded size is reported against a 320x240
+ *   raster overlay. No hardware needed.
+ */
+
+#include "isotherms.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace duosight;
+
+namespace {
+
+constexpr int W = Geometry::WIDTH, H = Geometry::HEIGHT;
+
+struct Spot { float x, y, sigma, peak; };
+
+std::vector<float> render(const std::vector<Spot>& spots, float background)
+{
+    std::vector<float> f(Geometry::PIXELS, background);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            for (const Spot& s : spots) {
+                const float d2 = (x - s.x) * (x - s.x) + (y - s.y) * (y - s.y);
+                f[y * W + x] += (s.peak - background) * std::exp(-d2 / (2 * s.sigma * s.sigma));
+            }
+        }
+    }
+    return f;
+}
+
+/// Grid edges the level crosses, counted directly
+size_t crossings(const std::vector<float>& f, float c)
+{
+    size_t n = 0;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            if (x + 1 < W && (f[y * W + x] >= c) != (f[y * W + x + 1] >= c)) ++n;
+            if (y + 1 < H && (f[y * W + x] >= c) != (f[(y + 1) * W + x] >= c)) ++n;
+        }
+    }
+    return n;
+}
+
+bool onBorder(const IsoPoint& p)
+{
+    return p.x <= 0.0f || p.y <= 0.0f || p.x >= W - 1 || p.y >= H - 1;
+}
+
+} // namespace
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    bool ok = true;
+
+    // 1) Gaussian hot spot: one closed loop per level at the analytic radius
+    {
+        const Spot s {15.3f, 11.7f, 4.0f, 90.0f};
+        IsothermExtractor iso;
+        const IsothermPtr set = iso.update(render({s}, 25.0f).data());
+        for (size_t li = 0; li < set->levels.size(); ++li) {
+            const float c = set->levels[li];
+            const float r = s.sigma * std::sqrt(2.0f * std::log((s.peak - 25.0f) / (c - 25.0f)));
+            int loops = 0;
+            float worst = 0.0f;
+            for (const Isoline& line : set->lines) {
+                if (line.level != li) continue;
+                loops += line.closed ? 1 : 100;
+                for (uint32_t i = 0; i < line.count; ++i) {
+                    const IsoPoint& p = set->points[line.first + i];
+                    worst = std::max(worst, std::fabs(std::hypot(p.x - s.x, p.y - s.y) - r));
+                }
+            }
+            std::cout << "[INFO] " << c << " °C: radius " << r << " px, worst deviation " << worst << " px\n";
+            if (loops != 1 || worst > 0.35f) {
+                std::cerr << "[FAIL] " << c << " °C contour: " << loops << " lines, off by " << worst << " px\n";
+                ok = false;
+            }
+        }
+    }
+
+    // 2) Topology on random fields (several spots, noise, saddles)
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> ux(-4.0f, W + 3.0f), uy(-4.0f, H + 3.0f), us(1.0f, 5.0f),
+                                              up(40.0f, 110.0f);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        IsothermOptions o;
+        o.levels    = {35.0f, 50.0f, 60.0f, 80.0f};
+        o.tolerance = 0.0f;   // crossings are counted on each exact frame
+        IsothermExtractor iso(o);
+        uint64_t bad = 0, lines = 0;
+        for (int round = 0; round < 200; ++round) {
+            std::vector<Spot> spots(1 + round % 6);
+            for (Spot& s : spots) s = {ux(rng), uy(rng), us(rng), up(rng)};
+            std::vector<float> f = render(spots, 25.0f);
+            for (float& v : f) v += noise(rng);
+            const IsothermPtr set = iso.update(f.data());
+            std::vector<size_t> points(o.levels.size(), 0);
+            for (const Isoline& line : set->lines) {
+                ++lines;
+                points[line.level] += line.count;
+                const IsoPoint* p = &set->points[line.first];
+                for (uint32_t i = 1; i < line.count; ++i) {
+                    bad += std::fabs(p[i].x - p[i - 1].x) > 1.0f || std::fabs(p[i].y - p[i - 1].y) > 1.0f;
+                }
+                if (!line.closed) bad += !onBorder(p[0]) + !onBorder(p[line.count - 1]);
+                if (line.closed && line.count < 4) ++bad;
+            }
+            for (size_t li = 0; li < o.levels.size(); ++li) bad += points[li] != crossings(f, o.levels[li]);
+        }
+        std::cout << "[INFO] random fields: " << lines << " lines over 200 frames\n";
+        if (bad) {
+            std::cerr << "[FAIL] " << bad << " topology violations\n";
+            ok = false;
+        }
+    }
+
+    // 3) Moving blob over a still scene. Exact: with tolerance 0 the cached
+    //    output equals a fresh extraction. Noisy: with the default tolerance,
+    //    report how much is reused and check every crossing still lies
+    //    between pixels that straddle its level to within the tolerance.
+    {
+        constexpr int FRAMES = 400;
+        const Spot still {24.0f, 6.0f, 3.0f, 85.0f};
+        std::mt19937 rng(5);
+        std::normal_distribution<float> noise(0.0f, 0.1f);   // SceneConfig::noiseC
+        std::vector<std::vector<float>> frames, noisy;
+        for (int i = 0; i < FRAMES; ++i) {
+            const float t = i * 0.05f;
+            frames.push_back(render({still, {6.0f + 2.0f * std::sin(t), 16.0f + std::cos(t), 2.5f, 75.0f}}, 25.0f));
+            noisy.push_back(frames.back());
+            for (float& v : frames.back()) v = std::round(v * 100.0f) / 100.0f;   // 0.01 °C steps, as converted
+            for (float& v : noisy.back()) v = std::round((v + noise(rng)) * 100.0f) / 100.0f;
+        }
+
+        IsothermOptions exact;
+        exact.tolerance = 0.0f;
+        IsothermExtractor cached(exact);
+        uint64_t mismatches = 0;
+        for (int i = 0; i < FRAMES; ++i) {
+            IsothermExtractor fresh(exact);
+            const auto a = IsothermExtractor::encode(*cached.update(frames[i].data(), i));
+            const auto b = IsothermExtractor::encode(*fresh.update(frames[i].data(), i));
+            mismatches += a != b;
+        }
+        const IsothermStats st = cached.stats();
+        const double reused = double(st.cellsReused) / double(st.cellsReused + st.cellsClassified);
+        std::cout << "[BENCH] moving blob, noise-free, tolerance 0: " << reused * 100.0 << "% cells reused; of "
+                  << st.frames * exact.levels.size() << " level passes " << st.levelsJoined
+                  << " re-joined, " << st.levelsReused << " reused whole\n";
+        if (mismatches || reused < 0.5) {
+            std::cerr << "[FAIL] " << mismatches << " cached frames differ, " << reused * 100.0 << "% reused\n";
+            ok = false;
+        }
+
+        IsothermExtractor tolerant;
+        const float tol = tolerant.options().tolerance;
+        uint64_t outside = 0;
+        for (int i = 0; i < FRAMES; ++i) {
+            const IsothermPtr set = tolerant.update(noisy[i].data(), i);
+            const std::vector<float>& f = noisy[i];
+            for (const Isoline& line : set->lines) {
+                const float c = set->levels[line.level];
+                for (uint32_t k = 0; k < line.count; ++k) {
+                    const IsoPoint& p = set->points[line.first + k];
+                    const int x0 = std::min(static_cast<int>(std::floor(p.x)), W - 1);
+                    const int y0 = std::min(static_cast<int>(std::floor(p.y)), H - 1);
+                    const int x1 = std::min(static_cast<int>(std::ceil(p.x)), W - 1);
+                    const int y1 = std::min(static_cast<int>(std::ceil(p.y)), H - 1);
+                    const float a = f[y0 * W + x0], b = f[y1 * W + x1];
+                    outside += c < std::min(a, b) - tol - 1e-3f || c > std::max(a, b) + tol + 1e-3f;
+                }
+            }
+        }
+        const IsothermStats nst = tolerant.stats();
+
+        auto t0 = Clock::now();
+        IsothermExtractor timed;
+        for (int i = 0; i < FRAMES; ++i) timed.update(noisy[i].data(), i);
+        const double cachedUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / FRAMES;
+        t0 = Clock::now();
+        for (int i = 0; i < FRAMES; ++i) IsothermExtractor().update(noisy[i].data(), i);
+        const double freshUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / FRAMES;
+
+        // Report only: reuse depends on how the noise compares to the tolerance
+        const double nreused = double(nst.cellsReused) / double(nst.cellsReused + nst.cellsClassified);
+        std::cout << "[BENCH] moving blob, 0.1 °C noise, tolerance " << tol << ": " << nreused * 100.0
+                  << "% cells reused, " << nst.levelsReused << " of " << nst.frames * timed.options().levels.size()
+                  << " level passes reused whole; " << cachedUs << " us/frame cached vs " << freshUs
+                  << " us from scratch\n";
+        if (outside) {
+            std::cerr << "[FAIL] " << outside << " noisy crossings further than " << tol << " °C from their level\n";
+            ok = false;
+        }
+    }
+
+    // 4) Wire format round trip and size against a raster overlay
+    {
+        IsothermOptions o;
+        o.levels = {40.0f, 60.0f, 80.0f};
+        IsothermExtractor iso(o);
+        const IsothermPtr set = iso.update(
+            render({{10.0f, 8.0f, 3.5f, 95.0f}, {22.0f, 15.0f, 4.5f, 70.0f}}, 25.0f).data(), 77, 123456789);
+        const std::vector<uint8_t> wire = IsothermExtractor::encode(*set);
+        IsothermSet back;
+        float worst = 0.0f;
+        bool same = IsothermExtractor::decode(wire.data(), wire.size(), back)
+                 && back.sequence == 77 && back.timestampNs == 123456789
+                 && back.lines.size() == set->lines.size() && back.points.size() == set->points.size();
+        for (size_t i = 0; same && i < set->points.size(); ++i) {
+            worst = std::max({worst, std::fabs(back.points[i].x - set->points[i].x),
+                              std::fabs(back.points[i].y - set->points[i].y)});
+        }
+        IsothermSet junk;
+        const bool rejects = !IsothermExtractor::decode(wire.data(), wire.size() - 1, junk);
+        std::cout << "[BENCH] " << set->lines.size() << " lines, " << set->points.size() << " points: "
+                  << wire.size() << " bytes encoded vs " << 320 * 240 << " bytes for a 320x240 overlay mask\n";
+        if (!same || worst > 1.0f / 128.0f + 1e-6f || !rejects) {
+            std::cerr << "[FAIL] round trip: " << (same ? "ok" : "mismatch") << ", worst " << worst
+                      << " px, truncated " << (rejects ? "rejected" : "accepted") << "\n";
+            ok = false;
+        }
+    }
+
+    // 5) As a graph sink
+    {
+        IsothermExtractor iso;
+        auto frame = std::make_shared<ThermalFrame>();
+        frame->sequence = 9;
+        const std::vector<float> f = render({{16.0f, 12.0f, 3.0f, 90.0f}}, 25.0f);
+        std::copy(f.begin(), f.end(), frame->temperatures.begin());
+        const FramePtr forwarded = iso.stage()(frame);
+        const IsothermPtr got = iso.latest();
+        if (forwarded || !got || got->sequence != 9 || got->lines.size() != 2) {
+            std::cerr << "[FAIL] stage did not publish the frame's contours\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] isotherms closed at the right radius, topology consistent, cache exact\n";
+    return 0;
+}
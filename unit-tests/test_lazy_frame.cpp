@@ -0,0 +1,92 @@
+/**
+ * @file test_lazy_frame.cpp
+ * @brief Correctness check and benchmark for LazyFrame ROI conversion.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Verifies that pixels converted on demand match MLX90640_CalculateTo
+ *   exactly, that an ROI query only converts the ROI's pixels, and reports
+ *   the time for "max temperature of one ROI per subpage" against full
+ *   per-subpage conversion. Uses nominal calibration; no hardware needed.
+ */
+
+#include "pixelConverter.hpp"
+#include "mlxTestParams.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int main() {
+    using namespace duosight;
+    using Clock = std::chrono::steady_clock;
+
+    const paramsMLX90640 params = test::makeNominalParams();
+    auto sp0 = test::makeSubpageWords(params, 0);
+    auto sp1 = test::makeSubpageWords(params, 1);
+
+    // Reference: the reader's path (full conversion + chess merge)
+    std::vector<float> ref0(Geometry::PIXELS), ref1(Geometry::PIXELS);
+    const float ta0 = MLX90640_GetTa(sp0.data(), &params);
+    const float ta1 = MLX90640_GetTa(sp1.data(), &params);
+    MLX90640_CalculateTo(sp0.data(), &params, IRParams::EMISSIVITY, ta0, ref0.data());
+    MLX90640_CalculateTo(sp1.data(), &params, IRParams::EMISSIVITY, ta1, ref1.data());
+
+    PixelConverter conv(params);
+    LazyFrame      lazy(conv);
+    lazy.update(sp0.data());
+    lazy.update(sp1.data());
+
+    const Roi roi{10, 8, 4, 4};
+    const RoiStats stats = lazy.roi(roi);
+    if (lazy.conversions() != static_cast<uint64_t>(roi.w * roi.h)) {
+        std::cerr << "[FAIL] ROI query converted " << lazy.conversions() << " pixels\n";
+        return 1;
+    }
+
+    const float* merged = lazy.full();
+    for (int i = 0; i < Geometry::PIXELS; ++i) {
+        const float expect = Geometry::PIXEL_TO_SUBPAGE[i] == 0 ? ref0[i] : ref1[i];
+        if (std::fabs(merged[i] - expect) > 1e-4f) {
+            std::cerr << "[FAIL] pixel " << i << " lazy=" << merged[i] << " ref=" << expect << "\n";
+            return 1;
+        }
+    }
+    std::cout << "[INFO] ROI max " << stats.max << " °C at pixel " << stats.hottest
+              << ", Ta=" << ta0 << " °C\n";
+
+    // Benchmark: one ROI max per incoming subpage vs full conversion
+    constexpr int ITER = 2000;
+    std::vector<float> scratch(Geometry::PIXELS);
+    float sink = 0.0f;
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < ITER; ++i) {
+        auto& sp = (i & 1) ? sp1 : sp0;
+        const float ta = MLX90640_GetTa(sp.data(), &params);
+        MLX90640_CalculateTo(sp.data(), &params, IRParams::EMISSIVITY, ta, scratch.data());
+        sink += scratch[roi.y * Geometry::WIDTH + roi.x];
+    }
+    const double fullUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / ITER;
+
+    t0 = Clock::now();
+    for (int i = 0; i < ITER; ++i) {
+        lazy.update(((i & 1) ? sp1 : sp0).data());
+        sink += lazy.roi(roi).max;
+    }
+    const double lazyUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / ITER;
+
+    std::cout << "[BENCH] full CalculateTo " << fullUs << " us/subpage, lazy ROI "
+              << lazyUs << " us/subpage (x" << fullUs / lazyUs << ")  [" << sink << "]\n";
+
+    if (lazyUs >= fullUs) {
+        std::cerr << "[WARN] lazy ROI path not faster than full conversion\n";
+        return 2;
+    }
+    std::cout << "[PASS] lazy ROI conversion matches CalculateTo\n";
+    return 0;
+}
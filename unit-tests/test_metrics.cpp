@@ -0,0 +1,218 @@
+/**
+ * @file test_metrics.cpp
+ * @brief Functional test and benchmark for MetricsRegistry and MetricsServer.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Hammers counters and a histogram from several threads and checks the
+ *   totals, then wires an MLX90640Reader on the simulated sensor to a
+ *   registry and scrapes it over loopback with several clients open at
+ *   once, checking the exposition text, 404 handling and that the server
+ *   never grows beyond its one thread. No hardware needed.
+ */
+
+#include "MLX90640Reader.hpp"
+#include "metrics.hpp"
+#include "metricsServer.hpp"
+#include "mlx90640Transport.h"
+#include "mlxTestParams.hpp"
+#include "simulatedMlx90640.hpp"
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int threadCount()
+{
+    int n = 0;
+    if (DIR* d = opendir("/proc/self/task")) {
+        while (const dirent* e = readdir(d)) {
+            if (e->d_name[0] != '.') ++n;
+        }
+        closedir(d);
+    }
+    return n;
+}
+
+int connectTo(uint16_t port)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string readAll(int fd)
+{
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        out.append(buf, static_cast<size_t>(n));
+    }
+    close(fd);
+    return out;
+}
+
+std::string get(uint16_t port, const std::string& path)
+{
+    const int fd = connectTo(port);
+    if (fd < 0) return "";
+    const std::string req = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    return readAll(fd);
+}
+
+/// Value of the first exposition line starting with `series `.
+double sampleValue(const std::string& text, const std::string& series)
+{
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, series.size() + 1, series + " ") == 0) {
+            return std::stod(line.substr(series.size() + 1));
+        }
+    }
+    return -1.0;
+}
+
+} // namespace
+
+int main() {
+    using namespace duosight;
+
+    MetricsRegistry registry;
+
+    // ── Hot path: concurrent updates, no lock ───────────────────
+    Counter&   hits    = registry.counter("test_hits_total", "Concurrent increments");
+    Histogram& latency = registry.histogram("test_latency_seconds", "Synthetic latencies",
+                                            {0.001, 0.01, 0.1});
+    constexpr int THREADS = 4;
+    constexpr int PER     = 1'000'000;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < PER; ++i) {
+                hits.inc();
+                if (i % 100 == 0) latency.observe(0.0005 * (1 + (i / 100 + t) % 3) * 10);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    const double ns = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - t0).count() / (THREADS * PER);
+    std::cout << "[BENCH] counter inc under " << THREADS << "-way contention: " << ns << " ns\n";
+
+    if (hits.value() != uint64_t(THREADS) * PER || latency.count() != uint64_t(THREADS) * PER / 100) {
+        std::cerr << "[FAIL] lost updates: " << hits.value() << " hits, "
+                  << latency.count() << " observations\n";
+        return 1;
+    }
+    if (&registry.counter("test_hits_total", "again") != &hits) {
+        std::cerr << "[FAIL] re-registration created a second counter\n";
+        return 1;
+    }
+
+    // ── Reader instruments on the simulated sensor ───────────────
+    const paramsMLX90640 params = test::makeNominalParams();
+    SceneConfig scene;
+    scene.refreshCode = refresh::FR16;
+    SimulatedMlx90640::Options opt;
+    opt.logFaults = false;
+    SimulatedMlx90640 sim(params, scene, opt);
+    sim.addFault({3, SimFault::Nack, 1});
+
+    MLX90640Reader reader(sim, Bus::SLAVE_ADDR);
+    reader.attachMetrics(registry);
+
+    std::streambuf* saved = std::clog.rdbuf(nullptr);   // readFrame is chatty
+    std::vector<float> frame;
+    int good = 0;
+    for (int i = 0; i < 6; ++i) {
+        good += reader.readFrame(frame) ? 1 : 0;
+    }
+    std::clog.rdbuf(saved);
+
+    // ── Scrape over loopback ─────────────────────────────────────
+    MetricsServer server(registry, 0);
+    if (!server.isRunning()) {
+        std::cerr << "[FAIL] server did not start\n";
+        return 1;
+    }
+    const int threadsBefore = threadCount();
+
+    // Several clients connected at once, answered by the one server thread
+    std::vector<int> clients;
+    for (int i = 0; i < 8; ++i) {
+        clients.push_back(connectTo(server.port()));
+    }
+    const int threadsDuring = threadCount();
+    const std::string req = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    for (int fd : clients) send(fd, req.data(), req.size(), 0);
+    std::vector<std::string> replies;
+    for (int fd : clients) replies.push_back(readAll(fd));
+
+    const auto tScrape = std::chrono::steady_clock::now();
+    const std::string body = get(server.port(), "/metrics");
+    const double scrapeMs = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - tScrape).count();
+    const std::string missing = get(server.port(), "/other");
+
+    std::cout << "[INFO] " << good << " frames read, scrape of " << body.size()
+              << " bytes in " << scrapeMs << " ms\n";
+
+    for (const auto& r : replies) {
+        if (r.compare(0, 15, "HTTP/1.1 200 OK") != 0) {
+            std::cerr << "[FAIL] concurrent scrape failed: " << r.substr(0, 40) << "\n";
+            return 1;
+        }
+    }
+    if (threadsDuring != threadsBefore) {
+        std::cerr << "[FAIL] scrapes changed thread count " << threadsBefore
+                  << " -> " << threadsDuring << "\n";
+        return 1;
+    }
+    if (missing.compare(0, 12, "HTTP/1.1 404") != 0) {
+        std::cerr << "[FAIL] unknown path not rejected\n";
+        return 1;
+    }
+
+    const bool typed = body.find("# TYPE duosight_frame_read_seconds histogram") != std::string::npos
+                    && body.find("# TYPE test_hits_total counter") != std::string::npos;
+    const double frames  = sampleValue(body, "duosight_frames_total");
+    const double errors  = sampleValue(body, "duosight_i2c_errors_total");
+    const double infBkt  = sampleValue(body, "test_latency_seconds_bucket{le=\"+Inf\"}");
+    const double readCnt = sampleValue(body, "duosight_frame_read_seconds_count");
+    if (!typed || frames != good || errors < 1 || readCnt != good
+        || infBkt != double(THREADS) * PER / 100
+        || sampleValue(body, "test_hits_total") != double(THREADS) * PER) {
+        std::cerr << "[FAIL] exposition text wrong (frames=" << frames << " errors=" << errors
+                  << ")\n" << body;
+        return 1;
+    }
+
+    server.stop();
+    std::cout << "[PASS] metrics update lock-free and scrape over loopback ("
+              << server.scrapes() << " scrapes)\n";
+    return 0;
+}
@@ -0,0 +1,293 @@
+/**
+ * @file test_nuc.cpp
+ * @brief Functional test for user NUC tables and the calibration cache.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Models an aged sensor as the factory calibration plus a hidden
+ *   per-pixel offset / gain pattern, renders uniform scenes through it and
+ *   stacks them with FrameStacker as the application does. Checks that a
+ *   one-point table flattens the pattern at other scene temperatures, that
+ *   a two-point table also removes a gain pattern, that tables at two
+ *   ambients track a Ta-dependent pattern, that the factory path stays
+ *   bit-exact with no tables and that the cache file round-trips and
+ *   rejects a corrupted or truncated copy. Reports conversion time with
+ *   and without a NUC folded in. No hardware needed.
+ */
+
+#include "frameStacker.hpp"
+#include "mlxTestParams.hpp"
+#include "nucTable.hpp"
+#include "pixelConverter.hpp"
+#include "syntheticScene.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+using namespace duosight;
+
+/// Per-pixel offset (counts) and gain pattern the factory EEPROM misses.
+NucTable agedPattern(uint32_t seed, float ta, float gainSpread, float offsetScale = 1.0f)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> off(-12.0f, 12.0f), g(-gainSpread, gainSpread);
+    NucTable t;
+    t.ta = ta;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        t.offset[p] = off(rng) * offsetScale;
+        t.gain[p]   = 1.0f + g(rng);
+    }
+    return t;
+}
+
+class Rig {
+public:
+    Rig(const paramsMLX90640& params, const PixelConverter& sensor, float ambientC)
+        : sensor_(sensor)
+    {
+        SceneConfig cfg;
+        cfg.ambientC = ambientC;
+        cfg.blobs    = 0;
+        SyntheticScene scene(params, cfg);
+        for (auto& w : words_) scene.nextSubpage(w.data());
+    }
+
+    /// Merged frame of a uniform scene at tempC as conv reports it. The
+    /// pixel words come from the aged sensor model plus read noise.
+    ThermalFrame frame(const PixelConverter& conv, float tempC)
+    {
+        ThermalFrame f;
+        f.sequence    = ++sequence_;
+        f.timestampNs = monotonicNowNs();
+        for (auto& w : words_) {
+            const SubpageTerms t = conv.prepare(w.data());
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                const float raw = (sensor_.signalBound(p, t, tempC) + sensor_.tgc() * t.irDataCP) / t.gain
+                              + noise_(rng_);
+                w[p] = static_cast<uint16_t>(static_cast<int16_t>(std::lround(raw)));
+            }
+            conv.convertSubpage(w.data(), t, f.temperatures.data());
+            terms_ = t;
+        }
+        return f;
+    }
+
+    /// FrameStacker mean of n frames, as the flat-field button captures it.
+    std::array<float, Geometry::PIXELS> stacked(const PixelConverter& conv, float tempC, size_t n = 32)
+    {
+        FrameStacker stacker({n});
+        stacker.arm();
+        StackPtr s;
+        while (!s) s = stacker.add(frame(conv, tempC));
+        return s->mean;
+    }
+
+    /// Spatial RMS deviation from tempC of one (noisy) frame, averaged.
+    double residual(const PixelConverter& conv, float tempC)
+    {
+        const auto m = stacked(conv, tempC, 16);
+        double e = 0.0;
+        for (float v : m) e += (v - tempC) * (v - tempC);
+        return std::sqrt(e / Geometry::PIXELS);
+    }
+
+    const SubpageTerms& terms() const { return terms_; }
+
+private:
+    const PixelConverter&                              sensor_;
+    std::array<std::array<uint16_t, Geometry::WORDS>, 2> words_ {};
+    SubpageTerms                                       terms_ {};
+    std::mt19937                                       rng_ {3};
+    std::normal_distribution<float>                    noise_ {0.0f, 1.0f};
+    uint64_t                                           sequence_ {0};
+};
+
+} // namespace
+
+int main() {
+    const paramsMLX90640 params = test::makeNominalParams();
+
+    // 1) Offset-only ageing, one-point table at 30 °C
+    {
+        PixelConverter sensor(params), conv(params);
+        sensor.applyNuc({agedPattern(1, 25.0f, 0.0f)});
+        Rig rig(params, sensor, 25.0f);
+
+        const double before = rig.residual(conv, 45.0f);
+        const auto   ref    = rig.stacked(conv, 30.0f);
+        conv.applyNuc({conv.measureNuc(rig.terms(), ref.data(), 30.0f)});
+        const double after  = rig.residual(conv, 45.0f);
+        std::cout << "[INFO] offset pattern at 45 °C: " << before << " °C rms, "
+                  << after << " after one-point NUC at 30 °C\n";
+        if (after > 0.2 * before || after > 0.05) {
+            std::cerr << "[FAIL] one-point NUC did not flatten the offset pattern\n";
+            return 1;
+        }
+    }
+
+    // 2) Offset + 4 % gain spread: one-point vs two-point
+    {
+        PixelConverter sensor(params), one(params), two(params);
+        sensor.applyNuc({agedPattern(2, 25.0f, 0.04f)});
+        Rig rig(params, sensor, 25.0f);
+
+        const auto cold = rig.stacked(one, 20.0f);
+        const auto hot  = rig.stacked(one, 50.0f);
+        one.applyNuc({one.measureNuc(rig.terms(), cold.data(), 20.0f)});
+        two.applyNuc({two.measureNuc(rig.terms(), cold.data(), 20.0f, hot.data(), 50.0f)});
+
+        const double r1 = rig.residual(one, 80.0f);
+        const double r2 = rig.residual(two, 80.0f);
+        std::cout << "[INFO] gain pattern at 80 °C: one-point " << r1 << " °C rms, two-point "
+                  << r2 << "\n";
+        if (r2 > 0.05 || r2 > 0.5 * r1) {
+            std::cerr << "[FAIL] two-point NUC did not remove the gain pattern\n";
+            return 1;
+        }
+    }
+
+    // 3) Ta-dependent offsets: tables at two ambients, checked in between
+    //    and beyond
+    {
+        PixelConverter sensor(params), single(params), indexed(params);
+        sensor.applyNuc({agedPattern(3, 20.0f, 0.0f, 0.5f), agedPattern(4, 30.0f, 0.0f, 1.5f)});
+
+        std::vector<NucTable> tables;
+        for (float ambient : {20.0f, 30.0f}) {
+            Rig rig(params, sensor, ambient);
+            const auto ref = rig.stacked(indexed, 30.0f);
+            tables.push_back(indexed.measureNuc(rig.terms(), ref.data(), 30.0f));
+        }
+        single.applyNuc({tables.front()});
+        indexed.applyNuc(tables);
+
+        for (float ambient : {25.0f, 35.0f}) {
+            Rig rig(params, sensor, ambient);
+            const double rs = rig.residual(single, 40.0f);
+            const double ri = rig.residual(indexed, 40.0f);
+            std::cout << "[INFO] Ta " << ambient << " °C: single table " << rs
+                      << " °C rms, Ta-indexed " << ri << "\n";
+            if (ri > 0.05 || ri > 0.5 * rs) {
+                std::cerr << "[FAIL] Ta-indexed NUC did not track the ambient\n";
+                return 1;
+            }
+        }
+
+        // Measuring again with the tables applied must describe the same
+        // sensor, not the residual
+        Rig rig(params, sensor, 20.0f);
+        const auto     ref     = rig.stacked(indexed, 30.0f);
+        const NucTable again   = indexed.measureNuc(rig.terms(), ref.data(), 30.0f);
+        double         maxDiff = 0.0;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            maxDiff = std::max(maxDiff, std::fabs(static_cast<double>(again.offset[p] - tables[0].offset[p])));
+        }
+        if (maxDiff > 1.0) {
+            std::cerr << "[FAIL] re-measurement under NUC drifted by " << maxDiff << " counts\n";
+            return 1;
+        }
+    }
+
+    // 4) No tables: still bit-exact with the Melexis conversion; and the
+    //    per-frame cost does not change with a table folded in
+    {
+        auto sp0 = test::makeSubpageWords(params, 0);
+        std::vector<float> ref(Geometry::PIXELS), out(Geometry::PIXELS);
+        MLX90640_CalculateTo(sp0.data(), &params, IRParams::EMISSIVITY,
+                             MLX90640_GetTa(sp0.data(), &params), ref.data());
+
+        PixelConverter conv(params);
+        conv.applyNuc({agedPattern(5, 25.0f, 0.02f)});
+        conv.applyNuc({});
+        const SubpageTerms t = conv.prepare(sp0.data());
+        conv.convertSubpage(sp0.data(), t, out.data());
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            if (conv.inSubpage(p, t) && out[p] != ref[p]) {
+                std::cerr << "[FAIL] pixel " << p << " differs from CalculateTo without NUC\n";
+                return 1;
+            }
+        }
+
+        constexpr int ITER = 2000;
+        auto time = [&]() {
+            const auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < ITER; ++i) {
+                conv.convertSubpage(sp0.data(), conv.prepare(sp0.data()), out.data());
+            }
+            return std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - t0).count() / ITER;
+        };
+        const double plain = time();
+        conv.applyNuc({agedPattern(5, 25.0f, 0.02f)});
+        const double nuc = time();
+        std::cout << "[BENCH] subpage conversion: " << plain << " us factory, " << nuc
+                  << " us with NUC folded in\n";
+    }
+
+    // 5) Calibration cache round trip
+    {
+        char path[] = "/tmp/duosight-calib-XXXXXX";
+        const int fd = mkstemp(path);
+        if (fd < 0) {
+            std::cerr << "[FAIL] mkstemp\n";
+            return 1;
+        }
+        close(fd);
+
+        CalibrationCache cache;
+        for (int i = 0; i < Eeprom::WORDS; ++i) cache.eeprom[i] = static_cast<uint16_t>(i * 77);
+        cache.addNuc(agedPattern(6, 30.0f, 0.01f));
+        cache.addNuc(agedPattern(7, 20.0f, 0.01f));
+        cache.addNuc(agedPattern(8, 30.4f, 0.01f));   // replaces the 30 °C table
+
+        CalibrationCache loaded;
+        const uint16_t id[Eeprom::ID_WORDS] = {7 * 77, 8 * 77, 9 * 77};
+        if (!cache.save(path) || !loaded.load(path) || loaded.nuc.size() != 2
+            || loaded.eeprom != cache.eeprom || loaded.nuc[1].ta != 30.4f
+            || loaded.nuc[1].offset != cache.nuc[1].offset || loaded.nuc[0].gain != cache.nuc[0].gain
+            || !loaded.sameDevice(id)) {
+            std::cerr << "[FAIL] calibration cache did not round-trip\n";
+            std::remove(path);
+            return 1;
+        }
+
+        // A flipped bit in a table fails the CRC even though the ID matches
+        {
+            const long at = 20 + static_cast<long>(sizeof(cache.eeprom)) + 1234;   // past the header
+            bool flipped = false;
+            if (FILE* f = std::fopen(path, "r+b")) {
+                std::fseek(f, at, SEEK_SET);
+                const int byte = std::fgetc(f);
+                std::fseek(f, at, SEEK_SET);
+                flipped = byte != EOF && std::fputc(byte ^ 0x10, f) != EOF;
+                std::fclose(f);
+            }
+            CalibrationCache torn;
+            if (!flipped || torn.load(path) || !torn.nuc.empty()) {
+                std::cerr << "[FAIL] corrupted cache accepted\n";
+                std::remove(path);
+                return 1;
+            }
+        }
+
+        // A truncated file is rejected and leaves the cache alone
+        if (truncate(path, 4000) != 0 || loaded.load(path) || loaded.nuc.size() != 2) {
+            std::cerr << "[FAIL] truncated cache accepted\n";
+            std::remove(path);
+            return 1;
+        }
+        std::remove(path);
+    }
+
+    std::cout << "[PASS] NUC tables flatten offset, gain and Ta-dependent patterns\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_processing_graph.cpp
+ * @brief Functional test for duosight::ProcessingGraph and WorkStealingPool.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Builds a small graph with a fast analytics branch and a deliberately
+ *   slow recording sink. Verifies that pushing frames never stalls on the
+ *   slow sink, that its bounded edge drops old frames, that the fast
+ *   branch sees every frame in order, and that per-node timing is kept.
+ *   Runs without any sensor hardware.
+ */
+
+#include "processingGraph.hpp"
+#include "workStealingPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+int main() {
+    using namespace duosight;
+
+    WorkStealingPool pool(4);
+    ProcessingGraph  graph(pool);
+
+    std::atomic<uint64_t> lastSeq{0};
+    std::atomic<bool>     inOrder{true};
+    std::atomic<int>      analysed{0};
+
+    graph.addSource("source");
+    graph.addNode("convert", NodeKind::Conversion, [](const FramePtr& f) {
+        auto out = std::make_shared<ThermalFrame>(*f);
+        for (float& t : out->temperatures) t += 1.0f;
+        return FramePtr(out);
+    });
+    graph.addNode("analytics", NodeKind::Detector, [&](const FramePtr& f) -> FramePtr {
+        if (f->sequence <= lastSeq.load()) inOrder = false;
+        lastSeq = f->sequence;
+        ++analysed;
+        return nullptr;
+    });
+    graph.addNode("record", NodeKind::Sink, [](const FramePtr&) -> FramePtr {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return nullptr;
+    });
+
+    if (!graph.configure("source -> convert -> analytics[64]; convert -> record[2]")) {
+        std::cerr << "[FAIL] configure() rejected a valid spec\n";
+        return 1;
+    }
+    if (graph.configure("source -> nowhere")) {
+        std::cerr << "[FAIL] configure() accepted an unknown node\n";
+        return 1;
+    }
+
+    constexpr int FRAMES = 50;
+    double worstPushUs = 0.0;
+    for (int i = 1; i <= FRAMES; ++i) {
+        auto f = std::make_shared<ThermalFrame>();
+        f->sequence    = static_cast<uint64_t>(i);
+        f->timestampNs = monotonicNowNs();
+
+        const auto t0 = std::chrono::steady_clock::now();
+        graph.push("source", f);
+        const double us = std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - t0).count();
+        worstPushUs = std::max(worstPushUs, us);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    graph.drain();
+
+    uint64_t recordDropped = 0;
+    for (const auto& s : graph.stats()) {
+        std::cout << "[INFO] " << s.name << " (" << toString(s.kind) << ") processed="
+                  << s.processed << " dropped=" << s.dropped << " mean=" << s.meanUs
+                  << "us max=" << s.maxUs << "us\n";
+        if (s.name == "record") recordDropped = s.dropped;
+    }
+    std::cout << "[INFO] worst push() " << worstPushUs << " us, steals=" << pool.stealCount() << "\n";
+
+    if (analysed != FRAMES || !inOrder) {
+        std::cerr << "[FAIL] analytics saw " << analysed << "/" << FRAMES
+                  << " frames, in order=" << inOrder << "\n";
+        return 1;
+    }
+    if (recordDropped == 0) {
+        std::cerr << "[FAIL] slow sink did not shed load\n";
+        return 1;
+    }
+    if (worstPushUs > 5'000.0) {
+        std::cerr << "[WARN] push() took " << worstPushUs << " us\n";
+        return 2;
+    }
+
+    std::cout << "[PASS] processing graph isolates slow sinks\n";
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test_rate_of_rise.cpp
+ * @brief Per-pixel rate of rise: accuracy, ranking, regions, cost per frame.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Noisy per-pixel ramps are fed with jittered timestamps and dropped
+ *   frames. The incremental rates must match a direct double-precision
+ *   least-squares fit over the same window on every frame. A scene with a
+ *   fast and a slow heating patch must put the fastest pixels and the
+ *   first region in the fast patch, at the right rate, with ROI means to
+ *   match. The cost per frame is reported against refitting every pixel
+ *   from scratch. No hardware needed.
+ */
+
+#include "rateOfRise.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace duosight;
+
+namespace {
+
+constexpr int W = Geometry::WIDTH, H = Geometry::HEIGHT;
+
+struct Sample {
+    int64_t            ns;
+    std::vector<float> y;
+};
+
+/// Direct least-squares slope in °C/min over the retained samples
+std::vector<float> refit(const std::deque<Sample>& window)
+{
+    const double t0 = window.back().ns / 1e9;
+    double st = 0.0, stt = 0.0;
+    for (const Sample& s : window) {
+        const double t = s.ns / 1e9 - t0;
+        st += t;
+        stt += t * t;
+    }
+    const double n = static_cast<double>(window.size());
+    std::vector<float> rate(Geometry::PIXELS);
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        double sy = 0.0, sty = 0.0;
+        for (const Sample& s : window) {
+            const double t = s.ns / 1e9 - t0;
+            sy += s.y[p];
+            sty += t * s.y[p];
+        }
+        rate[p] = static_cast<float>(60.0 * (n * sty - st * sy) / (n * stt - st * st));
+    }
+    return rate;
+}
+
+bool inside(const Roi& r, int p)
+{
+    const int x = p % W, y = p / W;
+    return x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h;
+}
+
+} // namespace
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    bool ok = true;
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    std::uniform_int_distribution<int> jitter(-3'000'000, 3'000'000);
+    std::uniform_real_distribution<float> uslope(-10.0f, 10.0f), ubase(20.0f, 60.0f);
+
+    // 1) Incremental fit against a direct fit: jitter, dropped frames, long run
+    {
+        constexpr int FRAMES = 2000;
+        RiseOptions o;
+        o.window = 32;
+        RateOfRise rise(o);
+        std::vector<float> base(Geometry::PIXELS), slope(Geometry::PIXELS);   // slope in °C/min
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            base[p] = ubase(rng);
+            slope[p] = uslope(rng);
+        }
+        std::deque<Sample> window;
+        int64_t ns = 1'000'000'000;
+        float worst = 0.0f;
+        int invalid = 0;
+        for (int i = 0; i < FRAMES; ++i) {
+            ns += 62'500'000 * (i % 17 == 5 ? 3 : 1) + jitter(rng);   // 16 Hz, some frames dropped
+            Sample s {ns, std::vector<float>(Geometry::PIXELS)};
+            const float minutes = (ns - 1'000'000'000) / 60e9f;
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                s.y[p] = base[p] + slope[p] * std::fmod(minutes, 2.0f) + noise(rng);
+            }
+            window.push_back(s);
+            if (window.size() > o.window) window.pop_front();
+
+            const RisePtr map = rise.update(s.y.data(), ns, i);
+            if (window.size() < o.minSamples) {
+                invalid += map->valid;
+                continue;
+            }
+            const std::vector<float> want = refit(window);
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                worst = std::max(worst, std::fabs(map->cPerMin[p] - want[p]));
+            }
+        }
+        std::cout << "[INFO] " << FRAMES << " frames, " << rise.resyncs()
+                  << " resyncs: worst difference from a direct fit " << worst << " °C/min\n";
+        if (worst > 0.01f || invalid) {
+            std::cerr << "[FAIL] incremental fit off by " << worst << " °C/min, "
+                      << invalid << " early maps valid\n";
+            ok = false;
+        }
+    }
+
+    // 2) Fast and slow patches on a noisy still scene
+    {
+        const Roi fast {4, 4, 3, 3}, slow {20, 14, 4, 4};
+        RiseOptions o;
+        o.window = 64;   // 16 s at 4 Hz
+        o.rois = {fast, slow, {12, 0, 4, 4}};
+        RateOfRise rise(o);
+        std::normal_distribution<float> sensor(0.0f, 0.15f);
+        std::vector<float> f(Geometry::PIXELS);
+        RisePtr map;
+        for (int i = 0; i < 128; ++i) {
+            const int64_t ns = i * 250'000'000LL;
+            const float minutes = ns / 60e9f;
+            for (int p = 0; p < Geometry::PIXELS; ++p) {
+                f[p] = 25.0f + sensor(rng);
+                if (inside(fast, p)) f[p] += 6.0f * minutes;
+                if (inside(slow, p)) f[p] += 2.0f * minutes;
+            }
+            map = rise.update(f.data(), ns, i);
+        }
+        const bool topInFast = !map->fastest.empty() && inside(fast, map->fastest[0].pixel);
+        const float top = map->fastest.empty() ? 0.0f : map->fastest[0].cPerMin;
+        const bool region = !map->regions.empty() && map->regions[0].box.x == fast.x
+                         && map->regions[0].box.y == fast.y && map->regions[0].box.w == fast.w
+                         && map->regions[0].box.h == fast.h && map->regions[0].pixels == 9;
+        std::cout << "[INFO] fastest pixel " << map->fastest[0].pixel << " at " << top << " °C/min; "
+                  << map->regions.size() << " region(s); ROI means " << map->roiCPerMin[0] << ", "
+                  << map->roiCPerMin[1] << ", " << map->roiCPerMin[2] << " °C/min\n";
+        if (!topInFast || std::fabs(top - 6.0f) > 0.5f || !region
+            || std::fabs(map->roiCPerMin[0] - 6.0f) > 0.3f || std::fabs(map->roiCPerMin[1] - 2.0f) > 0.3f
+            || std::fabs(map->roiCPerMin[2]) > 0.3f) {
+            std::cerr << "[FAIL] fast patch not found at 6 °C/min\n";
+            ok = false;
+        }
+    }
+
+    // 3) Cost per frame: incremental against refitting every window
+    for (size_t windowLength : {32, 128}) {
+        constexpr int FRAMES = 500;
+        RiseOptions o;
+        o.window = windowLength;
+        RateOfRise rise(o);
+        std::deque<Sample> window;
+        std::vector<std::vector<float>> frames(FRAMES, std::vector<float>(Geometry::PIXELS));
+        for (int i = 0; i < FRAMES; ++i) {
+            for (int p = 0; p < Geometry::PIXELS; ++p) frames[i][p] = 30.0f + 0.01f * i + noise(rng);
+        }
+        auto t0 = Clock::now();
+        for (int i = 0; i < FRAMES; ++i) rise.update(frames[i].data(), (i + 1) * 62'500'000LL, i);
+        const double incUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / FRAMES;
+        float sink = 0.0f;
+        t0 = Clock::now();
+        for (int i = 0; i < FRAMES; ++i) {
+            window.push_back({(i + 1) * 62'500'000LL, frames[i]});
+            if (window.size() > windowLength) window.pop_front();
+            if (window.size() >= 2) sink += refit(window)[0];
+        }
+        const double naiveUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / FRAMES;
+        std::cout << "[BENCH] window " << windowLength << ": " << incUs << " us/frame incremental (ranking included) vs "
+                  << naiveUs << " us refitting (" << naiveUs / incUs << "x)" << (sink > 0 ? "\n" : " \n");
+    }
+
+    // 4) As a graph sink
+    {
+        RateOfRise rise;
+        int calls = 0;
+        auto sink = rise.stage([&](const RisePtr&) { ++calls; });
+        FramePtr forwarded;
+        for (int i = 0; i < 10; ++i) {
+            auto frame = std::make_shared<ThermalFrame>();
+            frame->sequence = i;
+            frame->timestampNs = i * 62'500'000LL;
+            frame->temperatures.fill(30.0f + i * 0.1f);
+            forwarded = sink(frame);
+        }
+        const RisePtr got = rise.latest();
+        if (forwarded || calls != 10 || !got || got->sequence != 9 || !got->valid
+            || std::fabs(got->cPerMin[0] - 96.0f) > 0.01f) {
+            std::cerr << "[FAIL] stage did not publish the rate map\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] rate of rise matches a direct fit and finds the fastest patch\n";
+    return 0;
+}
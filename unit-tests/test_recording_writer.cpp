@@ -0,0 +1,307 @@
+/**
+ * @file test_recording_writer.cpp
+ * @brief Recording backend: content, drop accounting, producer-side latency.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Frames are recorded through each backend (io_uring where the kernel
+ *   allows it, and the thread pool). The file must then hold every
+ *   accepted record, in order, and be trimmed to the bytes appended.
+ *   With a tiny buffer pool and no back-off, dropped records must be
+ *   accounted for exactly and leave no torn record behind. The time
+ *   append() takes on the producer thread is reported against an inline
+ *   write() per frame, with the writer's own latency and queue depth.
+ *   Finally io_uring_enter() failures are injected: EBUSY must be retried
+ *   on the ring, and a hard failure, once or for good, must move every
+ *   block to `threads` pwrite() workers with the file still complete. No
+ *   hardware needed; the files go to /tmp.
+ */
+
+#include "metrics.hpp"
+#include "recordingWriter.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using namespace duosight;
+
+namespace {
+
+constexpr size_t RECORD = sizeof(FrameRecord) + Geometry::PIXELS * sizeof(float);
+
+std::string tempPath()
+{
+    char path[] = "/tmp/duosight-rec-XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return path;
+}
+
+ThermalFrame makeFrame(uint64_t seq)
+{
+    ThermalFrame f;
+    f.sequence    = seq;
+    f.timestampNs = static_cast<int64_t>(seq) * 62'500'000;
+    for (size_t p = 0; p < Geometry::PIXELS; ++p) {
+        f.temperatures[p] = 20.0f + 0.001f * static_cast<float>(seq) + 0.01f * static_cast<float>(p);
+    }
+    return f;
+}
+
+/// Sequences of the records in the file; false on a torn or corrupt record
+bool readBack(const std::string& path, std::vector<uint64_t>& sequences, size_t& size)
+{
+    std::ifstream in(path, std::ios::binary);
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size = data.size();
+    for (size_t at = 0; at < data.size(); at += RECORD) {
+        if (data.size() - at < RECORD) return false;
+        FrameRecord h;
+        std::memcpy(&h, &data[at], sizeof(h));
+        const ThermalFrame want = makeFrame(h.sequence);
+        if (h.magic != FrameRecord::MAGIC || h.bytes != RECORD || h.timestampNs != want.timestampNs
+            || std::memcmp(&data[at + sizeof(h)], want.temperatures.data(), Geometry::PIXELS * sizeof(float))) {
+            return false;
+        }
+        sequences.push_back(h.sequence);
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    bool ok = true;
+
+    // 1) Every backend writes every accepted record, in order
+    for (RecordingBackend backend : {RecordingBackend::IoUring, RecordingBackend::Threads}) {
+        constexpr uint64_t FRAMES = 3000;
+        const std::string path = tempPath();
+        RecordingOptions o;
+        o.backend = backend;
+        RecordingStats st;
+        bool closed;
+        {
+            RecordingWriter rec(path, o);
+            for (uint64_t i = 0; i < FRAMES; ++i) {
+                const ThermalFrame f = makeFrame(i);
+                while (!rec.append(f)) std::this_thread::yield();   // the test wants them all
+            }
+            closed = rec.close();
+            st = rec.stats();
+        }
+        std::vector<uint64_t> seqs;
+        size_t size = 0;
+        const bool intact = readBack(path, seqs, size);
+        bool ordered = seqs.size() == FRAMES;
+        for (size_t i = 0; ordered && i < seqs.size(); ++i) ordered = seqs[i] == i;
+        std::cout << "[INFO] " << toString(backend) << " requested, " << toString(st.backend)
+                  << (st.direct ? " + O_DIRECT" : " buffered") << ": " << st.writes << " blocks, "
+                  << st.preallocated / 1024 << " KiB preallocated, " << st.drops << " appends refused and retried\n";
+        const uint64_t blocks = (FRAMES * RECORD + o.blockBytes - 1) / o.blockBytes;
+        if (!closed || !intact || !ordered || size != FRAMES * RECORD || st.writes != blocks
+            || st.writeErrors || st.queueDepth || st.maxQueueDepth > o.buffers || st.preallocated == 0) {
+            std::cerr << "[FAIL] " << toString(backend) << ": closed " << closed << ", intact " << intact
+                      << ", ordered " << ordered << ", " << size << " bytes, " << st.writes << " writes\n";
+            ok = false;
+        }
+        std::remove(path.c_str());
+    }
+
+    // 2) Buffered, odd block size, no preallocation
+    {
+        const std::string path = tempPath();
+        RecordingOptions o;
+        o.direct        = false;
+        o.blockBytes    = 5000;   // rounded to 8 KiB
+        o.preallocBytes = 0;
+        o.backend       = RecordingBackend::Threads;
+        o.threads       = 3;
+        RecordingWriter rec(path, o);
+        for (uint64_t i = 0; i < 100; ++i) {
+            while (!rec.append(makeFrame(i))) std::this_thread::yield();
+        }
+        const bool closed = rec.close();
+        std::vector<uint64_t> seqs;
+        size_t size = 0;
+        const bool intact = readBack(path, seqs, size);
+        if (!closed || !intact || seqs.size() != 100 || rec.options().blockBytes != 8192 || rec.stats().direct) {
+            std::cerr << "[FAIL] buffered threads writer: " << seqs.size() << " records\n";
+            ok = false;
+        }
+        std::remove(path.c_str());
+    }
+
+    // 3) Tiny pool, no back-off: drops are whole records and fully counted
+    {
+        constexpr uint64_t FRAMES = 5000;
+        const std::string path = tempPath();
+        RecordingOptions o;
+        o.blockBytes = 4096;
+        o.buffers    = 2;
+        RecordingStats st;
+        {
+            RecordingWriter rec(path, o);
+            for (uint64_t i = 0; i < FRAMES; ++i) rec.append(makeFrame(i));
+            rec.close();
+            st = rec.stats();
+        }
+        std::vector<uint64_t> seqs;
+        size_t size = 0;
+        const bool intact = readBack(path, seqs, size);
+        const bool ascending = std::is_sorted(seqs.begin(), seqs.end())
+                            && std::adjacent_find(seqs.begin(), seqs.end()) == seqs.end();
+        std::cout << "[INFO] 2 x 4 KiB buffers, no back-off: " << st.drops << " of " << FRAMES << " frames dropped\n";
+        if (!intact || !ascending || seqs.size() + st.drops != FRAMES || st.bytes != size
+            || st.bytes + st.droppedBytes != FRAMES * RECORD) {
+            std::cerr << "[FAIL] drop accounting: " << seqs.size() << " kept, " << st.drops << " dropped\n";
+            ok = false;
+        }
+        std::remove(path.c_str());
+    }
+
+    // 4) Producer-side cost: append() against an inline write() per frame
+    {
+        constexpr int FRAMES = 20000;
+        std::vector<ThermalFrame> frames;
+        for (int i = 0; i < FRAMES; ++i) frames.push_back(makeFrame(i));
+        std::vector<double> us(FRAMES);
+        auto summarise = [&](const char* what) {
+            std::sort(us.begin(), us.end());
+            std::cout << "[BENCH] " << what << ": median " << us[FRAMES / 2] << " us, p99.9 "
+                      << us[FRAMES * 999 / 1000] << " us, max " << us.back() << " us per frame\n";
+        };
+
+        const std::string path = tempPath();
+        RecordingWriter rec(path);
+        for (int i = 0; i < FRAMES; ++i) {
+            const auto t0 = Clock::now();
+            rec.append(frames[i]);
+            us[i] = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            if (i % 8 == 7) std::this_thread::sleep_for(std::chrono::microseconds(200));   // bursty, ~4x real time
+        }
+        rec.close();
+        const RecordingStats st = rec.stats();
+        summarise(toString(st.backend));
+        std::cout << "[BENCH] " << st.writes << " block writes: mean " << st.meanWriteNs() / 1e3 << " us, max "
+                  << st.maxWriteNs / 1e3 << " us queued-to-done; max queue depth " << st.maxQueueDepth
+                  << ", " << st.drops << " dropped\n";
+        std::remove(path.c_str());
+
+        const std::string inlinePath = tempPath();
+        const int fd = ::open(inlinePath.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+        uint8_t record[RECORD];
+        for (int i = 0; i < FRAMES; ++i) {
+            const auto t0 = Clock::now();
+            std::memcpy(record + sizeof(FrameRecord), frames[i].temperatures.data(), RECORD - sizeof(FrameRecord));
+            if (write(fd, record, RECORD) != static_cast<ssize_t>(RECORD)) ok = false;
+            us[i] = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            if (i % 8 == 7) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        fdatasync(fd);
+        ::close(fd);
+        summarise("inline write()");
+        std::remove(inlinePath.c_str());
+    }
+
+    // 5) As a graph sink, with metrics attached
+    {
+        const std::string path = tempPath();
+        MetricsRegistry registry;
+        RecordingWriter rec(path);
+        rec.attachMetrics(registry, "test");
+        auto sink = rec.stage();
+        FramePtr forwarded;
+        for (uint64_t i = 0; i < 50; ++i) {
+            forwarded = sink(std::make_shared<ThermalFrame>(makeFrame(i)));
+        }
+        rec.close();
+        const std::string text = registry.render();
+        std::vector<uint64_t> seqs;
+        size_t size = 0;
+        if (forwarded || !readBack(path, seqs, size) || seqs.size() != 50
+            || text.find("duosight_recording_write_seconds_count{recording=\"test\"} 3") == std::string::npos
+            || text.find("duosight_recording_queue_depth{recording=\"test\"} 0") == std::string::npos) {
+            std::cerr << "[FAIL] stage or metrics:\n" << text;
+            ok = false;
+        }
+        std::remove(path.c_str());
+    }
+
+    // 6) Injected ring failures: busy, one hard error, a ring that never recovers
+    {
+        struct Case {
+            const char*      what;
+            int              busyEvery, failAt, failCount;
+            RecordingBackend expect;
+        };
+        const Case cases[] = {
+            {"EBUSY every 3rd enter", 3, 0, 1, RecordingBackend::IoUring},
+            {"EIO once",              0, 5, 1, RecordingBackend::Threads},
+            {"EIO from then on",      0, 5, 1 << 30, RecordingBackend::Threads},
+        };
+        for (const Case& c : cases) {
+            constexpr uint64_t FRAMES = 3000;
+            const std::string path = tempPath();
+            RecordingOptions o;
+            o.backend              = RecordingBackend::IoUring;
+            o.threads              = 3;
+            o.ringFaults.busyEvery = c.busyEvery;
+            o.ringFaults.failAt    = c.failAt;
+            o.ringFaults.failCount = c.failCount;
+            RecordingStats st;
+            bool closed, ring;
+            {
+                RecordingWriter rec(path, o);
+                ring = rec.stats().backend == RecordingBackend::IoUring;
+                for (uint64_t i = 0; ring && i < FRAMES; ++i) {
+                    const ThermalFrame f = makeFrame(i);
+                    while (!rec.append(f)) std::this_thread::yield();
+                }
+                closed = rec.close();
+                st = rec.stats();
+            }
+            if (!ring) {
+                std::cout << "[INFO] " << c.what << ": skipped, no io_uring here\n";
+                std::remove(path.c_str());
+                continue;
+            }
+            std::vector<uint64_t> seqs;
+            size_t size = 0;
+            const bool intact = readBack(path, seqs, size);
+            bool ordered = seqs.size() == FRAMES;
+            for (size_t i = 0; ordered && i < seqs.size(); ++i) ordered = seqs[i] == i;
+            const uint32_t writers = c.expect == RecordingBackend::IoUring ? 1 : 3;
+            std::cout << "[INFO] " << c.what << ": ended on " << toString(st.backend) << " with "
+                      << st.writers << " writer(s), " << st.writes << " blocks\n";
+            if (!closed || !intact || !ordered || size != FRAMES * RECORD || st.writeErrors
+                || st.backend != c.expect || st.writers != writers) {
+                std::cerr << "[FAIL] " << c.what << ": closed " << closed << ", intact " << intact
+                          << ", ordered " << ordered << ", " << st.writeErrors << " write errors\n";
+                ok = false;
+            }
+            std::remove(path.c_str());
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] recordings complete and ordered, drops accounted, producer never waits on the disk\n";
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_scene_change.cpp
+ * @brief Functional test for SceneChangeDetector and change gating.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Feeds a static noisy scene followed by a moving hot object. Checks that
+ *   the static part raises no tiles, that the object marks the right tile,
+ *   that slow drift is eventually reported, and prints the CPU saved by a
+ *   gated stage over the sequence. Then a gated sink behind a one-frame
+ *   graph edge is kept busy while a changed frame is evicted by an
+ *   unchanged one; the sink must still render the frame that replaced
+ *   it. No hardware needed.
+ */
+
+#include "sceneChange.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+int main() {
+    using namespace duosight;
+
+    SceneChangeDetector detector(0.3f);
+    GateStats gate;
+    auto stage = gateOnChange([](const FramePtr&) -> FramePtr {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));  // e.g. upscale + render
+        return nullptr;
+    }, gate);
+
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+
+    constexpr int STATIC = 500;
+    uint64_t staticChanges = 0;
+    for (int i = 0; i < STATIC + 20; ++i) {
+        auto f = std::make_shared<ThermalFrame>();
+        f->sequence = i;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            f->temperatures[p] = 22.0f + 0.01f * (p % Geometry::WIDTH) + noise(rng);
+        }
+        if (i >= STATIC) {                              // hot object in tile (1, 2)
+            f->temperatures[12 * Geometry::WIDTH + 20] = 60.0f;
+            f->temperatures[13 * Geometry::WIDTH + 21] = 60.0f;
+        }
+
+        const SceneChange sc = detector.update(f->temperatures.data());
+        f->changedTiles = sc.changedTiles;
+        f->changeScore  = sc.score;
+
+        if (i > 0 && i < STATIC && sc.changed()) ++staticChanges;
+        if (i == STATIC && sc.changedTiles != (1u << (1 * SceneTiles::COLS + 2))) {
+            std::cerr << "[FAIL] hot object tile mask 0x" << std::hex << sc.changedTiles << "\n";
+            return 1;
+        }
+        stage(f);
+    }
+
+    // Slow drift: 0.01 °C per frame must be reported once it accumulates.
+    SceneChangeDetector drift(0.3f);
+    std::array<float, Geometry::PIXELS> t{};
+    int firstReport = -1;
+    for (int i = 0; i < 100 && firstReport < 0; ++i) {
+        t.fill(20.0f + 0.01f * i);
+        if (drift.update(t.data()).changed() && i > 0) firstReport = i;
+    }
+
+    std::cout << "[INFO] static frames flagged " << staticChanges << "/" << STATIC - 1
+              << ", drift reported after " << firstReport << " frames\n";
+    std::cout << "[INFO] gated stage ran " << gate.passed << " times, skipped " << gate.skipped
+              << ", saved " << gate.savedMs() << " ms of CPU\n";
+
+    if (staticChanges > STATIC / 100 || firstReport < 0) {
+        std::cerr << "[FAIL] change detector too sensitive or blind to drift\n";
+        return 1;
+    }
+
+    // A changed frame dropped on a render[1] edge: its successor, unchanged
+    // against the detector's reference, must still be rendered
+    {
+        WorkStealingPool pool(2);
+        ProcessingGraph  graph(pool);
+        GateStats        renderGate;
+        std::atomic<bool> busy {false}, release {false};
+        std::mutex            mutex;
+        std::vector<uint64_t> rendered;
+        graph.addSource("source");
+        graph.addNode("render", NodeKind::Sink, gateOnChange([&](const FramePtr& f) -> FramePtr {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                rendered.push_back(f->sequence);
+            }
+            busy = true;
+            while (!release) std::this_thread::yield();
+            return nullptr;
+        }, renderGate));
+        graph.configure("source -> render[1]");
+
+        auto tagged = [](uint64_t seq, uint32_t tiles) {
+            auto f = std::make_shared<ThermalFrame>();
+            f->sequence     = seq;
+            f->changedTiles = tiles;
+            return f;
+        };
+        graph.push("source", tagged(0, SceneTiles::ALL));
+        while (!busy) std::this_thread::yield();
+        graph.push("source", tagged(1, 1u << 5));   // the hot object moves...
+        graph.push("source", tagged(2, 0));         // ...then stays put: evicts frame 1
+        release = true;
+        graph.drain();
+        graph.push("source", tagged(3, 0));         // still static: skipped
+        graph.drain();
+
+        std::cout << "[INFO] render[1] rendered " << rendered.size() << " of 4 frames, skipped "
+                  << renderGate.skipped << "\n";
+        if (rendered != std::vector<uint64_t>{0, 2}) {
+            std::cerr << "[FAIL] the change on a dropped frame never reached the render sink\n";
+            return 1;
+        }
+    }
+    std::cout << "[PASS] scene-change gating\n";
+    return 0;
+}
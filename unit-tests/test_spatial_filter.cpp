@@ -0,0 +1,211 @@
+/**
+ * @file test_spatial_filter.cpp
+ * @brief Sorting-network medians and LUT bilateral: exactness, denoise, timing.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   The 3x3 and 5x5 medians must equal a brute-force nth_element median
+ *   on random data. The check runs on the sensor grid and on a grid whose
+ *   width is not a multiple of four. On a 25 / 60 °C step with 2% salt
+ *   and pepper, the median must remove the impulses. With Gaussian noise,
+ *   the bilateral must cut the noise on both plateaus while keeping the
+ *   edge; it must also agree with an exact-exp reference. Then reports µs
+ *   per frame for each filter at 32x24 and at a 320x240 upscaled view, and
+ *   runs one filter as a graph stage. No hardware needed.
+ */
+
+#include "spatialFilter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace duosight;
+
+namespace {
+
+float refMedian(const std::vector<float>& in, int w, int h, int x, int y, int r)
+{
+    std::vector<float> win;
+    for (int dy = -r; dy <= r; ++dy) {
+        for (int dx = -r; dx <= r; ++dx) {
+            win.push_back(in[std::clamp(y + dy, 0, h - 1) * w + std::clamp(x + dx, 0, w - 1)]);
+        }
+    }
+    std::nth_element(win.begin(), win.begin() + win.size() / 2, win.end());
+    return win[win.size() / 2];
+}
+
+float refBilateral(const std::vector<float>& in, int w, int h, int x, int y, const SpatialFilterOptions& o)
+{
+    const float c = in[y * w + x];
+    double num = 0.0, den = 0.0;
+    for (int dy = -o.radius; dy <= o.radius; ++dy) {
+        for (int dx = -o.radius; dx <= o.radius; ++dx) {
+            const float v = in[std::clamp(y + dy, 0, h - 1) * w + std::clamp(x + dx, 0, w - 1)];
+            const double d = v - c;
+            if (std::fabs(d) >= 4.0 * o.sigmaRange) continue;
+            const double wt = std::exp(-(dx * dx + dy * dy) / (2.0 * o.sigmaSpace * o.sigmaSpace))
+                            * std::exp(-d * d / (2.0 * o.sigmaRange * o.sigmaRange));
+            num += wt * v;
+            den += wt;
+        }
+    }
+    return static_cast<float>(num / den);
+}
+
+/// 25 °C left of column 16, 60 °C right of it
+std::vector<float> stepScene()
+{
+    std::vector<float> f(Geometry::PIXELS);
+    for (int p = 0; p < Geometry::PIXELS; ++p) f[p] = (p % Geometry::WIDTH) < 16 ? 25.0f : 60.0f;
+    return f;
+}
+
+/// RMS deviation from the clean step, plateau pixels only (two columns from the edge)
+double plateauRms(const std::vector<float>& f, const std::vector<float>& clean)
+{
+    double sum = 0.0;
+    int    n   = 0;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        const int x = p % Geometry::WIDTH;
+        if (x >= 14 && x < 18) continue;
+        sum += (f[p] - clean[p]) * (f[p] - clean[p]);
+        ++n;
+    }
+    return std::sqrt(sum / n);
+}
+
+} // namespace
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    bool ok = true;
+    std::mt19937 rng(7);
+
+    // 1) Medians equal the brute-force median, including a ragged width
+    for (const auto& size : {std::pair<int, int>{Geometry::WIDTH, Geometry::HEIGHT}, {37, 19}}) {
+        const int w = size.first, h = size.second;
+        SpatialFilterOptions o;
+        o.width  = w;
+        o.height = h;
+        SpatialFilter f(o);
+        std::uniform_real_distribution<float> u(10.0f, 90.0f);
+        std::vector<float> in(w * h), out3(w * h), out5(w * h);
+        uint64_t wrong = 0;
+        for (int round = 0; round < 20; ++round) {
+            for (float& v : in) v = u(rng);
+            if (round & 1) {
+                for (float& v : in) v = std::round(v / 10.0f) * 10.0f;   // many ties
+            }
+            f.median3(in.data(), out3.data());
+            f.median5(in.data(), out5.data());
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    wrong += out3[y * w + x] != refMedian(in, w, h, x, y, 1);
+                    wrong += out5[y * w + x] != refMedian(in, w, h, x, y, 2);
+                }
+            }
+        }
+        if (wrong) {
+            std::cerr << "[FAIL] " << wrong << " median pixels differ at " << w << "x" << h << "\n";
+            ok = false;
+        }
+    }
+
+    const std::vector<float> clean = stepScene();
+    std::vector<float> noisy(clean), out(Geometry::PIXELS);
+    SpatialFilter filter;
+
+    // 2) Salt and pepper on the step: the 3x3 median removes every impulse
+    {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        int impulses = 0;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            if (u(rng) < 0.02f) {
+                noisy[p] = u(rng) < 0.5f ? -40.0f : 300.0f;
+                ++impulses;
+            }
+        }
+        filter.median3(noisy.data(), out.data());
+        float worst = 0.0f;
+        for (int p = 0; p < Geometry::PIXELS; ++p) worst = std::max(worst, std::fabs(out[p] - clean[p]));
+        std::cout << "[INFO] median3: " << impulses << " impulses, worst residual " << worst << " °C\n";
+        if (worst > 0.0f) {
+            std::cerr << "[FAIL] median3 left an impulse (" << worst << " °C)\n";
+            ok = false;
+        }
+    }
+
+    // 3) Gaussian noise on the step: bilateral smooths the plateaus, keeps the edge
+    {
+        std::normal_distribution<float> g(0.0f, 0.5f);
+        for (int p = 0; p < Geometry::PIXELS; ++p) noisy[p] = clean[p] + g(rng);
+        filter.bilateral(noisy.data(), out.data());
+        const double before = plateauRms(noisy, clean), after = plateauRms(out, clean);
+        float edge = 0.0f, refDiff = 0.0f;
+        constexpr int W = Geometry::WIDTH, H = Geometry::HEIGHT;
+        for (int y = 0; y < H; ++y) {
+            const int p = y * W;
+            edge = std::max({edge, std::fabs(out[p + 15] - 25.0f), std::fabs(out[p + 16] - 60.0f)});
+            for (int x = 0; x < W; ++x) {
+                refDiff = std::max(refDiff,
+                                   std::fabs(out[p + x] - refBilateral(noisy, W, H, x, y, filter.options())));
+            }
+        }
+        std::cout << "[INFO] bilateral: plateau noise " << before << " -> " << after
+                  << " °C rms, edge pixels within " << edge << " °C, vs exact exp " << refDiff << " °C\n";
+        if (after > before / 2.0 || edge > 1.5f || refDiff > 0.05f) {
+            std::cerr << "[FAIL] bilateral: noise " << after << " °C, edge " << edge << " °C, LUT error "
+                      << refDiff << " °C\n";
+            ok = false;
+        }
+    }
+
+    // 4) µs per frame at sensor resolution and at a 320x240 upscaled view
+    for (const auto& size : {std::pair<int, int>{Geometry::WIDTH, Geometry::HEIGHT}, {320, 240}}) {
+        SpatialFilterOptions o;
+        o.width  = size.first;
+        o.height = size.second;
+        SpatialFilter f(o);
+        std::vector<float> in(o.width * o.height), res(in.size());
+        std::normal_distribution<float> g(30.0f, 5.0f);
+        for (float& v : in) v = g(rng);
+        const int rounds = o.width == static_cast<int>(Geometry::WIDTH) ? 2000 : 20;
+        std::cout << "[BENCH] " << o.width << "x" << o.height << ":";
+        for (SpatialKind k : {SpatialKind::Median3, SpatialKind::Median5, SpatialKind::Bilateral}) {
+            const auto t0 = Clock::now();
+            for (int r = 0; r < rounds; ++r) f.apply(k, in.data(), res.data());
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / rounds;
+            std::cout << " " << toString(k) << " " << us << " us";
+        }
+        std::cout << " per frame\n";
+    }
+
+    // 5) As a graph stage in front of a temporal consumer
+    {
+        auto frame = std::make_shared<ThermalFrame>();
+        frame->sequence    = 42;
+        frame->timestampNs = 1234;
+        std::copy(noisy.begin(), noisy.end(), frame->temperatures.begin());
+        const FramePtr filtered = filter.stage(SpatialKind::Median3)(frame);
+        filter.median3(noisy.data(), out.data());
+        if (!filtered || filtered->sequence != 42 || filtered->timestampNs != 1234
+            || !std::equal(out.begin(), out.end(), filtered->temperatures.begin())) {
+            std::cerr << "[FAIL] stage output differs from median3()\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] medians exact, impulses removed, bilateral smooths without blurring the edge\n";
+    return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file test_stagger_coordinator.cpp
+ * @brief Phase staggering of several sensors sharing one I2C bus.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Three SimulatedMlx90640s (0x33-0x35) at 8 Hz share one virtual bus
+ *   clock, start in step and run with oscillators 20 ppm apart. The same
+ *   setup is read once with staggering off and once with it on; after a
+ *   settling period each run reports queueing behind other bursts,
+ *   NEW_DATA_READY -> RAM latency, overruns and bus idle time. Checks that
+ *   the ready phases end up spread across the period and stay there as
+ *   the clocks drift, and that no subpage is lost or mixed up on the way.
+ *   The staggered run only shows the coordinator agrees with the
+ *   simulator's model of a CTRL1 write restarting the measurement. A
+ *   third run uses sensors that ignore the rewrite. The coordinator must
+ *   notice that, stop re-phasing them and keep reading cleanly. No
+ *   hardware needed.
+ */
+
+#include "staggerCoordinator.hpp"
+#include "simulatedMlx90640.hpp"
+#include "mlxTestParams.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace duosight;
+
+constexpr int    SENSORS       = 3;
+constexpr double PPM[SENSORS]  = {0.0, 20.0, -20.0};
+constexpr int64_t SETTLE_NS    = 10'000'000'000;
+constexpr int64_t MEASURE_NS   = 300'000'000'000;
+
+struct Run {
+    StaggerStats coord;
+    std::vector<SimStats> sims;
+    uint64_t failures  {0};
+    uint64_t corrupted {0};   // gain word or subpage tag wrong
+    int64_t  minGapNs  {0};   // closest pair of ready phases at the end
+};
+
+Run runStagger(const paramsMLX90640& params, bool enabled, bool ctrl1Restarts = true)
+{
+    SceneConfig scene;
+    scene.refreshCode = refresh::FR8;
+    const int64_t periodNs = static_cast<int64_t>(refresh::TABLE[refresh::FR8].sec_subpage * 1e9);
+
+    auto clock = std::make_shared<int64_t>(0);
+    std::vector<std::unique_ptr<SimulatedMlx90640>> sims;
+    std::vector<I2cDevice*> buses;
+    for (int i = 0; i < SENSORS; ++i) {
+        SimulatedMlx90640::Options o;
+        o.address   = static_cast<uint8_t>(0x33 + i);
+        o.logFaults = false;
+        o.clockPpm  = PPM[i];
+        o.busClock  = clock;
+        o.ctrl1Restarts = ctrl1Restarts;
+        sims.push_back(std::make_unique<SimulatedMlx90640>(params, scene, o));
+        buses.push_back(sims.back().get());
+    }
+
+    StaggerOptions opt;
+    opt.periodNs = periodNs;
+    opt.enabled  = enabled;
+    StaggerCoordinator coord(buses, opt, {[&] { return *clock; }, [&](int64_t ns) { *clock += ns; }});
+
+    Run r;
+    std::array<uint16_t, Geometry::WORDS> words {};
+    std::vector<SimStats> base(SENSORS);
+    bool measuring = false;
+    while (*clock < SETTLE_NS + MEASURE_NS) {
+        if (!measuring && *clock >= SETTLE_NS) {
+            coord.resetStats();
+            for (int i = 0; i < SENSORS; ++i) base[i] = sims[i]->stats();
+            measuring = true;
+        }
+        FetchResult f;
+        if (coord.next(words.data(), &f) < 0) {
+            ++r.failures;
+            continue;
+        }
+        if (static_cast<int16_t>(words[778]) != params.gainEE || words[833] != f.subpage) {
+            ++r.corrupted;
+        }
+    }
+
+    r.coord = coord.stats();
+    for (int i = 0; i < SENSORS; ++i) {
+        SimStats s = sims[i]->stats();
+        s.delivered     -= base[i].delivered;
+        s.overwritten   -= base[i].overwritten;
+        s.readyToReadNs -= base[i].readyToReadNs;
+        r.sims.push_back(s);
+    }
+
+    std::vector<int64_t> phases;
+    for (const auto& s : r.coord.sensors) phases.push_back(s.phaseNs);
+    std::sort(phases.begin(), phases.end());
+    r.minGapNs = phases.front() + periodNs - phases.back();
+    for (size_t i = 1; i < phases.size(); ++i) r.minGapNs = std::min(r.minGapNs, phases[i] - phases[i - 1]);
+    return r;
+}
+
+void report(const char* label, const Run& r)
+{
+    uint64_t subpages = 0, overruns = 0, rephases = 0, delivered = 0, lost = 0;
+    int64_t  queued = 0, latency = 0;
+    for (const auto& s : r.coord.sensors) {
+        subpages += s.subpages;
+        overruns += s.overruns;
+        rephases += s.rephases;
+        queued   += s.queuedNs;
+    }
+    for (const auto& s : r.sims) {
+        delivered += s.delivered;
+        lost      += s.overwritten;
+        latency   += s.readyToReadNs;
+    }
+    std::cout << "[BENCH] " << label << ": " << subpages << " subpages, queued "
+              << queued / double(subpages) / 1e6 << " ms, ready->data "
+              << latency / double(delivered) / 1e6 << " ms, " << overruns << " overruns ("
+              << lost << " lost), bus idle " << r.coord.idleFraction() * 100.0 << "%, "
+              << rephases << " re-phases, closest phases " << r.minGapNs / 1e6 << " ms\n";
+}
+
+double meanLatency(const Run& r)
+{
+    int64_t latency = 0;
+    uint64_t delivered = 0;
+    for (const auto& s : r.sims) {
+        latency   += s.readyToReadNs;
+        delivered += s.delivered;
+    }
+    return delivered ? double(latency) / double(delivered) : 0.0;
+}
+
+double meanQueued(const Run& r)
+{
+    int64_t  queued = 0;
+    uint64_t subpages = 0;
+    for (const auto& s : r.coord.sensors) {
+        queued   += s.queuedNs;
+        subpages += s.subpages;
+    }
+    return subpages ? double(queued) / double(subpages) : 0.0;
+}
+
+uint64_t rephases(const Run& r)
+{
+    uint64_t n = 0;
+    for (const auto& s : r.coord.sensors) n += s.rephases;
+    return n;
+}
+
+uint64_t overruns(const Run& r)
+{
+    uint64_t n = 0;
+    for (const auto& s : r.coord.sensors) n += s.overruns;
+    for (const auto& s : r.sims) n += s.overwritten;
+    return n;
+}
+
+} // namespace
+
+int main() {
+    const paramsMLX90640 params = test::makeNominalParams();
+    const Run before = runStagger(params, false);
+    const Run after  = runStagger(params, true);
+    const Run fixed  = runStagger(params, true, false);
+    report("in step  ", before);
+    report("staggered", after);
+    report("no restart", fixed);
+
+    bool ok = true;
+    for (const Run* r : {&before, &after, &fixed}) {
+        if (r->failures || r->corrupted) {
+            std::cerr << "[FAIL] " << r->failures << " failures, " << r->corrupted << " corrupted subpages\n";
+            ok = false;
+        }
+    }
+    const int64_t slot = static_cast<int64_t>(refresh::TABLE[refresh::FR8].sec_subpage * 1e9) / SENSORS;
+    if (after.minGapNs < slot / 2) {
+        std::cerr << "[FAIL] ready phases " << after.minGapNs / 1e6 << " ms apart, slot "
+                  << slot / 1e6 << " ms\n";
+        ok = false;
+    }
+    if (meanQueued(after) * 5 > meanQueued(before) || meanLatency(after) >= meanLatency(before)) {
+        std::cerr << "[FAIL] bursts still queue: " << meanQueued(after) / 1e6 << " ms staggered vs "
+                  << meanQueued(before) / 1e6 << " ms in step\n";
+        ok = false;
+    }
+    if (rephases(after) == 0) {
+        std::cerr << "[FAIL] drift never re-phased a sensor after the first spread\n";
+        ok = false;
+    }
+    if (overruns(after) > overruns(before) || overruns(after) > 0) {
+        std::cerr << "[FAIL] " << overruns(after) << " overruns staggered\n";
+        ok = false;
+    }
+
+    // Sensors that ignore the rewrite: given up on after a few tries
+    uint64_t off = 0;
+    for (const auto& s : fixed.coord.sensors) off += s.rephaseOff ? 1 : 0;
+    if (off < SENSORS - 1 || rephases(fixed) != 0 || overruns(fixed) > overruns(before)) {
+        std::cerr << "[FAIL] without restarts: " << off << " sensors given up on, " << rephases(fixed)
+                  << " re-phases after settling\n";
+        ok = false;
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] bursts staggered across the period and held against drift; ready->data "
+              << (meanLatency(before) - meanLatency(after)) / 1e6 << " ms shorter\n";
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file test_subpage_fetcher.cpp
+ * @brief Speculative STATUS + RAM acquisition against the simulated sensor.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Drives SubpageFetcher over SimulatedMlx90640 in virtual time, once
+ *   polling and once speculating, and reports hit rate, transactions per
+ *   subpage and latency from NEW_DATA_READY to data in hand. Then checks
+ *   that a wrong nominal period is measured and held, that a jittery ready
+ *   time is tracked without losing data, and that a sensor running at a
+ *   rate the fetcher was not told about drops it back to polling. No
+ *   hardware needed.
+ */
+
+#include "subpageFetcher.hpp"
+#include "simulatedMlx90640.hpp"
+#include "mlxTestParams.hpp"
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+
+using namespace duosight;
+
+struct Run {
+    FetchStats fetch;
+    SimStats   sim;
+    int64_t    learnedPeriodNs {0};
+    uint64_t   failures        {0};   // bus error / timeout
+    uint64_t   corrupted       {0};   // gain word or subpage tag wrong
+    uint64_t   outOfOrder      {0};
+};
+
+Run runFetcher(const paramsMLX90640& params, uint8_t refreshCode, bool speculative,
+               double periodError = 0.0, bool jitter = false, int subpages = 600)
+{
+    SceneConfig scene;
+    scene.refreshCode = refreshCode;
+
+    SimulatedMlx90640::Options simOpt;
+    simOpt.logFaults = false;
+    SimulatedMlx90640 sim(params, scene, simOpt);
+
+    if (jitter) {
+        // From subpage 100 on, half the subpages turn up 1-5 ms late
+        std::mt19937 rng(7);
+        for (uint64_t sp = 100; sp < static_cast<uint64_t>(subpages) + 100; ++sp) {
+            if (rng() & 1) {
+                sim.addFault({sp, SimFault::DelayedReady, 1, 1000 + static_cast<uint32_t>(rng() % 4000)});
+            }
+        }
+    }
+
+    const int64_t truePeriodNs = static_cast<int64_t>(refresh::TABLE[refreshCode].sec_subpage * 1e9);
+    FetchOptions opt;
+    opt.speculative = speculative;
+    opt.periodNs    = static_cast<int64_t>(truePeriodNs * (1.0 + periodError));
+    opt.pollNs      = std::max<int64_t>(opt.periodNs / 32, 200'000);
+
+    SubpageFetcher fetcher(sim, opt, {[&] { return sim.nowNs(); }, [&](int64_t ns) { sim.advance(ns); }});
+
+    Run r;
+    std::array<uint16_t, Geometry::WORDS> words {};
+    int last = -1;
+    for (int i = 0; i < subpages; ++i) {
+        const FetchResult f = fetcher.fetch(words.data());
+        if (f.subpage < 0) {
+            ++r.failures;
+            continue;
+        }
+        if (static_cast<int16_t>(words[778]) != params.gainEE || words[833] != f.subpage) {
+            ++r.corrupted;
+        }
+        if (last >= 0 && f.subpage == last) {
+            ++r.outOfOrder;
+        }
+        last = f.subpage;
+    }
+    r.fetch           = fetcher.stats();
+    r.sim             = sim.stats();
+    r.learnedPeriodNs = fetcher.periodNs();
+    return r;
+}
+
+void report(const char* label, const Run& r)
+{
+    const double n = static_cast<double>(r.fetch.subpages);
+    std::cout << "[BENCH] " << label << ": " << r.fetch.subpages << " subpages, hit rate "
+              << r.fetch.hitRate() * 100.0 << "%, " << r.fetch.transactions / n << " transactions and "
+              << r.fetch.statusPolls / n << " STATUS polls per subpage, detect->data "
+              << r.fetch.detectToDataNs / n / 1e6 << " ms, ready->data "
+              << r.sim.readyToReadNs / static_cast<double>(r.sim.delivered) / 1e6 << " ms, "
+              << r.sim.overwritten << " lost, " << r.fetch.fallbacks << " fallbacks\n";
+}
+
+bool healthy(const char* label, const Run& r)
+{
+    if (r.failures || r.corrupted || r.outOfOrder) {
+        std::cerr << "[FAIL] " << label << ": " << r.failures << " failures, " << r.corrupted
+                  << " corrupted, " << r.outOfOrder << " out of order\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    const paramsMLX90640 params = test::makeNominalParams();
+    bool ok = true;
+
+    // 1) Polling vs speculation at the rates a 1 MHz bus can sustain
+    for (uint8_t code : {refresh::FR8, refresh::FR16}) {
+        const Run poll = runFetcher(params, code, false);
+        const Run spec = runFetcher(params, code, true);
+        const std::string hz = std::to_string(static_cast<int>(refresh::TABLE[code].hz_full_frame)) + " Hz";
+        report(("polling     " + hz).c_str(), poll);
+        report(("speculative " + hz).c_str(), spec);
+        ok = healthy("polling", poll) && healthy("speculative", spec) && ok;
+
+        const double pollLat = poll.sim.readyToReadNs / static_cast<double>(poll.sim.delivered);
+        const double specLat = spec.sim.readyToReadNs / static_cast<double>(spec.sim.delivered);
+        if (spec.fetch.hitRate() < 0.7) {
+            std::cerr << "[FAIL] " << hz << " hit rate " << spec.fetch.hitRate() << " < 0.7\n";
+            ok = false;
+        }
+        if (specLat >= pollLat) {
+            std::cerr << "[FAIL] " << hz << " speculation did not cut ready->data latency\n";
+            ok = false;
+        }
+        if (spec.fetch.transactions >= poll.fetch.transactions) {
+            std::cerr << "[FAIL] " << hz << " speculation did not save transactions\n";
+            ok = false;
+        }
+        if (spec.sim.overwritten > poll.sim.overwritten) {
+            std::cerr << "[FAIL] " << hz << " speculation lost subpages polling kept\n";
+            ok = false;
+        }
+    }
+
+    // 2) Nominal period 3 % off: measured while warming up, then held
+    {
+        const Run r = runFetcher(params, refresh::FR16, true, 0.03);
+        report("speculative, period +3%", r);
+        const double truePeriod = refresh::TABLE[refresh::FR16].sec_subpage * 1e9;
+        const double err = std::fabs(r.learnedPeriodNs - truePeriod) / truePeriod;
+        std::cout << "[INFO] learned period " << r.learnedPeriodNs / 1e6 << " ms (true "
+                  << truePeriod / 1e6 << " ms)\n";
+        ok = healthy("period +3%", r) && ok;
+        if (err > 0.001 || r.fetch.hitRate() < 0.7) {
+            std::cerr << "[FAIL] period off by " << err * 100.0 << "%, hit rate " << r.fetch.hitRate() << "\n";
+            ok = false;
+        }
+    }
+
+    // 3) Jittery ready time: the model settles late enough to keep hitting
+    {
+        const Run r = runFetcher(params, refresh::FR16, true, 0.0, true);
+        report("speculative, jittery ready", r);
+        ok = healthy("jitter", r) && ok;
+        if (r.sim.overwritten) {
+            std::cerr << "[FAIL] subpages lost under jitter\n";
+            ok = false;
+        }
+    }
+
+    // 4) Sensor at FR8 while the fetcher expects FR16: every other burst
+    //    finds nothing, so it falls back to polling and keeps delivering
+    {
+        const int64_t fr16 = static_cast<int64_t>(refresh::TABLE[refresh::FR16].sec_subpage * 1e9);
+        const int64_t fr8  = static_cast<int64_t>(refresh::TABLE[refresh::FR8].sec_subpage * 1e9);
+        const Run r = runFetcher(params, refresh::FR8, true, double(fr16 - fr8) / fr8, false, 400);
+        report("speculative, sensor at half rate", r);
+        ok = healthy("half rate", r) && ok;
+        if (r.fetch.fallbacks == 0 || r.sim.overwritten) {
+            std::cerr << "[FAIL] " << r.fetch.fallbacks << " fallbacks, " << r.sim.overwritten
+                      << " lost at an unexpected rate\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] speculative acquisition delivers every subpage with fewer transactions\n";
+    return 0;
+}
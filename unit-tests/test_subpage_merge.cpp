@@ -0,0 +1,115 @@
+/**
+ * @file test_subpage_merge.cpp
+ * @brief Functional test and microbenchmark for the subpage merge kernels.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Checks both specialisations against the Melexis pixel patterns (the
+ *   same formulas PixelConverter uses), including the in-place half update,
+ *   then times them against the former readFrame merge: a per-pixel branch
+ *   on Geometry::PIXEL_TO_SUBPAGE. No hardware needed.
+ */
+
+#include "subpageMerge.hpp"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+using namespace duosight;
+
+using Plane = std::array<float, Geometry::PIXELS>;
+
+/// Melexis pattern of pixel p (MLX90640_CalculateTo).
+int patternOf(int p, bool chess)
+{
+    const int il = p / 32 - (p / 64) * 2;
+    return chess ? (il ^ (p - (p / 2) * 2)) : il;
+}
+
+void legacyMerge(const float* sub0, const float* sub1, float* out)
+{
+    for (int row = 0; row < static_cast<int>(Geometry::HEIGHT); ++row) {
+        for (int col = 0; col < static_cast<int>(Geometry::WIDTH); ++col) {
+            const int i = row * static_cast<int>(Geometry::WIDTH) + col;
+            out[i] = (Geometry::PIXEL_TO_SUBPAGE[i] == 0) ? sub0[i] : sub1[i];
+        }
+    }
+}
+
+template <typename Fn>
+double nsPerMerge(Fn fn, Plane& a, Plane& b, Plane& out)
+{
+    constexpr int ITER = 200000;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITER; ++i) {
+        a[i % Geometry::PIXELS] += 1e-6f;   // keep the loop honest
+        fn(a.data(), b.data(), out.data());
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / ITER;
+}
+
+} // namespace
+
+int main() {
+    Plane sub0, sub1, out;
+    for (int p = 0; p < Geometry::PIXELS; ++p) {
+        sub0[p] = 1000.0f + p;
+        sub1[p] = 2000.0f + p;
+    }
+
+    // 1) Both patterns pick every pixel from its own subpage
+    for (bool chess : {true, false}) {
+        out.fill(-1.0f);
+        mergeSubpages(chess, sub0.data(), sub1.data(), out.data());
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            const float want = patternOf(p, chess) ? sub1[p] : sub0[p];
+            if (out[p] != want) {
+                std::cerr << "[FAIL] " << (chess ? "chess" : "interleaved") << " pixel " << p
+                          << " = " << out[p] << ", want " << want << "\n";
+                return 1;
+            }
+        }
+    }
+
+    // 2) In-place half update from a single subpage
+    for (bool chess : {true, false}) {
+        Plane frame = sub0;
+        mergeSubpages(chess, frame.data(), sub1.data(), frame.data());
+        Plane expect;
+        mergeSubpages(chess, sub0.data(), sub1.data(), expect.data());
+        if (frame != expect) {
+            std::cerr << "[FAIL] in-place half update (" << (chess ? "chess" : "interleaved") << ")\n";
+            return 1;
+        }
+    }
+
+    // 3) Chess agrees with the lookup table the reader used to branch on
+    {
+        Plane legacy;
+        legacyMerge(sub0.data(), sub1.data(), legacy.data());
+        mergeSubpages<ReadoutPattern::Chess>(sub0.data(), sub1.data(), out.data());
+        if (legacy != out) {
+            std::cerr << "[FAIL] chess kernel differs from PIXEL_TO_SUBPAGE\n";
+            return 1;
+        }
+    }
+
+    // 4) Microbenchmark
+    const double legacyNs = nsPerMerge(legacyMerge, sub0, sub1, out);
+    const double chessNs  = nsPerMerge(mergeSubpages<ReadoutPattern::Chess>, sub0, sub1, out);
+    const double ilNs     = nsPerMerge(mergeSubpages<ReadoutPattern::Interleaved>, sub0, sub1, out);
+    std::cout << "[BENCH] merge per frame: LUT + branch " << legacyNs << " ns, chess kernel "
+              << chessNs << " ns (" << legacyNs / chessNs << "x), interleaved " << ilNs << " ns\n";
+    if (chessNs > legacyNs) {
+        std::cerr << "[WARN] chess kernel slower than the branching loop on this machine\n";
+    }
+
+    std::cout << "[PASS] subpage merge kernels match the Melexis patterns\n";
+    return 0;
+}
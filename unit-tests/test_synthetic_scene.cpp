@@ -0,0 +1,78 @@
+/**
+ * @file test_synthetic_scene.cpp
+ * @brief Round-trip and throughput test for SyntheticScene.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Generates noise-free subpages, converts them back with the Melexis
+ *   MLX90640_CalculateTo and checks that the ground-truth field, Ta and
+ *   Vdd are recovered. Then measures generator throughput in subpages per
+ *   second. Uses nominal calibration; no hardware needed.
+ */
+
+#include "syntheticScene.hpp"
+#include "mlxTestParams.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int main() {
+    using namespace duosight;
+
+    const paramsMLX90640 params = test::makeNominalParams();
+
+    SceneConfig cfg;
+    cfg.noiseC              = 0.0f;
+    cfg.blobPeakC           = 80.0f;
+    cfg.ambientC            = 31.5f;
+    cfg.ambientDriftCPerSec = 0.01f;
+    SyntheticScene scene(params, cfg);
+
+    std::array<uint16_t, Geometry::WORDS> words{};
+    std::vector<float> to(Geometry::PIXELS);
+    float worst = 0.0f, worstTa = 0.0f;
+
+    for (int i = 0; i < 40; ++i) {
+        scene.nextSubpage(words.data());
+        const float ta = MLX90640_GetTa(words.data(), &params);
+        const float vdd = MLX90640_GetVdd(words.data(), &params);
+        MLX90640_CalculateTo(words.data(), &params, cfg.emissivity, ta, to.data());
+
+        const float expectTa = cfg.ambientC + cfg.ambientDriftCPerSec * scene.timeSec();
+        worstTa = std::max(worstTa, std::fabs(ta - expectTa));
+        if (std::fabs(vdd - cfg.vdd) > 0.01f || words[833] != (i & 1)) {
+            std::cerr << "[FAIL] aux words decode to Vdd=" << vdd << " subpage=" << words[833] << "\n";
+            return 1;
+        }
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            if (Geometry::PIXEL_TO_SUBPAGE[p] != (i & 1)) continue;
+            worst = std::max(worst, std::fabs(to[p] - scene.truth()[p]));
+        }
+    }
+    std::cout << "[INFO] round-trip error: pixels " << worst << " °C, Ta " << worstTa << " °C\n";
+    if (worst > 0.15f || worstTa > 0.05f) {
+        std::cerr << "[FAIL] inverse model does not round-trip\n";
+        return 1;
+    }
+
+    SceneConfig busy;                         // defaults: noise + two blobs
+    busy.blobs = 4;
+    SyntheticScene load(params, busy);
+    constexpr int N = 20000;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) load.nextSubpage(words.data());
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "[BENCH] " << N / s << " subpages/s (" << 1e6 * s / N << " us each)\n";
+    if (N / s < 2000.0) {
+        std::cerr << "[WARN] generator slower than 2000 subpages/s\n";
+        return 2;
+    }
+    std::cout << "[PASS] synthetic scene round-trips through CalculateTo\n";
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_threshold_search.cpp
+ * @brief Exactness check and benchmark for ThresholdSearch.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Drives a stream of subpages with a wandering hot spot and compares the
+ *   hottest pixel and the over-threshold set against brute-force full
+ *   conversion, then reports the cost of both query modes relative to
+ *   MLX90640_CalculateTo. Uses nominal calibration; no hardware needed.
+ */
+
+#include "thresholdSearch.hpp"
+#include "mlxTestParams.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+int main() {
+    using namespace duosight;
+    using Clock = std::chrono::steady_clock;
+
+    const paramsMLX90640 params = test::makeNominalParams();
+    PixelConverter  conv(params);
+    ThresholdSearch search(conv);
+
+    constexpr int   FRAMES = 400;
+    constexpr float ALARM  = 60.0f;
+
+    std::vector<std::array<uint16_t, Geometry::WORDS>> stream;
+    for (int i = 0; i < FRAMES; ++i) {
+        auto w = test::makeSubpageWords(params, i & 1, 100 + i);
+        const int hot = (i * 7) % Geometry::PIXELS;
+        for (int d : {0, 1, 32, 33}) {
+            const int p = (hot + d) % Geometry::PIXELS;
+            w[p] = static_cast<uint16_t>(static_cast<int16_t>(params.offset[p] + 1500 + 3 * (i % 50)));
+        }
+        stream.push_back(w);
+    }
+
+    std::vector<float> full(Geometry::PIXELS);
+    for (auto& w : stream) {
+        const SubpageTerms t = conv.prepare(w.data());
+        conv.convertSubpage(w.data(), t, full.data());
+
+        ThresholdHit ref;
+        size_t refOver = 0;
+        for (int p = 0; p < Geometry::PIXELS; ++p) {
+            if (!conv.inSubpage(p, t)) continue;
+            if (ref.pixel < 0 || full[p] > ref.temperature) ref = {p, full[p]};
+            if (full[p] >= ALARM) ++refOver;
+        }
+
+        const ThresholdHit got = search.hottest(w.data());
+        std::vector<ThresholdHit> hits;
+        const size_t over = search.overThreshold(w.data(), ALARM, hits);
+
+        if (got.pixel != ref.pixel || got.temperature != ref.temperature || over != refOver) {
+            std::cerr << "[FAIL] hottest " << got.pixel << "/" << got.temperature
+                      << " vs " << ref.pixel << "/" << ref.temperature
+                      << ", over " << over << " vs " << refOver << "\n";
+            return 1;
+        }
+    }
+    const auto& st = search.stats();
+    std::cout << "[INFO] screened=" << st.screened << " converted=" << st.converted
+              << " rebuilds=" << st.rebuilds << "\n";
+
+    // Benchmark
+    constexpr int REPS = 5;
+    float sink = 0.0f;
+    auto t0 = Clock::now();
+    for (int r = 0; r < REPS; ++r) {
+        for (auto& w : stream) {
+            const float ta = MLX90640_GetTa(w.data(), &params);
+            MLX90640_CalculateTo(w.data(), &params, IRParams::EMISSIVITY, ta, full.data());
+            sink += full[0];
+        }
+    }
+    const double fullUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count()
+                        / (REPS * FRAMES);
+
+    t0 = Clock::now();
+    for (int r = 0; r < REPS; ++r) {
+        for (auto& w : stream) sink += search.hottest(w.data()).temperature;
+    }
+    const double hotUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count()
+                       / (REPS * FRAMES);
+
+    std::vector<ThresholdHit> hits;
+    t0 = Clock::now();
+    for (int r = 0; r < REPS; ++r) {
+        for (auto& w : stream) {
+            hits.clear();
+            sink += static_cast<float>(search.overThreshold(w.data(), ALARM, hits));
+        }
+    }
+    const double overUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count()
+                        / (REPS * FRAMES);
+
+    std::cout << "[BENCH] CalculateTo " << fullUs << " us, hottest " << hotUs
+              << " us (x" << fullUs / hotUs << "), over-threshold " << overUs
+              << " us (x" << fullUs / overUs << ")  [" << sink << "]\n";
+
+    if (hotUs >= fullUs || overUs >= fullUs) {
+        std::cerr << "[WARN] early-out search not faster than full conversion\n";
+        return 2;
+    }
+    std::cout << "[PASS] early-out search is exact\n";
+    return 0;
+}
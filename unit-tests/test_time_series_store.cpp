@@ -0,0 +1,216 @@
+/**
+ * @file test_time_series_store.cpp
+ * @brief Functional test and benchmark for TimeSeriesStore.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   Writes a year of ROI statistics (one sample every 10 s, jittered) for
+ *   an XOR and a fixed-point series, closing and reopening the file half
+ *   way. Checks raw round trips, that every hourly bucket matches a brute
+ *   force roll-up of the inputs, and that a read-only open sees the same
+ *   data. Prints bytes per sample and the time of year-long range
+ *   queries. No hardware needed.
+ */
+
+#include "timeSeriesStore.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+
+namespace {
+
+struct Expected {
+    float    min   {0.0f};
+    float    max   {0.0f};
+    double   sum   {0.0};
+    uint32_t count {0};
+};
+
+double msSince(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main() {
+    using namespace duosight;
+
+    char path[] = "/tmp/duosight-tsdb-XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        std::cerr << "[FAIL] cannot create temporary file\n";
+        return 1;
+    }
+    close(fd);
+
+    constexpr int64_t T0      = 1'735'689'600'000;   // 2025-01-01 00:00 UTC
+    constexpr int64_t STEP    = 10'000;
+    constexpr int     SAMPLES = 365 * 24 * 360;      // one year at 10 s
+    constexpr float   QUANTUM = 0.01f;
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> jitter(-40, 40);
+    std::normal_distribution<float>    noise(0.0f, 0.15f);
+
+    std::vector<int64_t> times(SAMPLES);
+    std::vector<float>   values(SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i) {
+        times[i]  = T0 + int64_t(i) * STEP + jitter(rng);
+        const double day = (times[i] - T0) / 86'400'000.0;
+        values[i] = static_cast<float>(24.0 + 6.0 * std::sin(day * 2 * M_PI / 365.0)
+                                       + 3.0 * std::sin(day * 2 * M_PI)) + noise(rng);
+    }
+
+    // Write half, reopen, write the rest
+    auto store = std::make_unique<TimeSeriesStore>(path);
+    int exact = store->addSeries("roi0.max");
+    int fixed = store->addSeries("roi0.mean", {SeriesEncoding::FixedPoint, QUANTUM});
+    if (!store->isValid() || exact < 0 || fixed < 0) {
+        std::cerr << "[FAIL] could not create store\n";
+        return 1;
+    }
+
+    const auto tWrite = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; ++i) {
+        if (i == SAMPLES / 2) {
+            store = std::make_unique<TimeSeriesStore>(path);
+            if (store->findSeries("roi0.max") != exact || store->findSeries("roi0.mean") != fixed) {
+                std::cerr << "[FAIL] series lost on reopen\n";
+                return 1;
+            }
+        }
+        if (!store->append(exact, times[i], values[i]) || !store->append(fixed, times[i], values[i])) {
+            std::cerr << "[FAIL] append " << i << " rejected\n";
+            return 1;
+        }
+    }
+    const double writeMs = msSince(tWrite);
+
+    if (store->append(exact, times.back() - 1, 0.0f)) {
+        std::cerr << "[FAIL] out-of-order timestamp accepted\n";
+        return 1;
+    }
+
+    const StoreStats st = store->stats();
+    std::cout << "[INFO] " << st.samples << " samples in " << st.blocks << " blocks, "
+              << st.bytes / 1024 << " KiB including tiers\n";
+    std::cout << "[BENCH] append: " << writeMs * 1e6 / (2.0 * SAMPLES) << " ns/sample\n";
+
+    // Raw round trip over one day in the middle (spans the reopen)
+    const int first = SAMPLES / 2 - 4000;
+    const int last  = SAMPLES / 2 + 4640;
+    std::vector<Sample> raw, rawFixed;
+    store->query(exact, times[first], times[last], raw);
+    store->query(fixed, times[first], times[last], rawFixed);
+    if (raw.size() != size_t(last - first + 1) || rawFixed.size() != raw.size()) {
+        std::cerr << "[FAIL] raw query returned " << raw.size() << " samples\n";
+        return 1;
+    }
+    for (size_t k = 0; k < raw.size(); ++k) {
+        const int i = first + static_cast<int>(k);
+        if (raw[k].timeMs != times[i] || raw[k].value != values[i]
+            || rawFixed[k].timeMs != times[i]
+            || std::fabs(rawFixed[k].value - values[i]) > QUANTUM * 0.51f) {
+            std::cerr << "[FAIL] raw sample " << i << " differs\n";
+            return 1;
+        }
+    }
+
+    // Hourly buckets against a brute-force roll-up
+    std::map<int64_t, Expected> hours;
+    for (int i = 0; i < SAMPLES; ++i) {
+        const int64_t h = times[i] - (((times[i] % 3'600'000) + 3'600'000) % 3'600'000);
+        Expected& e = hours[h];
+        if (!e.count) {
+            e.min = e.max = values[i];
+        }
+        e.min = std::min(e.min, values[i]);
+        e.max = std::max(e.max, values[i]);
+        e.sum += values[i];
+        ++e.count;
+    }
+
+    // Exact series must match bit for bit, fixed-point within a quantum
+    double yearHourMs = 0.0;
+    std::vector<Aggregate> hourly;
+    for (const int id : {exact, fixed}) {
+        const float tol = id == fixed ? QUANTUM * 0.51f : 0.0f;
+        hourly.clear();
+        const auto tYear = std::chrono::steady_clock::now();
+        store->query(id, Tier::Hour, T0 - 3'600'000, times.back(), hourly);
+        yearHourMs = std::max(yearHourMs, msSince(tYear));
+
+        if (hourly.size() != hours.size()) {
+            std::cerr << "[FAIL] " << hourly.size() << " hourly buckets, expected "
+                      << hours.size() << "\n";
+            return 1;
+        }
+        size_t k = 0;
+        for (const auto& [start, e] : hours) {
+            const Aggregate& a = hourly[k++];
+            if (a.timeMs != start || a.count != e.count
+                || std::fabs(a.min - e.min) > tol || std::fabs(a.max - e.max) > tol
+                || std::fabs(a.mean - e.sum / e.count) > tol + 1e-3) {
+                std::cerr << "[FAIL] hour bucket " << start << " mismatch (count " << a.count
+                          << " vs " << e.count << ")\n";
+                return 1;
+            }
+        }
+    }
+
+    const auto tMinute = std::chrono::steady_clock::now();
+    std::vector<Sample> minuteMax;
+    store->query(exact, Tier::Minute, Field::Max, T0, times.back(), minuteMax);
+    const double yearMinuteMs = msSince(tMinute);
+
+    const auto tDay = std::chrono::steady_clock::now();
+    raw.clear();
+    store->query(exact, times[SAMPLES - 8640], times.back(), raw);
+    const double dayRawMs = msSince(tDay);
+
+    std::cout << "[BENCH] year of hourly aggregates (" << hourly.size() << "): "
+              << yearHourMs << " ms\n";
+    std::cout << "[BENCH] year of minute maxima (" << minuteMax.size() << "): "
+              << yearMinuteMs << " ms\n";
+    std::cout << "[BENCH] one day raw (" << raw.size() << "): " << dayRawMs << " ms\n";
+
+    if (TimeSeriesStore::tierFor(T0, times.back(), 10'000) != Tier::Hour
+        || TimeSeriesStore::tierFor(T0, T0 + 86'400'000, 2'000) != Tier::Minute) {
+        std::cerr << "[FAIL] tierFor picked the wrong tier\n";
+        return 1;
+    }
+
+    // A read-only reader sees the same history, open buckets included
+    store.reset();
+    TimeSeriesStore reader(path, true);
+    std::vector<Aggregate> again;
+    reader.query(reader.findSeries("roi0.mean"), Tier::Hour, T0 - 3'600'000, times.back(), again);
+    const bool sameCount = again.size() == hourly.size();
+    const bool sameLast  = sameCount && again.back().count == hourly.back().count;
+    std::remove(path);
+    if (!sameCount || !sameLast || reader.append(0, times.back() + 1, 0.0f)) {
+        std::cerr << "[FAIL] read-only reopen differs\n";
+        return 1;
+    }
+
+    std::cout << "[INFO] raw: " << static_cast<double>(st.rawBlocks * TimeSeriesStore::BLOCK_BYTES)
+                                    / st.samples << " bytes/sample; with tiers: "
+              << static_cast<double>(st.bytes) / st.samples << " bytes/sample\n";
+    if (yearHourMs > 50.0) {
+        std::cerr << "[WARN] year-long hourly query took " << yearHourMs << " ms\n";
+        return 2;
+    }
+    std::cout << "[PASS] store round-trips and rolls up a year of statistics\n";
+    return 0;
+}
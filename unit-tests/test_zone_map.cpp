@@ -0,0 +1,253 @@
+/**
+ * @file test_zone_map.cpp
+ * @brief Zone-mapped recordings: pruned queries match a full scan, month benchmark.
+ *
+ * (c) 2025 Highland Biosciences
+ * Author: Dr Richard Day
+ * Email: richard_day@highlandbiosciences.com
+ *
+ * Summary:
+ *   A month of frames at one per minute (43,200 frames, about 140 MB) is
+ *   recorded through ZoneMapRecorder and RecordingWriter. The scene is a
+ *   daily temperature swing with noise, a few hot events inside a
+ *   recorded ROI, and decoys: hot events elsewhere in the same tile, and
+ *   in another tile. Queries for "any pixel above 90 °C" must return
+ *   exactly the frames the generator knows about, with and without the
+ *   zone maps. This is checked for the recorded ROI, an unrecorded ROI
+ *   inside it, one bounded only by its tile, a time-bounded window and an
+ *   empty below-threshold query. Header summaries must agree with the
+ *   generator's extremes. The benchmark reports index-open time and query
+ *   time with pruning, against a full scan on four workers and on one.
+ *   No hardware needed; the file goes to /tmp.
+ */
+
+#include "zoneMap.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace duosight;
+
+namespace {
+
+constexpr int     W = Geometry::WIDTH;
+constexpr int     MINUTES = 30 * 24 * 60;
+constexpr int64_t MINUTE_NS = 60'000'000'000LL;
+
+struct Event { int start, minutes; float x, y, sigma, peak; };
+
+// Three in ROI X, two decoys in its tile but outside it, two in the far corner
+const std::vector<Event> EVENTS = {
+    {3'000, 20, 5.5f, 5.5f, 1.2f, 110.0f},
+    {17'500, 15, 5.0f, 6.0f, 1.0f, 98.0f},
+    {31'000, 30, 6.5f, 4.5f, 1.5f, 120.0f},
+    {9'000, 25, 0.5f, 0.5f, 0.6f, 125.0f},
+    {26'000, 10, 1.0f, 0.0f, 0.6f, 105.0f},
+    {12'000, 40, 28.0f, 20.0f, 1.5f, 100.0f},
+    {40'000, 20, 27.0f, 21.0f, 1.5f, 95.0f},
+};
+
+const Roi ROI_X {4, 4, 4, 4};   // recorded
+const Roi ROI_Y {5, 5, 2, 2};   // not recorded, inside ROI X
+const Roi ROI_Z {0, 0, 3, 3};   // not recorded; only the tile bounds it
+
+uint32_t rng = 12345;
+float noise()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng & 0xffff) / 65535.0f * 0.6f - 0.3f;
+}
+
+void render(int minute, ThermalFrame& f)
+{
+    f.sequence    = static_cast<uint64_t>(minute);
+    f.timestampNs = minute * MINUTE_NS;
+    const float base = 25.0f + 3.0f * std::sin(2.0f * 3.14159265f * minute / (24 * 60));
+    for (float& v : f.temperatures) v = base + noise();
+    for (const Event& e : EVENTS) {
+        if (minute < e.start || minute >= e.start + e.minutes) continue;
+        for (int p = 0; p < static_cast<int>(Geometry::PIXELS); ++p) {
+            const float dx = p % W - e.x, dy = p / W - e.y;
+            f.temperatures[p] += (e.peak - base) * std::exp(-(dx * dx + dy * dy) / (2 * e.sigma * e.sigma));
+        }
+    }
+}
+
+float roiMax(const ThermalFrame& f, const Roi& r)
+{
+    float mx = -1e9f;
+    for (int y = r.y; y < r.y + r.h; ++y) {
+        for (int x = r.x; x < r.x + r.w; ++x) mx = std::max(mx, f.temperatures[y * W + x]);
+    }
+    return mx;
+}
+
+bool sameMinutes(const std::vector<ZoneHit>& hits, const std::vector<int>& want)
+{
+    if (hits.size() != want.size()) return false;
+    for (size_t i = 0; i < hits.size(); ++i) {
+        if (hits[i].sequence != static_cast<uint64_t>(want[i])) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    bool ok = true;
+
+    char path[] = "/tmp/duosight-zones-XXXXXX";
+    const int tmp = mkstemp(path);
+    if (tmp >= 0) ::close(tmp);
+
+    // Record the month, keeping the generator's own answers
+    std::vector<int> hotX, hotY, hotZ, hotXWeek2;
+    float maxX = -1e9f;
+    ZoneRecorderStats rs;
+    double recordMs;
+    {
+        RecordingOptions ro;
+        RecordingWriter writer(path, ro);
+        ZoneMapOptions zo;
+        zo.rois = {ROI_X};
+        ZoneMapRecorder rec(writer, zo);
+        ThermalFrame f;
+        const auto t0 = Clock::now();
+        for (int m = 0; m < MINUTES; ++m) {
+            render(m, f);
+            const float mx = roiMax(f, ROI_X);
+            maxX = std::max(maxX, mx);
+            if (mx > 90.0f) {
+                hotX.push_back(m);
+                if (m >= 7 * 24 * 60 && m < 14 * 24 * 60) hotXWeek2.push_back(m);
+            }
+            if (roiMax(f, ROI_Y) > 90.0f) hotY.push_back(m);
+            if (roiMax(f, ROI_Z) > 90.0f) hotZ.push_back(m);
+            // Offline the test can wait for the disk; live acquisition would not
+            while (writer.stats().queueDepth + 1 >= ro.buffers) std::this_thread::yield();
+            rec.append(f);
+        }
+        rec.finish();
+        writer.close();
+        recordMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        rs = rec.stats();
+    }
+    std::cout << "[INFO] recorded " << rs.frames << " frames in " << rs.blocks << " blocks (" << recordMs
+              << " ms); hot minutes: " << hotX.size() << " in ROI X, " << hotY.size() << " in ROI Y, "
+              << hotZ.size() << " in ROI Z\n";
+    if (rs.frames != MINUTES || rs.droppedBlocks || hotX.empty() || hotY.empty() || hotZ.empty()) {
+        std::cerr << "[FAIL] recording: " << rs.droppedBlocks << " blocks dropped\n";
+        ok = false;
+    }
+
+    auto t0 = Clock::now();
+    RecordingIndex index(path);
+    const double openMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (!index.isValid() || index.frames() != MINUTES || index.rois().size() != 1
+        || index.rois()[0].x != ROI_X.x || index.rois()[0].w != ROI_X.w) {
+        std::cerr << "[FAIL] index: " << index.frames() << " frames\n";
+        return 1;
+    }
+
+    WorkStealingPool pool(4);   // the board's four A53 cores
+    WorkStealingPool single(1);
+
+    // 1) Pruned queries return exactly the generator's frames, as does a full scan
+    {
+        struct Case { const char* name; ZoneQuery q; const std::vector<int>& want; };
+        ZoneQuery x;
+        x.roi   = ROI_X;
+        x.above = 90.0f;
+        ZoneQuery y = x;
+        y.roi = ROI_Y;
+        ZoneQuery z = x;
+        z.roi = ROI_Z;
+        ZoneQuery week2 = x;
+        week2.fromNs = 7 * 24 * 60 * MINUTE_NS;
+        week2.toNs   = 14 * 24 * 60 * MINUTE_NS - 1;
+        const std::vector<Case> cases = {{"ROI X > 90", x, hotX}, {"ROI Y > 90", y, hotY},
+                                         {"ROI Z > 90", z, hotZ},
+                                         {"ROI X > 90, week 2", week2, hotXWeek2}};
+        for (const Case& c : cases) {
+            ZoneQueryStats pruned, full;
+            ZoneQuery scan = c.q;
+            scan.useZoneMaps = false;
+            const bool same = sameMinutes(index.query(c.q, pool, &pruned), c.want)
+                           && sameMinutes(index.query(scan, pool, &full), c.want);
+            std::cout << "[INFO] " << c.name << ": " << c.want.size() << " frames; decoded "
+                      << pruned.candidates << " of " << pruned.blocks << " blocks\n";
+            if (!same || pruned.candidates >= full.candidates) {
+                std::cerr << "[FAIL] " << c.name << " differs from the generator or pruned nothing\n";
+                ok = false;
+            }
+        }
+
+        ZoneQuery cold;
+        cold.roi   = ROI_X;
+        cold.below = 15.0f;
+        ZoneQueryStats st;
+        if (!index.query(cold, pool, &st).empty() || st.candidates) {
+            std::cerr << "[FAIL] below-threshold query decoded " << st.candidates << " blocks\n";
+            ok = false;
+        }
+    }
+
+    // 2) Header summaries agree with the generator
+    {
+        float mx = -1e9f;
+        uint64_t frames = 0;
+        for (const ZoneSummary& s : index.summaries(SceneTiles::COUNT, INT64_MIN, INT64_MAX)) {
+            mx = std::max(mx, s.range.max);
+            frames += s.frames;
+        }
+        if (mx != maxX || frames != MINUTES || !index.summaries(SceneTiles::COUNT + 1, 0, INT64_MAX).empty()) {
+            std::cerr << "[FAIL] ROI X summary max " << mx << " vs " << maxX << "\n";
+            ok = false;
+        }
+    }
+
+    // 3) Query time over the month (page cache warm)
+    {
+        ZoneQuery q;
+        q.roi   = ROI_X;
+        q.above = 90.0f;
+        ZoneQuery scan = q;
+        scan.useZoneMaps = false;
+        index.query(scan, pool);   // warm the cache
+
+        auto best = [&](const ZoneQuery& query, WorkStealingPool& p, ZoneQueryStats& st) {
+            double ms = 1e30;
+            for (int i = 0; i < 3; ++i) {
+                index.query(query, p, &st);
+                ms = std::min(ms, st.ms);
+            }
+            return ms;
+        };
+        ZoneQueryStats a, b, c;
+        const double prunedMs = best(q, pool, a);
+        const double scanMs   = best(scan, pool, b);
+        const double serialMs = best(scan, single, c);
+        std::cout << "[BENCH] month at 1 frame/min, " << index.blocks() << " blocks: index open "
+                  << openMs << " ms; ROI X > 90 °C in " << prunedMs << " ms (" << a.candidates
+                  << " blocks, " << a.frames << " frames decoded) vs full scan " << scanMs << " ms on "
+                  << pool.workerCount() << " workers (" << std::thread::hardware_concurrency() << " cores here), "
+                  << serialMs << " ms on one ("
+                  << scanMs / prunedMs << "x / " << serialMs / prunedMs << "x)\n";
+    }
+
+    std::remove(path);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "[PASS] zone-mapped queries exact, irrelevant blocks skipped\n";
+    return 0;
+}